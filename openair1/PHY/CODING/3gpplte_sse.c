@@ -43,6 +43,9 @@
 #include <stdlib.h>
 
 #include "PHY/sse_intrin.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 #define print_bytes(s,x) printf("%s %x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x\n",s,(x)[0],(x)[1],(x)[2],(x)[3],(x)[4],(x)[5],(x)[6],(x)[7],(x)[8],(x)[9],(x)[10],(x)[11],(x)[12],(x)[13],(x)[14],(x)[15])
 #define print_shorts(s,x) printf("%s %x,%x,%x,%x,%x,%x,%x,%x\n",s,(x)[0],(x)[1],(x)[2],(x)[3],(x)[4],(x)[5],(x)[6],(x)[7])
@@ -54,43 +57,19 @@
 unsigned short threegpplte_interleaver_output;
 unsigned long long threegpplte_interleaver_tmp;
 
-#if defined(__x86_64__) || defined(__i386__)
-struct treillis {
-  union {
-    __m64 systematic_64[3];
-    char systematic_8[24];
-  };
-  union {
-    __m64 parity1_64[3];
-    char parity1_8[24];
-  };
-  union {
-    __m64 parity2_64[3];
-    char parity2_8[24];
-  };
-  int exit_state;
-}  __attribute__ ((aligned(64)));
-
-#elif defined(__arm__)
-
-struct treillis {
-  union {
-    uint8x8_t systematic_64[3];
-    char systematic_8[24];
-  }__attribute__((aligned(64)));
-  union {
-    uint8x8_t parity1_64[3];
-    char parity1_8[24];
-  }__attribute__((aligned(64)));
-  union {
-    uint8x8_t parity2_64[3];
-    char parity2_8[24];
-  }__attribute__((aligned(64)));
-  int exit_state;
-};
-#endif
-
-struct treillis all_treillis[8][256];
+// Encoder tables. The RSC code is linear, so the parity bits and the exit state of a group of input
+// bits are the xor of the response to the input from state 0 and of the zero-input response of the
+// initial state. The input bits are taken in transmission order from a little-endian 16-bit load
+// (MSB of the first byte first) and the parity bits are returned in the same layout, so that one
+// lookup in turbo_lut16 and one in turbo_zs16 step both the state and the output over 16 bits.
+// turbo_lut8/turbo_zs8 do the same for the odd byte at the end of the code blocks with K/8 odd.
+// Entries hold parity | (exit_state<<16) (resp. <<8).
+static uint32_t turbo_lut16[1<<16];
+static uint32_t turbo_zs16[8];
+static uint16_t turbo_lut8[256];
+static uint16_t turbo_zs8[8];
+// f1f2mat index of each code block size (in bytes), -1 if the size is not in Table 5.1.3-3 of 36-212
+static short turbo_iind[(6144>>3)+1];
 int all_treillis_initialized=0;
 
 static inline unsigned char threegpplte_rsc(unsigned char input,unsigned char *state)
@@ -108,37 +87,173 @@ static inline void threegpplte_rsc_termination(unsigned char *x,unsigned char *z
   *state = (*state)>>1;
 }
 
+// runs nb_bits (8 or 16) bits of u through the RSC from state, returns parity | (exit_state<<nb_bits)
+static uint32_t threegpplte_rsc_word(uint32_t u,int nb_bits,unsigned char state)
+{
+
+  uint32_t parity=0;
+  int b,pos;
+
+  for (b=0; b<nb_bits; b++) {
+    pos = ((b>>3)<<3) + 7 - (b&7);
+    parity |= (uint32_t)threegpplte_rsc((u>>pos)&1,&state)<<pos;
+  }
+
+  return(parity | ((uint32_t)state<<nb_bits));
+}
+
 void treillis_table_init(void)
 {
-  //struct treillis t[][]=all_treillis;
-  //t=memalign(16,sizeof(struct treillis)*8*256);
-  int i, j,b;
-  unsigned char v, current_state;
-
-  // clear all_treillis
-  for (i=0; i<8; i++)
-    bzero( all_treillis[i], sizeof(all_treillis[0]) );
-
-  for (i=0; i<8; i++) { //all possible initial states
-    for (j=0; j<=255; j++) { // all possible values of a byte
-      current_state=i;
-
-      for (b=0; b<8 ; b++ ) { // pre-compute the image of the byte j in _m128i vector right place
-        all_treillis[i][j].systematic_8[b*3]= (j&(1<<(7-b)))>>(7-b);
-        v=threegpplte_rsc( all_treillis[i][j].systematic_8[b*3] ,
-                           &current_state);
-        all_treillis[i][j].parity1_8[b*3+1]=v; // for the yparity1
-        all_treillis[i][j].parity2_8[b*3+2]=v; // for the yparity2
-      }
-
-      all_treillis[i][j].exit_state=current_state;
-    }
+
+  int i;
+
+  for (i=0; i<(1<<16); i++)
+    turbo_lut16[i] = threegpplte_rsc_word(i,16,0);
+
+  for (i=0; i<256; i++)
+    turbo_lut8[i] = threegpplte_rsc_word(i,8,0);
+
+  for (i=0; i<8; i++) {
+    turbo_zs16[i] = threegpplte_rsc_word(0,16,i);
+    turbo_zs8[i]  = threegpplte_rsc_word(0,8,i);
   }
 
+  for (i=0; i<=(6144>>3); i++)
+    turbo_iind[i] = -1;
+
+  for (i=0; i<188; i++)
+    turbo_iind[f1f2mat[i].nb_bits>>3] = i;
+
   all_treillis_initialized=1;
   return ;
 }
 
+// Output expansion: bit b of the systematic, parity1 and parity2 words (held in bytes 0-1, 2-3 and 4-5 of w)
+// goes to bytes 3b, 3b+1 and 3b+2 of the output, as 0/1.
+static const uint8_t turbo_expand_byte[48] __attribute__((aligned(32))) = {
+  0,2,4, 0,2,4, 0,2,4, 0,2,4, 0,2,4, 0,2,4, 0,2,4, 0,2,4,
+  1,3,5, 1,3,5, 1,3,5, 1,3,5, 1,3,5, 1,3,5, 1,3,5, 1,3,5
+};
+
+static const uint8_t turbo_expand_mask[48] __attribute__((aligned(32))) = {
+  0x80,0x80,0x80, 0x40,0x40,0x40, 0x20,0x20,0x20, 0x10,0x10,0x10,
+  0x08,0x08,0x08, 0x04,0x04,0x04, 0x02,0x02,0x02, 0x01,0x01,0x01,
+  0x80,0x80,0x80, 0x40,0x40,0x40, 0x20,0x20,0x20, 0x10,0x10,0x10,
+  0x08,0x08,0x08, 0x04,0x04,0x04, 0x02,0x02,0x02, 0x01,0x01,0x01
+};
+
+static inline void threegpplte_expand(uint64_t w,unsigned char *output,int nb_bytes)
+{
+
+  int j;
+
+  for (j=0; j<nb_bytes; j++)
+    output[j] = (((uint8_t)(w>>(turbo_expand_byte[j]<<3)))&turbo_expand_mask[j]) ? 1 : 0;
+}
+
+// 16 bits of both constituent encoders, returns the word to expand (systematic | parity1<<16 | parity2<<32)
+static inline uint64_t threegpplte_rsc16(uint32_t s1,uint32_t s2,unsigned char *state0,unsigned char *state1) __attribute__((always_inline));
+static inline uint64_t threegpplte_rsc16(uint32_t s1,uint32_t s2,unsigned char *state0,unsigned char *state1)
+{
+
+  uint32_t v1 = turbo_lut16[s1]^turbo_zs16[*state0];
+  uint32_t v2 = turbo_lut16[s2]^turbo_zs16[*state1];
+
+  *state0 = v1>>16;
+  *state1 = v2>>16;
+
+  return((uint64_t)s1 | ((uint64_t)(v1&0xffff)<<16) | ((uint64_t)(v2&0xffff)<<32));
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define AVX2_FUNC __attribute__((target("avx2")))
+
+static int te_avx2 = -1;
+
+static inline int te_avx2_enabled(void) __attribute__((always_inline));
+static inline int te_avx2_enabled(void)
+{
+
+  if (te_avx2 < 0)
+    te_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+
+  return(te_avx2);
+}
+
+int te_set_avx2(int enable)
+{
+
+  te_avx2 = (enable && __builtin_cpu_supports("avx2")) ? 1 : 0;
+
+  return(te_avx2);
+}
+
+static inline void threegpplte_expand48_avx2(uint64_t w,unsigned char *output) AVX2_FUNC;
+static inline void threegpplte_expand48_avx2(uint64_t w,unsigned char *output)
+{
+
+  const __m256i one = _mm256_set1_epi8(1);
+  __m256i w256 = _mm256_set1_epi64x(w);
+
+  _mm256_storeu_si256((__m256i *)output,
+                      _mm256_min_epu8(_mm256_and_si256(_mm256_shuffle_epi8(w256,_mm256_load_si256((__m256i *)turbo_expand_byte)),
+                                                       _mm256_load_si256((__m256i *)turbo_expand_mask)),
+                                      one));
+  _mm_storeu_si128((__m128i *)(output+32),
+                   _mm_min_epu8(_mm_and_si128(_mm_shuffle_epi8(_mm256_castsi256_si128(w256),_mm_load_si128((__m128i *)(turbo_expand_byte+32))),
+                                              _mm_load_si128((__m128i *)(turbo_expand_mask+32))),
+                                _mm256_castsi256_si128(one)));
+}
+
+static void threegpplte_rsc16_avx2(unsigned char *input,unsigned char *systematic2,int nb_words,unsigned char *output,
+                                   unsigned char *state0,unsigned char *state1) AVX2_FUNC;
+static void threegpplte_rsc16_avx2(unsigned char *input,unsigned char *systematic2,int nb_words,unsigned char *output,
+                                   unsigned char *state0,unsigned char *state1)
+{
+
+  int i;
+
+  for (i=0; i<nb_words; i++)
+    threegpplte_expand48_avx2(threegpplte_rsc16(((uint16_t *)input)[i],((uint16_t *)systematic2)[i],state0,state1),
+                              output+(48*i));
+}
+
+#else
+
+int te_set_avx2(int enable)
+{
+
+  return(0);
+}
+
+#endif
+
+// 48 output bytes for 16 input bits
+static inline void threegpplte_expand48(uint64_t w,unsigned char *output)
+{
+
+#if defined(__SSSE3__)
+  const __m128i one = _mm_set1_epi8(1);
+  __m128i w128 = _mm_set1_epi64x(w);
+  int j;
+
+  for (j=0; j<48; j+=16)
+    _mm_storeu_si128((__m128i *)(output+j),
+                     _mm_min_epu8(_mm_and_si128(_mm_shuffle_epi8(w128,_mm_load_si128((__m128i *)(turbo_expand_byte+j))),
+                                                _mm_load_si128((__m128i *)(turbo_expand_mask+j))),
+                                  one));
+#elif defined(__arm__)
+  const uint8x8_t one = vdup_n_u8(1);
+  uint8x8_t w8 = vcreate_u8(w);
+  int j;
+
+  for (j=0; j<48; j+=8)
+    vst1_u8(output+j,vmin_u8(vand_u8(vtbl1_u8(w8,vld1_u8(turbo_expand_byte+j)),vld1_u8(turbo_expand_mask+j)),one));
+#else
+  threegpplte_expand(w,output,48);
+#endif
+}
 
 char interleave_compact_byte(short * base_interleaver,unsigned char * input, unsigned char * output, int n)
 {
@@ -363,6 +478,16 @@ char interleave_compact_byte(short * base_interleaver,unsigned char * input, uns
 #endif
   }
 
+  // last byte of the code blocks with K/8 odd
+  if ((n&1) > 0) {
+    unsigned char last=0;
+
+    for (i=0; i<8; i++)
+      last |= (expandInput[*ptr_intl++]&1)<<(7-i);
+
+    output[n-1] = last;
+  }
+
   return n;
 }
 
@@ -377,67 +502,58 @@ char interleave_compact_byte(short * base_interleaver,unsigned char * input, uns
   }
 */
 
-void threegpplte_turbo_encoder(unsigned char *input,
-                               unsigned short input_length_bytes,
-                               unsigned char *output,
-                               unsigned char F,
-                               unsigned short interleaver_f1,
-                               unsigned short interleaver_f2)
+static inline short *threegpplte_interleaver_lookup(unsigned short input_length_bytes)
 {
 
-  int i;
-  unsigned char *x;
-  unsigned char state0=0,state1=0;
-  unsigned short input_length_bits = input_length_bytes<<3;
-  short * base_interleaver;
-
-  if (  all_treillis_initialized == 0 )
-    treillis_table_init();
-
-  // look for f1 and f2 precomputed interleaver values
-  for (i=0; i < 188 && f1f2mat[i].nb_bits != input_length_bits; i++);
-
-  if ( i == 188 ) {
+  if ((input_length_bytes > (6144>>3)) || (turbo_iind[input_length_bytes] < 0)) {
     printf("Illegal frame length!\n");
-    return;
-  } else {
-    base_interleaver=il_tb+f1f2mat[i].beg_index;
+    return(NULL);
   }
 
+  return(il_tb+f1f2mat[turbo_iind[input_length_bytes]].beg_index);
+}
+
+static void threegpplte_turbo_encode_block(unsigned char *input,
+    unsigned short input_length_bytes,
+    unsigned char *output,
+    short *base_interleaver)
+{
+
+  int i;
+  unsigned char *x;
+  unsigned char state0=0,state1=0;
+  unsigned char systematic2[768] __attribute__((aligned(16)));
+  uint32_t s1,s2,v1,v2;
 
-  unsigned char systematic2[768];
   interleave_compact_byte(base_interleaver,input,systematic2,input_length_bytes);
 
+  // both constituent encoders over 16 bits per iteration, the states are the only serial dependency
+  i=0;
 #if defined(__x86_64__) || defined(__i386__)
-  __m64 *ptr_output=(__m64*) output;
-#elif defined(__arm__)
-  uint8x8_t *ptr_output=(uint8x8_t*)output; 
-#endif
-  unsigned char cur_s1, cur_s2;
-  int code_rate;
 
-  for ( state0=state1=i=0 ; i<input_length_bytes; i++ ) {
-    cur_s1=input[i];
-    cur_s2=systematic2[i];
+  if (te_avx2_enabled()) {
+    threegpplte_rsc16_avx2(input,systematic2,input_length_bytes>>1,output,&state0,&state1);
+    i = input_length_bytes>>1;
+  }
 
-    for ( code_rate=0; code_rate<3; code_rate++) {
-#if defined(__x86_64__) || defined(__i386__)
-      *ptr_output++ = _mm_add_pi8(all_treillis[state0][cur_s1].systematic_64[code_rate],
-                                  _mm_add_pi8(all_treillis[state0][cur_s1].parity1_64[code_rate],
-                                              all_treillis[state1][cur_s2].parity2_64[code_rate]));
-#elif defined(__arm__)
-      uint8x8_t ptmp = vadd_u8(all_treillis[state0][cur_s1].parity1_64[code_rate],
-                               all_treillis[state1][cur_s2].parity2_64[code_rate]);
-      *ptr_output++ = vadd_u8(all_treillis[state0][cur_s1].systematic_64[code_rate],
-                              ptmp);
 #endif
-    }
 
-    state0=all_treillis[state0][cur_s1].exit_state;
-    state1=all_treillis[state1][cur_s2].exit_state;
+  for (; i<(input_length_bytes>>1); i++)
+    threegpplte_expand48(threegpplte_rsc16(((uint16_t *)input)[i],((uint16_t *)systematic2)[i],&state0,&state1),
+                         output+(48*i));
+
+  if ((input_length_bytes&1) > 0) {
+    s1 = input[input_length_bytes-1];
+    s2 = systematic2[input_length_bytes-1];
+    v1 = turbo_lut8[s1]^turbo_zs8[state0];
+    v2 = turbo_lut8[s2]^turbo_zs8[state1];
+    state0 = v1>>8;
+    state1 = v2>>8;
+    threegpplte_expand((uint64_t)s1 | ((uint64_t)(v1&0xff)<<16) | ((uint64_t)(v2&0xff)<<32),
+                       output+(48*i),24);
   }
 
-  x=output+(input_length_bits*3);
+  x=output+(input_length_bytes*24);
 
   // Trellis termination
   threegpplte_rsc_termination(&x[0],&x[1],&state0);
@@ -469,10 +585,51 @@ void threegpplte_turbo_encoder(unsigned char *input,
 #ifdef DEBUG_TURBO_ENCODER
   printf("term: x0 %d, x1 %d, state1 %d\n",x[10],x[11],state1);
 #endif //DEBUG_TURBO_ENCODER
-#if defined(__x86_64__) || defined(__i386__)
-  _mm_empty();
-  _m_empty();
-#endif
+}
+
+void threegpplte_turbo_encoder(unsigned char *input,
+                               unsigned short input_length_bytes,
+                               unsigned char *output,
+                               unsigned char F,
+                               unsigned short interleaver_f1,
+                               unsigned short interleaver_f2)
+{
+
+  short * base_interleaver;
+
+  if (  all_treillis_initialized == 0 )
+    treillis_table_init();
+
+  if ((base_interleaver = threegpplte_interleaver_lookup(input_length_bytes)) == NULL)
+    return;
+
+  threegpplte_turbo_encode_block(input,input_length_bytes,output,base_interleaver);
+}
+
+void threegpplte_turbo_encoder_segments(unsigned char **input,
+                                        unsigned short *input_length_bytes,
+                                        unsigned char **output,
+                                        int nb_segments)
+{
+
+  int r;
+  unsigned short length=0;
+  short * base_interleaver=NULL;
+
+  if (  all_treillis_initialized == 0 )
+    treillis_table_init();
+
+  // the code blocks of a transport block have at most two sizes (K+ and K-)
+  for (r=0; r<nb_segments; r++) {
+    if ((base_interleaver == NULL) || (input_length_bytes[r] != length)) {
+      length = input_length_bytes[r];
+
+      if ((base_interleaver = threegpplte_interleaver_lookup(length)) == NULL)
+        continue;
+    }
+
+    threegpplte_turbo_encode_block(input[r],length,output[r],base_interleaver);
+  }
 }
 
 
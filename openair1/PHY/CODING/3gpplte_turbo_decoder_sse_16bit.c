@@ -942,6 +942,104 @@ void init_td16()
   }
 }
 
+// hard decisions in the natural order, llr[pi[k]] is the LLR of bit k
+static void td16_hard_decision(llr_t *llr,int *pi,unsigned short n,unsigned char *decoded_bytes)
+{
+
+  int *pi_p=pi;
+  unsigned int i;
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i zeros=_mm_setzero_si128(), tmp=zeros;
+#elif defined(__arm__)
+  int16x8_t zeros=vdupq_n_s16(0), tmp=zeros;
+  const uint16_t __attribute__ ((aligned (16))) _Powers[8]= 
+    { 1, 2, 4, 8, 16, 32, 64, 128};
+  uint16x8_t Powers= vld1q_u16(_Powers);
+#endif
+
+  for (i=0; i<(n>>3); i++) {
+#if defined(__x86_64__) || defined(__i386__)
+    tmp=_mm_insert_epi16(tmp, llr[*pi_p++],7);
+    tmp=_mm_insert_epi16(tmp, llr[*pi_p++],6);
+    tmp=_mm_insert_epi16(tmp, llr[*pi_p++],5);
+    tmp=_mm_insert_epi16(tmp, llr[*pi_p++],4);
+    tmp=_mm_insert_epi16(tmp, llr[*pi_p++],3);
+    tmp=_mm_insert_epi16(tmp, llr[*pi_p++],2);
+    tmp=_mm_insert_epi16(tmp, llr[*pi_p++],1);
+    tmp=_mm_insert_epi16(tmp, llr[*pi_p++],0);
+    tmp=_mm_cmpgt_epi8(_mm_packs_epi16(tmp,zeros),zeros);
+    decoded_bytes[i]=(unsigned char)_mm_movemask_epi8(tmp);
+#elif defined(__arm__)
+    tmp=vsetq_lane_s16(llr[*pi_p++],tmp,7);
+    tmp=vsetq_lane_s16(llr[*pi_p++],tmp,6);
+    tmp=vsetq_lane_s16(llr[*pi_p++],tmp,5);
+    tmp=vsetq_lane_s16(llr[*pi_p++],tmp,4);
+    tmp=vsetq_lane_s16(llr[*pi_p++],tmp,3);
+    tmp=vsetq_lane_s16(llr[*pi_p++],tmp,2);
+    tmp=vsetq_lane_s16(llr[*pi_p++],tmp,1);
+    tmp=vsetq_lane_s16(llr[*pi_p++],tmp,0);
+// This does:
+// [1 2 4 8 16 32 64 128] .* I(ext_i > 0) = 2.^[b0 b1 b2 b3 b4 b5 b6 b7], where bi =I(ext_i > 0)
+// [2^b0 + 2^b1 2^b2 + 2^b3 2^b4 + 2^b5 2^b6 + 2^b7]
+// [2^b0 + 2^b1 + 2^b2 + 2^b3   2^b4 + 2^b5 + 2^b6 + 2^b7] 
+// Mask64 = 2^b0 + 2^b1 + 2^b2 + 2^b3 + 2^b4 + 2^b5 + 2^b6 + 2^b7
+	uint64x2_t Mask   = vpaddlq_u32(vpaddlq_u16(vandq_u16(vcgtq_s16(tmp,zeros), Powers)));
+    uint64x1_t Mask64 = vget_high_u64(Mask)+vget_low_u64(Mask);
+    decoded_bytes[i] = (uint8_t)Mask64;
+#endif
+  }
+}
+
+// returns 1 if the CRC of the decoded block matches, 0 if not and -1 for an unknown CRC type
+static int td16_check_crc(unsigned char *decoded_bytes,unsigned short n,unsigned char crc_type,unsigned char F,unsigned int crc_len)
+{
+
+  unsigned int crc,oldcrc;
+  uint8_t temp;
+
+  oldcrc= *((unsigned int *)(&decoded_bytes[(n>>3)-crc_len]));
+
+  switch (crc_type) {
+
+  case CRC24_A:
+    oldcrc&=0x00ffffff;
+    crc = crc24a(&decoded_bytes[F>>3],
+                 n-24-F)>>8;
+    temp=((uint8_t *)&crc)[2];
+    ((uint8_t *)&crc)[2] = ((uint8_t *)&crc)[0];
+    ((uint8_t *)&crc)[0] = temp;
+    break;
+
+  case CRC24_B:
+    oldcrc&=0x00ffffff;
+    crc = crc24b(decoded_bytes,
+                 n-24)>>8;
+    temp=((uint8_t *)&crc)[2];
+    ((uint8_t *)&crc)[2] = ((uint8_t *)&crc)[0];
+    ((uint8_t *)&crc)[0] = temp;
+    break;
+
+  case CRC16:
+    oldcrc&=0x0000ffff;
+    crc = crc16(decoded_bytes,
+                n-16)>>16;
+    break;
+
+  case CRC8:
+    oldcrc&=0x000000ff;
+    crc = crc8(decoded_bytes,
+               n-8)>>24;
+    break;
+
+  default:
+    printf("FATAL: 3gpplte_turbo_decoder_sse.c: Unknown CRC\n");
+    return(-1);
+    break;
+  }
+
+  return(((crc == oldcrc) && (crc!=0)) ? 1 : 0);
+}
+
 unsigned char phy_threegpplte_turbo_decoder16(short *y,
     unsigned char *decoded_bytes,
     unsigned short n,
@@ -979,24 +1077,23 @@ unsigned char phy_threegpplte_turbo_decoder16(short *y,
   llr_t m10[n+16] __attribute__ ((aligned(16)));
 
 
-  int *pi2_p,*pi4_p,*pi5_p,*pi6_p;
+  int *pi2_p,*pi4_p,*pi5_p;
   llr_t *s,*s1,*s2,*yp1,*yp2,*yp;
   unsigned int i,j,iind;//,pi;
   unsigned char iteration_cnt=0;
-  unsigned int crc,oldcrc,crc_len;
-  uint8_t temp;
+  unsigned int crc_len;
+  int crc_ok;
+  turbo_stop_t policy=turbo_get_stop_policy();
+  unsigned char hd[6144/8];
 
 #if defined(__x86_64__) || defined(__i386__)
   __m128i *yp128;
-  __m128i tmp, zeros=_mm_setzero_si128();
+  __m128i tmp;
   register __m128i tmpe;
 #elif defined(__arm__)
   int16x8_t *yp128;
 //  int16x8_t tmp128[(n+8)>>3];
-  int16x8_t tmp, zeros=vdupq_n_s16(0);
-  const uint16_t __attribute__ ((aligned (16))) _Powers[8]= 
-    { 1, 2, 4, 8, 16, 32, 64, 128};
-  uint16x8_t Powers= vld1q_u16(_Powers);
+  int16x8_t tmp;
 #endif
   int offset8_flag=0;
 
@@ -1198,6 +1295,19 @@ unsigned char phy_threegpplte_turbo_decoder16(short *y,
 
   log_map16(systematic0,yparity1,m11,m10,alpha,beta,ext,n,0,F,offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
 
+  if (policy != TURBO_STOP_CRC) {
+    start_meas(intl2_stats);
+    td16_hard_decision(ext,pi2tab16[iind],n,decoded_bytes);
+    crc_ok = td16_check_crc(decoded_bytes,n,crc_type,F,crc_len);
+    stop_meas(intl2_stats);
+
+    if (crc_ok < 0)
+      return(255);
+
+    if (crc_ok == 1)
+      return(1);
+  }
+
   while (iteration_cnt++ < max_iterations) {
 
 #ifdef DEBUG_LOGMAP
@@ -1264,95 +1374,44 @@ unsigned char phy_threegpplte_turbo_decoder16(short *y,
 #endif
     }
 
-    if (iteration_cnt>1) {
+    if ((iteration_cnt>1) || (policy != TURBO_STOP_CRC)) {
       start_meas(intl2_stats);
-      pi6_p=pi6tab16[iind];
+      td16_hard_decision(ext2,pi6tab16[iind],n,decoded_bytes);
+      crc_ok = td16_check_crc(decoded_bytes,n,crc_type,F,crc_len);
 
-      for (i=0; i<(n>>3); i++) {
-#if defined(__x86_64__) || defined(__i386__)
-        tmp=_mm_insert_epi16(tmp, ((llr_t*)ext2)[*pi6_p++],7);
-        tmp=_mm_insert_epi16(tmp, ((llr_t*)ext2)[*pi6_p++],6);
-        tmp=_mm_insert_epi16(tmp, ((llr_t*)ext2)[*pi6_p++],5);
-        tmp=_mm_insert_epi16(tmp, ((llr_t*)ext2)[*pi6_p++],4);
-        tmp=_mm_insert_epi16(tmp, ((llr_t*)ext2)[*pi6_p++],3);
-        tmp=_mm_insert_epi16(tmp, ((llr_t*)ext2)[*pi6_p++],2);
-        tmp=_mm_insert_epi16(tmp, ((llr_t*)ext2)[*pi6_p++],1);
-        tmp=_mm_insert_epi16(tmp, ((llr_t*)ext2)[*pi6_p++],0);
-        tmp=_mm_cmpgt_epi8(_mm_packs_epi16(tmp,zeros),zeros);
-        decoded_bytes[i]=(unsigned char)_mm_movemask_epi8(tmp);
-#elif defined(__arm__)
-        tmp=vsetq_lane_s16(ext2[*pi6_p++],tmp,7);
-        tmp=vsetq_lane_s16(ext2[*pi6_p++],tmp,6);
-        tmp=vsetq_lane_s16(ext2[*pi6_p++],tmp,5);
-        tmp=vsetq_lane_s16(ext2[*pi6_p++],tmp,4);
-        tmp=vsetq_lane_s16(ext2[*pi6_p++],tmp,3);
-        tmp=vsetq_lane_s16(ext2[*pi6_p++],tmp,2);
-        tmp=vsetq_lane_s16(ext2[*pi6_p++],tmp,1);
-        tmp=vsetq_lane_s16(ext2[*pi6_p++],tmp,0);
-// This does:
-// [1 2 4 8 16 32 64 128] .* I(ext_i > 0) = 2.^[b0 b1 b2 b3 b4 b5 b6 b7], where bi =I(ext_i > 0)
-// [2^b0 + 2^b1 2^b2 + 2^b3 2^b4 + 2^b5 2^b6 + 2^b7]
-// [2^b0 + 2^b1 + 2^b2 + 2^b3   2^b4 + 2^b5 + 2^b6 + 2^b7] 
-// Mask64 = 2^b0 + 2^b1 + 2^b2 + 2^b3 + 2^b4 + 2^b5 + 2^b6 + 2^b7
-	uint64x2_t Mask   = vpaddlq_u32(vpaddlq_u16(vandq_u16(vcgtq_s16(tmp,zeros), Powers)));
-        uint64x1_t Mask64 = vget_high_u64(Mask)+vget_low_u64(Mask);
-        decoded_bytes[i] = (uint8_t)Mask64;
-#endif
-      }
-    }
-
-    // check status on output
-    if (iteration_cnt>1) {
-      oldcrc= *((unsigned int *)(&decoded_bytes[(n>>3)-crc_len]));
-
-      switch (crc_type) {
-
-      case CRC24_A:
-        oldcrc&=0x00ffffff;
-        crc = crc24a(&decoded_bytes[F>>3],
-                     n-24-F)>>8;
-        temp=((uint8_t *)&crc)[2];
-        ((uint8_t *)&crc)[2] = ((uint8_t *)&crc)[0];
-        ((uint8_t *)&crc)[0] = temp;
-        break;
-
-      case CRC24_B:
-        oldcrc&=0x00ffffff;
-        crc = crc24b(decoded_bytes,
-                     n-24)>>8;
-        temp=((uint8_t *)&crc)[2];
-        ((uint8_t *)&crc)[2] = ((uint8_t *)&crc)[0];
-        ((uint8_t *)&crc)[0] = temp;
-        break;
-
-      case CRC16:
-        oldcrc&=0x0000ffff;
-        crc = crc16(decoded_bytes,
-                    n-16)>>16;
-        break;
-
-      case CRC8:
-        oldcrc&=0x000000ff;
-        crc = crc8(decoded_bytes,
-                   n-8)>>24;
-        break;
-
-      default:
-        printf("FATAL: 3gpplte_turbo_decoder_sse.c: Unknown CRC\n");
+      if (crc_ok < 0)
         return(255);
-        break;
-      }
 
       stop_meas(intl2_stats);
 
-      if ((crc == oldcrc) && (crc!=0)) {
+      if (crc_ok == 1) {
         return(iteration_cnt);
       }
+
+      // the decisions did not move during a whole iteration, more iterations won't fix the CRC
+      if (policy == TURBO_STOP_CRC_HALF_HD) {
+        if ((iteration_cnt>1) && (memcmp(hd,decoded_bytes,n>>3) == 0))
+          return(max_iterations+1);
+
+        memcpy(hd,decoded_bytes,n>>3);
+      }
     }
 
     // do log_map from first parity bit
     if (iteration_cnt < max_iterations) {
       log_map16(systematic1,yparity1,m11,m10,alpha,beta,ext,n,0,F,offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+
+      // hard decisions of the first decoder (ext before the update below)
+      if (policy != TURBO_STOP_CRC) {
+        start_meas(intl2_stats);
+        td16_hard_decision(ext,pi2tab16[iind],n,decoded_bytes);
+        crc_ok = td16_check_crc(decoded_bytes,n,crc_type,F,crc_len);
+        stop_meas(intl2_stats);
+
+        if (crc_ok == 1)
+          return(iteration_cnt+1);
+      }
+
 #if defined(__x86_64__) || defined(__i386__)
       __m128i* ext_128=(__m128i*) ext;
       __m128i* s1_128=(__m128i*) systematic1;
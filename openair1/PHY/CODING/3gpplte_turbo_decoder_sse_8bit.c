@@ -44,6 +44,9 @@
 ///
 
 #include "PHY/sse_intrin.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 #ifndef TEST_DEBUG
 #include "PHY/defs.h"
@@ -891,113 +894,90 @@ void init_td8()
   }
 }
 
-unsigned char phy_threegpplte_turbo_decoder8(short *y,
-    unsigned char *decoded_bytes,
-    unsigned short n,
-    unsigned short f1,
-    unsigned short f2,
-    unsigned char max_iterations,
-    unsigned char crc_type,
-    unsigned char F,
-    time_stats_t *init_stats,
-    time_stats_t *alpha_stats,
-    time_stats_t *beta_stats,
-    time_stats_t *gamma_stats,
-    time_stats_t *ext_stats,
-    time_stats_t *intl1_stats,
-    time_stats_t *intl2_stats)
-{
-
-  /*  y is a pointer to the input
-      decoded_bytes is a pointer to the decoded output
-      n is the size in bits of the coded block, with the tail */
-
+// Per code block state of the decoder. The buffers belong to the caller (stack), the helpers
+// below are the steps of phy_threegpplte_turbo_decoder8 which do not depend on the trellis
+// recursions, so that they can be shared with the two-block AVX2 decoder.
+typedef struct {
   int n2;
-
-  llr_t y8[3*(n+16)] __attribute__((aligned(16)));
-
-
-  llr_t systematic0[n+16] __attribute__ ((aligned(16)));
-  llr_t systematic1[n+16] __attribute__ ((aligned(16)));
-  llr_t systematic2[n+16] __attribute__ ((aligned(16)));
-  llr_t yparity1[n+16] __attribute__ ((aligned(16)));
-  llr_t yparity2[n+16] __attribute__ ((aligned(16)));
-
-  llr_t ext[n+128] __attribute__((aligned(16)));
-  llr_t ext2[n+128] __attribute__((aligned(16)));
-
-  llr_t alpha[(n+16)*8] __attribute__ ((aligned(16)));
-  llr_t beta[(n+16)*8] __attribute__ ((aligned(16)));
-  llr_t m11[n+16] __attribute__ ((aligned(16)));
-  llr_t m10[n+16] __attribute__ ((aligned(16)));
-
-
-  //  int *pi2_p,*pi4_p,*pi5_p,*pi6_p;
-  int *pi4_p,*pi5_p,*pi6_p;
-  llr_t *s,*s1,*s2,*yp1,*yp2,*yp;
-
-  unsigned int i,j,iind;//,pi;
-  unsigned char iteration_cnt=0;
-  unsigned int crc,oldcrc,crc_len;
-  uint8_t temp;
+  int offset8_flag;
+  unsigned int iind;
+  unsigned int crc_len;
+  llr_t *systematic0;
+  llr_t *systematic1;
+  llr_t *systematic2;
+  llr_t *yparity1;
+  llr_t *yparity2;
+  llr_t *ext;
+  llr_t *ext2;
+  uint16_t *decoded_bytes_interl;
 #if defined(__x86_64__) || defined(__i386__)
-  __m128i *yp128;
-  __m128i tmp128[(n+8)>>3];
-  __m128i tmp, zeros=_mm_setzero_si128();
+  __m128i *tmp128;
 #elif defined(__arm__)
-  int8x16_t *yp128;
-  int8x16_t tmp128[(n+8)>>3];
-  int8x16_t tmp, zeros=vdupq_n_s8(0);
-  const uint8_t __attribute__ ((aligned (16))) _Powers[16]= 
-    { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
-  
-  // Set the powers of 2 (do it once for all, if applicable)
-  uint8x16_t Powers= vld1q_u8(_Powers);
+  int8x16_t *tmp128;
 #endif
+} td8_block_t;
 
-  int offset8_flag=0;
+static int td8_block_init(td8_block_t *b,unsigned short n,unsigned char crc_type)
+{
 
   if (crc_type > 3) {
     msg("Illegal crc length!\n");
-    return 255;
+    return(-1);
   }
 
-
-  start_meas(init_stats);
-
+  b->offset8_flag=0;
 
   if ((n&15)>0) {
-    n2 = n+8;
-    offset8_flag=1;
+    b->n2 = n+8;
+    b->offset8_flag=1;
   } else
-    n2 = n;
+    b->n2 = n;
 
 
-  for (iind=0; iind < 188 && f1f2mat[iind].nb_bits != n; iind++);
+  for (b->iind=0; b->iind < 188 && f1f2mat[b->iind].nb_bits != n; b->iind++);
 
-  if ( iind == 188 ) {
+  if ( b->iind == 188 ) {
     msg("Illegal frame length!\n");
-    return 255;
+    return(-1);
   }
 
   switch (crc_type) {
   case CRC24_A:
   case CRC24_B:
-    crc_len=3;
+    b->crc_len=3;
     break;
 
   case CRC16:
-    crc_len=2;
+    b->crc_len=2;
     break;
 
   case CRC8:
-    crc_len=1;
+    b->crc_len=1;
     break;
 
   default:
-    crc_len=3;
+    b->crc_len=3;
   }
 
+  return(0);
+}
+
+// scale the 16-bit input to 8 bits and split it in systematic/parity columns
+static void td8_load_input(short *y,unsigned short n,llr_t *y8,td8_block_t *b)
+{
+
+  int n2=b->n2;
+  llr_t *systematic0=b->systematic0,*systematic1=b->systematic1,*systematic2=b->systematic2;
+  llr_t *yparity1=b->yparity1,*yparity2=b->yparity2;
+  llr_t *s,*s1,*s2,*yp1,*yp2,*yp;
+  unsigned int i,j;
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i *yp128;
+#elif defined(__arm__)
+  int8x16_t *yp128;
+#endif
+
+
 #if defined(__x86_64__) || defined(__i386__)
 
   __m128i avg=_mm_set1_epi32(0);
@@ -1324,335 +1304,1144 @@ unsigned char phy_threegpplte_turbo_decoder8(short *y,
 #ifdef DEBUG_LOGMAP
   msg("\n");
 #endif //DEBUG_LOGMAP
+}
 
-  stop_meas(init_stats);
-
-  // do log_map from first parity bit
-
-  log_map8(systematic0,yparity1,m11,m10,alpha,beta,ext,n2,0,F,offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+// interleave the extrinsic information of the first decoder to form the a-priori input of the second one
+static void td8_interleave(td8_block_t *b)
+{
 
-  while (iteration_cnt++ < max_iterations) {
+  int n2=b->n2;
+  llr_t *ext=b->ext,*systematic2=b->systematic2;
+  int *pi4_p;
+  unsigned int i;
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i tmp=_mm_setzero_si128();
+#elif defined(__arm__)
+  int8x16_t tmp=vdupq_n_s8(0);
+#endif
 
-#ifdef DEBUG_LOGMAP
-    printf("\n*******************ITERATION %d (n %d, n2 %d), ext %p\n\n",iteration_cnt,n,n2,ext);
-#endif //DEBUG_LOGMAP
 
-    start_meas(intl1_stats);
-    pi4_p=pi4tab8[iind];
+  pi4_p=pi4tab8[b->iind];
 
-    for (i=0; i<(n2>>4); i++) { // steady-state portion
+  for (i=0; i<(n2>>4); i++) { // steady-state portion
 #if defined(__x86_64__) || defined(__i386__)
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],0);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],1);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],2);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],3);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],4);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],5);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],6);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],7);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],8);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],9);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],10);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],11);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],12);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],13);
-      tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],14);
-      ((__m128i *)systematic2)[i]=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],15);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],0);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],1);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],2);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],3);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],4);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],5);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],6);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],7);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],8);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],9);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],10);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],11);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],12);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],13);
+    tmp=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],14);
+    ((__m128i *)systematic2)[i]=_mm_insert_epi8(tmp,((llr_t*)ext)[*pi4_p++],15);
 #elif defined(__arm__)
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,0);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,1);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,2);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,3);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,4);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,5);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,6);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,7);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,8);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,9);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,10);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,11);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,12);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,13);
-      tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,14);
-      ((int8x16_t *)systematic2)[i]=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,15);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,0);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,1);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,2);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,3);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,4);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,5);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,6);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,7);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,8);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,9);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,10);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,11);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,12);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,13);
+    tmp=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,14);
+    ((int8x16_t *)systematic2)[i]=vsetq_lane_s8(((llr_t*)ext)[*pi4_p++],tmp,15);
 #endif
-    }
-
-    stop_meas(intl1_stats);
-
-    // do log_map from second parity bit
+  }
+}
 
-    log_map8(systematic2,yparity2,m11,m10,alpha,beta,ext2,n2,1,F,offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+// deinterleave the extrinsic information of the second decoder, updates the a-priori input of the first one
+static void td8_deinterleave(td8_block_t *b,unsigned char *decoded_bytes)
+{
 
+  int n2=b->n2;
+  llr_t *ext=b->ext,*ext2=b->ext2,*systematic0=b->systematic0,*systematic1=b->systematic1,*systematic2=b->systematic2;
+  uint16_t *decoded_bytes_interl=b->decoded_bytes_interl;
+  int *pi5_p;
+  unsigned int i;
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i *tmp128=b->tmp128;
+  __m128i tmp=_mm_setzero_si128(), zeros=_mm_setzero_si128();
+#elif defined(__arm__)
+  int8x16_t *tmp128=b->tmp128;
+  int8x16_t tmp=vdupq_n_s8(0), zeros=vdupq_n_s8(0);
+  const uint8_t __attribute__ ((aligned (16))) _Powers[16]= 
+    { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+  
+  // Set the powers of 2 (do it once for all, if applicable)
+  uint8x16_t Powers= vld1q_u8(_Powers);
+#endif
 
 
-    pi5_p=pi5tab8[iind];
-    uint16_t decoded_bytes_interl[6144/16] __attribute__((aligned(16)));
+  pi5_p=pi5tab8[b->iind];
 
-    if ((n2&0x7f) == 0) {  // n2 is a multiple of 128 bits
-      for (i=0; i<(n2>>4); i++) {
+  if ((n2&0x7f) == 0) {  // n2 is a multiple of 128 bits
+    for (i=0; i<(n2>>4); i++) {
 #if defined(__x86_64__) || defined(__i386__)
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],0);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],1);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],2);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],3);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],4);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],5);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],6);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],7);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],8);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],9);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],10);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],11);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],12);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],13);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],14);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],15);
-        decoded_bytes_interl[i]=(uint16_t) _mm_movemask_epi8(_mm_cmpgt_epi8(tmp,zeros));
-        ((__m128i *)systematic1)[i] = _mm_adds_epi8(_mm_subs_epi8(tmp,((__m128i*)ext)[i]),((__m128i *)systematic0)[i]);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],0);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],1);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],2);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],3);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],4);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],5);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],6);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],7);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],8);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],9);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],10);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],11);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],12);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],13);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],14);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],15);
+      decoded_bytes_interl[i]=(uint16_t) _mm_movemask_epi8(_mm_cmpgt_epi8(tmp,zeros));
+      ((__m128i *)systematic1)[i] = _mm_adds_epi8(_mm_subs_epi8(tmp,((__m128i*)ext)[i]),((__m128i *)systematic0)[i]);
 #elif defined(__arm__)
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,0);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,1);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,2);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,3);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,4);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,5);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,6);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,7);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,8);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,9);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,10);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,11);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,12);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,13);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,14);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,15);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,0);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,1);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,2);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,3);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,4);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,5);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,6);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,7);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,8);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,9);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,10);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,11);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,12);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,13);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,14);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,15);
 	uint64x2_t Mask= vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(vcgtq_s8(tmp,zeros), Powers))));
 	vst1q_lane_u8(&((uint8_t*)&decoded_bytes[i])[0], (uint8x16_t)Mask, 0);
 	vst1q_lane_u8(&((uint8_t*)&decoded_bytes[i])[1], (uint8x16_t)Mask, 8);
 	((int8x16_t *)systematic1)[i] = vqaddq_s8(vqsubq_s8(tmp,((int8x16_t*)ext)[i]),((int8x16_t *)systematic0)[i]);
 #endif
-      }
+    }
 
-    } else {
-      for (i=0; i<(n2>>4); i++) {
+  } else {
+    for (i=0; i<(n2>>4); i++) {
 #if defined(__x86_64__) || defined(__i386__)
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],0);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],1);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],2);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],3);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],4);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],5);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],6);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],7);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],8);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],9);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],10);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],11);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],12);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],13);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],14);
-        tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],15);
-        tmp128[i] = _mm_adds_epi8(((__m128i *)ext2)[i],((__m128i *)systematic2)[i]);
-
-        ((__m128i *)systematic1)[i] = _mm_adds_epi8(_mm_subs_epi8(tmp,((__m128i*)ext)[i]),((__m128i *)systematic0)[i]);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],0);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],1);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],2);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],3);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],4);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],5);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],6);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],7);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],8);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],9);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],10);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],11);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],12);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],13);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],14);
+      tmp=_mm_insert_epi8(tmp,ext2[*pi5_p++],15);
+      tmp128[i] = _mm_adds_epi8(((__m128i *)ext2)[i],((__m128i *)systematic2)[i]);
+
+      ((__m128i *)systematic1)[i] = _mm_adds_epi8(_mm_subs_epi8(tmp,((__m128i*)ext)[i]),((__m128i *)systematic0)[i]);
 #elif defined(__arm__)
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,0);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,1);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,2);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,3);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,4);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,5);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,6);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,7);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,8);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,9);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,10);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,11);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,12);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,13);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,14);
-        tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,15);
-        tmp128[i] = vqaddq_s8(((int8x16_t *)ext2)[i],((int8x16_t *)systematic2)[i]);
-
-        ((int8x16_t *)systematic1)[i] = vqaddq_s8(vqsubq_s8(tmp,((int8x16_t*)ext)[i]),((int8x16_t *)systematic0)[i]);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,0);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,1);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,2);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,3);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,4);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,5);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,6);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,7);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,8);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,9);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,10);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,11);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,12);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,13);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,14);
+      tmp=vsetq_lane_s8(ext2[*pi5_p++],tmp,15);
+      tmp128[i] = vqaddq_s8(((int8x16_t *)ext2)[i],((int8x16_t *)systematic2)[i]);
+
+      ((int8x16_t *)systematic1)[i] = vqaddq_s8(vqsubq_s8(tmp,((int8x16_t*)ext)[i]),((int8x16_t *)systematic0)[i]);
 
 #endif 
-     }
-    }
+   }
+  }
+}
 
-    // Check if we decoded the block
-    if (iteration_cnt>1) {
-      start_meas(intl2_stats);
+// Hard decisions in the natural order. When n2 is a multiple of 128 the sign bits are taken from
+// decoded_bytes_interl (first decoder layout), otherwise llr[pi[k]] is the LLR of bit k.
+static void td8_hard_decision(td8_block_t *b,llr_t *llr,int *pi,unsigned char *decoded_bytes)
+{
+
+  int n2=b->n2;
+  uint16_t *decoded_bytes_interl=b->decoded_bytes_interl;
+  int *pi_p;
+  unsigned int i;
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i tmp=_mm_setzero_si128(), zeros=_mm_setzero_si128();
+#elif defined(__arm__)
+  int8x16_t tmp=vdupq_n_s8(0), zeros=vdupq_n_s8(0);
+  const uint8_t __attribute__ ((aligned (16))) _Powers[16]= 
+    { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+  
+  // Set the powers of 2 (do it once for all, if applicable)
+  uint8x16_t Powers= vld1q_u8(_Powers);
+#endif
 
-      if ((n2&0x7f) == 0) {  // n2 is a multiple of 128 bits
 
-        // re-order the decoded bits in theregular order
-        // as it is presently ordered as 16 sequential columns
+  if ((n2&0x7f) == 0) {  // n2 is a multiple of 128 bits
+
+    // re-order the decoded bits in theregular order
+    // as it is presently ordered as 16 sequential columns
 #if defined(__x86_64__) || defined(__i386__)
-        __m128i* dbytes=(__m128i*)decoded_bytes_interl;
-        __m128i shuffle=SHUFFLE16(7,6,5,4,3,2,1,0);
-        __m128i mask  __attribute__((aligned(16)));
-        int n_128=n2>>7;
-
-        for (i=0; i<n_128; i++) {
-          mask=_mm_set1_epi16(1);
-          __m128i tmp __attribute__((aligned(16)));
-          tmp=_mm_shuffle_epi8(dbytes[i],shuffle);
-          __m128i tmp2 __attribute__((aligned(16))) ;
-
-          tmp2=_mm_and_si128(tmp,mask);
-          tmp2=_mm_cmpeq_epi16(tmp2,mask);
-          decoded_bytes[n_128*0+i]=(uint8_t) _mm_movemask_epi8(_mm_packs_epi16(tmp2,zeros));
-          int j;
-
-          for (j=1; j<16; j++) {
-            mask=_mm_slli_epi16(mask,1);
-            tmp2=_mm_and_si128(tmp,mask);
-            tmp2=_mm_cmpeq_epi16(tmp2,mask);
-            decoded_bytes[n_128*j +i]=(uint8_t) _mm_movemask_epi8(_mm_packs_epi16(tmp2,zeros));
-          }
-        }
+    __m128i* dbytes=(__m128i*)decoded_bytes_interl;
+    __m128i shuffle=SHUFFLE16(7,6,5,4,3,2,1,0);
+    __m128i mask  __attribute__((aligned(16)));
+    int n_128=n2>>7;
+
+    for (i=0; i<n_128; i++) {
+      mask=_mm_set1_epi16(1);
+      __m128i tmp __attribute__((aligned(16)));
+      tmp=_mm_shuffle_epi8(dbytes[i],shuffle);
+      __m128i tmp2 __attribute__((aligned(16))) ;
+
+      tmp2=_mm_and_si128(tmp,mask);
+      tmp2=_mm_cmpeq_epi16(tmp2,mask);
+      decoded_bytes[n_128*0+i]=(uint8_t) _mm_movemask_epi8(_mm_packs_epi16(tmp2,zeros));
+      int j;
+
+      for (j=1; j<16; j++) {
+        mask=_mm_slli_epi16(mask,1);
+        tmp2=_mm_and_si128(tmp,mask);
+        tmp2=_mm_cmpeq_epi16(tmp2,mask);
+        decoded_bytes[n_128*j +i]=(uint8_t) _mm_movemask_epi8(_mm_packs_epi16(tmp2,zeros));
+      }
+    }
 #elif defined(__arm__)
-        uint8x16_t* dbytes=(uint8x16_t*)decoded_bytes_interl;
-        uint16x8_t mask  __attribute__((aligned(16)));
-        int n_128=n2>>7;
+    uint8x16_t* dbytes=(uint8x16_t*)decoded_bytes_interl;
+    uint16x8_t mask  __attribute__((aligned(16)));
+    int n_128=n2>>7;
 
-        for (i=0; i<n_128; i++) {
-          mask=vdupq_n_u16(1);
-          uint8x16_t tmp __attribute__((aligned(16)));
-          tmp=vcombine_u8(vrev64_u8(((uint8x8_t*)&dbytes[i])[1]),vrev64_u8(((uint8x8_t*)&dbytes[i])[0]));
-          vst1q_lane_u8(&decoded_bytes[n_128*0+i],(uint8x16_t)vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(tmp, Powers)))),0);
+    for (i=0; i<n_128; i++) {
+      mask=vdupq_n_u16(1);
+      uint8x16_t tmp __attribute__((aligned(16)));
+      tmp=vcombine_u8(vrev64_u8(((uint8x8_t*)&dbytes[i])[1]),vrev64_u8(((uint8x8_t*)&dbytes[i])[0]));
+      vst1q_lane_u8(&decoded_bytes[n_128*0+i],(uint8x16_t)vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(tmp, Powers)))),0);
 
-          int j;
+      int j;
 
-          for (j=1; j<16; j++) {
-            mask=vshlq_n_u16(mask,1);
+      for (j=1; j<16; j++) {
+        mask=vshlq_n_u16(mask,1);
 	    vst1q_lane_u8(&decoded_bytes[n_128*0+i],(uint8x16_t)vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(tmp, Powers)))),0);
-          }
-        }
+      }
+    }
 
 #endif
-      } else {
-        pi6_p=pi6tab8[iind];
+  } else {
+    pi_p=pi;
 
-        for (i=0; i<(n2>>4); i++) {
+    for (i=0; i<(n2>>4); i++) {
 #if defined(__x86_64__) || defined(__i386__)
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],7);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],6);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],5);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],4);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],3);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],2);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],1);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],0);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],15);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],14);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],13);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],12);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],11);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],10);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],9);
-          tmp=_mm_insert_epi8(tmp, ((llr_t *)tmp128)[*pi6_p++],8);
-          tmp=_mm_cmpgt_epi8(tmp,zeros);
-          ((uint16_t *)decoded_bytes)[i]=(uint16_t)_mm_movemask_epi8(tmp);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],7);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],6);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],5);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],4);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],3);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],2);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],1);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],0);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],15);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],14);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],13);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],12);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],11);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],10);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],9);
+      tmp=_mm_insert_epi8(tmp, llr[*pi_p++],8);
+      tmp=_mm_cmpgt_epi8(tmp,zeros);
+      ((uint16_t *)decoded_bytes)[i]=(uint16_t)_mm_movemask_epi8(tmp);
 #elif defined(__arm__)
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,7);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,6);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,5);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,4);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,3);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,2);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,1);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,0);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,15);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,14);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,13);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,12);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,11);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,10);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,9);
-          tmp=vsetq_lane_s8(((llr_t *)tmp128)[*pi6_p++],tmp,8);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,7);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,6);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,5);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,4);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,3);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,2);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,1);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,0);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,15);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,14);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,13);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,12);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,11);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,10);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,9);
+      tmp=vsetq_lane_s8(llr[*pi_p++],tmp,8);
 	  uint64x2_t Mask= vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(vcgtq_s8(tmp,zeros), Powers))));
 	  vst1q_lane_u8(&((uint8_t*)&decoded_bytes[i])[0], (uint8x16_t)Mask, 0);
 	  vst1q_lane_u8(&((uint8_t*)&decoded_bytes[i])[1], (uint8x16_t)Mask, 8);
 #endif
-        }
-      }
+    }
+  }
+}
 
-      // check the CRC
-      oldcrc= *((unsigned int *)(&decoded_bytes[(n>>3)-crc_len]));
+// returns 1 if the CRC of the decoded block matches, 0 if not and -1 for an unknown CRC type
+static int td8_check_crc(td8_block_t *b,unsigned char *decoded_bytes,unsigned short n,unsigned char crc_type,unsigned char F)
+{
 
-      switch (crc_type) {
+  unsigned int crc,oldcrc,crc_len=b->crc_len;
+  uint8_t temp;
 
-      case CRC24_A:
-        oldcrc&=0x00ffffff;
-        crc = crc24a(&decoded_bytes[F>>3],
-                     n-24-F)>>8;
-        temp=((uint8_t *)&crc)[2];
-        ((uint8_t *)&crc)[2] = ((uint8_t *)&crc)[0];
-        ((uint8_t *)&crc)[0] = temp;
-        break;
 
-      case CRC24_B:
-        oldcrc&=0x00ffffff;
-        crc = crc24b(decoded_bytes,
-                     n-24)>>8;
-        temp=((uint8_t *)&crc)[2];
-        ((uint8_t *)&crc)[2] = ((uint8_t *)&crc)[0];
-        ((uint8_t *)&crc)[0] = temp;
-        break;
+  // check the CRC
+  oldcrc= *((unsigned int *)(&decoded_bytes[(n>>3)-crc_len]));
 
-      case CRC16:
-        oldcrc&=0x0000ffff;
-        crc = crc16(decoded_bytes,
-                    n-16)>>16;
-        break;
+  switch (crc_type) {
 
-      case CRC8:
-        oldcrc&=0x000000ff;
-        crc = crc8(decoded_bytes,
-                   n-8)>>24;
-        break;
+  case CRC24_A:
+    oldcrc&=0x00ffffff;
+    crc = crc24a(&decoded_bytes[F>>3],
+                 n-24-F)>>8;
+    temp=((uint8_t *)&crc)[2];
+    ((uint8_t *)&crc)[2] = ((uint8_t *)&crc)[0];
+    ((uint8_t *)&crc)[0] = temp;
+    break;
+
+  case CRC24_B:
+    oldcrc&=0x00ffffff;
+    crc = crc24b(decoded_bytes,
+                 n-24)>>8;
+    temp=((uint8_t *)&crc)[2];
+    ((uint8_t *)&crc)[2] = ((uint8_t *)&crc)[0];
+    ((uint8_t *)&crc)[0] = temp;
+    break;
+
+  case CRC16:
+    oldcrc&=0x0000ffff;
+    crc = crc16(decoded_bytes,
+                n-16)>>16;
+    break;
+
+  case CRC8:
+    oldcrc&=0x000000ff;
+    crc = crc8(decoded_bytes,
+               n-8)>>24;
+    break;
+
+  default:
+    printf("FATAL: 3gpplte_turbo_decoder_sse.c: Unknown CRC\n");
+    return(-1);
+    break;
+  }
+
+  return(((crc == oldcrc) && (crc!=0)) ? 1 : 0);
+}
+
+static void td8_update_ext(td8_block_t *b)
+{
+
+  unsigned int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i* ext_128=(__m128i*) b->ext;
+  __m128i* s1_128=(__m128i*) b->systematic1;
+  __m128i* s0_128=(__m128i*) b->systematic0;
+#elif defined(__arm__)
+  int8x16_t* ext_128=(int8x16_t*) b->ext;
+  int8x16_t* s1_128=(int8x16_t*) b->systematic1;
+  int8x16_t* s0_128=(int8x16_t*) b->systematic0;
+#endif
+  int myloop=b->n2>>4;
+
+  for (i=0; i<myloop; i++) {
+#if defined(__x86_64__) || defined(__i386__)
+    *ext_128=_mm_adds_epi8(_mm_subs_epi8(*ext_128,*s1_128++),*s0_128++);
+#elif defined(__arm__)
+    *ext_128=vqaddq_s8(vqsubq_s8(*ext_128,*s1_128++),*s0_128++);
+#endif
+    ext_128++;
+  }
+}
+
+static turbo_stop_t turbo_stop_policy = TURBO_STOP_CRC;
+
+void turbo_set_stop_policy(turbo_stop_t policy)
+{
+
+  turbo_stop_policy = policy;
+}
+
+turbo_stop_t turbo_get_stop_policy(void)
+{
+
+  return(turbo_stop_policy);
+}
+
+// hard decisions and CRC of the first decoder output (ext before td8_update_ext, natural order)
+static int td8_check_crc_ext(td8_block_t *b,unsigned char *decoded_bytes,unsigned short n,unsigned char crc_type,unsigned char F)
+{
+
+  unsigned int i;
+
+  if ((b->n2&0x7f) == 0) {
+#if defined(__x86_64__) || defined(__i386__)
+    __m128i zeros=_mm_setzero_si128();
+
+    for (i=0; i<(b->n2>>4); i++)
+      b->decoded_bytes_interl[i]=(uint16_t)_mm_movemask_epi8(_mm_cmpgt_epi8(((__m128i *)b->ext)[i],zeros));
+
+#else
+    unsigned int k;
+
+    for (i=0; i<(b->n2>>4); i++) {
+      b->decoded_bytes_interl[i]=0;
+
+      for (k=0; k<16; k++)
+        if (b->ext[(i<<4)+k] > 0)
+          b->decoded_bytes_interl[i] |= (1<<k);
+    }
+
+#endif
+  }
+
+  td8_hard_decision(b,b->ext,pi2tab8[b->iind],decoded_bytes);
+
+  return(td8_check_crc(b,decoded_bytes,n,crc_type,F));
+}
+
+unsigned char phy_threegpplte_turbo_decoder8(short *y,
+    unsigned char *decoded_bytes,
+    unsigned short n,
+    unsigned short f1,
+    unsigned short f2,
+    unsigned char max_iterations,
+    unsigned char crc_type,
+    unsigned char F,
+    time_stats_t *init_stats,
+    time_stats_t *alpha_stats,
+    time_stats_t *beta_stats,
+    time_stats_t *gamma_stats,
+    time_stats_t *ext_stats,
+    time_stats_t *intl1_stats,
+    time_stats_t *intl2_stats)
+{
+
+  /*  y is a pointer to the input
+      decoded_bytes is a pointer to the decoded output
+      n is the size in bits of the coded block, with the tail */
+
+  td8_block_t b;
+  int n2,crc_ok;
+
+  llr_t y8[3*(n+16)] __attribute__((aligned(16)));
+
+  // the termination columns are written up to n2+19 and read up to n2+31 by compute_gamma8
+  llr_t systematic0[n+48] __attribute__ ((aligned(16)));
+  llr_t systematic1[n+48] __attribute__ ((aligned(16)));
+  llr_t systematic2[n+48] __attribute__ ((aligned(16)));
+  llr_t yparity1[n+48] __attribute__ ((aligned(16)));
+  llr_t yparity2[n+48] __attribute__ ((aligned(16)));
+
+  llr_t ext[n+128] __attribute__((aligned(16)));
+  llr_t ext2[n+128] __attribute__((aligned(16)));
+
+  llr_t alpha[(n+32)*8] __attribute__ ((aligned(16)));
+  llr_t beta[(n+32)*8] __attribute__ ((aligned(16)));
+  llr_t m11[n+48] __attribute__ ((aligned(16)));
+  llr_t m10[n+48] __attribute__ ((aligned(16)));
+
+  uint16_t decoded_bytes_interl[6144/16] __attribute__((aligned(16)));
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i tmp128[(n+8)>>3];
+#elif defined(__arm__)
+  int8x16_t tmp128[(n+8)>>3];
+#endif
+
+  unsigned char iteration_cnt=0;
+  turbo_stop_t policy=turbo_stop_policy;
+  unsigned char hd[6144/8];
+
+  start_meas(init_stats);
+
+  if (td8_block_init(&b,n,crc_type) < 0)
+    return 255;
+
+  n2 = b.n2;
+  b.systematic0 = systematic0;
+  b.systematic1 = systematic1;
+  b.systematic2 = systematic2;
+  b.yparity1 = yparity1;
+  b.yparity2 = yparity2;
+  b.ext = ext;
+  b.ext2 = ext2;
+  b.decoded_bytes_interl = decoded_bytes_interl;
+  b.tmp128 = tmp128;
+
+  td8_load_input(y,n,y8,&b);
+
+  stop_meas(init_stats);
+
+  // do log_map from first parity bit
 
-      default:
-        printf("FATAL: 3gpplte_turbo_decoder_sse.c: Unknown CRC\n");
+  log_map8(systematic0,yparity1,m11,m10,alpha,beta,ext,n2,0,F,b.offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+
+  if (policy != TURBO_STOP_CRC) {
+    start_meas(intl2_stats);
+    crc_ok = td8_check_crc_ext(&b,decoded_bytes,n,crc_type,F);
+    stop_meas(intl2_stats);
+
+    if (crc_ok < 0)
+      return(255);
+
+    if (crc_ok == 1)
+      return(1);
+  }
+
+  while (iteration_cnt++ < max_iterations) {
+
+#ifdef DEBUG_LOGMAP
+    printf("\n*******************ITERATION %d (n %d, n2 %d), ext %p\n\n",iteration_cnt,n,n2,ext);
+#endif //DEBUG_LOGMAP
+
+    start_meas(intl1_stats);
+    td8_interleave(&b);
+    stop_meas(intl1_stats);
+
+    // do log_map from second parity bit
+
+    log_map8(systematic2,yparity2,m11,m10,alpha,beta,ext2,n2,1,F,b.offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+
+    td8_deinterleave(&b,decoded_bytes);
+
+    // Check if we decoded the block
+    if ((iteration_cnt>1) || (policy != TURBO_STOP_CRC)) {
+      start_meas(intl2_stats);
+      td8_hard_decision(&b,(llr_t *)b.tmp128,pi6tab8[b.iind],decoded_bytes);
+      crc_ok = td8_check_crc(&b,decoded_bytes,n,crc_type,F);
+
+      if (crc_ok < 0)
         return(255);
-        break;
-      }
 
       stop_meas(intl2_stats);
 
-      if ((crc == oldcrc) && (crc!=0)) {
+      if (crc_ok == 1) {
         return(iteration_cnt);
       }
+
+      // the decisions did not move during a whole iteration, more iterations won't fix the CRC
+      if (policy == TURBO_STOP_CRC_HALF_HD) {
+        if ((iteration_cnt>1) && (memcmp(hd,decoded_bytes,n>>3) == 0))
+          return(max_iterations+1);
+
+        memcpy(hd,decoded_bytes,n>>3);
+      }
     }
 
     // do a new iteration if it is not yet decoded
     if (iteration_cnt < max_iterations) {
-      log_map8(systematic1,yparity1,m11,m10,alpha,beta,ext,n2,0,F,offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+      log_map8(systematic1,yparity1,m11,m10,alpha,beta,ext,n2,0,F,b.offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+
+      if (policy != TURBO_STOP_CRC) {
+        start_meas(intl2_stats);
+        crc_ok = td8_check_crc_ext(&b,decoded_bytes,n,crc_type,F);
+        stop_meas(intl2_stats);
+
+        if (crc_ok == 1)
+          return(iteration_cnt+1);
+      }
+
+      td8_update_ext(&b);
+    }
+  }
+
+  return(iteration_cnt);
+
+}
+
 #if defined(__x86_64__) || defined(__i386__)
-      __m128i* ext_128=(__m128i*) ext;
-      __m128i* s1_128=(__m128i*) systematic1;
-      __m128i* s0_128=(__m128i*) systematic0;
-#elif defined(__arm__)
-      int8x16_t* ext_128=(int8x16_t*) ext;
-      int8x16_t* s1_128=(int8x16_t*) systematic1;
-      int8x16_t* s0_128=(int8x16_t*) systematic0;
+
+// Two code blocks of the same size decoded with the 256-bit (AVX2) recursions. The 16 lanes
+// of a 128-bit vector of the decoder above are 16 windows of the same code block (the 8 trellis
+// states are 8 distinct vectors) and compute_gamma8/alpha8/beta8/ext8 only use lane-wise
+// operations and byte shifts of the whole vector. The AVX2 versions of these operations work
+// on each 128-bit half separately, so the low half carries the first code block and the high
+// half the second one, and each block gets exactly the metrics of the 128-bit decoder.
+
+#define TD8_AVX2_FUNC __attribute__((target("avx2")))
+
+static int td8_avx2 = -1;
+
+static inline int td8_avx2_enabled(void) __attribute__((always_inline));
+static inline int td8_avx2_enabled(void)
+{
+
+  if (td8_avx2 < 0)
+    td8_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+
+  return(td8_avx2);
+}
+
+int td8_set_avx2(int enable)
+{
+
+  td8_avx2 = (enable && __builtin_cpu_supports("avx2")) ? 1 : 0;
+
+  return(td8_avx2);
+}
+
+static inline __m256i td8_pair(__m128i lo,__m128i hi) __attribute__((always_inline,target("avx2")));
+static inline __m256i td8_pair(__m128i lo,__m128i hi)
+{
+  return(_mm256_inserti128_si256(_mm256_castsi128_si256(lo),hi,1));
+}
+
+static void compute_gamma8x2(__m256i *m11_256,__m256i *m10_256,llr_t **systematic,channel_t **y_parity,
+                             unsigned short frame_length,unsigned char term_flag) TD8_AVX2_FUNC;
+static void compute_gamma8x2(__m256i *m11_256,__m256i *m10_256,llr_t **systematic,channel_t **y_parity,
+                             unsigned short frame_length,unsigned char term_flag)
+{
+  int k,K1;
+  __m128i *s0=(__m128i *)systematic[0],*s1=(__m128i *)systematic[1];
+  __m128i *yp0=(__m128i *)y_parity[0],*yp1=(__m128i *)y_parity[1];
+  __m256i s,yp,sl,sh,ypl,yph;
+
+  K1 = (frame_length>>4);
+
+  for (k=0; k<K1; k++) {
+    s   = td8_pair(s0[k],s1[k]);
+    yp  = td8_pair(yp0[k],yp1[k]);
+    // sign extension of the low and high 8 bytes of each half (_mm_cvtepi8_epi16)
+    sl  = _mm256_srai_epi16(_mm256_unpacklo_epi8(s,s),8);
+    sh  = _mm256_srai_epi16(_mm256_unpackhi_epi8(s,s),8);
+    ypl = _mm256_srai_epi16(_mm256_unpacklo_epi8(yp,yp),8);
+    yph = _mm256_srai_epi16(_mm256_unpackhi_epi8(yp,yp),8);
+    m11_256[k] = _mm256_packs_epi16(_mm256_srai_epi16(_mm256_adds_epi16(sl,ypl),1),
+                                    _mm256_srai_epi16(_mm256_adds_epi16(sh,yph),1));
+    m10_256[k] = _mm256_packs_epi16(_mm256_srai_epi16(_mm256_subs_epi16(sl,ypl),1),
+                                    _mm256_srai_epi16(_mm256_subs_epi16(sh,yph),1));
+  }
+
+  // Termination, the low bytes come from column K1+term_flag as in compute_gamma8
+
+  s   = td8_pair(s0[k+term_flag],s1[k+term_flag]);
+  yp  = td8_pair(yp0[k+term_flag],yp1[k+term_flag]);
+  sl  = _mm256_srai_epi16(_mm256_unpacklo_epi8(s,s),8);
+  ypl = _mm256_srai_epi16(_mm256_unpacklo_epi8(yp,yp),8);
+  s   = td8_pair(s0[k],s1[k]);
+  yp  = td8_pair(yp0[k],yp1[k]);
+  sh  = _mm256_srai_epi16(_mm256_unpackhi_epi8(s,s),8);
+  yph = _mm256_srai_epi16(_mm256_unpackhi_epi8(yp,yp),8);
+  m11_256[k] = _mm256_packs_epi16(_mm256_srai_epi16(_mm256_adds_epi16(sl,ypl),1),
+                                  _mm256_srai_epi16(_mm256_adds_epi16(sh,yph),1));
+  m10_256[k] = _mm256_packs_epi16(_mm256_srai_epi16(_mm256_subs_epi16(sl,ypl),1),
+                                  _mm256_srai_epi16(_mm256_subs_epi16(sh,yph),1));
+}
+
+static void compute_alpha8x2(__m256i *alpha256,__m256i *m11_256,__m256i *m10_256,unsigned short frame_length) TD8_AVX2_FUNC;
+static void compute_alpha8x2(__m256i *alpha256,__m256i *m11_256,__m256i *m10_256,unsigned short frame_length)
+{
+  int k,j,loopval,rerun_flag,K1;
+  __m256i *alpha_ptr,*m11p,*m10p;
+  __m256i m_b0,m_b1,m_b2,m_b3,m_b4,m_b5,m_b6,m_b7;
+  __m256i new0,new1,new2,new3,new4,new5,new6,new7;
+  __m256i alpha_max;
+  __m256i unknown = _mm256_set1_epi8(-MAX8/2);
+  // -MAX8/2 in the first window of each half, 0 elsewhere
+  __m256i unknown0 = _mm256_srli_si256(_mm256_slli_si256(unknown,15),15);
+
+  // Set initial state: first colum is known
+  // the other columns are unknown, so all states are set to same value
+  alpha256[0] = _mm256_slli_si256(unknown,1);
+
+  for (j=1; j<8; j++)
+    alpha256[j] = unknown;
+
+  for (loopval=frame_length>>4, rerun_flag=0; rerun_flag<2; loopval=L, rerun_flag++) {
+
+    alpha_ptr = &alpha256[0];
+
+    m11p = m11_256;
+    m10p = m10_256;
+
+    for (k=0;  k<loopval;  k++) {
+      m_b0 = _mm256_adds_epi8(alpha_ptr[1],*m11p);  // m11
+      m_b4 = _mm256_subs_epi8(alpha_ptr[1],*m11p);  // m00=-m11
+      m_b1 = _mm256_subs_epi8(alpha_ptr[3],*m10p);  // m01=-m10
+      m_b5 = _mm256_adds_epi8(alpha_ptr[3],*m10p);  // m10
+      m_b2 = _mm256_adds_epi8(alpha_ptr[5],*m10p);  // m10
+      m_b6 = _mm256_subs_epi8(alpha_ptr[5],*m10p);  // m01=-m10
+      m_b3 = _mm256_subs_epi8(alpha_ptr[7],*m11p);  // m00=-m11
+      m_b7 = _mm256_adds_epi8(alpha_ptr[7],*m11p);  // m11
+
+      new0 = _mm256_subs_epi8(alpha_ptr[0],*m11p);  // m00=-m11
+      new4 = _mm256_adds_epi8(alpha_ptr[0],*m11p);  // m11
+      new1 = _mm256_adds_epi8(alpha_ptr[2],*m10p);  // m10
+      new5 = _mm256_subs_epi8(alpha_ptr[2],*m10p);  // m01=-m10
+      new2 = _mm256_subs_epi8(alpha_ptr[4],*m10p);  // m01=-m10
+      new6 = _mm256_adds_epi8(alpha_ptr[4],*m10p);  // m10
+      new3 = _mm256_adds_epi8(alpha_ptr[6],*m11p);  // m11
+      new7 = _mm256_subs_epi8(alpha_ptr[6],*m11p);  // m00=-m11
+
+      alpha_ptr += 8;
+      m11p++;
+      m10p++;
+      alpha_ptr[0] = _mm256_max_epi8(m_b0,new0);
+      alpha_ptr[1] = _mm256_max_epi8(m_b1,new1);
+      alpha_ptr[2] = _mm256_max_epi8(m_b2,new2);
+      alpha_ptr[3] = _mm256_max_epi8(m_b3,new3);
+      alpha_ptr[4] = _mm256_max_epi8(m_b4,new4);
+      alpha_ptr[5] = _mm256_max_epi8(m_b5,new5);
+      alpha_ptr[6] = _mm256_max_epi8(m_b6,new6);
+      alpha_ptr[7] = _mm256_max_epi8(m_b7,new7);
+
+      // compute and subtract maxima
+      alpha_max = _mm256_max_epi8(alpha_ptr[0],alpha_ptr[1]);
+      alpha_max = _mm256_max_epi8(alpha_max,alpha_ptr[2]);
+      alpha_max = _mm256_max_epi8(alpha_max,alpha_ptr[3]);
+      alpha_max = _mm256_max_epi8(alpha_max,alpha_ptr[4]);
+      alpha_max = _mm256_max_epi8(alpha_max,alpha_ptr[5]);
+      alpha_max = _mm256_max_epi8(alpha_max,alpha_ptr[6]);
+      alpha_max = _mm256_max_epi8(alpha_max,alpha_ptr[7]);
+
+      alpha_ptr[0] = _mm256_subs_epi8(alpha_ptr[0],alpha_max);
+      alpha_ptr[1] = _mm256_subs_epi8(alpha_ptr[1],alpha_max);
+      alpha_ptr[2] = _mm256_subs_epi8(alpha_ptr[2],alpha_max);
+      alpha_ptr[3] = _mm256_subs_epi8(alpha_ptr[3],alpha_max);
+      alpha_ptr[4] = _mm256_subs_epi8(alpha_ptr[4],alpha_max);
+      alpha_ptr[5] = _mm256_subs_epi8(alpha_ptr[5],alpha_max);
+      alpha_ptr[6] = _mm256_subs_epi8(alpha_ptr[6],alpha_max);
+      alpha_ptr[7] = _mm256_subs_epi8(alpha_ptr[7],alpha_max);
+    }
+
+    // Set intial state for next iteration from the last state
+    // as acolum end states are the first states of the next column
+    K1 = frame_length>>1;
+    alpha256[0] = _mm256_slli_si256(alpha256[K1],1);
+
+    for (j=1; j<8; j++)
+      alpha256[j] = _mm256_or_si256(_mm256_slli_si256(alpha256[j+K1],1),unknown0);
+  }
+}
+
+static void compute_beta8x2(__m256i *alpha256,__m256i *beta256,__m256i *m11_256,__m256i *m10_256,
+                            unsigned short frame_length,int offset8_flag) TD8_AVX2_FUNC;
+static void compute_beta8x2(__m256i *alpha256,__m256i *beta256,__m256i *m11_256,__m256i *m10_256,
+                            unsigned short frame_length,int offset8_flag)
+{
+  int k,j,rerun_flag,loopval;
+  __m256i m11_128,m10_128;
+  __m256i m_b0,m_b1,m_b2,m_b3,m_b4,m_b5,m_b6,m_b7;
+  __m256i new0,new1,new2,new3,new4,new5,new6,new7;
+  __m256i *beta_ptr;
+  __m256i beta_max;
+  // clears the last window of each half
+  __m256i last_mask = _mm256_srli_si256(_mm256_set1_epi8(-1),1);
+
+  // the initial states of backward computation are set from last value of alpha states (forward computation)
+  beta_ptr = &beta256[frame_length>>1];
+
+  for (j=0; j<8; j++)
+    beta_ptr[j] = alpha256[j+(frame_length>>1)];
+
+  for (rerun_flag=0, loopval=0;
+       rerun_flag<2 ;
+       loopval=(frame_length>>4)-L,rerun_flag++) {
+
+    if (offset8_flag==0) {
+      for (j=0; j<8; j++)
+        beta_ptr[j] = _mm256_and_si256(beta_ptr[j],last_mask);
+    }
+
+    beta_ptr = &beta256[frame_length>>1];
+
+    for (k=(frame_length>>4)-1;
+         k>=loopval;
+         k--) {
+      m11_128=m11_256[k];
+      m10_128=m10_256[k];
+      m_b0 = _mm256_adds_epi8(beta_ptr[4],m11_128);  //m11
+      m_b1 = _mm256_subs_epi8(beta_ptr[4],m11_128);  //m00
+      m_b2 = _mm256_subs_epi8(beta_ptr[5],m10_128);  //m01
+      m_b3 = _mm256_adds_epi8(beta_ptr[5],m10_128);  //m10
+      m_b4 = _mm256_adds_epi8(beta_ptr[6],m10_128);  //m10
+      m_b5 = _mm256_subs_epi8(beta_ptr[6],m10_128);  //m01
+      m_b6 = _mm256_subs_epi8(beta_ptr[7],m11_128);  //m00
+      m_b7 = _mm256_adds_epi8(beta_ptr[7],m11_128);  //m11
+
+      new0 = _mm256_subs_epi8(beta_ptr[0],m11_128);  //m00
+      new1 = _mm256_adds_epi8(beta_ptr[0],m11_128);  //m11
+      new2 = _mm256_adds_epi8(beta_ptr[1],m10_128);  //m10
+      new3 = _mm256_subs_epi8(beta_ptr[1],m10_128);  //m01
+      new4 = _mm256_subs_epi8(beta_ptr[2],m10_128);  //m01
+      new5 = _mm256_adds_epi8(beta_ptr[2],m10_128);  //m10
+      new6 = _mm256_adds_epi8(beta_ptr[3],m11_128);  //m11
+      new7 = _mm256_subs_epi8(beta_ptr[3],m11_128);  //m00
+
+      beta_ptr-=8;
+
+      beta_ptr[0] = _mm256_max_epi8(m_b0,new0);
+      beta_ptr[1] = _mm256_max_epi8(m_b1,new1);
+      beta_ptr[2] = _mm256_max_epi8(m_b2,new2);
+      beta_ptr[3] = _mm256_max_epi8(m_b3,new3);
+      beta_ptr[4] = _mm256_max_epi8(m_b4,new4);
+      beta_ptr[5] = _mm256_max_epi8(m_b5,new5);
+      beta_ptr[6] = _mm256_max_epi8(m_b6,new6);
+      beta_ptr[7] = _mm256_max_epi8(m_b7,new7);
+
+      beta_max = _mm256_max_epi8(beta_ptr[0],beta_ptr[1]);
+      beta_max = _mm256_max_epi8(beta_max   ,beta_ptr[2]);
+      beta_max = _mm256_max_epi8(beta_max   ,beta_ptr[3]);
+      beta_max = _mm256_max_epi8(beta_max   ,beta_ptr[4]);
+      beta_max = _mm256_max_epi8(beta_max   ,beta_ptr[5]);
+      beta_max = _mm256_max_epi8(beta_max   ,beta_ptr[6]);
+      beta_max = _mm256_max_epi8(beta_max   ,beta_ptr[7]);
+
+      beta_ptr[0] = _mm256_subs_epi8(beta_ptr[0],beta_max);
+      beta_ptr[1] = _mm256_subs_epi8(beta_ptr[1],beta_max);
+      beta_ptr[2] = _mm256_subs_epi8(beta_ptr[2],beta_max);
+      beta_ptr[3] = _mm256_subs_epi8(beta_ptr[3],beta_max);
+      beta_ptr[4] = _mm256_subs_epi8(beta_ptr[4],beta_max);
+      beta_ptr[5] = _mm256_subs_epi8(beta_ptr[5],beta_max);
+      beta_ptr[6] = _mm256_subs_epi8(beta_ptr[6],beta_max);
+      beta_ptr[7] = _mm256_subs_epi8(beta_ptr[7],beta_max);
+    }
+
+    // Set intial state for next iteration from the last state
+    // as column last states are the first states of the next column
+    beta_ptr = &beta256[frame_length>>1];
+
+    for (j=0; j<8; j++)
+      beta_ptr[j] = _mm256_srli_si256(beta256[j],1);
+  }
+}
+
+static void compute_ext8x2(__m256i *alpha256,__m256i *beta256,__m256i *m11_256,__m256i *m10_256,llr_t **ext,
+                           unsigned short frame_length) TD8_AVX2_FUNC;
+static void compute_ext8x2(__m256i *alpha256,__m256i *beta256,__m256i *m11_256,__m256i *m10_256,llr_t **ext,
+                           unsigned short frame_length)
+{
+  __m128i *ext0=(__m128i *)ext[0],*ext1=(__m128i *)ext[1];
+  __m256i *alpha_ptr,*beta_ptr;
+  __m256i m00_1,m00_2,m00_3,m00_4;
+  __m256i m01_1,m01_2,m01_3,m01_4;
+  __m256i m10_1,m10_2,m10_3,m10_4;
+  __m256i m11_1,m11_2,m11_3,m11_4;
+  __m256i ext256;
+  int k;
+
+  alpha_ptr = alpha256;
+  beta_ptr = &beta256[8];
+
+  for (k=0; k<(frame_length>>4); k++) {
+
+    m00_4 = _mm256_adds_epi8(alpha_ptr[7],beta_ptr[3]); //ALPHA_BETA_4m00;
+    m11_4 = _mm256_adds_epi8(alpha_ptr[7],beta_ptr[7]); //ALPHA_BETA_4m11;
+    m00_3 = _mm256_adds_epi8(alpha_ptr[6],beta_ptr[7]); //ALPHA_BETA_3m00;
+    m11_3 = _mm256_adds_epi8(alpha_ptr[6],beta_ptr[3]); //ALPHA_BETA_3m11;
+    m00_2 = _mm256_adds_epi8(alpha_ptr[1],beta_ptr[4]); //ALPHA_BETA_2m00;
+    m11_2 = _mm256_adds_epi8(alpha_ptr[1],beta_ptr[0]); //ALPHA_BETA_2m11;
+    m11_1 = _mm256_adds_epi8(alpha_ptr[0],beta_ptr[4]); //ALPHA_BETA_1m11;
+    m00_1 = _mm256_adds_epi8(alpha_ptr[0],beta_ptr[0]); //ALPHA_BETA_1m00;
+    m01_4 = _mm256_adds_epi8(alpha_ptr[5],beta_ptr[6]); //ALPHA_BETA_4m01;
+    m10_4 = _mm256_adds_epi8(alpha_ptr[5],beta_ptr[2]); //ALPHA_BETA_4m10;
+    m01_3 = _mm256_adds_epi8(alpha_ptr[4],beta_ptr[2]); //ALPHA_BETA_3m01;
+    m10_3 = _mm256_adds_epi8(alpha_ptr[4],beta_ptr[6]); //ALPHA_BETA_3m10;
+    m01_2 = _mm256_adds_epi8(alpha_ptr[3],beta_ptr[1]); //ALPHA_BETA_2m01;
+    m10_2 = _mm256_adds_epi8(alpha_ptr[3],beta_ptr[5]); //ALPHA_BETA_2m10;
+    m10_1 = _mm256_adds_epi8(alpha_ptr[2],beta_ptr[1]); //ALPHA_BETA_1m10;
+    m01_1 = _mm256_adds_epi8(alpha_ptr[2],beta_ptr[5]); //ALPHA_BETA_1m01;
+
+    m01_1 = _mm256_max_epi8(m01_1,m01_2);
+    m01_1 = _mm256_max_epi8(m01_1,m01_3);
+    m01_1 = _mm256_max_epi8(m01_1,m01_4);
+    m00_1 = _mm256_max_epi8(m00_1,m00_2);
+    m00_1 = _mm256_max_epi8(m00_1,m00_3);
+    m00_1 = _mm256_max_epi8(m00_1,m00_4);
+    m10_1 = _mm256_max_epi8(m10_1,m10_2);
+    m10_1 = _mm256_max_epi8(m10_1,m10_3);
+    m10_1 = _mm256_max_epi8(m10_1,m10_4);
+    m11_1 = _mm256_max_epi8(m11_1,m11_2);
+    m11_1 = _mm256_max_epi8(m11_1,m11_3);
+    m11_1 = _mm256_max_epi8(m11_1,m11_4);
+
+    m01_1 = _mm256_subs_epi8(m01_1,m10_256[k]);
+    m00_1 = _mm256_subs_epi8(m00_1,m11_256[k]);
+    m10_1 = _mm256_adds_epi8(m10_1,m10_256[k]);
+    m11_1 = _mm256_adds_epi8(m11_1,m11_256[k]);
+
+    m01_1 = _mm256_max_epi8(m01_1,m00_1);
+    m10_1 = _mm256_max_epi8(m10_1,m11_1);
+
+    ext256  = _mm256_subs_epi8(m10_1,m01_1);
+    ext0[k] = _mm256_castsi256_si128(ext256);
+    ext1[k] = _mm256_extracti128_si256(ext256,1);
+
+    alpha_ptr+=8;
+    beta_ptr+=8;
+  }
+}
+
+static void log_map8x2(llr_t **systematic,channel_t **y_parity,__m256i *m11,__m256i *m10,__m256i *alpha,__m256i *beta,
+                       llr_t **ext,unsigned short frame_length,unsigned char term_flag,int offset8_flag,
+                       time_stats_t *alpha_stats,time_stats_t *beta_stats,time_stats_t *gamma_stats,time_stats_t *ext_stats)
+{
+
+  start_meas(gamma_stats) ;
+  compute_gamma8x2(m11,m10,systematic,y_parity,frame_length,term_flag) ;
+  stop_meas(gamma_stats);
+  start_meas(alpha_stats) ;
+  compute_alpha8x2(alpha,m11,m10,frame_length)                  ;
+  stop_meas(alpha_stats);
+  start_meas(beta_stats)  ;
+  compute_beta8x2(alpha,beta,m11,m10,frame_length,offset8_flag)      ;
+  stop_meas(beta_stats);
+  start_meas(ext_stats)   ;
+  compute_ext8x2(alpha,beta,m11,m10,ext,frame_length)       ;
+  stop_meas(ext_stats);
+
+}
+
+// Decodes y[0] and y[1], both of n bits. A block which passes its CRC is left out of the
+// interleaving and hard decisions of the next iterations, so that its output and return value
+// are the ones of phy_threegpplte_turbo_decoder8.
+static void phy_threegpplte_turbo_decoder8x2(short **y,
+    unsigned char **decoded_bytes,
+    unsigned short n,
+    unsigned char max_iterations,
+    unsigned char crc_type,
+    unsigned char *F,
+    unsigned char *ret,
+    time_stats_t *init_stats,
+    time_stats_t *alpha_stats,
+    time_stats_t *beta_stats,
+    time_stats_t *gamma_stats,
+    time_stats_t *ext_stats,
+    time_stats_t *intl1_stats,
+    time_stats_t *intl2_stats)
+{
+
+  td8_block_t b[2];
+  int n2,i,done[2]= {0,0};
+
+  start_meas(init_stats);
+
+  td8_block_init(&b[0],n,crc_type);
+  n2 = b[0].n2;
+
+  llr_t y8[2][3*(n2+16)] __attribute__((aligned(16)));
+  llr_t systematic0[2][n2+48] __attribute__ ((aligned(16)));
+  llr_t systematic1[2][n2+48] __attribute__ ((aligned(16)));
+  llr_t systematic2[2][n2+48] __attribute__ ((aligned(16)));
+  llr_t yparity1[2][n2+48] __attribute__ ((aligned(16)));
+  llr_t yparity2[2][n2+48] __attribute__ ((aligned(16)));
+  llr_t ext[2][n2+128] __attribute__((aligned(16)));
+  llr_t ext2[2][n2+128] __attribute__((aligned(16)));
+  uint16_t decoded_bytes_interl[2][6144/16] __attribute__((aligned(16)));
+  __m128i tmp128[2][(n+8)>>3];
+
+  __m256i alpha[(n2+32)>>1] __attribute__ ((aligned(32)));
+  __m256i beta[(n2+32)>>1] __attribute__ ((aligned(32)));
+  __m256i m11[(n2+48)>>4] __attribute__ ((aligned(32)));
+  __m256i m10[(n2+48)>>4] __attribute__ ((aligned(32)));
+
+  llr_t *s0[2],*s1[2],*s2[2],*yp1[2],*yp2[2],*e[2],*e2[2];
+  unsigned char iteration_cnt=0;
+  turbo_stop_t policy=turbo_stop_policy;
+  unsigned char hd[2][6144/8];
+
+  for (i=0; i<2; i++) {
+    if (i>0)
+      b[i] = b[0];
+
+    b[i].systematic0 = s0[i] = systematic0[i];
+    b[i].systematic1 = s1[i] = systematic1[i];
+    b[i].systematic2 = s2[i] = systematic2[i];
+    b[i].yparity1 = yp1[i] = yparity1[i];
+    b[i].yparity2 = yp2[i] = yparity2[i];
+    b[i].ext = e[i] = ext[i];
+    b[i].ext2 = e2[i] = ext2[i];
+    b[i].decoded_bytes_interl = decoded_bytes_interl[i];
+    b[i].tmp128 = tmp128[i];
+
+    td8_load_input(y[i],n,y8[i],&b[i]);
+  }
+
+  stop_meas(init_stats);
+
+  // do log_map from first parity bit
+
+  log_map8x2(s0,yp1,m11,m10,alpha,beta,e,n2,0,b[0].offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+
+  if (policy != TURBO_STOP_CRC) {
+    start_meas(intl2_stats);
+
+    for (i=0; i<2; i++) {
+      if (td8_check_crc_ext(&b[i],decoded_bytes[i],n,crc_type,F[i]) == 1) {
+        done[i] = 1;
+        ret[i] = 1;
+      }
+    }
+
+    stop_meas(intl2_stats);
+
+    if (done[0] && done[1])
+      return;
+  }
+
+  while (iteration_cnt++ < max_iterations) {
+
+    start_meas(intl1_stats);
+
+    for (i=0; i<2; i++)
+      if (done[i] == 0)
+        td8_interleave(&b[i]);
+
+    stop_meas(intl1_stats);
+
+    // do log_map from second parity bit
+
+    log_map8x2(s2,yp2,m11,m10,alpha,beta,e2,n2,1,b[0].offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+
+    for (i=0; i<2; i++)
+      if (done[i] == 0)
+        td8_deinterleave(&b[i],decoded_bytes[i]);
+
+    // Check if we decoded the blocks
+    if ((iteration_cnt>1) || (policy != TURBO_STOP_CRC)) {
+      start_meas(intl2_stats);
+
+      for (i=0; i<2; i++) {
+        if (done[i] == 0) {
+          td8_hard_decision(&b[i],(llr_t *)b[i].tmp128,pi6tab8[b[i].iind],decoded_bytes[i]);
+
+          if (td8_check_crc(&b[i],decoded_bytes[i],n,crc_type,F[i]) == 1) {
+            done[i] = 1;
+            ret[i] = iteration_cnt;
+          } else if (policy == TURBO_STOP_CRC_HALF_HD) {
+            if ((iteration_cnt>1) && (memcmp(hd[i],decoded_bytes[i],n>>3) == 0)) {
+              done[i] = 1;
+              ret[i] = max_iterations+1;
+            }
+
+            memcpy(hd[i],decoded_bytes[i],n>>3);
+          }
+        }
+      }
+
+      stop_meas(intl2_stats);
+
+      if (done[0] && done[1])
+        return;
+    }
+
+    // do a new iteration if they are not yet decoded
+    if (iteration_cnt < max_iterations) {
+      log_map8x2(s1,yp1,m11,m10,alpha,beta,e,n2,0,b[0].offset8_flag,alpha_stats,beta_stats,gamma_stats,ext_stats);
+
+      if (policy != TURBO_STOP_CRC) {
+        start_meas(intl2_stats);
+
+        for (i=0; i<2; i++) {
+          if ((done[i] == 0) && (td8_check_crc_ext(&b[i],decoded_bytes[i],n,crc_type,F[i]) == 1)) {
+            done[i] = 1;
+            ret[i] = iteration_cnt+1;
+          }
+        }
+
+        stop_meas(intl2_stats);
+
+        if (done[0] && done[1])
+          return;
+      }
+
+      for (i=0; i<2; i++)
+        if (done[i] == 0)
+          td8_update_ext(&b[i]);
+    }
+  }
+
+  for (i=0; i<2; i++)
+    if (done[i] == 0)
+      ret[i] = iteration_cnt;
+}
+
+#else
+
+int td8_set_avx2(int enable)
+{
+
+  return(0);
+}
+
 #endif
-      int myloop=n2>>4;
 
-      for (i=0; i<myloop; i++) {
+void phy_threegpplte_turbo_decoder8_batch(int16_t **y,
+    uint8_t **decoded_bytes,
+    uint16_t *n,
+    uint8_t nb,
+    uint8_t max_iterations,
+    uint8_t crc_type,
+    uint8_t F,
+    uint8_t *ret,
+    time_stats_t *init_stats,
+    time_stats_t *alpha_stats,
+    time_stats_t *beta_stats,
+    time_stats_t *gamma_stats,
+    time_stats_t *ext_stats,
+    time_stats_t *intl1_stats,
+    time_stats_t *intl2_stats)
+{
+
+  int r=0;
 #if defined(__x86_64__) || defined(__i386__)
-        *ext_128=_mm_adds_epi8(_mm_subs_epi8(*ext_128,*s1_128++),*s0_128++);
-#elif defined(__arm__)
-        *ext_128=vqaddq_s8(vqsubq_s8(*ext_128,*s1_128++),*s0_128++);
+  unsigned char Fp[2];
+  td8_block_t b;
 #endif
-        ext_128++;
-      }
+
+  while (r<nb) {
+#if defined(__x86_64__) || defined(__i386__)
+
+    // the second pass of the alpha/beta recursions runs over L columns, blocks shorter
+    // than that (n<256) keep the 128-bit decoder
+    if ((td8_avx2_enabled() == 1) &&
+        (r+1 < nb) &&
+        (n[r] == n[r+1]) &&
+        (n[r] >= (L<<4)) &&
+        (td8_block_init(&b,n[r],crc_type) == 0)) {
+      Fp[0] = (r==0) ? F : 0;
+      Fp[1] = 0;
+      phy_threegpplte_turbo_decoder8x2(&y[r],&decoded_bytes[r],n[r],max_iterations,crc_type,Fp,&ret[r],
+                                       init_stats,alpha_stats,beta_stats,gamma_stats,ext_stats,intl1_stats,intl2_stats);
+      r+=2;
+
+      if ((ret[r-2] > max_iterations) || (ret[r-1] > max_iterations))
+        break;
+
+      continue;
     }
-  }
 
-  return(iteration_cnt);
+#endif
+    ret[r] = phy_threegpplte_turbo_decoder8(y[r],decoded_bytes[r],n[r],0,0,max_iterations,crc_type,(r==0) ? F : 0,
+                                            init_stats,alpha_stats,beta_stats,gamma_stats,ext_stats,intl1_stats,intl2_stats);
+    r++;
+
+    if (ret[r-1] > max_iterations)
+      break;
+  }
 
+  // the transport block is lost, the remaining segments are not decoded
+  for (; r<nb; r++)
+    ret[r] = max_iterations+2;
 }
@@ -47,6 +47,10 @@
 
 #include "defs.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 
 /*ref 36-212 v8.6.0 , pp 8-9 */
 /* the highest degree is set by default */
@@ -88,122 +92,296 @@ crcbit (unsigned char * inputptr, int octetlen, unsigned int poly)
 
 crc table initialization
 
+All the CRCs are kept MSB aligned in a 32-bit register, i.e. as
+CRCs of the polynomial P32(x) = x^32 + poly(x). Table k holds the
+contribution of a byte followed by k zero bytes, so that 8 bytes
+are processed per iteration (slice-by-8).
+
 *********************************************************/
-static unsigned int      crc24aTable[256];
-static unsigned int      crc24bTable[256];
-static unsigned short      crc16Table[256];
-static unsigned short      crc12Table[256];
-static unsigned char       crc8Table[256];
+typedef struct {
+  unsigned int poly;
+  unsigned int table[8][256];
+  /// x^n mod P32 for n = 128+64, 128, 512+64, 512 (PCLMULQDQ folding)
+  uint64_t fold[4];
+} crc_engine_t;
+
+static crc_engine_t crc24aEngine;
+static crc_engine_t crc24bEngine;
+static crc_engine_t crc16Engine;
+static crc_engine_t crc12Engine;
+static crc_engine_t crc8Engine;
+
+// x^n mod P32
+static unsigned int crc_xpow_mod(int n, unsigned int poly)
+{
+  unsigned int r = 1;
 
-void crcTableInit (void)
+  while (n-- > 0)
+    r = (r & (1U<<31)) ? ((r << 1) ^ poly) : (r << 1);
+
+  return r;
+}
+
+static void crc_engine_init(crc_engine_t *e, unsigned int poly)
 {
-  unsigned char              c = 0;
+  unsigned int k, i;
+  unsigned char c = 0;
+
+  e->poly = poly;
 
   do {
-    crc24aTable[c] = crcbit (&c, 1, poly24a);
-    crc24bTable[c] = crcbit (&c, 1, poly24b);
-    crc16Table[c] = (unsigned short) (crcbit (&c, 1, poly16) >> 16);
-    crc12Table[c] = (unsigned short) (crcbit (&c, 1, poly12) >> 16);
-    crc8Table[c] = (unsigned char) (crcbit (&c, 1, poly8) >> 24);
+    e->table[0][c] = crcbit (&c, 1, poly);
   } while (++c);
+
+  for (k = 1; k < 8; k++)
+    for (i = 0; i < 256; i++)
+      e->table[k][i] = (e->table[k-1][i] << 8) ^ e->table[0][e->table[k-1][i] >> 24];
+
+  e->fold[0] = crc_xpow_mod(128+64, poly);
+  e->fold[1] = crc_xpow_mod(128, poly);
+  e->fold[2] = crc_xpow_mod(512+64, poly);
+  e->fold[3] = crc_xpow_mod(512, poly);
 }
+
 /*********************************************************
 
-Byte by byte implementations,
-assuming initial byte is 0 padded (in MSB) if necessary
+Slice-by-8 implementation
 
 *********************************************************/
-unsigned int
-crc24a (unsigned char * inptr, int bitlen)
+static inline unsigned int crc_slice8 (const crc_engine_t *e, unsigned int crc, const unsigned char *inptr, int octetlen)
 {
+  unsigned int w1, w2;
 
-  int             octetlen, resbit;
-  unsigned int             crc = 0;
-  octetlen = bitlen / 8;        /* Change in octets */
-  resbit = (bitlen % 8);
-
-  while (octetlen-- > 0) {
-    //    printf("in %x => crc %x\n",crc,*inptr);
-    crc = (crc << 8) ^ crc24aTable[(*inptr++) ^ (crc >> 24)];
+  for (; octetlen >= 8; octetlen -= 8, inptr += 8) {
+    w1 = crc ^ (((unsigned int)inptr[0] << 24) | ((unsigned int)inptr[1] << 16) | ((unsigned int)inptr[2] << 8) | inptr[3]);
+    w2 = ((unsigned int)inptr[4] << 24) | ((unsigned int)inptr[5] << 16) | ((unsigned int)inptr[6] << 8) | inptr[7];
+    crc = e->table[7][w1 >> 24] ^ e->table[6][(w1 >> 16) & 0xff] ^ e->table[5][(w1 >> 8) & 0xff] ^ e->table[4][w1 & 0xff] ^
+          e->table[3][w2 >> 24] ^ e->table[2][(w2 >> 16) & 0xff] ^ e->table[1][(w2 >> 8) & 0xff] ^ e->table[0][w2 & 0xff];
   }
 
-  if (resbit > 0)
-    crc = (crc << resbit) ^ crc24aTable[((*inptr) >> (8 - resbit)) ^ (crc >> (32 - resbit))];
+  while (octetlen-- > 0)
+    crc = (crc << 8) ^ e->table[0][(*inptr++) ^ (crc >> 24)];
 
   return crc;
 }
 
-unsigned int crc24b (unsigned char * inptr, int bitlen)
+/*********************************************************
+
+Carry-less multiply (PCLMULQDQ) implementation
+
+The message is folded 64 bytes at a time into four 128-bit
+accumulators (multiplication by x^512 mod P32), which are then
+folded into one (x^128 mod P32). The 128-bit remainder and the
+last bytes go through the tables.
+
+*********************************************************/
+#if defined(__x86_64__) || defined(__i386__)
+
+#define CRC_PCLMUL_MIN_OCTETS 64
+
+static int crc_pclmul = -1;
+
+int crc_set_pclmul(int enable)
 {
 
-  int             octetlen, resbit;
-  unsigned int             crc = 0;
-  octetlen = bitlen / 8;        /* Change in octets */
-  resbit = (bitlen % 8);
+  crc_pclmul = (enable && __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3")) ? 1 : 0;
 
-  while (octetlen-- > 0) {
-    crc = (crc << 8) ^ crc24bTable[(*inptr++) ^ (crc >> 24)];
+  return(crc_pclmul);
+}
+
+static inline int crc_pclmul_enabled(void)
+{
+
+  if (crc_pclmul < 0)
+    crc_set_pclmul(1);
+
+  return(crc_pclmul);
+}
+
+#define PCLMUL_FUNC __attribute__((target("pclmul,ssse3")))
+
+// x.x^n reduced to 96 bits, with k = (x^(n+64) mod P32, x^n mod P32)
+static inline __m128i crc_fold128(__m128i x, __m128i k) PCLMUL_FUNC;
+static inline __m128i crc_fold128(__m128i x, __m128i k)
+{
+
+  return(_mm_xor_si128(_mm_clmulepi64_si128(x,k,0x11),_mm_clmulepi64_si128(x,k,0x00)));
+}
+
+static unsigned int crc_pclmul_octets (const crc_engine_t *e, const unsigned char *inptr, int octetlen) PCLMUL_FUNC;
+static unsigned int crc_pclmul_octets (const crc_engine_t *e, const unsigned char *inptr, int octetlen)
+{
+
+  // first byte of the message in the most significant byte
+  const __m128i bswap = _mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0);
+  const __m128i k128 = _mm_set_epi64x(e->fold[0],e->fold[1]);
+  const __m128i k512 = _mm_set_epi64x(e->fold[2],e->fold[3]);
+  __m128i a0,a1,a2,a3;
+  unsigned char r[16];
+
+  a0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)inptr),bswap);
+  a1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)(inptr+16)),bswap);
+  a2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)(inptr+32)),bswap);
+  a3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)(inptr+48)),bswap);
+  inptr    += 64;
+  octetlen -= 64;
+
+  for (; octetlen >= 64; octetlen -= 64, inptr += 64) {
+    a0 = _mm_xor_si128(crc_fold128(a0,k512),_mm_shuffle_epi8(_mm_loadu_si128((__m128i *)inptr),bswap));
+    a1 = _mm_xor_si128(crc_fold128(a1,k512),_mm_shuffle_epi8(_mm_loadu_si128((__m128i *)(inptr+16)),bswap));
+    a2 = _mm_xor_si128(crc_fold128(a2,k512),_mm_shuffle_epi8(_mm_loadu_si128((__m128i *)(inptr+32)),bswap));
+    a3 = _mm_xor_si128(crc_fold128(a3,k512),_mm_shuffle_epi8(_mm_loadu_si128((__m128i *)(inptr+48)),bswap));
   }
 
-  if (resbit > 0)
-    crc = (crc << resbit) ^ crc24bTable[((*inptr) >> (8 - resbit)) ^ (crc >> (32 - resbit))];
+  a0 = _mm_xor_si128(crc_fold128(a0,k128),a1);
+  a0 = _mm_xor_si128(crc_fold128(a0,k128),a2);
+  a0 = _mm_xor_si128(crc_fold128(a0,k128),a3);
 
-  return crc;
+  for (; octetlen >= 16; octetlen -= 16, inptr += 16)
+    a0 = _mm_xor_si128(crc_fold128(a0,k128),_mm_shuffle_epi8(_mm_loadu_si128((__m128i *)inptr),bswap));
+
+  _mm_storeu_si128((__m128i *)r,_mm_shuffle_epi8(a0,bswap));
+
+  return crc_slice8(e,crc_slice8(e,0,r,16),inptr,octetlen);
 }
 
-unsigned int
-crc16 (unsigned char * inptr, int bitlen)
+#else
+
+int crc_set_pclmul(int enable)
 {
-  int             octetlen, resbit;
-  unsigned int             crc = 0;
-  octetlen = bitlen / 8;        /* Change in octets */
-  resbit = (bitlen % 8);
 
-  while (octetlen-- > 0) {
+  return(0);
+}
+
+#endif
 
-    crc = (crc << 8) ^ (crc16Table[(*inptr++) ^ (crc >> 24)] << 16);
+static void crc_engine_check(crc_engine_t *e, const char *name, unsigned char *buf, int maxlen, int *errors)
+{
+  int octetlen;
+  unsigned int ref;
+
+  for (octetlen = 0; octetlen <= maxlen; octetlen += 1 + (octetlen >> 3)) {
+    ref = crcbit(buf, octetlen, e->poly);
+
+    if (crc_slice8(e, 0, buf, octetlen) != ref) {
+      msg("[CRC] %s slice-by-8 mismatch for %d octets\n",name,octetlen);
+      (*errors)++;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+    if ((crc_pclmul_enabled() == 1) && (octetlen >= CRC_PCLMUL_MIN_OCTETS) &&
+        (crc_pclmul_octets(e, buf, octetlen) != ref)) {
+      msg("[CRC] %s carry-less multiply mismatch for %d octets\n",name,octetlen);
+      (*errors)++;
+    }
+
+#endif
   }
+}
 
-  if (resbit > 0)
-    crc = (crc << resbit) ^ (crc16Table[((*inptr) >> (8 - resbit)) ^ (crc >> (32 - resbit))] << 16);
+int crc_self_test(void)
+{
+  static unsigned char buf[1024];
+  unsigned int i, s = 0x12345678;
+  int errors = 0;
 
-  return crc;
+  for (i = 0; i < sizeof(buf); i++) {
+    s = s*1103515245 + 12345;
+    buf[i] = (unsigned char)(s >> 16);
+  }
+
+  crc_engine_check(&crc24aEngine, "crc24a", buf, sizeof(buf), &errors);
+  crc_engine_check(&crc24bEngine, "crc24b", buf, sizeof(buf), &errors);
+  crc_engine_check(&crc16Engine, "crc16", buf, sizeof(buf), &errors);
+  crc_engine_check(&crc12Engine, "crc12", buf, sizeof(buf), &errors);
+  crc_engine_check(&crc8Engine, "crc8", buf, sizeof(buf), &errors);
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  if ((errors > 0) && (crc_pclmul == 1)) {
+    msg("[CRC] Self-test failed, falling back to slice-by-8\n");
+    crc_pclmul = 0;
+  }
+
+#endif
+
+  return errors;
 }
 
-unsigned int
-crc12 (unsigned char * inptr, int bitlen)
+void crcTableInit (void)
+{
+
+  crc_engine_init(&crc24aEngine, poly24a);
+  crc_engine_init(&crc24bEngine, poly24b);
+  crc_engine_init(&crc16Engine, poly16);
+  crc_engine_init(&crc12Engine, poly12);
+  crc_engine_init(&crc8Engine, poly8);
+
+  crc_self_test();
+}
+/*********************************************************
+
+Byte-oriented implementations (slice-by-8 or carry-less multiply),
+assuming initial byte is 0 padded (in MSB) if necessary
+
+*********************************************************/
+static inline unsigned int crc_engine (const crc_engine_t *e, unsigned char * inptr, int bitlen)
 {
+
   int             octetlen, resbit;
-  unsigned int             crc = 0;
+  unsigned int             crc;
   octetlen = bitlen / 8;        /* Change in octets */
   resbit = (bitlen % 8);
 
-  while (octetlen-- > 0) {
-    crc = (crc << 8) ^ (crc12Table[(*inptr++) ^ (crc >> 24)] << 16);
-  }
+#if defined(__x86_64__) || defined(__i386__)
+
+  if ((octetlen >= CRC_PCLMUL_MIN_OCTETS) && (crc_pclmul_enabled() == 1))
+    crc = crc_pclmul_octets(e, inptr, octetlen);
+  else
+#endif
+    crc = crc_slice8(e, 0, inptr, octetlen);
+
+  inptr += octetlen;
 
   if (resbit > 0)
-    crc = (crc << resbit) ^ (crc12Table[((*inptr) >> (8 - resbit)) ^ (crc >> (32 - resbit))] << 16);
+    crc = (crc << resbit) ^ e->table[0][((*inptr) >> (8 - resbit)) ^ (crc >> (32 - resbit))];
 
   return crc;
 }
 
 unsigned int
-crc8 (unsigned char * inptr, int bitlen)
+crc24a (unsigned char * inptr, int bitlen)
 {
-  int             octetlen, resbit;
-  unsigned int             crc = 0;
-  octetlen = bitlen / 8;        /* Change in octets */
-  resbit = (bitlen % 8);
 
-  while (octetlen-- > 0) {
-    crc = crc8Table[(*inptr++) ^ (crc >> 24)] << 24;
-  }
+  return crc_engine(&crc24aEngine, inptr, bitlen);
+}
 
-  if (resbit > 0)
-    crc = (crc << resbit) ^ (crc8Table[((*inptr) >> (8 - resbit)) ^ (crc >> (32 - resbit))] << 24);
+unsigned int crc24b (unsigned char * inptr, int bitlen)
+{
 
-  return crc;
+  return crc_engine(&crc24bEngine, inptr, bitlen);
+}
+
+unsigned int
+crc16 (unsigned char * inptr, int bitlen)
+{
+
+  return crc_engine(&crc16Engine, inptr, bitlen);
+}
+
+unsigned int
+crc12 (unsigned char * inptr, int bitlen)
+{
+
+  return crc_engine(&crc12Engine, inptr, bitlen);
+}
+
+unsigned int
+crc8 (unsigned char * inptr, int bitlen)
+{
+
+  return crc_engine(&crc8Engine, inptr, bitlen);
 }
 
 #ifdef DEBUG_CRC
@@ -218,10 +396,11 @@ main()
 {
   unsigned char test[] = "Thebigredfox";
   crcTableInit();
-  printf("%x\n", crcbit(test, sizeof(test) - 1, poly24));
-  printf("%x\n", crc24(test, (sizeof(test) - 1)*8));
+  printf("%x\n", crcbit(test, sizeof(test) - 1, poly24a));
+  printf("%x\n", crc24a(test, (sizeof(test) - 1)*8));
   printf("%x\n", crcbit(test, sizeof(test) - 1, poly8));
   printf("%x\n", crc8(test, (sizeof(test) - 1)*8));
+  printf("self-test: %d errors\n", crc_self_test());
 }
 #endif
 
@@ -252,6 +252,79 @@ int lte_rate_matching_turbo_rx(uint32_t RTC,
                                uint8_t r,
                                uint32_t *E_out);
 
+/// maximum number of runs of a rm_turbo_map_t (at most 7 NULL positions per column plus the last one)
+#define RM_TURBO_MAX_RUNS 232
+
+/*!\brief Positions of the circular buffer (w-sequence) of a turbo code block which are not LTE_NULL,
+stored as runs of consecutive positions in increasing order. It replaces the dummy_w sequence of
+lte_rate_matching_turbo_rx(). */
+typedef struct {
+  /// R^TC_subblock, number of rows of the interleaving matrix
+  uint32_t RTC;
+  /// number of runs
+  uint16_t nb_runs;
+  /// first position of each run
+  uint16_t start[RM_TURBO_MAX_RUNS];
+  /// number of positions of each run
+  uint16_t length[RM_TURBO_MAX_RUNS];
+} rm_turbo_map_t;
+
+/** \fn void init_rm_turbo_maps(void)
+\brief This function precomputes the rm_turbo_map_t of the 188 code block sizes without filler bits.
+*/
+void init_rm_turbo_maps(void);
+
+/** \fn const rm_turbo_map_t *get_rm_turbo_map(uint32_t D,uint8_t F,rm_turbo_map_t *map)
+\brief This function returns the NULL-free runs of the circular buffer of a code block, the same positions as generate_dummy_w().
+The precomputed map is returned when F is 0 and init_rm_turbo_maps() was called, otherwise it is computed in map.
+\param D Number of systematic bits plus 4 (plus 4 for termination)
+\param F Number of filler bits due added during segmentation
+\param map Storage used when there is no precomputed map
+\returns Pointer to the map
+*/
+const rm_turbo_map_t *get_rm_turbo_map(uint32_t D,uint8_t F,rm_turbo_map_t *map);
+
+/**
+\brief Same as lte_rate_matching_turbo_rx() with the NULL positions given by a rm_turbo_map_t. The soft inputs are
+combined run by run with saturating SIMD additions.
+\param map NULL-free runs of the code block (from get_rm_turbo_map())
+\param G This the number of coded transport bits allocated in sub-frame
+\param w This is a pointer to the soft w-sequence (second interleaver output) with soft-combined outputs from successive HARQ rounds
+\param soft_input This is a pointer to the soft channel output
+\param C Number of segments (codewords) in the sub-frame
+\param Nsoft Total number of soft bits (from UE capabilities in 36-306)
+\param Mdlharq Number of HARQ rounds
+\param Kmimo MIMO capability for this DLSCH (0 = no MIMO)
+\param rvidx round index (0-3)
+\param clear 1 means clear soft buffer (start of HARQ round)
+\param Qm modulation order (2,4,6)
+\param Nl number of layers (1,2)
+\param r segment number
+\param E_out the number of coded bits per segment
+\returns 0 on success, -1 on failure
+*/
+int lte_rate_matching_turbo_rx_map(const rm_turbo_map_t *map,
+                                   uint32_t G,
+                                   int16_t *w,
+                                   int16_t *soft_input,
+                                   uint8_t C,
+                                   uint32_t Nsoft,
+                                   uint8_t Mdlharq,
+                                   uint8_t Kmimo,
+                                   uint8_t rvidx,
+                                   uint8_t clear,
+                                   uint8_t Qm,
+                                   uint8_t Nl,
+                                   uint8_t r,
+                                   uint32_t *E_out);
+
+/*!\fn int rm_set_avx2(int enable)
+\brief Select the 256-bit soft combining of lte_rate_matching_turbo_rx_map(), called from phy_simd_dispatch_init()
+\param enable 1 to use AVX2 when the CPU supports it
+\returns 1 if the AVX2 path is used
+*/
+int rm_set_avx2(int enable);
+
 uint32_t lte_rate_matching_turbo_rx_abs(uint32_t RTC,
                                         uint32_t G,
                                         double *w,
@@ -319,6 +392,26 @@ void threegpplte_turbo_encoder(uint8_t *input,
                                uint16_t interleaver_f1,
                                uint16_t interleaver_f2);
 
+/*!\fn void threegpplte_turbo_encoder_segments(uint8_t **input,uint16_t *input_length_bytes,uint8_t **output,int nb_segments)
+\brief Turbo encodes the code blocks of a transport block in one call, the interleaver is looked up once per code block size.
+The output of each code block has the layout of threegpplte_turbo_encoder().
+@param input Pointers to the code blocks
+@param input_length_bytes Number of bytes of each code block (K/8)
+@param output Pointers to the output buffers
+@param nb_segments Number of code blocks
+*/
+void threegpplte_turbo_encoder_segments(uint8_t **input,
+                                        uint16_t *input_length_bytes,
+                                        uint8_t **output,
+                                        int nb_segments);
+
+/*!\fn int te_set_avx2(int enable)
+\brief Select the 256-bit output expansion of threegpplte_turbo_encoder(), called from phy_simd_dispatch_init()
+@param enable 1 to use AVX2 when the host supports it
+@returns 1 if the AVX2 path is in use, 0 otherwise
+*/
+int te_set_avx2(int enable);
+
 
 /** \fn void ccodelte_encode(int32_t numbits,uint8_t add_crc, uint8_t *inPtr,uint8_t *outPtr,uint16_t rnti)
 \brief This function implements the LTE convolutional code of rate 1/3
@@ -354,7 +447,7 @@ void ccodedab_init(void);
 void ccodedab_init_inv(void);
 
 /*!\fn void crcTableInit(void)
-\brief This function initializes the different crc tables.*/
+\brief This function initializes the different crc tables (slice-by-8 and carry-less multiply constants) and runs crc_self_test().*/
 void crcTableInit (void);
 
 /*!\fn void init_td8(void)
@@ -400,6 +493,19 @@ uint32_t crc12 (uint8_t *inPtr, int32_t bitlen);
 @param bitlen length of inputs in bits*/
 uint32_t crc8  (uint8_t *inPtr, int32_t bitlen);
 
+/*!\fn int crc_set_pclmul(int enable)
+\brief Select the carry-less multiply (PCLMULQDQ) folding for the CRCs of 64 octets or more, the slice-by-8 tables are used otherwise
+@param enable 1 to use PCLMULQDQ when the host supports it, 0 to use the tables only
+@returns 1 if the PCLMULQDQ path is in use, 0 otherwise
+*/
+int crc_set_pclmul(int enable);
+
+/*!\fn int crc_self_test(void)
+\brief Check the slice-by-8 and carry-less multiply CRCs against the bit by bit implementation (crcbit) on a pseudo-random buffer. The carry-less multiply path is disabled on a mismatch.
+@returns number of mismatches
+*/
+int crc_self_test(void);
+
 /*!\fn void phy_viterbi_dot11_sse2(int8_t *y, uint8_t *decoded_bytes, uint16_t n,int offset,int traceback)
 \brief This routine performs a SIMD optmized Viterbi decoder for the 802.11 64-state convolutional code. It can be
 run in segments with final trace back after last segment.
@@ -418,6 +524,26 @@ void phy_viterbi_dot11_sse2(int8_t *y,uint8_t *decoded_bytes,uint16_t n);
 //void phy_viterbi_lte_sse2(int8_t *y,uint8_t *decoded_bytes,uint16_t n);
 void phy_viterbi_lte_sse2(int8_t *y,uint8_t *decoded_bytes,uint16_t n);
 
+/// Longest trellis decoded two codewords at a time by phy_viterbi_lte_batch (DCI and PBCH payloads with their CRC)
+#define VITERBI_LTE_BATCH_MAX_BITS 128
+
+/*!\fn void phy_viterbi_lte_batch(int8_t **y,uint8_t **decoded_bytes,uint16_t n,int nb_cw)
+\brief Viterbi decoding of nb_cw codewords of the same length. With AVX2 pairs of codewords are decoded in the two 128-bit lanes of the
+phy_viterbi_lte_sse2 recursion, giving the same output as nb_cw calls to phy_viterbi_lte_sse2. Longer trellises and the last odd codeword
+are decoded one at a time.
+@param y Pointers to the soft inputs
+@param decoded_bytes Pointers to the decoded outputs, to be cleared by the caller as for phy_viterbi_lte_sse2
+@param n Length of input/trellis depth in bits
+@param nb_cw Number of codewords*/
+void phy_viterbi_lte_batch(int8_t **y,uint8_t **decoded_bytes,uint16_t n,int nb_cw);
+
+/*!\fn int viterbi_set_avx2(int enable)
+\brief Select the two codeword AVX2 path of phy_viterbi_lte_batch, called from phy_simd_dispatch_init()
+@param enable 1 to use AVX2 when the host supports it, 0 to decode one codeword at a time
+@returns 1 if the AVX2 path is in use, 0 otherwise
+*/
+int viterbi_set_avx2(int enable);
+
 /*!\fn void phy_generate_viterbi_tables(void)
 \brief This routine initializes metric tables for the optimized Viterbi decoder.
 */
@@ -512,6 +638,63 @@ uint8_t phy_threegpplte_turbo_decoder8(int16_t *y,
                                        time_stats_t *intl1_stats,
                                        time_stats_t *intl2_stats);
 
+/*!\fn void phy_threegpplte_turbo_decoder8_batch(int16_t **y,uint8_t **decoded_bytes,uint16_t *n,uint8_t nb,uint8_t max_iterations,uint8_t crc_type,uint8_t F,uint8_t *ret,time_stats_t *init_stats,time_stats_t *alpha_stats,time_stats_t *beta_stats,time_stats_t *gamma_stats,time_stats_t *ext_stats,time_stats_t *intl1_stats,time_stats_t *intl2_stats)
+\brief Decodes the nb code blocks of a transport block with the 8-bit decoder. When the host supports AVX2,
+consecutive blocks of the same size (at least 256 bits) are decoded two at a time, with the same results
+as phy_threegpplte_turbo_decoder8. Decoding stops at the first block which fails its CRC.
+@param y Pointers to the LLRs of each code block (d[r][96])
+@param decoded_bytes Pointers to the decoded output of each code block
+@param n number of coded bits of each code block
+@param nb number of code blocks
+@param max_iterations The maximum number of iterations to perform
+@param crc_type Length of 3GPPLTE crc (CRC24a,CRC24b,CRC16,CRC8)
+@param F Number of filler bits at start of the first code block
+@param ret Number of iterations used for each code block (1+max if incorrect crc, 2+max if not decoded since a previous block failed)
+*/
+void phy_threegpplte_turbo_decoder8_batch(int16_t **y,
+    uint8_t **decoded_bytes,
+    uint16_t *n,
+    uint8_t nb,
+    uint8_t max_iterations,
+    uint8_t crc_type,
+    uint8_t F,
+    uint8_t *ret,
+    time_stats_t *init_stats,
+    time_stats_t *alpha_stats,
+    time_stats_t *beta_stats,
+    time_stats_t *gamma_stats,
+    time_stats_t *ext_stats,
+    time_stats_t *intl1_stats,
+    time_stats_t *intl2_stats);
+
+/// Early termination of the turbo decoders
+typedef enum {
+  /// CRC check after each full iteration, from the second one (default)
+  TURBO_STOP_CRC=0,
+  /// CRC check after each component decoder (half iteration), from the first one
+  TURBO_STOP_CRC_HALF,
+  /// TURBO_STOP_CRC_HALF, and the block is declared in error as soon as its hard decisions stay unchanged over a full iteration
+  TURBO_STOP_CRC_HALF_HD
+} turbo_stop_t;
+
+/*!\fn void turbo_set_stop_policy(turbo_stop_t policy)
+\brief Select the early termination of phy_threegpplte_turbo_decoder8/16 and phy_threegpplte_turbo_decoder8_batch. The return value is the iteration in which the decoder stopped (max_iterations+1 if the CRC failed), a half iteration counting as the iteration it belongs to.
+@param policy early termination policy
+*/
+void turbo_set_stop_policy(turbo_stop_t policy);
+
+/*!\fn turbo_stop_t turbo_get_stop_policy(void)
+\brief Early termination policy in use
+*/
+turbo_stop_t turbo_get_stop_policy(void);
+
+/*!\fn int td8_set_avx2(int enable)
+\brief Select the two code block AVX2 path of phy_threegpplte_turbo_decoder8_batch
+@param enable 1 to use AVX2 when the host supports it, 0 to decode one block at a time
+@returns 1 if the AVX2 path is in use, 0 otherwise
+*/
+int td8_set_avx2(int enable);
+
 uint8_t phy_threegpplte_turbo_decoder_scalar(int16_t *y,
     uint8_t *decoded_bytes,
     uint16_t n,
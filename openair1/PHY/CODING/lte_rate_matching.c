@@ -36,6 +36,10 @@
 #include <stdlib.h>
 #endif
 #include "PHY/defs.h"
+#include "PHY/sse_intrin.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 //#define cmin(a,b) ((a)<(b) ? (a) : (b))
 
@@ -190,19 +194,70 @@ uint32_t sub_block_interleaving_cc(uint32_t D, uint8_t *d,uint8_t *w)
   return(RCC);
 }
 
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__SSSE3__)
+static inline void rm_transpose8_epi16(__m128i *x)
+{
+
+  __m128i a0,a1,a2,a3,a4,a5,a6,a7,b0,b1,b2,b3,b4,b5,b6,b7;
+
+  a0 = _mm_unpacklo_epi16(x[0],x[1]);
+  a1 = _mm_unpackhi_epi16(x[0],x[1]);
+  a2 = _mm_unpacklo_epi16(x[2],x[3]);
+  a3 = _mm_unpackhi_epi16(x[2],x[3]);
+  a4 = _mm_unpacklo_epi16(x[4],x[5]);
+  a5 = _mm_unpackhi_epi16(x[4],x[5]);
+  a6 = _mm_unpacklo_epi16(x[6],x[7]);
+  a7 = _mm_unpackhi_epi16(x[6],x[7]);
+  b0 = _mm_unpacklo_epi32(a0,a2);
+  b1 = _mm_unpackhi_epi32(a0,a2);
+  b2 = _mm_unpacklo_epi32(a1,a3);
+  b3 = _mm_unpackhi_epi32(a1,a3);
+  b4 = _mm_unpacklo_epi32(a4,a6);
+  b5 = _mm_unpackhi_epi32(a4,a6);
+  b6 = _mm_unpacklo_epi32(a5,a7);
+  b7 = _mm_unpackhi_epi32(a5,a7);
+  x[0] = _mm_unpacklo_epi64(b0,b4);
+  x[1] = _mm_unpackhi_epi64(b0,b4);
+  x[2] = _mm_unpacklo_epi64(b1,b5);
+  x[3] = _mm_unpackhi_epi64(b1,b5);
+  x[4] = _mm_unpacklo_epi64(b2,b6);
+  x[5] = _mm_unpackhi_epi64(b2,b6);
+  x[6] = _mm_unpacklo_epi64(b3,b7);
+  x[7] = _mm_unpackhi_epi64(b3,b7);
+}
+#endif
+#endif
+
 void sub_block_deinterleaving_turbo(uint32_t D,int16_t *d,int16_t *w)
 {
 
   uint32_t RTC = (D>>5), ND, ND3;
-  uint32_t row,col,Kpi,index;
-  uint32_t index3,k,k2;
-  int16_t *d1,*d2,*d3;
+  uint32_t row,Kpi,index;
+  int16_t *d1,*s[32],*p[32];
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__SSSE3__)
+  uint32_t blk,r,j;
+  __m128i S[4][8],P1[4][8],P2[4][8],lo,hi,q,carry,*o;
+  // even int16 lanes to the low half, odd lanes to the high half
+  const __m128i evenodd = _mm_setr_epi8(0,1,4,5,8,9,12,13,2,3,6,7,10,11,14,15);
+  // interleaving of the systematic, parity 1 and (delayed) parity 2 streams, 8 positions -> 3 vectors
+  const __m128i ms0 = _mm_setr_epi8(0,1,-1,-1,-1,-1,2,3,-1,-1,-1,-1,4,5,-1,-1);
+  const __m128i mp0 = _mm_setr_epi8(-1,-1,0,1,-1,-1,-1,-1,2,3,-1,-1,-1,-1,4,5);
+  const __m128i mq0 = _mm_setr_epi8(-1,-1,-1,-1,0,1,-1,-1,-1,-1,2,3,-1,-1,-1,-1);
+  const __m128i ms1 = _mm_setr_epi8(-1,-1,6,7,-1,-1,-1,-1,8,9,-1,-1,-1,-1,10,11);
+  const __m128i mp1 = _mm_setr_epi8(-1,-1,-1,-1,6,7,-1,-1,-1,-1,8,9,-1,-1,-1,-1);
+  const __m128i mq1 = _mm_setr_epi8(4,5,-1,-1,-1,-1,6,7,-1,-1,-1,-1,8,9,-1,-1);
+  const __m128i ms2 = _mm_setr_epi8(-1,-1,-1,-1,12,13,-1,-1,-1,-1,14,15,-1,-1,-1,-1);
+  const __m128i mp2 = _mm_setr_epi8(10,11,-1,-1,-1,-1,12,13,-1,-1,-1,-1,14,15,-1,-1);
+  const __m128i mq2 = _mm_setr_epi8(-1,-1,10,11,-1,-1,-1,-1,12,13,-1,-1,-1,-1,14,15);
+#endif
+#endif
 
   if ((D&0x1f) > 0)
     RTC++;
 
   Kpi = (RTC<<5);
-  //  Kpi3 = Kpi*3;
   ND = Kpi - D;
 #ifdef RM_DEBUG2
   printf("sub_block_interleaving_turbo : D = %d (%d)\n",D,D*3);
@@ -210,31 +265,65 @@ void sub_block_deinterleaving_turbo(uint32_t D,int16_t *d,int16_t *w)
 #endif
   ND3 = ND*3;
 
-  // copy d02 to dD2 (for mod Kpi operation from clause (4), p.16 of 36.212
-  k=0;
-  k2=0;
+  // column bitrev[col] of the interleaver holds the bits index=col+32*row, bitrev being an involution
+  // the output is written row by row, i.e. sequentially, instead of column by column (stride 96)
+  for (index=0; index<32; index++) {
+    s[index] = w+(bitrev[index]*RTC);
+    p[index] = w+Kpi+(2*bitrev[index]*RTC);
+  }
+
+  // the second parity stream is delayed by one position (for mod Kpi operation from clause (4), p.16 of 36.212)
   d1 = d-ND3;
-  d2 = d1+1;
-  d3 = d1+5;
+  row = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__SSSE3__)
+  // 8 rows at a time : load 8 rows of the 32 columns, transpose 8x8 blocks and interleave the 3 streams
+  carry = _mm_insert_epi16(_mm_setzero_si128(),d1[2],7);
+
+  for (; row+8<=RTC; row+=8) {
+    for (blk=0; blk<4; blk++) {
+      for (j=0; j<8; j++) {
+        index = (blk<<3)+j;
+        S[blk][j]  = _mm_loadu_si128((__m128i*)(s[index]+row));
+        lo         = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)(p[index]+(2*row))),evenodd);
+        hi         = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)(p[index]+(2*row)+8)),evenodd);
+        P1[blk][j] = _mm_unpacklo_epi64(lo,hi);
+        P2[blk][j] = _mm_unpackhi_epi64(lo,hi);
+      }
 
-  for (col=0; col<32; col++) {
-#ifdef RM_DEBUG2
-    printf("Col %d\n",col);
-#endif
-    index = bitrev[col];
-    index3 = bitrev_x3[col];//3*index;
+      rm_transpose8_epi16(S[blk]);
+      rm_transpose8_epi16(P1[blk]);
+      rm_transpose8_epi16(P2[blk]);
+    }
 
-    for (row=0; row<RTC; row++) {
+    for (r=0; r<8; r++) {
+      o = (__m128i*)(d1+(96*(row+r)));
 
-      d1[index3]   = w[k];
-      d2[index3]   = w[Kpi+k2];
-      d3[index3]   = w[Kpi+1+k2];
-      index3+=96;
-      index+=32;
-      k++;
-      k2++;
-      k2++;
+      for (blk=0; blk<4; blk++) {
+        q     = _mm_alignr_epi8(P2[blk][r],carry,14);
+        carry = P2[blk][r];
+        _mm_storeu_si128(o+0,_mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(S[blk][r],ms0),_mm_shuffle_epi8(P1[blk][r],mp0)),_mm_shuffle_epi8(q,mq0)));
+        _mm_storeu_si128(o+1,_mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(S[blk][r],ms1),_mm_shuffle_epi8(P1[blk][r],mp1)),_mm_shuffle_epi8(q,mq1)));
+        _mm_storeu_si128(o+2,_mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(S[blk][r],ms2),_mm_shuffle_epi8(P1[blk][r],mp2)),_mm_shuffle_epi8(q,mq2)));
+        o+=3;
+      }
+    }
+  }
+
+  d1[(96*row)+2] = _mm_extract_epi16(carry,7);
+  d1 += (96*row);
+#endif
+#endif
+
+  for (; row<RTC; row++) {
+    for (index=0; index<32; index++) {
+      d1[3*index]   = s[index][row];
+      d1[3*index+1] = p[index][2*row];
+      d1[3*index+5] = p[index][2*row+1];
     }
+
+    d1+=96;
   }
 
   //  if (ND>0)
@@ -685,6 +774,51 @@ uint32_t lte_rate_matching_cc(uint32_t RCC,
 }
 
 
+// E, Ncb and the starting position k0 of the circular buffer of code block r (36-212 5.1.4.1.2)
+static int lte_rate_matching_turbo_rx_param(uint32_t RTC,
+                                            uint32_t G,
+                                            uint8_t C,
+                                            uint32_t Nsoft,
+                                            uint8_t Mdlharq,
+                                            uint8_t Kmimo,
+                                            uint8_t rvidx,
+                                            uint8_t Qm,
+                                            uint8_t Nl,
+                                            uint8_t r,
+                                            uint32_t *E,
+                                            uint32_t *Ncb,
+                                            uint32_t *ind)
+{
+
+  uint32_t Nir,Gp,GpmodC,Ncbmod;
+
+  if (Kmimo==0 || Mdlharq==0 || C==0 || Qm==0 || Nl==0) {
+    printf("lte_rate_matching.c: invalid parameters (Kmimo %d, Mdlharq %d, C %d, Qm %d, Nl %d\n",
+        Kmimo,Mdlharq,C,Qm,Nl);
+    return(-1);
+  }
+
+  Nir = Nsoft/Kmimo/cmin(8,Mdlharq);
+  *Ncb = cmin(Nir/C,3*(RTC<<5));
+
+
+  Gp = G/Nl/Qm;
+  GpmodC = Gp%C;
+
+
+
+  if (r < (C-(GpmodC)))
+    *E = Nl*Qm * (Gp/C);
+  else
+    *E = Nl*Qm * ((GpmodC==0?0:1) + (Gp/C));
+
+  Ncbmod = *Ncb%(RTC<<3);
+
+  *ind = RTC * (2+(rvidx*(((Ncbmod==0)?0:1) + (*Ncb/(RTC<<3)))*2));
+
+  return(0);
+}
+
 int lte_rate_matching_turbo_rx(uint32_t RTC,
                                uint32_t G,
                                int16_t *w,
@@ -703,36 +837,15 @@ int lte_rate_matching_turbo_rx(uint32_t RTC,
 {
 
 
-  uint32_t Nir,Ncb,Gp,GpmodC,E,Ncbmod,ind,k;
+  uint32_t Ncb,E,ind,k;
   int16_t *soft_input2;
   //   int32_t w_tmp;
 #ifdef RM_DEBUG
   int nulled=0;
 #endif
 
-  if (Kmimo==0 || Mdlharq==0 || C==0 || Qm==0 || Nl==0) {
-    printf("lte_rate_matching.c: invalid parameters (Kmimo %d, Mdlharq %d, C %d, Qm %d, Nl %d\n",
-        Kmimo,Mdlharq,C,Qm,Nl);
+  if (lte_rate_matching_turbo_rx_param(RTC,G,C,Nsoft,Mdlharq,Kmimo,rvidx,Qm,Nl,r,&E,&Ncb,&ind) == -1)
     return(-1);
-  }
-
-  Nir = Nsoft/Kmimo/cmin(8,Mdlharq);
-  Ncb = cmin(Nir/C,3*(RTC<<5));
-
-
-  Gp = G/Nl/Qm;
-  GpmodC = Gp%C;
-
-
-
-  if (r < (C-(GpmodC)))
-    E = Nl*Qm * (Gp/C);
-  else
-    E = Nl*Qm * ((GpmodC==0?0:1) + (Gp/C));
-
-  Ncbmod = Ncb%(RTC<<3);
-
-  ind = RTC * (2+(rvidx*(((Ncbmod==0)?0:1) + (Ncb/(RTC<<3)))*2));
 
 #ifdef RM_DEBUG
   printf("lte_rate_matching_turbo_rx: Clear %d, E %d, Ncb %d, Kw %d, rvidx %d, G %d, Qm %d, Nl%d, r %d\n",clear,E,Ncb,3*(RTC<<5),rvidx, G, Qm,Nl,r);
@@ -830,6 +943,270 @@ int lte_rate_matching_turbo_rx(uint32_t RTC,
 
 }
 
+// NULL-free runs of the circular buffer of the code block sizes without filler bits, indexed like f1f2mat
+static rm_turbo_map_t rm_turbo_maps[188];
+static int rm_turbo_maps_ready = 0;
+
+static void rm_turbo_null(uint16_t *nulls,int *nb_null,uint32_t pos)
+{
+
+  int i;
+
+  // the positions come almost sorted (only the rows of the short columns of K=40 overlap)
+  for (i=*nb_null; (i>0) && (nulls[i-1]>pos); i--)
+    nulls[i] = nulls[i-1];
+
+  if ((i>0) && (nulls[i-1]==pos)) {
+    for (; i<*nb_null; i++)
+      nulls[i] = nulls[i+1];
+
+    return;
+  }
+
+  nulls[i] = pos;
+  (*nb_null)++;
+}
+
+// same NULL positions as generate_dummy_w()
+static void rm_turbo_map_build(uint32_t D,uint8_t F,rm_turbo_map_t *map)
+{
+
+  uint32_t RTC = (D>>5), ND, Kpi, col, index, k, k2, pos;
+  uint16_t nulls[RM_TURBO_MAX_RUNS];
+  int nb_null=0, i;
+
+  if ((D&0x1f) > 0)
+    RTC++;
+
+  Kpi = (RTC<<5);
+  ND = Kpi - D;
+
+  for (col=0; col<32; col++) {
+    index = bitrev[col];
+    k  = col*RTC;
+    k2 = k<<1;
+
+    if (index<(ND+F)) {
+      rm_turbo_null(nulls,&nb_null,k);
+      rm_turbo_null(nulls,&nb_null,Kpi+k2);
+    }
+
+    if ((index+32)<(ND+F)) {
+      rm_turbo_null(nulls,&nb_null,k+1);
+      rm_turbo_null(nulls,&nb_null,Kpi+2+k2);
+    }
+
+    if ((index+64)<(ND+F)) {
+      rm_turbo_null(nulls,&nb_null,k+2);
+      rm_turbo_null(nulls,&nb_null,Kpi+4+k2);
+    }
+
+    if ((index+1)<ND)
+      rm_turbo_null(nulls,&nb_null,Kpi+1+k2);
+  }
+
+  if (ND>0)
+    rm_turbo_null(nulls,&nb_null,(3*Kpi)-1);
+
+  map->RTC = RTC;
+  map->nb_runs = 0;
+  pos = 0;
+
+  for (i=0; i<=nb_null; i++) {
+    k = (i<nb_null) ? nulls[i] : 3*Kpi;
+
+    if (k>pos) {
+      map->start[map->nb_runs]  = pos;
+      map->length[map->nb_runs] = k-pos;
+      map->nb_runs++;
+    }
+
+    pos = k+1;
+  }
+}
+
+void init_rm_turbo_maps(void)
+{
+
+  int i;
+  uint32_t K;
+
+  for (i=0; i<188; i++) {
+    if (i<60)
+      K = 40+(i<<3);
+    else if (i<92)
+      K = 512+((i-59)<<4);
+    else if (i<124)
+      K = 1024+((i-91)<<5);
+    else
+      K = 2048+((i-123)<<6);
+
+    rm_turbo_map_build(K+4,0,&rm_turbo_maps[i]);
+  }
+
+  rm_turbo_maps_ready = 1;
+}
+
+const rm_turbo_map_t *get_rm_turbo_map(uint32_t D,uint8_t F,rm_turbo_map_t *map)
+{
+
+  uint32_t K = D-4, iind;
+
+  if ((F==0) && (rm_turbo_maps_ready==1) && (K>=40) && (K<=6144)) {
+    if (K<=512)
+      iind = (K-40)>>3;
+    else if (K<=1024)
+      iind = 59 + ((K-512)>>4);
+    else if (K<=2048)
+      iind = 91 + ((K-1024)>>5);
+    else
+      iind = 123 + ((K-2048)>>6);
+
+    return(&rm_turbo_maps[iind]);
+  }
+
+  rm_turbo_map_build(D,F,map);
+  return(map);
+}
+
+// soft combining of n LLRs, w[i] = w[i]+soft[i] saturated to 16 bits
+static inline void rm_combine_scalar(int16_t *w,int16_t *soft,uint32_t n)
+{
+
+  int32_t tmp;
+  uint32_t i;
+
+  for (i=0; i<n; i++) {
+    tmp = (int32_t)w[i] + soft[i];
+    w[i] = (tmp > 32767) ? 32767 : ((tmp < -32768) ? -32768 : tmp);
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+static int rm_avx2 = -1;
+
+int rm_set_avx2(int enable)
+{
+
+  rm_avx2 = (enable && __builtin_cpu_supports("avx2")) ? 1 : 0;
+
+  return(rm_avx2);
+}
+
+static void rm_combine_avx2(int16_t *w,int16_t *soft,uint32_t n) __attribute__((target("avx2")));
+static void rm_combine_avx2(int16_t *w,int16_t *soft,uint32_t n)
+{
+
+  uint32_t i;
+
+  for (i=0; i+16<=n; i+=16)
+    _mm256_storeu_si256((__m256i *)&w[i],_mm256_adds_epi16(_mm256_loadu_si256((__m256i *)&w[i]),
+                                                           _mm256_loadu_si256((__m256i *)&soft[i])));
+
+  rm_combine_scalar(w+i,soft+i,n-i);
+}
+
+static void rm_combine(int16_t *w,int16_t *soft,uint32_t n)
+{
+
+  uint32_t i;
+
+  if (rm_avx2 < 0)
+    rm_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+
+  if (rm_avx2 == 1) {
+    rm_combine_avx2(w,soft,n);
+    return;
+  }
+
+  for (i=0; i+8<=n; i+=8)
+    _mm_storeu_si128((__m128i *)&w[i],_mm_adds_epi16(_mm_loadu_si128((__m128i *)&w[i]),
+                                                     _mm_loadu_si128((__m128i *)&soft[i])));
+
+  rm_combine_scalar(w+i,soft+i,n-i);
+}
+
+#elif defined(__arm__)
+
+int rm_set_avx2(int enable)
+{
+
+  return(0);
+}
+
+static void rm_combine(int16_t *w,int16_t *soft,uint32_t n)
+{
+
+  uint32_t i;
+
+  for (i=0; i+8<=n; i+=8)
+    vst1q_s16(&w[i],vqaddq_s16(vld1q_s16(&w[i]),vld1q_s16(&soft[i])));
+
+  rm_combine_scalar(w+i,soft+i,n-i);
+}
+
+#endif
+
+int lte_rate_matching_turbo_rx_map(const rm_turbo_map_t *map,
+                                   uint32_t G,
+                                   int16_t *w,
+                                   int16_t *soft_input,
+                                   uint8_t C,
+                                   uint32_t Nsoft,
+                                   uint8_t Mdlharq,
+                                   uint8_t Kmimo,
+                                   uint8_t rvidx,
+                                   uint8_t clear,
+                                   uint8_t Qm,
+                                   uint8_t Nl,
+                                   uint8_t r,
+                                   uint32_t *E_out)
+{
+
+  uint32_t Ncb,E,ind,k,pos,end,n;
+  int j;
+
+  if (lte_rate_matching_turbo_rx_param(map->RTC,G,C,Nsoft,Mdlharq,Kmimo,rvidx,Qm,Nl,r,&E,&Ncb,&ind) == -1)
+    return(-1);
+
+  if ((map->nb_runs == 0) || (map->start[0] >= Ncb)) {
+    printf("lte_rate_matching.c: no soft bit position in the circular buffer (Ncb %d)\n",Ncb);
+    return(-1);
+  }
+
+#ifdef RM_DEBUG
+  printf("lte_rate_matching_turbo_rx_map: Clear %d, E %d, Ncb %d, Kw %d, rvidx %d, G %d, Qm %d, Nl%d, r %d, runs %d\n",clear,E,Ncb,3*(map->RTC<<5),rvidx, G, Qm,Nl,r,map->nb_runs);
+#endif
+
+  if (clear==1)
+    memset(w,0,Ncb*sizeof(int16_t));
+
+  // run holding k0 (or the first one after it)
+  for (j=0; (j<map->nb_runs) && (map->start[j]+map->length[j] <= ind); j++);
+
+  pos = (j<map->nb_runs) ? cmax(map->start[j],ind) : 0;
+
+  for (k=0; k<E; k+=n) {
+    // wrap around at the end of the circular buffer
+    if ((j==map->nb_runs) || (pos >= Ncb)) {
+      j = 0;
+      pos = map->start[0];
+    }
+
+    end = cmin((uint32_t)map->start[j]+map->length[j],Ncb);
+    n = cmin(end-pos,E-k);
+    rm_combine(&w[pos],&soft_input[k],n);
+
+    j++;
+
+    if (j<map->nb_runs)
+      pos = map->start[j];
+  }
+
+  *E_out = E;
+  return(0);
+}
 
 void lte_rate_matching_cc_rx(uint32_t RCC,
                              uint16_t E,
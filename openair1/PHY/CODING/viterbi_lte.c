@@ -51,6 +51,9 @@
 
 
 #include "PHY/sse_intrin.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 extern uint8_t ccodelte_table[128],ccodelte_table_rev[128];
 
@@ -59,6 +62,10 @@ extern uint8_t ccodelte_table[128],ccodelte_table_rev[128];
 
 static int8_t m0_table[64*16*16*16] __attribute__ ((aligned(16)));
 static int8_t m1_table[64*16*16*16] __attribute__ ((aligned(16)));
+// the 8 branch metrics of each input triplet, and the branch of each state (m0/m1_table = w_table shuffled by m0/m1_index)
+static int8_t w_table[8*16*16*16] __attribute__ ((aligned(16)));
+static uint8_t m0_index[64] __attribute__ ((aligned(16)));
+static uint8_t m1_index[64] __attribute__ ((aligned(16)));
 
 
 // Set up Viterbi tables for SSE2 implementation
@@ -83,6 +90,8 @@ void phy_generate_viterbi_tables_lte()
         w[7] = 24 + in0 + in1 + in2;           //  1, 1, 1
 
         //    printf("w: %d %d %d %d\n",w[0],w[1],w[2],w[3]);
+        memcpy(&w_table[(in0+8 + (16*(in1+8)) + (256*(in2+8)))*8],w,8);
+
         for (state=0; state<64 ; state++) {
 
           // input 0
@@ -98,6 +107,9 @@ void phy_generate_viterbi_tables_lte()
           index1 = (1+ (state<<1));
           m1_table[(in0+8 + (16*(in1+8)) + (256*(in2+8)))*64 +state] = w[ccodelte_table_rev[index1]];
 
+          m0_index[state] = ccodelte_table_rev[index0];
+          m1_index[state] = ccodelte_table_rev[index1];
+
         }
       }
     }
@@ -149,6 +161,10 @@ void phy_viterbi_lte_sse2(int8_t *y,uint8_t *decoded_bytes,uint16_t n)
     TBodd33_63;
   
   __m128i min_state,min_state2;
+#if defined(__SSSE3__)
+  __m128i w,m0[4],m1[4];
+  uint8_t i;
+#endif
 
 #elif defined(__arm__)
   uint8x16x2_t TB[2*8192];  // 2 int8x16_t per input bit, 8 bits / byte, 8192 is largest packet size in bits
@@ -197,8 +213,21 @@ void phy_viterbi_lte_sse2(int8_t *y,uint8_t *decoded_bytes,uint16_t n)
       table_offset = (in[0]+8 + ((in[1]+8)<<4) + ((in[2]+8)<<8))<<6;
 
 #if defined(__x86_64__) || defined(__i386__)
+#if defined(__SSSE3__)
+      // shuffle the 8 branch metrics of the input triplet rather than reading m0_table/m1_table (512 kbytes)
+      w = _mm_loadl_epi64((__m128i *)&w_table[table_offset>>3]);
+
+      for (i=0; i<4; i++) {
+        m0[i] = _mm_shuffle_epi8(w,((__m128i *)m0_index)[i]);
+        m1[i] = _mm_shuffle_epi8(w,((__m128i *)m1_index)[i]);
+      }
+
+      m0_ptr = m0;
+      m1_ptr = m1;
+#else
       m0_ptr = (__m128i *)&m0_table[table_offset];
       m1_ptr = (__m128i *)&m1_table[table_offset];
+#endif
 
       // even states
       even0_30a  = _mm_adds_epu8(metrics0_15,m0_ptr[0]);
@@ -415,6 +444,199 @@ void phy_viterbi_lte_sse2(int8_t *y,uint8_t *decoded_bytes,uint16_t n)
 #endif
 }
 
+#if defined(__x86_64__) || defined(__i386__)
+
+static int viterbi_avx2 = -1;
+
+int viterbi_set_avx2(int enable)
+{
+
+  viterbi_avx2 = (enable && __builtin_cpu_supports("avx2")) ? 1 : 0;
+
+  return(viterbi_avx2);
+}
+
+// Same recursion as phy_viterbi_lte_sse2 with the codeword 2*k in the low 128-bit lane and 2*k+1 in the high lane of chain k.
+// All the instructions used operate within 128-bit lanes, so the metrics (and the decisions) of each lane are those of the SSE2 decoder.
+// The nch chains are independent and interleaved to hide the latency of the add-compare-select and of the rescaling.
+static inline void phy_viterbi_lte_avx2(int8_t **y,uint8_t **decoded_bytes,uint16_t n,const int nch) __attribute__((always_inline,target("avx2")));
+static inline void phy_viterbi_lte_avx2(int8_t **y,uint8_t **decoded_bytes,uint16_t n,const int nch)
+{
+
+  __m256i TB[2][4*VITERBI_LTE_BATCH_MAX_BITS];
+  __m256i *TB_ptr[2];
+  __m256i metrics[2][4],even0_30a,even0_30b,even32_62a,even32_62b,odd1_31a,odd1_31b,odd33_63a,odd33_63b,TBeven0_30,TBeven32_62,TBodd1_31,
+          TBodd33_63,m0[4],m1[4],m0_idx[4],m1_idx[4],w;
+  __m256i min_state,min_state2;
+  int8_t *in[4];
+  uint8_t prev_state0,maxm,s,*TB_ptr2;
+  uint32_t table_offset0,table_offset1;
+  uint8_t iter,i;
+  int16_t position;
+  int k,cw;
+
+  for (k=0; k<nch; k++)
+    for (i=0; i<4; i++)
+      metrics[k][i] = _mm256_setzero_si256();
+
+  for (i=0; i<4; i++) {
+    m0_idx[i] = _mm256_broadcastsi128_si256(((__m128i *)m0_index)[i]);
+    m1_idx[i] = _mm256_broadcastsi128_si256(((__m128i *)m1_index)[i]);
+  }
+
+  for (iter=0; iter<2; iter++) {
+    for (cw=0; cw<2*nch; cw++)
+      in[cw] = y[cw];
+
+    for (k=0; k<nch; k++)
+      TB_ptr[k] = &TB[k][0];
+
+    for (position=0; position<n; position++) {
+      for (k=0; k<nch; k++) {
+
+        // branch metrics of the 64 states of each codeword, shuffled from the 8 metrics of the input triplet
+        // instead of being read from m0_table/m1_table (512 kbytes)
+        table_offset0 = (in[2*k][0]+8 + ((in[2*k][1]+8)<<4) + ((in[2*k][2]+8)<<8))<<3;
+        table_offset1 = (in[2*k+1][0]+8 + ((in[2*k+1][1]+8)<<4) + ((in[2*k+1][2]+8)<<8))<<3;
+        w = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadl_epi64((__m128i *)&w_table[table_offset0])),
+                                    _mm_loadl_epi64((__m128i *)&w_table[table_offset1]),1);
+
+        for (i=0; i<4; i++) {
+          m0[i] = _mm256_shuffle_epi8(w,m0_idx[i]);
+          m1[i] = _mm256_shuffle_epi8(w,m1_idx[i]);
+        }
+
+        // even states
+        even0_30a  = _mm256_adds_epu8(metrics[k][0],m0[0]);
+        even32_62a = _mm256_adds_epu8(metrics[k][1],m0[1]);
+        even0_30b  = _mm256_adds_epu8(metrics[k][2],m0[2]);
+        even32_62b = _mm256_adds_epu8(metrics[k][3],m0[3]);
+
+        // odd states
+        odd1_31a   = _mm256_adds_epu8(metrics[k][0],m1[0]);
+        odd33_63a  = _mm256_adds_epu8(metrics[k][1],m1[1]);
+        odd1_31b   = _mm256_adds_epu8(metrics[k][2],m1[2]);
+        odd33_63b  = _mm256_adds_epu8(metrics[k][3],m1[3]);
+
+        // select maxima
+        even0_30a  = _mm256_max_epu8(even0_30a,even0_30b);
+        even32_62a = _mm256_max_epu8(even32_62a,even32_62b);
+        odd1_31a   = _mm256_max_epu8(odd1_31a,odd1_31b);
+        odd33_63a  = _mm256_max_epu8(odd33_63a,odd33_63b);
+
+        // Traceback information
+        TBeven0_30  = _mm256_cmpeq_epi8(even0_30a,even0_30b);
+        TBeven32_62 = _mm256_cmpeq_epi8(even32_62a,even32_62b);
+        TBodd1_31   = _mm256_cmpeq_epi8(odd1_31a,odd1_31b);
+        TBodd33_63  = _mm256_cmpeq_epi8(odd33_63a,odd33_63b);
+
+        metrics[k][0] = _mm256_unpacklo_epi8(even0_30a ,odd1_31a);
+        metrics[k][1] = _mm256_unpackhi_epi8(even0_30a ,odd1_31a);
+        metrics[k][2] = _mm256_unpacklo_epi8(even32_62a,odd33_63a);
+        metrics[k][3] = _mm256_unpackhi_epi8(even32_62a,odd33_63a);
+
+        TB_ptr[k][0] = _mm256_unpacklo_epi8(TBeven0_30,TBodd1_31);
+        TB_ptr[k][1] = _mm256_unpackhi_epi8(TBeven0_30,TBodd1_31);
+        TB_ptr[k][2] = _mm256_unpacklo_epi8(TBeven32_62,TBodd33_63);
+        TB_ptr[k][3] = _mm256_unpackhi_epi8(TBeven32_62,TBodd33_63);
+
+        in[2*k]+=3;
+        in[2*k+1]+=3;
+        TB_ptr[k] += 4;
+
+        // rescale by subtracting the minimum of each lane
+        min_state =_mm256_min_epu8(metrics[k][0],metrics[k][1]);
+        min_state =_mm256_min_epu8(min_state,metrics[k][2]);
+        min_state =_mm256_min_epu8(min_state,metrics[k][3]);
+
+        for (i=0; i<4; i++) {
+          min_state2 = _mm256_unpackhi_epi8(min_state,min_state);
+          min_state  = _mm256_unpacklo_epi8(min_state,min_state);
+          min_state  = _mm256_min_epu8(min_state,min_state2);
+        }
+
+        for (i=0; i<4; i++)
+          metrics[k][i] = _mm256_subs_epu8(metrics[k][i],min_state);
+      }
+    }
+  } // iteration
+
+  // Traceback, byte s&15 of vector s>>4 for the state s, +16 for the codeword in the high lane
+  for (cw=0; cw<2*nch; cw++) {
+    k = cw>>1;
+    prev_state0 = 0;
+    maxm = 0;
+
+    for (s=0; s<64; s++)
+      if (((uint8_t *)&metrics[k][s>>4])[(s&0xf)+((cw&1)<<4)] > maxm) {
+        maxm = ((uint8_t *)&metrics[k][s>>4])[(s&0xf)+((cw&1)<<4)];
+        prev_state0 = s;
+      }
+
+    TB_ptr2 = (uint8_t *)&TB[k][(n-1)*4] + ((cw&1)<<4);
+
+    for (position = n-1 ; position>-1; position--) {
+
+      decoded_bytes[cw][(position)>>3] += (prev_state0 & 0x1)<<(7-(position & 0x7));
+
+      if (TB_ptr2[((prev_state0>>4)<<5) + (prev_state0&0xf)] == 0)
+        prev_state0 = (prev_state0 >> 1);
+      else
+        prev_state0 = 32 + (prev_state0>>1);
+
+      TB_ptr2-=128;
+    }
+  }
+}
+
+static void phy_viterbi_lte_avx2_x2(int8_t **y,uint8_t **decoded_bytes,uint16_t n) __attribute__((target("avx2")));
+static void phy_viterbi_lte_avx2_x2(int8_t **y,uint8_t **decoded_bytes,uint16_t n)
+{
+  phy_viterbi_lte_avx2(y,decoded_bytes,n,1);
+}
+
+static void phy_viterbi_lte_avx2_x4(int8_t **y,uint8_t **decoded_bytes,uint16_t n) __attribute__((target("avx2")));
+static void phy_viterbi_lte_avx2_x4(int8_t **y,uint8_t **decoded_bytes,uint16_t n)
+{
+  phy_viterbi_lte_avx2(y,decoded_bytes,n,2);
+}
+
+#elif defined(__arm__)
+
+int viterbi_set_avx2(int enable)
+{
+
+  return(0);
+}
+
+#endif
+
+void phy_viterbi_lte_batch(int8_t **y,uint8_t **decoded_bytes,uint16_t n,int nb_cw)
+{
+
+  int cw=0;
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  if (viterbi_avx2 < 0)
+    viterbi_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+
+  if ((viterbi_avx2 == 1) && (n <= VITERBI_LTE_BATCH_MAX_BITS)) {
+    for (; cw+4<=nb_cw; cw+=4)
+      phy_viterbi_lte_avx2_x4(&y[cw],&decoded_bytes[cw],n);
+
+    if (cw+2<=nb_cw) {
+      phy_viterbi_lte_avx2_x2(&y[cw],&decoded_bytes[cw],n);
+      cw+=2;
+    }
+  }
+
+#endif
+
+  for (; cw<nb_cw; cw++)
+    phy_viterbi_lte_sse2(y[cw],decoded_bytes[cw],n);
+}
+
 #ifdef TEST_DEBUG
 int test_viterbi(uint8_t dabflag)
 {
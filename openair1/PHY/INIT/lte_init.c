@@ -880,6 +880,10 @@ void  phy_config_cba_rnti (module_id_t Mod_id,int CC_id,eNB_flag_t eNB_flag, uin
 void phy_init_lte_top(LTE_DL_FRAME_PARMS *lte_frame_parms)
 {
 
+  phy_simd_dispatch_init();
+
+  lte_gold_init();
+
   crcTableInit();
 
   ccodedot11_init();
@@ -895,6 +899,9 @@ void phy_init_lte_top(LTE_DL_FRAME_PARMS *lte_frame_parms)
 
   init_td8();
   init_td16();
+  init_rm_turbo_maps();
+
+  init_dft_plans();
 
 
   lte_sync_time_init(lte_frame_parms);
@@ -1213,6 +1220,7 @@ int phy_init_lte_ue(PHY_VARS_UE *phy_vars_ue,
   // set channel estimation to do linear interpolation in time
   phy_vars_ue->high_speed_flag = 1;
   phy_vars_ue->ch_est_alpha    = 24576;
+  phy_vars_ue->ch_est_wiener   = 0;
 
   init_prach_tables(839);
 
@@ -1247,6 +1255,7 @@ int phy_init_lte_eNB(PHY_VARS_eNB *phy_vars_eNB,
   lte_gold(frame_parms,phy_vars_eNB->lte_gold_table,frame_parms->Nid_cell);
   generate_pcfich_reg_mapping(frame_parms);
   generate_phich_reg_mapping(frame_parms);
+  init_dlsch_re_list();
 
   for (UE_id=0; UE_id<NUMBER_OF_UE_MAX; UE_id++) {
     phy_vars_eNB->first_run_timing_advance[UE_id] =
@@ -65,7 +65,7 @@ void lte_sync_time_free(void);
 
 /*!
 \brief This function performs the coarse timing synchronization.
-The algorithm uses a time domain correlation with a downsampled version of the received signal.
+The algorithm correlates the received signal with the 3 PSS every 4 samples, with the correlator selected by lte_sync_time_set_method.
 \param rxdata Received time domain data for all rx antennas
 \param frame_parms LTE DL frame parameter structure
 \param eNB_id return value with the eNb_id
@@ -75,6 +75,23 @@ int lte_sync_time(int **rxdata,
                   LTE_DL_FRAME_PARMS *frame_parms,
                   int *eNB_id);
 
+/*!\brief Correlator used by lte_sync_time*/
+typedef enum {
+  /// dot product against the PSS every 4 samples
+  SYNC_TIME_TD=0,
+  /// overlap-save FFT correlation giving the same sync_corr_ue0/1/2 metrics (default)
+  SYNC_TIME_FD,
+  /// FFT correlation of the signal decimated to 1.92 Msps, followed by a time domain search around the best candidate only
+  SYNC_TIME_FD_COARSE
+} sync_time_method_t;
+
+/*!
+\brief This function selects the correlator of lte_sync_time. The bandwidths without a suitable DFT size fall back to SYNC_TIME_TD (and SYNC_TIME_FD_COARSE to SYNC_TIME_FD for 1.4 MHz).
+With SYNC_TIME_FD_COARSE only the positions around the peak are written to sync_corr_ue0/1/2.
+\param method correlator
+ */
+void lte_sync_time_set_method(sync_time_method_t method);
+
 /*!
 \brief This function performs the coarse frequency and PSS synchronization.
 The algorithm uses a frequency-domain correlation.  It scans over 20 MHz/10ms signal chunks using each of the 3 PSS finding the most likely (strongest) carriers and their frequency offset (+-2.5 kHz).
@@ -223,6 +240,24 @@ int lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
                               uint8_t Ns,
                               uint8_t cooperation_flag);
 
+/*! \brief Same as lte_ul_channel_estimation() without cooperation for all the UEs of UE_list in one call.
+@param phy_vars_eNB Pointer to eNB variables
+@param eNB_id Sector of each UE, indexed by UE id
+@param UE_list Indices of the UEs to estimate
+@param nb_UE Number of entries of UE_list
+@param sched_subframe Index of the scheduled subframe
+@param l Symbol within the slot
+@param Ns Slot within the subframe
+@returns 0 on success, -1 if the allocation of a UE has no DMRS sequence
+*/
+int32_t lte_ul_channel_estimation_multi(PHY_VARS_eNB *phy_vars_eNB,
+                                        uint8_t *eNB_id,
+                                        uint8_t *UE_list,
+                                        uint8_t nb_UE,
+                                        uint8_t sched_subframe,
+                                        unsigned char l,
+                                        unsigned char Ns);
+
 int16_t lte_ul_freq_offset_estimation(LTE_DL_FRAME_PARMS *frame_parms,
                                       int32_t *ul_ch_estimates,
                                       uint16_t nb_rb);
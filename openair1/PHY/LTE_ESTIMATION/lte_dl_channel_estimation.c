@@ -34,6 +34,182 @@
 #include "filt96_32.h"
 //#define DEBUG_CH
 
+
+// Interpolation filters of the pilots of one OFDM symbol, selected by the pilot offset
+// k = (nu+nushift)%6, i.e. per cell and antenna port
+typedef struct {
+  int16_t *f;     // first pilot of RB
+  int16_t *f2;    // second pilot of RB
+  int16_t *fl;    // first pilot of leftmost RB
+  int16_t *f2l2;  // second pilot of leftmost RB
+  int16_t *fr;    // first pilot of rightmost RB
+  int16_t *f2r2;  // second pilot of rightmost RB
+  int16_t *f_dc;  // last pilot before DC (25 RBs)
+  int16_t *f2_dc; // first pilot after DC (25 RBs)
+} dl_ch_filt_set_t;
+
+static dl_ch_filt_set_t dl_ch_filt_set[6] = {
+  {filt24_0,filt24_2,filt24_0,filt24_2,filt24_0r2,filt24_2r,filt24_0_dcr,filt24_2_dcl},
+  {filt24_1,filt24_3,filt24_1l,filt24_3l2,filt24_1r2,filt24_3r,filt24_1_dcr,filt24_3_dcl},
+  {filt24_2,filt24_4,filt24_2l,filt24_4l2,filt24_2r2,filt24_4r,filt24_2_dcr,filt24_4_dcl},
+  {filt24_3,filt24_5,filt24_3l,filt24_5l2,filt24_3r2,filt24_5r,filt24_3_dcr,filt24_5_dcl},
+  {filt24_4,filt24_6,filt24_4l,filt24_6l2,filt24_4r2,filt24_6r,filt24_4_dcr,filt24_6_dcl},
+  {filt24_5,filt24_7,filt24_5l,filt24_7l2,filt24_5r2,filt24_7r,filt24_5_dcr,filt24_7_dcl}
+};
+
+// filter of each of the 2*N_RB_DL pilots of a symbol, built for dl_ch_filt_bank_N_RB_DL
+static int16_t *dl_ch_filt_bank[6][200];
+static unsigned char dl_ch_filt_bank_N_RB_DL = 0;
+
+static int lte_dl_ch_filt_bank_init(unsigned char N_RB_DL)
+{
+
+  unsigned char k;
+  unsigned short i,nb_pilots = N_RB_DL<<1;
+  dl_ch_filt_set_t *s;
+
+  if ((N_RB_DL!=6) && (N_RB_DL!=15) && (N_RB_DL!=25) && (N_RB_DL!=50) && (N_RB_DL!=100))
+    return(-1);
+
+  for (k=0; k<6; k++) {
+    s = &dl_ch_filt_set[k];
+
+    for (i=0; i<nb_pilots; i++)
+      dl_ch_filt_bank[k][i] = (i&1) ? s->f2 : s->f;
+
+    // 15 RBs use the regular filters on the edges
+    if (N_RB_DL != 15) {
+      dl_ch_filt_bank[k][0]           = s->fl;
+      dl_ch_filt_bank[k][1]           = s->f2l2;
+      dl_ch_filt_bank[k][nb_pilots-2] = s->fr;
+      dl_ch_filt_bank[k][nb_pilots-1] = s->f2r2;
+    }
+
+    if (N_RB_DL == 25) {
+      dl_ch_filt_bank[k][24] = s->f_dc;
+      dl_ch_filt_bank[k][25] = s->f2_dc;
+    }
+  }
+
+  dl_ch_filt_bank_N_RB_DL = N_RB_DL;
+
+  return(0);
+}
+
+// Wiener (LMMSE) smoothing of the LS pilot estimates of a symbol over 5 neighbouring pilots, for a
+// uniform power delay profile over the cyclic prefix and the SNR in steps of 3 dB from 0 to 30 dB.
+// The window is truncated on the 2 pilots at each edge (position 0,1 left, 2 middle, 3,4 right).
+#define DL_CH_WIENER_SNR_BINS 11
+#define DL_CH_WIENER_TAPS 5
+
+static int16_t dl_ch_wiener[2][DL_CH_WIENER_SNR_BINS][5][2*DL_CH_WIENER_TAPS]; // Q14
+static unsigned char dl_ch_wiener_init = 0;
+
+static void lte_dl_ch_wiener_init(void)
+{
+
+  double r_re[2*DL_CH_WIENER_TAPS-1],r_im[2*DL_CH_WIENER_TAPS-1];
+  double a_re[DL_CH_WIENER_TAPS][DL_CH_WIENER_TAPS+1],a_im[DL_CH_WIENER_TAPS][DL_CH_WIENER_TAPS+1];
+  double x,sinc,d,t_re,t_im,n0;
+  int Ncp,snr,pos,m,i,j,c,first,last,n;
+
+  for (Ncp=0; Ncp<2; Ncp++) {
+    // correlation of pilots m apart (6m subcarriers) for delays uniform over the prefix (144/2048 or 512/2048)
+    for (m=-(DL_CH_WIENER_TAPS-1); m<DL_CH_WIENER_TAPS; m++) {
+      x    = 6.0*m*((Ncp==0) ? 0.0703125 : 0.25);
+      sinc = (m==0) ? 1.0 : sin(M_PI*x)/(M_PI*x);
+      r_re[m+DL_CH_WIENER_TAPS-1] = cos(M_PI*x)*sinc;
+      r_im[m+DL_CH_WIENER_TAPS-1] = -sin(M_PI*x)*sinc;
+    }
+
+    for (snr=0; snr<DL_CH_WIENER_SNR_BINS; snr++) {
+      n0 = pow(10.0,-0.3*snr);
+
+      for (pos=0; pos<5; pos++) {
+        first = (pos<2) ? 2-pos : 0;
+        last  = (pos>2) ? 6-pos : DL_CH_WIENER_TAPS-1;
+        n     = last-first+1;
+
+        // (R_pp+n0 I)^T w = r_hp, taps i,j are pilots i-2,j-2 relative to the estimated one
+        for (i=0; i<n; i++) {
+          for (j=0; j<n; j++) {
+            a_re[i][j] = r_re[(first+j)-(first+i)+DL_CH_WIENER_TAPS-1] + ((i==j) ? n0 : 0.0);
+            a_im[i][j] = r_im[(first+j)-(first+i)+DL_CH_WIENER_TAPS-1];
+          }
+
+          a_re[i][n] = r_re[2-(first+i)+DL_CH_WIENER_TAPS-1];
+          a_im[i][n] = r_im[2-(first+i)+DL_CH_WIENER_TAPS-1];
+        }
+
+        // Gauss-Jordan elimination, the matrix is Hermitian positive definite
+        for (i=0; i<n; i++) {
+          d = a_re[i][i]*a_re[i][i] + a_im[i][i]*a_im[i][i];
+
+          for (j=0; j<n; j++) {
+            if (j==i)
+              continue;
+
+            // factor a[j][i]/a[i][i]
+            t_re = (a_re[j][i]*a_re[i][i] + a_im[j][i]*a_im[i][i])/d;
+            t_im = (a_im[j][i]*a_re[i][i] - a_re[j][i]*a_im[i][i])/d;
+
+            for (c=i; c<=n; c++) {
+              a_re[j][c] -= t_re*a_re[i][c] - t_im*a_im[i][c];
+              a_im[j][c] -= t_re*a_im[i][c] + t_im*a_re[i][c];
+            }
+          }
+        }
+
+        memset(dl_ch_wiener[Ncp][snr][pos],0,2*DL_CH_WIENER_TAPS*sizeof(int16_t));
+
+        for (i=0; i<n; i++) {
+          d    = a_re[i][i]*a_re[i][i] + a_im[i][i]*a_im[i][i];
+          t_re = (a_re[i][n]*a_re[i][i] + a_im[i][n]*a_im[i][i])/d;
+          t_im = (a_im[i][n]*a_re[i][i] - a_re[i][n]*a_im[i][i])/d;
+          dl_ch_wiener[Ncp][snr][pos][(first+i)<<1]     = (int16_t)lrint(t_re*16384.0);
+          dl_ch_wiener[Ncp][snr][pos][1+((first+i)<<1)] = (int16_t)lrint(t_im*16384.0);
+        }
+      }
+    }
+  }
+
+  dl_ch_wiener_init = 1;
+}
+
+static void lte_dl_ch_wiener(int16_t *ls,
+                             int16_t *ls_w,
+                             unsigned short nb_pilots,
+                             unsigned char Ncp,
+                             int snr_dB)
+{
+
+  int16_t *w;
+  int i,b,pos,re,im;
+  unsigned char snr;
+
+  snr = (snr_dB <= 0) ? 0 : (snr_dB >= 3*(DL_CH_WIENER_SNR_BINS-1)) ? DL_CH_WIENER_SNR_BINS-1 : (snr_dB+1)/3;
+
+  for (i=0; i<nb_pilots; i++) {
+    pos = (i<2) ? i : (i>=nb_pilots-2) ? 4-(nb_pilots-1-i) : 2;
+    w   = dl_ch_wiener[Ncp][snr][pos];
+    re  = 0;
+    im  = 0;
+
+    for (b=0; b<DL_CH_WIENER_TAPS; b++) {
+      if ((i+b-2<0) || (i+b-2>=nb_pilots))
+        continue;
+
+      re += (int32_t)w[b<<1]*ls[(i+b-2)<<1]     - (int32_t)w[1+(b<<1)]*ls[1+((i+b-2)<<1)];
+      im += (int32_t)w[b<<1]*ls[1+((i+b-2)<<1)] + (int32_t)w[1+(b<<1)]*ls[(i+b-2)<<1];
+    }
+
+    re >>= 14;
+    im >>= 14;
+    ls_w[i<<1]     = (int16_t)((re > 32767) ? 32767 : (re < -32768) ? -32768 : re);
+    ls_w[1+(i<<1)] = (int16_t)((im > 32767) ? 32767 : (im < -32768) ? -32768 : im);
+  }
+}
+
 int lte_dl_channel_estimation(PHY_VARS_UE *phy_vars_ue,
                               uint8_t eNB_id,
                               uint8_t eNB_offset,
@@ -46,10 +222,11 @@ int lte_dl_channel_estimation(PHY_VARS_UE *phy_vars_ue,
 
 
   int pilot[2][200] __attribute__((aligned(16)));
-  unsigned char nu,aarx;
-  unsigned short k;
-  unsigned int rb,pilot_cnt;
-  int16_t ch[2],*pil,*rxF,*dl_ch,*dl_ch_prev,*f,*f2,*fl,*f2l2,*fr,*f2r2,*f2_dc,*f_dc;
+  int16_t ls[2][400] __attribute__((aligned(16)));
+  int16_t w_interp[6];
+  unsigned char nu,aarx,k2;
+  unsigned short k,nb_pilots,i;
+  int16_t *pil,*rxF,*rxF2,*dl_ch,*dl_ch_prev,*ch;
   int ch_offset,symbol_offset;
   //  unsigned int n;
   //  int i;
@@ -59,6 +236,7 @@ int lte_dl_channel_estimation(PHY_VARS_UE *phy_vars_ue,
   uint8_t nushift,pilot1,pilot2,pilot3;
   int **dl_ch_estimates=phy_vars_ue->lte_ue_common_vars.dl_ch_estimates[eNB_offset];
   int **rxdataF=phy_vars_ue->lte_ue_common_vars.rxdataF;
+  int ofdm_symbol_size=phy_vars_ue->lte_frame_parms.ofdm_symbol_size;
 
   if (phy_vars_ue->lte_frame_parms.Ncp == 0) {  // normal prefix
     pilot1 = 4;
@@ -97,88 +275,25 @@ int lte_dl_channel_estimation(PHY_VARS_UE *phy_vars_ue,
 
   k = (nu + nushift)%6;
 
+  // first pilot after DC, 15 RBs use the offset of port p in the first symbol of the slot
+  if (phy_vars_ue->lte_frame_parms.N_RB_DL == 15)
+    k2 = nushift + (3*p);
+  else
+    k2 = k;
+
 #ifdef DEBUG_CH
   printf("Channel Estimation : eNB_offset %d cell_id %d ch_offset %d, OFDM size %d, Ncp=%d, l=%d, Ns=%d, k=%d\n",eNB_offset,Nid_cell,ch_offset,phy_vars_ue->lte_frame_parms.ofdm_symbol_size,
          phy_vars_ue->lte_frame_parms.Ncp,l,Ns,k);
 #endif
 
-  switch (k) {
-  case 0 :
-    f=filt24_0;  //for first pilot of RB, first half
-    f2=filt24_2; //for second pilot of RB, first half
-    fl=filt24_0; //for first pilot of leftmost RB
-    f2l2=filt24_2;
-    //    fr=filt24_2r; //for first pilot of rightmost RB
-    fr=filt24_0r2; //for first pilot of rightmost RB
-    //    f2r2=filt24_0r2;
-    f2r2=filt24_2r;
-
-    f_dc=filt24_0_dcr;
-    f2_dc=filt24_2_dcl;
-
-    break;
-
-  case 1 :
-    f=filt24_1;
-    f2=filt24_3;
-    fl=filt24_1l;
-    f2l2=filt24_3l2;
-    fr=filt24_1r2;
-    f2r2=filt24_3r;
-    f_dc=filt24_1_dcr;  //for first pilot of RB, first half
-    f2_dc=filt24_3_dcl;  //for first pilot of RB, first half
-    break;
-
-  case 2 :
-    f=filt24_2;
-    f2=filt24_4;
-    fl=filt24_2l;
-    f2l2=filt24_4l2;
-    fr=filt24_2r2;
-    f2r2=filt24_4r;
-    f_dc=filt24_2_dcr;  //for first pilot of RB, first half
-    f2_dc=filt24_4_dcl;  //for first pilot of RB, first half
-    break;
-
-  case 3 :
-    f=filt24_3;
-    f2=filt24_5;
-    fl=filt24_3l;
-    f2l2=filt24_5l2;
-    fr=filt24_3r2;
-    f2r2=filt24_5r;
-    f_dc=filt24_3_dcr;  //for first pilot of RB, first half
-    f2_dc=filt24_5_dcl;  //for first pilot of RB, first half
-    break;
-
-  case 4 :
-    f=filt24_4;
-    f2=filt24_6;
-    fl=filt24_4l;
-    f2l2=filt24_6l2;
-    fr=filt24_4r2;
-    f2r2=filt24_6r;
-    f_dc=filt24_4_dcr;  //for first pilot of RB, first half
-    f2_dc=filt24_6_dcl;  //for first pilot of RB, first half
-    break;
-
-  case 5 :
-    f=filt24_5;
-    f2=filt24_7;
-    fl=filt24_5l;
-    f2l2=filt24_7l2;
-    fr=filt24_5r2;
-    f2r2=filt24_7r;
-    f_dc=filt24_5_dcr;  //for first pilot of RB, first half
-    f2_dc=filt24_7_dcl;  //for first pilot of RB, first half
-    break;
+  if ((dl_ch_filt_bank_N_RB_DL != phy_vars_ue->lte_frame_parms.N_RB_DL) &&
+      (lte_dl_ch_filt_bank_init(phy_vars_ue->lte_frame_parms.N_RB_DL) != 0))
+    msg("channel estimation not implemented for phy_vars_ue->lte_frame_parms.N_RB_DL = %d\n",phy_vars_ue->lte_frame_parms.N_RB_DL);
 
-  default:
-    msg("lte_dl_channel_estimation: k=%d -> ERROR\n",k);
-    return(-1);
-    break;
-  }
+  if ((phy_vars_ue->ch_est_wiener == 1) && (dl_ch_wiener_init == 0))
+    lte_dl_ch_wiener_init();
 
+  nb_pilots = phy_vars_ue->lte_frame_parms.N_RB_DL<<1;
 
 
   // generate pilot
@@ -194,435 +309,45 @@ int lte_dl_channel_estimation(PHY_VARS_UE *phy_vars_ue,
 
     pil   = (int16_t *)&pilot[p][0];
     rxF   = (int16_t *)&rxdataF[aarx][((symbol_offset+k+phy_vars_ue->lte_frame_parms.first_carrier_offset))];
+    rxF2  = (int16_t *)&rxdataF[aarx][((symbol_offset+1+k2))];
     dl_ch = (int16_t *)&dl_ch_estimates[(p<<1)+aarx][ch_offset];
 
 
     //    if (eNb_id==0)
     memset(dl_ch,0,4*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size));
-    if (phy_vars_ue->high_speed_flag==0) // multiply previous channel estimate by ch_est_alpha
-      multadd_complex_vector_real_scalar(dl_ch-(phy_vars_ue->lte_frame_parms.ofdm_symbol_size<<1),
-                                         phy_vars_ue->ch_est_alpha,dl_ch-(phy_vars_ue->lte_frame_parms.ofdm_symbol_size<<1),
-                                         1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-
-
-    if ((phy_vars_ue->lte_frame_parms.N_RB_DL==6)  ||
-        (phy_vars_ue->lte_frame_parms.N_RB_DL==50) ||
-        (phy_vars_ue->lte_frame_parms.N_RB_DL==100)) {
-
-      //First half of pilots
-      // Treat first 2 pilots specially (left edge)
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-      // printf("pilot 0 : rxF - > (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-      multadd_real_vector_complex_scalar(fl,
-                                         ch,
-                                         dl_ch,
-                                         24);
-      pil+=2;    // Re Im
-      rxF+=12;
-      dl_ch+=8;
-
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-      // printf("pilot 1 : rxF - > (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-      multadd_real_vector_complex_scalar(f2l2,
-                                         ch,
-                                         dl_ch,
-                                         24);
-      pil+=2;
-      rxF+=12;
-      dl_ch+=16;
-
-      for (pilot_cnt=2; pilot_cnt<((phy_vars_ue->lte_frame_parms.N_RB_DL)-1); pilot_cnt+=2) {
-
-        // printf("%d\n",dl_ch-(int16_t *)&dl_ch_estimates[(p<<1)+aarx][ch_offset]);
-
-        //  printf("pilot[%d][%d] (%d,%d)\n",p,pilot_cnt,pil[0],pil[1]);
-        //  printf("rx[%d] -> (%d,%d)\n", k, rxF[0], rxF[1]);
-
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15); //Re
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15); //Im
-        // printf("**rb %d %d\n",rb,dl_ch-(int16_t *)&dl_ch_estimates[(p<<1)+aarx][ch_offset]);
-        multadd_real_vector_complex_scalar(f,
-                                           ch,
-                                           dl_ch,
-                                           24);
-
-
-        pil+=2;    // Re Im
-        rxF+=12;
-        dl_ch+=8;
-
-        // printf("pilot[%d][%d] (%d,%d)\n",p,rb,pil[0],pil[1]);
-        // printf("rx[%d] -> (%d,%d)\n", k+6, rxF[0], rxF[1]);
-
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-        // printf("**rb %d %d\n",rb,dl_ch-(int16_t *)&dl_ch_estimates[(p<<1)+aarx][ch_offset]);
-        multadd_real_vector_complex_scalar(f2,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;
-        rxF+=12;
-        dl_ch+=16;
-
-      }
-
-      //       printf("Second half\n");
-      // Second half of RBs
-
-      k = (nu + nushift)%6;
-
-      if (k > 6)
-        k -=6;
-
-      rxF   = (int16_t *)&rxdataF[aarx][((symbol_offset+1+k))];
-
-      for (pilot_cnt=0; pilot_cnt<((phy_vars_ue->lte_frame_parms.N_RB_DL)-3); pilot_cnt+=2) {
-        //  printf("pilot[%d][%d] (%d,%d)\n",p,pilot_cnt,pil[0],pil[1]);
-        //  printf("rx[%d] -> (%d,%d)\n", k+6, rxF[0], rxF[1]);
-
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
-        //   printf("**rb %d %d\n",rb,dl_ch-(int16_t *)&dl_ch_estimates[(p<<1)+aarx][ch_offset]);
-        multadd_real_vector_complex_scalar(f,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;
-        rxF+=12;
-        dl_ch+=8;
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
-        //   printf("**rb %d %d\n",rb,dl_ch-(int16_T *)&dl_ch_estimates[(p<<1)+aarx][ch_offset]);
-        multadd_real_vector_complex_scalar(f2,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;
-        rxF+=12;
-        dl_ch+=16;
-
-      }
-
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-      //            printf("pilot 49: rxF -> (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-      multadd_real_vector_complex_scalar(fr,
-                                         ch,
-                                         dl_ch,
-                                         24);
-      pil+=2;    // Re Im
-      rxF+=12;
-      dl_ch+=8;
-
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-      //             printf("pilot 50: rxF - > (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-      multadd_real_vector_complex_scalar(f2r2,
-                                         ch,
-                                         dl_ch,
-                                         24);
 
+    // LS estimates of the pilots, N_RB_DL on each side of DC
+    for (i=0; i<nb_pilots; i++) {
+      if (i == (nb_pilots>>1))
+        rxF = rxF2;
 
-    }
-
-    else if (phy_vars_ue->lte_frame_parms.N_RB_DL==25) {
-      //printf("Channel estimation\n");
-
-      // Treat first 2 pilots specially (left edge)
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
+      ls[0][i<<1]     = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15); //Re
+      ls[0][1+(i<<1)] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15); //Im
 #ifdef DEBUG_CH
-      printf("pilot 0 : rxF - > (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-      //      ch[0] = 1024;
-      //      ch[1] = -128;
+      printf("pilot %d : rxF - > (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",i,rxF[0],rxF[1],ls[0][i<<1],ls[0][1+(i<<1)],pil[0],pil[1]);
 #endif
-
-      multadd_real_vector_complex_scalar(fl,
-                                         ch,
-                                         dl_ch,
-                                         24);
       pil+=2;    // Re Im
       rxF+=12;
-      dl_ch+=8;
-
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
-#ifdef DEBUG_CH
-      printf("pilot 1 : rxF - > (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-      //      ch[0] = 1024;
-      //      ch[1] = -128;
-#endif
-
-      multadd_real_vector_complex_scalar(f2l2,
-                                         ch,
-                                         dl_ch,
-                                         24);
-      pil+=2;
-      rxF+=12;
-      dl_ch+=16;
-
-      for (pilot_cnt=2; pilot_cnt<24; pilot_cnt+=2) {
-
-        // printf("pilot[%d][%d] (%d,%d)\n",p,rb,pil[0],pil[1]);
-        // printf("rx[%d][%d] -> (%d,%d)\n",p,phy_vars_ue->lte_frame_parms.first_carrier_offset + phy_vars_ue->lte_frame_parms.nushift + 6*rb+(3*p),rxF[0],rxF[1]);
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
-#ifdef DEBUG_CH
-        printf("pilot %d : rxF - > (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",pilot_cnt,rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-        //  ch[0] = 1024;
-        //  ch[1] = -128;
-#endif
-
-
-        multadd_real_vector_complex_scalar(f,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;    // Re Im
-        rxF+=12;
-        dl_ch+=8;
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
-#ifdef DEBUG_CH
-        printf("pilot %d : rxF - > (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",pilot_cnt+1,rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-        //  ch[0] = 1024;
-        //  ch[1] = -128;
-#endif
-        multadd_real_vector_complex_scalar(f2,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;
-        rxF+=12;
-        dl_ch+=16;
-
-      }
-
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-#ifdef DEBUG_CH
-      printf("pilot 24: rxF -> (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-      //      ch[0] = 1024;
-      //      ch[1] = -128;
-#endif
-
-
-      multadd_real_vector_complex_scalar(f_dc,
-                                         ch,
-                                         dl_ch,
-                                         24);
-      pil+=2;    // Re Im
-      dl_ch+=8;
-
-      // printf("Second half\n");
-      // Second half of RBs
-      rxF   = (int16_t *)&rxdataF[aarx][((symbol_offset+1+k))];
-
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-#ifdef DEBUG_CH
-      printf("pilot 25: rxF -> (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-      //      ch[0] = 1024;
-      //      ch[1] = -128;
-#endif
-
-      multadd_real_vector_complex_scalar(f2_dc,
-                                         ch,
-                                         dl_ch,
-                                         24);
-      pil+=2;
-      rxF+=12;
-      dl_ch+=16;
-
-      for (pilot_cnt=0; pilot_cnt<22; pilot_cnt+=2) {
-
-        // printf("* pilot[%d][%d] (%d,%d)\n",p,rb,pil[0],pil[1]);
-        // printf("rx[%d][%d] -> (%d,%d)\n",p,phy_vars_ue->lte_frame_parms.first_carrier_offset + phy_vars_ue->lte_frame_parms.nushift + 6*rb+(3*p),rxF[0],rxF[1]);
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-#ifdef DEBUG_CH
-        printf("pilot %d rxF -> (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",26+pilot_cnt,rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-        //  ch[0] = 1024;
-        //  ch[1] = -128;
-#endif
-
-        multadd_real_vector_complex_scalar(f,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;
-        rxF+=12;
-        dl_ch+=8;
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-#ifdef DEBUG_CH
-        printf("pilot %d : rxF -> (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",27+pilot_cnt,rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-        //  ch[0] = 1024;
-        //  ch[1] = -128;
-#endif
-
-        multadd_real_vector_complex_scalar(f2,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;
-        rxF+=12;
-        dl_ch+=16;
-
-      }
-
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
-#ifdef DEBUG_CH
-      printf("pilot 49: rxF -> (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-      //      ch[0] = 1024;
-      //      ch[1] = -128;
-#endif
-
-
-      multadd_real_vector_complex_scalar(fr,
-                                         ch,
-                                         dl_ch,
-                                         24);
-      pil+=2;    // Re Im
-      rxF+=12;
-      dl_ch+=8;
-
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
-#ifdef DEBUG_CH
-
-      printf("pilot 50: rxF - > (%d,%d) ch -> (%d,%d), pil -> (%d,%d) \n",rxF[0],rxF[1],ch[0],ch[1],pil[0],pil[1]);
-
-      //      ch[0] = 1024;
-      //      ch[1] = -128;
-#endif
-
-      multadd_real_vector_complex_scalar(f2r2,
-                                         ch,
-                                         dl_ch,
-                                         24);
-
-    } else if (phy_vars_ue->lte_frame_parms.N_RB_DL==15) {
-
-      //printf("First Half\n");
-      for (rb=0; rb<28; rb+=4) {
-
-        //printf("aarx=%d\n",aarx);
-        //printf("pilot[%d][%d] (%d,%d)\n",p,rb,pil[0],pil[1]);
-        //printf("rx[%d][%d] -> (%d,%d)\n",p,
-        //       phy_vars_ue->lte_frame_parms.first_carrier_offset + phy_vars_ue->lte_frame_parms.nushift + 6*rb+(3*p),
-        //       rxF[0],
-        //       rxF[1]);
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-        //printf("ch -> (%d,%d)\n",ch[0],ch[1]);
-        multadd_real_vector_complex_scalar(f,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;    // Re Im
-        rxF+=12;
-        dl_ch+=8;
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-        //printf("ch -> (%d,%d)\n",ch[0],ch[1]);
-        multadd_real_vector_complex_scalar(f2,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;
-        rxF+=12;
-        dl_ch+=16;
+    }
 
-      }
+    ch = ls[0];
 
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-      //     printf("ch -> (%d,%d)\n",ch[0],ch[1]);
-      multadd_real_vector_complex_scalar(f,
-                                         ch,
-                                         dl_ch,
-                                         24);
-      pil+=2;    // Re Im
-      dl_ch+=8;
-
-      //printf("Second half\n");
-      //Second half of RBs
-      rxF   = (int16_t *)&rxdataF[aarx][((symbol_offset+1+nushift + (3*p)))];
-      ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-      ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
-      multadd_real_vector_complex_scalar(f2,
-                                         ch,
-                                         dl_ch,
-                                         24);
-      pil+=2;
-      rxF+=12;
-      dl_ch+=16;
-
-      for (rb=0; rb<28; rb+=4) {
-        //printf("aarx=%d\n",aarx);
-        //printf("pilot[%d][%d] (%d,%d)\n",p,rb,pil[0],pil[1]);
-        //printf("rx[%d][%d] -> (%d,%d)\n",p,
-        //       phy_vars_ue->lte_frame_parms.first_carrier_offset + phy_vars_ue->lte_frame_parms.nushift + 6*rb+(3*p),
-        //       rxF[0],
-        //       rxF[1]);
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
-
-        multadd_real_vector_complex_scalar(f,
-                                           ch,
-                                           dl_ch,
-                                           24);
-        pil+=2;
-        rxF+=12;
-        dl_ch+=8;
-
-        ch[0] = (int16_t)(((int32_t)pil[0]*rxF[0] - (int32_t)pil[1]*rxF[1])>>15);
-        ch[1] = (int16_t)(((int32_t)pil[0]*rxF[1] + (int32_t)pil[1]*rxF[0])>>15);
+    if ((phy_vars_ue->ch_est_wiener == 1) && (eNB_offset == 0)) {
+      lte_dl_ch_wiener(ls[0],
+                       ls[1],
+                       nb_pilots,
+                       phy_vars_ue->lte_frame_parms.Ncp,
+                       phy_vars_ue->PHY_measurements.wideband_cqi_avg[eNB_id]);
+      ch = ls[1];
+    }
 
-        multadd_real_vector_complex_scalar(f2,
-                                           ch,
-                                           dl_ch,
+    // frequency interpolation, the filters of pilots 2i and 2i+1 start at RE 12i and 12i+4
+    if (dl_ch_filt_bank_N_RB_DL == phy_vars_ue->lte_frame_parms.N_RB_DL) {
+      for (i=0; i<nb_pilots; i++)
+        multadd_real_vector_complex_scalar(dl_ch_filt_bank[k][i],
+                                           &ch[i<<1],
+                                           &dl_ch[(24*(i>>1))+((i&1)<<3)],
                                            24);
-        pil+=2;
-        rxF+=12;
-        dl_ch+=16;
-
-      }
-    } else {
-      msg("channel estimation not implemented for phy_vars_ue->lte_frame_parms.N_RB_DL = %d\n",phy_vars_ue->lte_frame_parms.N_RB_DL);
     }
 
 
@@ -633,74 +358,45 @@ int lte_dl_channel_estimation(PHY_VARS_UE *phy_vars_ue,
       dl_ch = (int16_t *)&dl_ch_estimates[(p<<1)+aarx][ch_offset];
 
       if (phy_vars_ue->high_speed_flag == 0) {
-        multadd_complex_vector_real_scalar(dl_ch,
-                                           32767-phy_vars_ue->ch_est_alpha,
-                                           dl_ch-(phy_vars_ue->lte_frame_parms.ofdm_symbol_size<<1),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
+        // filter the previous channel estimate with ch_est_alpha
+        w_interp[0] = phy_vars_ue->ch_est_alpha;
+        w_interp[1] = 32767-phy_vars_ue->ch_est_alpha;
+        interp_complex_vector_real_scalar(dl_ch-(ofdm_symbol_size<<1),dl_ch,w_interp,dl_ch-(ofdm_symbol_size<<1),1,ofdm_symbol_size);
       } else { // high_speed_flag == 1
         if (symbol == 0) {
           //      printf("Interpolating %d->0\n",4-phy_vars_ue->lte_frame_parms.Ncp);
           //      dl_ch_prev = (int16_t *)&dl_ch_estimates[(p<<1)+aarx][(4-phy_vars_ue->lte_frame_parms.Ncp)*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)];
           dl_ch_prev = (int16_t *)&dl_ch_estimates[(p<<1)+aarx][pilot3*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)];
-
-          multadd_complex_vector_real_scalar(dl_ch_prev,21845,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-          multadd_complex_vector_real_scalar(dl_ch,10923,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-
-          multadd_complex_vector_real_scalar(dl_ch_prev,10923,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-          multadd_complex_vector_real_scalar(dl_ch,21845,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-        } // this is 1/3,2/3 combination for pilots spaced by 3 symbols
-        else if (symbol == pilot1) {
+        } else if (symbol == pilot1) {
           dl_ch_prev = (int16_t *)&dl_ch_estimates[(p<<1)+aarx][0];
-
-          if (phy_vars_ue->lte_frame_parms.Ncp==0) {// pilot spacing 4 symbols (1/4,1/2,3/4 combination)
-            multadd_complex_vector_real_scalar(dl_ch_prev,24576,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,8192,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-
-            multadd_complex_vector_real_scalar(dl_ch_prev,16384,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,16384,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-
-            multadd_complex_vector_real_scalar(dl_ch_prev,8192,dl_ch_prev+(3*2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,24576,dl_ch_prev+(3*2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-          } else {
-            multadd_complex_vector_real_scalar(dl_ch_prev,10923,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,21845,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-
-            multadd_complex_vector_real_scalar(dl_ch_prev,21845,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,10923,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-          } // pilot spacing 3 symbols (1/3,2/3 combination)
         } else if (symbol == pilot2) {
           dl_ch_prev = (int16_t *)&dl_ch_estimates[(p<<1)+aarx][pilot1*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)];
-
-          multadd_complex_vector_real_scalar(dl_ch_prev,21845,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-          multadd_complex_vector_real_scalar(dl_ch,10923,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-
-          multadd_complex_vector_real_scalar(dl_ch_prev,10923,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-          multadd_complex_vector_real_scalar(dl_ch,21845,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
         } else { // symbol == pilot3
           //      printf("Interpolating 0->%d\n",4-phy_vars_ue->lte_frame_parms.Ncp);
           dl_ch_prev = (int16_t *)&dl_ch_estimates[(p<<1)+aarx][pilot2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)];
-
-          if (phy_vars_ue->lte_frame_parms.Ncp==0) {// pilot spacing 4 symbols (1/4,1/2,3/4 combination)
-            multadd_complex_vector_real_scalar(dl_ch_prev,24576,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,8192,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-
-            multadd_complex_vector_real_scalar(dl_ch_prev,16384,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,16384,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-
-            multadd_complex_vector_real_scalar(dl_ch_prev,8192,dl_ch_prev+(3*2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,24576,dl_ch_prev+(3*2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-          } else {
-            multadd_complex_vector_real_scalar(dl_ch_prev,10923,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,21845,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-
-            multadd_complex_vector_real_scalar(dl_ch_prev,21845,dl_ch_prev+(2*(phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1),1,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-            multadd_complex_vector_real_scalar(dl_ch,10923,dl_ch_prev+(2*((phy_vars_ue->lte_frame_parms.ofdm_symbol_size)<<1)),0,phy_vars_ue->lte_frame_parms.ofdm_symbol_size);
-          } // pilot spacing 3 symbols (1/3,2/3 combination)
         }
 
+        // symbols between the previous and this pilot symbol in one pass
+        if ((phy_vars_ue->lte_frame_parms.Ncp==0) && ((symbol == pilot1) || (symbol == pilot3))) {
+          // pilot spacing 4 symbols (3/4,1/4 - 1/2,1/2 - 1/4,3/4 combination)
+          w_interp[0] = 24576;
+          w_interp[1] = 8192;
+          w_interp[2] = 16384;
+          w_interp[3] = 16384;
+          w_interp[4] = 8192;
+          w_interp[5] = 24576;
+          interp_complex_vector_real_scalar(dl_ch_prev,dl_ch,w_interp,dl_ch_prev+(ofdm_symbol_size<<1),3,ofdm_symbol_size);
+        } else {
+          // pilot spacing 3 symbols (2/3,1/3 - 1/3,2/3 combination)
+          w_interp[0] = 21845;
+          w_interp[1] = 10923;
+          w_interp[2] = 10923;
+          w_interp[3] = 21845;
+          interp_complex_vector_real_scalar(dl_ch_prev,dl_ch,w_interp,dl_ch_prev+(ofdm_symbol_size<<1),2,ofdm_symbol_size);
+        }
       }
     }
   }
-
   void (*idft)(int16_t *,int16_t *, int);
 
   switch (phy_vars_ue->lte_frame_parms.log2_symbol_size) {
@@ -729,13 +425,15 @@ int lte_dl_channel_estimation(PHY_VARS_UE *phy_vars_ue,
     break;
   }
 
-  // do ifft of channel estimate
-  for (aarx=0; aarx<phy_vars_ue->lte_frame_parms.nb_antennas_rx; aarx++)
-    for (p=0; p<phy_vars_ue->lte_frame_parms.nb_antennas_tx_eNB; p++) {
+  // do ifft of channel estimate (from the start of the first symbol), only port p has changed and
+  // with time interpolation only after the first symbol of the subframe and the next pilot symbol
+  if ((phy_vars_ue->high_speed_flag == 0) || (symbol == 0) || (symbol == pilot1)) {
+    for (aarx=0; aarx<phy_vars_ue->lte_frame_parms.nb_antennas_rx; aarx++) {
       if (phy_vars_ue->lte_ue_common_vars.dl_ch_estimates[eNB_offset][(p<<1)+aarx])
         idft((int16_t*) &phy_vars_ue->lte_ue_common_vars.dl_ch_estimates[eNB_offset][(p<<1)+aarx][8],
              (int16_t*) phy_vars_ue->lte_ue_common_vars.dl_ch_estimates_time[eNB_offset][(p<<1)+aarx],1);
     }
+  }
 
   return(0);
 }
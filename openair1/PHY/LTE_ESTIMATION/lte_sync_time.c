@@ -55,6 +55,267 @@ int* sync_corr_ue2 = NULL;
 int sync_tmp[2048*4] __attribute__((aligned(16)));
 short syncF_tmp[2048*2] __attribute__((aligned(16)));
 
+// overlap-save correlation: blocks of N lags computed with a DFT of size M=2N
+#define SYNC_FD_MAX_SIZE 4096
+// bits of headroom of the spectral products, given back on the outputs
+#define SYNC_FD_HEADROOM 2
+// symbol size of the decimated signal for SYNC_TIME_FD_COARSE (1.92 Msps)
+#define SYNC_COARSE_SIZE 128
+
+typedef struct {
+  /// length of the sequences
+  int N;
+  /// DFT size, 0 if not available for N
+  int M;
+  /// shift of the spectral products
+  int shift;
+  void (*dft)(int16_t *x,int16_t *y,int scale);
+  void (*idft)(int16_t *x,int16_t *y,int scale);
+  /// spectra of the zero-padded sequences
+  int16_t *pss_f[3];
+} sync_fd_t;
+
+static sync_time_method_t sync_time_method = SYNC_TIME_FD;
+static sync_fd_t sync_fd,sync_fd_coarse;
+static int16_t *primary_synch_coarse[3];
+static int16_t **sync_rx_coarse = NULL;
+static int sync_rx_coarse_antennas = 0;
+static int *sync_corr_coarse[3];
+static int16_t sync_fd_x[SYNC_FD_MAX_SIZE*2] __attribute__((aligned(16)));
+static int16_t sync_fd_y[SYNC_FD_MAX_SIZE*2] __attribute__((aligned(16)));
+static int16_t sync_fd_tmp[SYNC_FD_MAX_SIZE*2] __attribute__((aligned(16)));
+static int16_t sync_fd_z[3][SYNC_FD_MAX_SIZE*2] __attribute__((aligned(16)));
+
+void lte_sync_time_set_method(sync_time_method_t method)
+{
+  sync_time_method = method;
+}
+
+static inline int16_t sync_sat16(int x)
+{
+  return((x > 32767) ? 32767 : ((x < -32768) ? -32768 : x));
+}
+
+static int sync_fd_init(sync_fd_t *fd, int16_t *pss_time[3], int N)
+{
+  int s,i,log2M;
+
+  fd->N = N;
+  fd->M = 2*N;
+
+  switch (fd->M) {
+  case 256:
+    fd->dft  = dft256;
+    fd->idft = idft256;
+    log2M = 8;
+    break;
+
+  case 1024:
+    fd->dft  = dft1024;
+    fd->idft = idft1024;
+    log2M = 10;
+    break;
+
+  case 2048:
+    fd->dft  = dft2048;
+    fd->idft = idft2048;
+    log2M = 11;
+    break;
+
+  case 4096:
+    fd->dft  = dft4096;
+    fd->idft = idft4096;
+    log2M = 12;
+    break;
+
+  default:
+    fd->M = 0;
+    return(-1);
+  }
+
+  // dft and idft both scale by 1/sqrt(M): with the spectra scaled by sqrt(2) for odd log2(M),
+  // the outputs are those of dot_product(pss,rx,N,15) shifted down by SYNC_FD_HEADROOM
+  fd->shift = 15 + SYNC_FD_HEADROOM - ((log2M+1)>>1);
+
+  for (s=0; s<3; s++) {
+    fd->pss_f[s] = (int16_t *)malloc16(fd->M*sizeof(int16_t)*2);
+
+    if (fd->pss_f[s] == NULL) {
+      msg("[openair][LTE_PHY][SYNC] pss spectrum not allocated\n");
+      fd->M = 0;
+      return(-1);
+    }
+
+    memset(sync_fd_x,0,fd->M*sizeof(int16_t)*2);
+    memcpy(sync_fd_x,pss_time[s],N*sizeof(int16_t)*2);
+    fd->dft(sync_fd_x,fd->pss_f[s],1);
+
+    if (log2M&1)
+      for (i=0; i<2*fd->M; i++)
+        fd->pss_f[s][i] = (int16_t)(((int)fd->pss_f[s][i]*ONE_OVER_SQRT2_Q15)>>15);
+  }
+
+  return(0);
+}
+
+static void sync_fd_free(sync_fd_t *fd)
+{
+  int s;
+
+  for (s=0; s<3; s++) {
+    if (fd->pss_f[s])
+      free(fd->pss_f[s]);
+
+    fd->pss_f[s] = NULL;
+  }
+
+  fd->M = 0;
+}
+
+// corr[s][n] = sum over the antennas of the correlation of rx[ar][n..n+N[ with sequence s for n<nb_out
+// multiple of step, in the packed format of dot_product, rx holding len samples
+static void sync_fd_corr(sync_fd_t *fd, int16_t **rx, int nb_antennas, int len, int **corr, int nb_out, int step)
+{
+  int n0,ar,s,i,j;
+  int16_t *x;
+
+  for (n0=0; n0<nb_out; n0+=fd->N) {
+    for (ar=0; ar<nb_antennas; ar++) {
+      if (n0+fd->M <= len) {
+        x = &rx[ar][2*n0];
+      } else {
+        // last block, zero-padded
+        memset(sync_fd_x,0,fd->M*sizeof(int16_t)*2);
+        memcpy(sync_fd_x,&rx[ar][2*n0],(len-n0)*sizeof(int16_t)*2);
+        x = sync_fd_x;
+      }
+
+      fd->dft(x,sync_fd_y,1);
+
+      for (s=0; s<3; s++) {
+        if (ar == 0) {
+          mult_cpx_conj_vector(fd->pss_f[s],sync_fd_y,sync_fd_z[s],fd->M,fd->shift);
+        } else {
+          mult_cpx_conj_vector(fd->pss_f[s],sync_fd_y,sync_fd_tmp,fd->M,fd->shift);
+
+          for (i=0; i<2*fd->M; i++)
+            sync_fd_z[s][i] = sync_sat16((int)sync_fd_z[s][i] + sync_fd_tmp[i]);
+        }
+      }
+    }
+
+    for (s=0; s<3; s++) {
+      fd->idft(sync_fd_z[s],sync_fd_tmp,1);
+
+      for (j=0; (j<fd->N) && (n0+j<nb_out); j+=step) {
+        ((int16_t *)&corr[s][n0+j])[0] = sync_sat16((int)sync_fd_tmp[2*j]<<SYNC_FD_HEADROOM);
+        ((int16_t *)&corr[s][n0+j])[1] = sync_sat16((int)sync_fd_tmp[2*j+1]<<SYNC_FD_HEADROOM);
+      }
+    }
+  }
+}
+
+// PSS sampled at 1.92 Msps, for the coarse search
+static void lte_sync_time_coarse_pss(short *primary_synch, int16_t *primary_synch_time)
+{
+  int16_t pssF[SYNC_COARSE_SIZE*2] __attribute__((aligned(16)));
+  int i,k;
+
+  memset(pssF,0,sizeof(pssF));
+  k = SYNC_COARSE_SIZE-36;
+
+  for (i=0; i<72; i++) {
+    pssF[2*k]   = primary_synch[2*i]>>2;
+    pssF[2*k+1] = primary_synch[2*i+1]>>2;
+    k++;
+
+    if (k >= SYNC_COARSE_SIZE) {
+      k++;  // skip DC carrier
+      k-=SYNC_COARSE_SIZE;
+    }
+  }
+
+  idft128(pssF,primary_synch_time,1);
+}
+
+static int lte_sync_time_fd_init(LTE_DL_FRAME_PARMS *frame_parms)
+{
+  int16_t *pss_time[3] = {primary_synch0_time,primary_synch1_time,primary_synch2_time};
+  short *pss[3] = {primary_synch0,primary_synch1,primary_synch2};
+  int N = frame_parms->ofdm_symbol_size;
+  int length_coarse,ar,s;
+
+  if (sync_fd_init(&sync_fd,pss_time,N) < 0)
+    LOG_I(PHY,"[SYNC TIME] no DFT of size %d, using the time domain correlation\n",2*N);
+
+  if ((N <= SYNC_COARSE_SIZE) || (N%SYNC_COARSE_SIZE != 0))
+    return(0);
+
+  length_coarse = LTE_NUMBER_OF_SUBFRAMES_PER_FRAME*frame_parms->samples_per_tti/(N/SYNC_COARSE_SIZE);
+
+  for (s=0; s<3; s++) {
+    primary_synch_coarse[s] = (int16_t *)malloc16(SYNC_COARSE_SIZE*sizeof(int16_t)*2);
+    sync_corr_coarse[s] = (int *)malloc16(length_coarse*sizeof(int));
+
+    if ((primary_synch_coarse[s] == NULL) || (sync_corr_coarse[s] == NULL)) {
+      msg("[openair][LTE_PHY][SYNC] coarse sync buffers not allocated\n");
+      return(-1);
+    }
+
+    lte_sync_time_coarse_pss(pss[s],primary_synch_coarse[s]);
+  }
+
+  sync_rx_coarse = (int16_t **)calloc(frame_parms->nb_antennas_rx,sizeof(int16_t *));
+
+  if (sync_rx_coarse == NULL) {
+    msg("[openair][LTE_PHY][SYNC] coarse sync buffers not allocated\n");
+    return(-1);
+  }
+
+  sync_rx_coarse_antennas = frame_parms->nb_antennas_rx;
+
+  for (ar=0; ar<frame_parms->nb_antennas_rx; ar++) {
+    sync_rx_coarse[ar] = (int16_t *)malloc16(length_coarse*sizeof(int16_t)*2);
+
+    if (sync_rx_coarse[ar] == NULL) {
+      msg("[openair][LTE_PHY][SYNC] coarse sync buffers not allocated\n");
+      return(-1);
+    }
+  }
+
+  return(sync_fd_init(&sync_fd_coarse,primary_synch_coarse,SYNC_COARSE_SIZE));
+}
+
+static void lte_sync_time_fd_free(void)
+{
+  int ar,s;
+
+  sync_fd_free(&sync_fd);
+  sync_fd_free(&sync_fd_coarse);
+
+  for (s=0; s<3; s++) {
+    if (primary_synch_coarse[s])
+      free(primary_synch_coarse[s]);
+
+    if (sync_corr_coarse[s])
+      free(sync_corr_coarse[s]);
+
+    primary_synch_coarse[s] = NULL;
+    sync_corr_coarse[s] = NULL;
+  }
+
+  if (sync_rx_coarse) {
+    for (ar=0; ar<sync_rx_coarse_antennas; ar++)
+      if (sync_rx_coarse[ar])
+        free(sync_rx_coarse[ar]);
+
+    free(sync_rx_coarse);
+  }
+
+  sync_rx_coarse = NULL;
+  sync_rx_coarse_antennas = 0;
+}
+
 
 
 int lte_sync_time_init(LTE_DL_FRAME_PARMS *frame_parms )   // LTE_UE_COMMON *common_vars
@@ -299,6 +560,10 @@ int lte_sync_time_init(LTE_DL_FRAME_PARMS *frame_parms )   // LTE_UE_COMMON *com
   write_output("primary_sync1.m","psync1",primary_synch1_time,frame_parms->ofdm_symbol_size,1,1);
   write_output("primary_sync2.m","psync2",primary_synch2_time,frame_parms->ofdm_symbol_size,1,1);
 #endif
+
+  if (lte_sync_time_fd_init(frame_parms) < 0)
+    return(-1);
+
   return (1);
 }
 
@@ -343,6 +608,8 @@ void lte_sync_time_free(void)
   primary_synch0_time = NULL;
   primary_synch1_time = NULL;
   primary_synch2_time = NULL;
+
+  lte_sync_time_fd_free();
 }
 
 static inline int abs32(int x)
@@ -354,6 +621,110 @@ static inline int abs32(int x)
 int debug_cnt=0;
 #endif
 
+// coarse search at 1.92 Msps with the frequency domain correlator, then time domain search
+// at full rate around the best lag with the sequence found
+static int lte_sync_time_coarse(int **rxdata,
+                                LTE_DL_FRAME_PARMS *frame_parms,
+                                int *eNB_id)
+{
+  int *sync_corr[3] = {sync_corr_ue0,sync_corr_ue1,sync_corr_ue2};
+  int16_t *primary_synch_time[3] = {primary_synch0_time,primary_synch1_time,primary_synch2_time};
+  int N = frame_parms->ofdm_symbol_size;
+  int decimation = N/SYNC_COARSE_SIZE;
+  int length = LTE_NUMBER_OF_SUBFRAMES_PER_FRAME*frame_parms->samples_per_tti>>1;
+  int length_coarse = length/decimation;
+  int ar,m,n,j,s,re,im,first,last,result,result2;
+  int sync_out,sync_out2;
+  unsigned int tmp,peak_val,peak_pos,sync_source;
+  int16_t acc[2],acc2[2],res[2],res2[2];
+  int16_t *rx;
+
+  // boxcar filter and decimation, the PSS is within +-0.47 MHz
+  for (ar=0; ar<frame_parms->nb_antennas_rx; ar++) {
+    rx = (int16_t *)rxdata[ar];
+
+    for (m=0; m<2*length_coarse; m++) {
+      re = 0;
+      im = 0;
+
+      for (j=0; j<decimation; j++) {
+        re += rx[2*(m*decimation+j)];
+        im += rx[2*(m*decimation+j)+1];
+      }
+
+      sync_rx_coarse[ar][2*m]   = re/decimation;
+      sync_rx_coarse[ar][2*m+1] = im/decimation;
+    }
+  }
+
+  sync_fd_corr(&sync_fd_coarse,sync_rx_coarse,frame_parms->nb_antennas_rx,2*length_coarse,sync_corr_coarse,2*length_coarse-SYNC_COARSE_SIZE,1);
+
+  peak_val = 0;
+  peak_pos = 0;
+  sync_source = 0;
+
+  for (m=0; m<length_coarse-SYNC_COARSE_SIZE; m++) {
+    for (s=0; s<3; s++) {
+      tmp = (abs32(sync_corr_coarse[s][m])>>1) + (abs32(sync_corr_coarse[s][m+length_coarse])>>1);
+
+      if (tmp>peak_val) {
+        peak_val = tmp;
+        peak_pos = m;
+        sync_source = s;
+      }
+    }
+  }
+
+  // the boxcar delays the coarse peak by up to one decimated sample
+  first = ((int)peak_pos-1)*decimation;
+  first = (first < 0) ? 0 : (first&~3);
+  last  = (peak_pos+2)*decimation;
+
+  for (s=0; s<3; s++)
+    memset(sync_corr[s],0,2*length*sizeof(int));
+
+  peak_val = 0;
+  peak_pos = first;
+
+  for (n=first; (n<=last) && (n<length-N); n+=4) {
+    memset(acc,0,sizeof(acc));
+    memset(acc2,0,sizeof(acc2));
+
+    // the dot products are packed (re,im) 16-bit pairs, accumulated with 16-bit wrap-around
+    for (ar=0; ar<frame_parms->nb_antennas_rx; ar++) {
+      result  = dot_product(primary_synch_time[sync_source], (short*) &(rxdata[ar][n]), N, 15);
+      result2 = dot_product(primary_synch_time[sync_source], (short*) &(rxdata[ar][n+length]), N, 15);
+      memcpy(res,&result,sizeof(res));
+      memcpy(res2,&result2,sizeof(res2));
+      acc[0]  += res[0];
+      acc[1]  += res[1];
+      acc2[0] += res2[0];
+      acc2[1] += res2[1];
+    }
+
+    memcpy(&sync_out,acc,sizeof(acc));
+    memcpy(&sync_out2,acc2,sizeof(acc2));
+
+    sync_corr[sync_source][n] = abs32(sync_out);
+    sync_corr[sync_source][n+length] = abs32(sync_out2);
+    tmp = (abs32(sync_out)>>1) + (abs32(sync_out2)>>1);
+
+    if (tmp>peak_val) {
+      peak_val = tmp;
+      peak_pos = n;
+    }
+  }
+
+  *eNB_id = sync_source;
+
+#ifdef DEBUG_PHY
+  msg("[PHY][UE] lte_sync_time (coarse): Sync source = %d, Peak found at pos %d, val = %d\n",
+      sync_source,peak_pos,peak_val);
+#endif
+
+  return(peak_pos);
+}
+
 int lte_sync_time(int **rxdata, ///rx data in time domain
                   LTE_DL_FRAME_PARMS *frame_parms,
                   int *eNB_id)
@@ -368,6 +739,8 @@ int lte_sync_time(int **rxdata, ///rx data in time domain
   int sync_out[3] = {0,0,0},sync_out2[3] = {0,0,0};
   int tmp[3] = {0,0,0};
   int length =   LTE_NUMBER_OF_SUBFRAMES_PER_FRAME*frame_parms->samples_per_tti>>1;
+  int *sync_corr[3] = {sync_corr_ue0,sync_corr_ue1,sync_corr_ue2};
+  int fd;
 
   //msg("[SYNC TIME] Calling sync_time.\n");
   if (sync_corr_ue0 == NULL) {
@@ -385,6 +758,21 @@ int lte_sync_time(int **rxdata, ///rx data in time domain
     return(-1);
   }
 
+  if ((sync_time_method == SYNC_TIME_FD_COARSE) && (sync_fd_coarse.M > 0))
+    return(lte_sync_time_coarse(rxdata,frame_parms,eNB_id));
+
+  fd = (sync_time_method != SYNC_TIME_TD) && (sync_fd.M > 0);
+
+  if (fd) {
+    // all the lags of both half frames at once, those not computed by the time domain loop are cleared
+    sync_fd_corr(&sync_fd,(int16_t **)rxdata,frame_parms->nb_antennas_rx,2*length,sync_corr,2*length-frame_parms->ofdm_symbol_size,4);
+
+    for (s=0; s<3; s++) {
+      memset(&sync_corr[s][length-frame_parms->ofdm_symbol_size],0,frame_parms->ofdm_symbol_size*sizeof(int));
+      memset(&sync_corr[s][2*length-frame_parms->ofdm_symbol_size],0,frame_parms->ofdm_symbol_size*sizeof(int));
+    }
+  }
+
   peak_val = 0;
   peak_pos = 0;
   sync_source = 0;
@@ -404,20 +792,22 @@ int lte_sync_time(int **rxdata, ///rx data in time domain
 
 #endif
 
-    sync_corr_ue0[n] = 0;
-    sync_corr_ue0[n+length] = 0;
-    sync_corr_ue1[n] = 0;
-    sync_corr_ue1[n+length] = 0;
-    sync_corr_ue2[n] = 0;
-    sync_corr_ue2[n+length] = 0;
+    if (fd == 0) {
+      sync_corr_ue0[n] = 0;
+      sync_corr_ue0[n+length] = 0;
+      sync_corr_ue1[n] = 0;
+      sync_corr_ue1[n+length] = 0;
+      sync_corr_ue2[n] = 0;
+      sync_corr_ue2[n+length] = 0;
+    }
 
     for (s=0; s<3; s++) {
-      sync_out[s]=0;
-      sync_out2[s]=0;
+      sync_out[s] = (fd == 0) ? 0 : sync_corr[s][n];
+      sync_out2[s] = (fd == 0) ? 0 : sync_corr[s][n+length];
     }
 
     //    if (n<(length-frame_parms->ofdm_symbol_size-frame_parms->nb_prefix_samples)) {
-    if (n<(length-frame_parms->ofdm_symbol_size)) {
+    if ((fd == 0) && (n<(length-frame_parms->ofdm_symbol_size))) {
 
       //calculate dot product of primary_synch0_time and rxdata[ar][n] (ar=0..nb_ant_rx) and store the sum in temp[n];
       for (ar=0; ar<frame_parms->nb_antennas_rx; ar++) {
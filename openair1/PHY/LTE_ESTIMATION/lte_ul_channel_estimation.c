@@ -52,72 +52,106 @@ static int16_t ru_90c[2*128] = {32767, 0,32766, -402,32758, -804,32746, -1206,32
 
 #define SCALE 0x3FFF
 
-int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
-                                  uint8_t eNB_id,
-                                  uint8_t UE_id,
-                                  uint8_t sched_subframe,
-                                  unsigned char l,
-                                  unsigned char Ns,
-                                  uint8_t cooperation_flag)
+// exp(sqrt(-1)*2*pi*[0:11]/12)*pow2(15), the cyclic shifts of the DMRS (36-211 5.5.2.1.1)
+static int16_t ul_cs_alpha_re[12] = {32767, 28377, 16383,     0,-16384,  -28378,-32768,-28378,-16384,    -1, 16383, 28377};
+static int16_t ul_cs_alpha_im[12] = {0,     16383, 28377, 32767, 28377,   16383,     0,-16384,-28378,-32768,-28378,-16384};
+
+#if defined(__x86_64__) || defined(__i386__)
+// Cyclic shift compensation of 4 estimates, same arithmetic as the scalar loop: re = (ar*cr+ai*ci)>>15,
+// im = (ar*ci-ai*cr)>>15, truncated to 16 bits. The imaginary part takes two madds since alpha_im can be
+// -32768 and cannot be negated. w_re holds (ar,ai), w_im0 (0,ar) and w_im1 (ai,0) for each estimate.
+static inline __m128i lte_ul_cs_comp128(__m128i ch,
+                                        __m128i w_re,
+                                        __m128i w_im0,
+                                        __m128i w_im1)
 {
 
-  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
-  LTE_eNB_PUSCH *eNB_pusch_vars = phy_vars_eNB->lte_eNB_pusch_vars[UE_id];
-  int32_t **ul_ch_estimates=eNB_pusch_vars->drs_ch_estimates[eNB_id];
-  int32_t **ul_ch_estimates_time=  eNB_pusch_vars->drs_ch_estimates_time[eNB_id];
-  int32_t **ul_ch_estimates_0=  eNB_pusch_vars->drs_ch_estimates_0[eNB_id];
-  int32_t **ul_ch_estimates_1=  eNB_pusch_vars->drs_ch_estimates_1[eNB_id];
-  int32_t **rxdataF_ext=  eNB_pusch_vars->rxdataF_ext[eNB_id];
-  int subframe = phy_vars_eNB->proc[sched_subframe].subframe_rx;
-  uint8_t harq_pid = subframe2harq_pid(frame_parms,phy_vars_eNB->proc[sched_subframe].frame_rx,subframe);
-  int16_t delta_phase = 0;
-  int16_t *ru1 = ru_90;
-  int16_t *ru2 = ru_90;
-  int16_t current_phase1,current_phase2;
-  uint16_t N_rb_alloc = phy_vars_eNB->ulsch_eNB[UE_id]->harq_processes[harq_pid]->nb_rb;
-  uint16_t aa,Msc_RS,Msc_RS_idx;
-  uint16_t * Msc_idx_ptr;
-  int k,pilot_pos1 = 3 - frame_parms->Ncp, pilot_pos2 = 10 - 2*frame_parms->Ncp;
-  int16_t alpha, beta;
-  int32_t *ul_ch1=NULL, *ul_ch2=NULL;
-  int32_t *ul_ch1_0=NULL,*ul_ch2_0=NULL,*ul_ch1_1=NULL,*ul_ch2_1=NULL;
-  int16_t ul_ch_estimates_re,ul_ch_estimates_im;
-  int32_t rx_power_correction;
+  __m128i re,im,lo,hi;
 
-  //uint8_t nb_antennas_rx = frame_parms->nb_antennas_tx_eNB;
-  uint8_t nb_antennas_rx = frame_parms->nb_antennas_rx;
-  uint8_t cyclic_shift;
+  re = _mm_srai_epi32(_mm_madd_epi16(ch,w_re),15);
+  im = _mm_srai_epi32(_mm_sub_epi32(_mm_madd_epi16(ch,w_im0),_mm_madd_epi16(ch,w_im1)),15);
+  lo = _mm_srai_epi32(_mm_slli_epi32(_mm_unpacklo_epi32(re,im),16),16);
+  hi = _mm_srai_epi32(_mm_slli_epi32(_mm_unpackhi_epi32(re,im),16),16);
 
-  uint32_t alpha_ind;
-  uint32_t u=frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.grouphop[Ns+(subframe<<1)];
-  uint32_t v=frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.seqhop[Ns+(subframe<<1)];
-  int32_t tmp_estimates[N_rb_alloc*12] __attribute__((aligned(16)));
+  return(_mm_packs_epi32(lo,hi));
+}
+#endif
 
-  int symbol_offset,i,j;
+// Interpolation of the estimates of the two pilot symbols to nb_k symbols: symbol k is
+// (ul_ch1*ru1[k] + ul_ch2*ru2[k])*SCALE, the pilots are read once for all the symbols.
+// Same arithmetic as rotate_cpx_vector() followed by multadd_complex_vector_real_scalar().
+static void lte_ul_interp_rotate(int16_t *ul_ch1,
+                                 int16_t *ul_ch2,
+                                 int16_t **ru1,
+                                 int16_t **ru2,
+                                 int16_t **ul_ch,
+                                 int nb_k,
+                                 uint16_t Msc_RS)
+{
 
-  //debug_msg("lte_ul_channel_estimation: cyclic shift %d\n",cyclicShift);
+  int k;
+#if defined(__x86_64__) || defined(__i386__)
+  int n;
+  __m128i r1_re[12],r1_im[12],r2_re[12],r2_im[12];
+  __m128i scale128 = _mm_set1_epi16(SCALE);
+  __m128i x1,x2,re,im,y1,y2;
+
+  for (k=0; k<nb_k; k++) {
+    r1_re[k] = _mm_set1_epi32(((uint16_t)ru1[k][0]) | ((uint32_t)(uint16_t)(-ru1[k][1])<<16));
+    r1_im[k] = _mm_set1_epi32(((uint16_t)ru1[k][1]) | ((uint32_t)(uint16_t)ru1[k][0]<<16));
+    r2_re[k] = _mm_set1_epi32(((uint16_t)ru2[k][0]) | ((uint32_t)(uint16_t)(-ru2[k][1])<<16));
+    r2_im[k] = _mm_set1_epi32(((uint16_t)ru2[k][1]) | ((uint32_t)(uint16_t)ru2[k][0]<<16));
+  }
 
+  for (n=0; n<Msc_RS>>2; n++) {
+    x1 = ((__m128i *)ul_ch1)[n];
+    x2 = ((__m128i *)ul_ch2)[n];
 
-  int16_t alpha_re[12] = {32767, 28377, 16383,     0,-16384,  -28378,-32768,-28378,-16384,    -1, 16383, 28377};
-  int16_t alpha_im[12] = {0,     16383, 28377, 32767, 28377,   16383,     0,-16384,-28378,-32768,-28378,-16384};
+    for (k=0; k<nb_k; k++) {
+      re = _mm_srai_epi32(_mm_madd_epi16(x1,r1_re[k]),15);
+      im = _mm_srai_epi32(_mm_madd_epi16(x1,r1_im[k]),15);
+      y1 = _mm_packs_epi32(_mm_unpacklo_epi32(re,im),_mm_unpackhi_epi32(re,im));
+      re = _mm_srai_epi32(_mm_madd_epi16(x2,r2_re[k]),15);
+      im = _mm_srai_epi32(_mm_madd_epi16(x2,r2_im[k]),15);
+      y2 = _mm_packs_epi32(_mm_unpacklo_epi32(re,im),_mm_unpackhi_epi32(re,im));
 
-  int32_t *in_fft_ptr_0 = (int32_t*)0,*in_fft_ptr_1 = (int32_t*)0,
-           *temp_out_fft_0_ptr = (int32_t*)0,*out_fft_ptr_0 = (int32_t*)0,
-            *temp_out_fft_1_ptr = (int32_t*)0,*out_fft_ptr_1 = (int32_t*)0,
-             *temp_in_ifft_ptr = (int32_t*)0;
+      ((__m128i *)ul_ch[k])[n] = _mm_adds_epi16(_mm_slli_epi16(_mm_mulhi_epi16(y1,scale128),1),
+                                                _mm_slli_epi16(_mm_mulhi_epi16(y2,scale128),1));
+    }
+  }
 
-#if defined(__x86_64__) || defined(__i386__)
-  __m128i *rxdataF128,*ul_ref128,*ul_ch128;
-  __m128i mmtmpU0,mmtmpU1,mmtmpU2,mmtmpU3;
-#elif defined(__arm__)
-  int16x8_t *rxdataF128,*ul_ref128,*ul_ch128;
-  int32x4_t mmtmp0,mmtmp1,mmtmp_re,mmtmp_im;
+  _mm_empty();
+#else
+  int16_t tmp_estimates[Msc_RS*2] __attribute__((aligned(16)));
+
+  for (k=0; k<nb_k; k++) {
+    rotate_cpx_vector(ul_ch1,ru1[k],ul_ch[k],Msc_RS,15);
+    rotate_cpx_vector(ul_ch2,ru2[k],tmp_estimates,Msc_RS,15);
+    multadd_complex_vector_real_scalar(ul_ch[k],SCALE,ul_ch[k],1,Msc_RS);
+    multadd_complex_vector_real_scalar(tmp_estimates,SCALE,ul_ch[k],0,Msc_RS);
+  }
 #endif
-  Msc_RS = N_rb_alloc*12;
+}
+
+// DMRS base sequence and cyclic shift of UE_id in slot Ns, NULL if Msc_RS is not a DFT size
+static int16_t *lte_ul_dmrs_ref(PHY_VARS_eNB *phy_vars_eNB,
+                                uint8_t UE_id,
+                                uint8_t harq_pid,
+                                int subframe,
+                                unsigned char Ns,
+                                uint8_t *cyclic_shift)
+{
+
+  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
+  uint32_t u=frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.grouphop[Ns+(subframe<<1)];
+  uint32_t v=frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.seqhop[Ns+(subframe<<1)];
+  uint16_t Msc_RS = phy_vars_eNB->ulsch_eNB[UE_id]->harq_processes[harq_pid]->nb_rb*12;
+  uint16_t Msc_RS_idx=0;
+  uint16_t * Msc_idx_ptr;
 
-  cyclic_shift = (frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.cyclicShift +
-                  phy_vars_eNB->ulsch_eNB[UE_id]->harq_processes[harq_pid]->n_DMRS2 +
-                  frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.nPRS[(subframe<<1)+Ns]) % 12;
+  *cyclic_shift = (frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.cyclicShift +
+                   phy_vars_eNB->ulsch_eNB[UE_id]->harq_processes[harq_pid]->n_DMRS2 +
+                   frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.nPRS[(subframe<<1)+Ns]) % 12;
 
 #if defined(USER_MODE)
   Msc_idx_ptr = (uint16_t*) bsearch(&Msc_RS, dftsizes, 33, sizeof(uint16_t), compareints);
@@ -126,7 +160,7 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
     Msc_RS_idx = Msc_idx_ptr - dftsizes;
   else {
     msg("lte_ul_channel_estimation: index for Msc_RS=%d not found\n",Msc_RS);
-    return(-1);
+    return(NULL);
   }
 
 #else
@@ -138,7 +172,7 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
 
 #endif
 
-  //  LOG_I(PHY,"subframe %d, Ns %d, l %d, Msc_RS = %d, Msc_RS_idx = %d, u %d, v %d, cyclic_shift %d\n",subframe,Ns,l,Msc_RS, Msc_RS_idx,u,v,cyclic_shift);
+  //  LOG_I(PHY,"subframe %d, Ns %d, Msc_RS = %d, Msc_RS_idx = %d, u %d, v %d, cyclic_shift %d\n",subframe,Ns,Msc_RS, Msc_RS_idx,u,v,cyclic_shift);
 #ifdef DEBUG_CH
 
 #ifdef USER_MODE
@@ -151,25 +185,101 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
 #endif
 #endif
 
+  return(ul_ref_sigs_rx[u][v][Msc_RS_idx]);
+}
+
+static void lte_ul_channel_estimation_ue(PHY_VARS_eNB *phy_vars_eNB,
+                                         uint8_t eNB_id,
+                                         uint8_t UE_id,
+                                         uint8_t harq_pid,
+                                         int16_t *ul_ref,
+                                         uint8_t cyclic_shift,
+                                         unsigned char l,
+                                         unsigned char Ns,
+                                         uint8_t cooperation_flag)
+{
+
+  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
+  LTE_eNB_PUSCH *eNB_pusch_vars = phy_vars_eNB->lte_eNB_pusch_vars[UE_id];
+  int32_t **ul_ch_estimates=eNB_pusch_vars->drs_ch_estimates[eNB_id];
+  int32_t **ul_ch_estimates_time=  eNB_pusch_vars->drs_ch_estimates_time[eNB_id];
+  int32_t **ul_ch_estimates_0=  eNB_pusch_vars->drs_ch_estimates_0[eNB_id];
+  int32_t **ul_ch_estimates_1=  eNB_pusch_vars->drs_ch_estimates_1[eNB_id];
+  int32_t **rxdataF_ext=  eNB_pusch_vars->rxdataF_ext[eNB_id];
+  int16_t delta_phase = 0;
+  int16_t *ru1[12],*ru2[12],*ul_ch_k[12];
+  int16_t current_phase1,current_phase2;
+  uint16_t N_rb_alloc = phy_vars_eNB->ulsch_eNB[UE_id]->harq_processes[harq_pid]->nb_rb;
+  uint16_t aa,Msc_RS;
+  int k,nb_k,pilot_pos1 = 3 - frame_parms->Ncp, pilot_pos2 = 10 - 2*frame_parms->Ncp;
+  int16_t alpha, beta;
+  int32_t *ul_ch1=NULL, *ul_ch2=NULL;
+  int32_t *ul_ch1_0=NULL,*ul_ch2_0=NULL,*ul_ch1_1=NULL,*ul_ch2_1=NULL;
+  int16_t ul_ch_estimates_re,ul_ch_estimates_im;
+  int32_t rx_power_correction;
+
+  //uint8_t nb_antennas_rx = frame_parms->nb_antennas_tx_eNB;
+  uint8_t nb_antennas_rx = frame_parms->nb_antennas_rx;
+
+  uint32_t alpha_ind;
+
+  int symbol_offset,i,j;
+
+  int32_t *in_fft_ptr_0 = (int32_t*)0,*in_fft_ptr_1 = (int32_t*)0,
+           *temp_out_fft_0_ptr = (int32_t*)0,*out_fft_ptr_0 = (int32_t*)0,
+            *temp_out_fft_1_ptr = (int32_t*)0,*out_fft_ptr_1 = (int32_t*)0,
+             *temp_in_ifft_ptr = (int32_t*)0;
+
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i *rxdataF128,*ul_ref128,*ul_ch128;
+  __m128i mmtmpU0,mmtmpU1,mmtmpU2,mmtmpU3;
+  // (alpha_re,alpha_im), (0,alpha_re) and (alpha_im,0) of the 12 REs of an RB, the cyclic shift has period 12
+  int16_t cs_re[24] __attribute__((aligned(16)));
+  int16_t cs_im0[24] __attribute__((aligned(16)));
+  int16_t cs_im1[24] __attribute__((aligned(16)));
+#elif defined(__arm__)
+  int16x8_t *rxdataF128,*ul_ref128,*ul_ch128;
+  int32x4_t mmtmp0,mmtmp1,mmtmp_re,mmtmp_im;
+#endif
+  Msc_RS = N_rb_alloc*12;
+
   rx_power_correction = 1;
 
   if (l == (3 - frame_parms->Ncp)) {
 
+#if defined(__x86_64__) || defined(__i386__)
+    alpha_ind = 0;
+
+    for (i=0; i<12; i++) {
+      cs_re[i<<1]      = ul_cs_alpha_re[alpha_ind];
+      cs_re[1+(i<<1)]  = ul_cs_alpha_im[alpha_ind];
+      cs_im0[i<<1]     = 0;
+      cs_im0[1+(i<<1)] = ul_cs_alpha_re[alpha_ind];
+      cs_im1[i<<1]     = ul_cs_alpha_im[alpha_ind];
+      cs_im1[1+(i<<1)] = 0;
+
+      alpha_ind+=cyclic_shift;
+
+      if (alpha_ind>11)
+        alpha_ind-=12;
+    }
+
+#endif
+
     symbol_offset = frame_parms->N_RB_UL*12*(l+((7-frame_parms->Ncp)*(Ns&1)));
 
     for (aa=0; aa<nb_antennas_rx; aa++) {
-      //           msg("Componentwise prod aa %d, symbol_offset %d,ul_ch_estimates %p,ul_ch_estimates[aa] %p,ul_ref_sigs_rx[0][0][Msc_RS_idx] %p\n",aa,symbol_offset,ul_ch_estimates,ul_ch_estimates[aa],ul_ref_sigs_rx[0][0][Msc_RS_idx]);
+      //           msg("Componentwise prod aa %d, symbol_offset %d,ul_ch_estimates %p,ul_ch_estimates[aa] %p,ul_ref %p\n",aa,symbol_offset,ul_ch_estimates,ul_ch_estimates[aa],ul_ref);
 
 #if defined(__x86_64__) || defined(__i386__)
       rxdataF128 = (__m128i *)&rxdataF_ext[aa][symbol_offset];
       ul_ch128   = (__m128i *)&ul_ch_estimates[aa][symbol_offset];
-      ul_ref128  = (__m128i *)ul_ref_sigs_rx[u][v][Msc_RS_idx];
+      ul_ref128  = (__m128i *)ul_ref;
 #elif defined(__arm__)
       rxdataF128 = (int16x8_t *)&rxdataF_ext[aa][symbol_offset];
       ul_ch128   = (int16x8_t *)&ul_ch_estimates[aa][symbol_offset];
-      ul_ref128  = (int16x8_t *)ul_ref_sigs_rx[u][v][Msc_RS_idx];
+      ul_ref128  = (int16x8_t *)ul_ref;
 #endif
-
       for (i=0; i<Msc_RS/12; i++) {
 #if defined(__x86_64__) || defined(__i386__)
         // multiply by conjugated channel
@@ -215,6 +325,13 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
         mmtmpU3 = _mm_unpackhi_epi32(mmtmpU0,mmtmpU1);
 
         ul_ch128[2] = _mm_packs_epi32(mmtmpU2,mmtmpU3);
+
+        if (cyclic_shift != 0) {
+          // Compensating for the phase shift introduced at the transmitter
+          ul_ch128[0] = lte_ul_cs_comp128(ul_ch128[0],((__m128i *)cs_re)[0],((__m128i *)cs_im0)[0],((__m128i *)cs_im1)[0]);
+          ul_ch128[1] = lte_ul_cs_comp128(ul_ch128[1],((__m128i *)cs_re)[1],((__m128i *)cs_im0)[1],((__m128i *)cs_im1)[1]);
+          ul_ch128[2] = lte_ul_cs_comp128(ul_ch128[2],((__m128i *)cs_re)[2],((__m128i *)cs_im0)[2],((__m128i *)cs_im1)[2]);
+        }
 #elif defined(__arm__)
       mmtmp0 = vmull_s16(((int16x4_t*)ul_ref128)[0],((int16x4_t*)rxdataF128)[0]);
       mmtmp1 = vmull_s16(((int16x4_t*)ul_ref128)[1],((int16x4_t*)rxdataF128)[1]);
@@ -264,71 +381,60 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
         rxdataF128+=3;
       }
 
+
+#if defined(__arm__)
       alpha_ind = 0;
 
       if((cyclic_shift != 0)) {
-        // Compensating for the phase shift introduced at the transmitte
-#ifdef DEBUG_CH
-        write_output("drs_est_pre.m","drsest_pre",ul_ch_estimates[0],300*12,1,1);
-#endif
-
+        // Compensating for the phase shift introduced at the transmitter
         for(i=symbol_offset; i<symbol_offset+Msc_RS; i++) {
           ul_ch_estimates_re = ((int16_t*) ul_ch_estimates[aa])[i<<1];
           ul_ch_estimates_im = ((int16_t*) ul_ch_estimates[aa])[(i<<1)+1];
-          //    ((int16_t*) ul_ch_estimates[aa])[i<<1] =  (i%2 == 1? 1:-1) * ul_ch_estimates_re;
           ((int16_t*) ul_ch_estimates[aa])[i<<1] =
-            (int16_t) (((int32_t) (alpha_re[alpha_ind]) * (int32_t) (ul_ch_estimates_re) +
-                        (int32_t) (alpha_im[alpha_ind]) * (int32_t) (ul_ch_estimates_im))>>15);
+            (int16_t) (((int32_t) (ul_cs_alpha_re[alpha_ind]) * (int32_t) (ul_ch_estimates_re) +
+                        (int32_t) (ul_cs_alpha_im[alpha_ind]) * (int32_t) (ul_ch_estimates_im))>>15);
 
-          //((int16_t*) ul_ch_estimates[aa])[(i<<1)+1] =  (i%2 == 1? 1:-1) * ul_ch_estimates_im;
           ((int16_t*) ul_ch_estimates[aa])[(i<<1)+1] =
-            (int16_t) (((int32_t) (alpha_re[alpha_ind]) * (int32_t) (ul_ch_estimates_im) -
-                        (int32_t) (alpha_im[alpha_ind]) * (int32_t) (ul_ch_estimates_re))>>15);
+            (int16_t) (((int32_t) (ul_cs_alpha_re[alpha_ind]) * (int32_t) (ul_ch_estimates_im) -
+                        (int32_t) (ul_cs_alpha_im[alpha_ind]) * (int32_t) (ul_ch_estimates_re))>>15);
 
           alpha_ind+=cyclic_shift;
 
           if (alpha_ind>11)
             alpha_ind-=12;
         }
+      }
 
-#ifdef DEBUG_CH
-        write_output("drs_est_post.m","drsest_post",ul_ch_estimates[0],300*12,1,1);
 #endif
-      }
 
       //copy MIMO channel estimates to temporary buffer for EMOS
       //memcpy(&ul_ch_estimates_0[aa][symbol_offset],&ul_ch_estimates[aa][symbol_offset],frame_parms->ofdm_symbol_size*sizeof(int32_t)*2);
 
-      memset(temp_in_ifft_0,0,frame_parms->ofdm_symbol_size*sizeof(int32_t));
-
       // Convert to time domain for visualization
-      for(i=0; i<Msc_RS; i++)
-        ((int32_t*)temp_in_ifft_0)[i] = ul_ch_estimates[aa][symbol_offset+i];
+      memcpy(temp_in_ifft_0,&ul_ch_estimates[aa][symbol_offset],Msc_RS*sizeof(int32_t));
+      memset(&temp_in_ifft_0[Msc_RS],0,(frame_parms->ofdm_symbol_size-Msc_RS)*sizeof(int32_t));
+
       switch(frame_parms->N_RB_DL) {
       case 6:
-	
-	idft128((int16_t*) temp_in_ifft_0,
-	       (int16_t*) ul_ch_estimates_time[aa],
-	       1);
-	break;
+        idft128((int16_t*) temp_in_ifft_0,
+                (int16_t*) ul_ch_estimates_time[aa],
+                1);
+        break;
       case 25:
-	
-	idft512((int16_t*) temp_in_ifft_0,
-	       (int16_t*) ul_ch_estimates_time[aa],
-	       1);
-	break;
+        idft512((int16_t*) temp_in_ifft_0,
+                (int16_t*) ul_ch_estimates_time[aa],
+                1);
+        break;
       case 50:
-	
-	idft1024((int16_t*) temp_in_ifft_0,
-	       (int16_t*) ul_ch_estimates_time[aa],
-	       1);
-	break;
+        idft1024((int16_t*) temp_in_ifft_0,
+                 (int16_t*) ul_ch_estimates_time[aa],
+                 1);
+        break;
       case 100:
-	
-	idft2048((int16_t*) temp_in_ifft_0,
-	       (int16_t*) ul_ch_estimates_time[aa],
-	       1);
-	break;
+        idft2048((int16_t*) temp_in_ifft_0,
+                 (int16_t*) ul_ch_estimates_time[aa],
+                 1);
+        break;
       }
 
 #ifdef DEBUG_CH
@@ -344,7 +450,6 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
 
 #endif
 
-
       if(cooperation_flag == 2) {
         memset(temp_in_ifft_0,0,frame_parms->ofdm_symbol_size*sizeof(int32_t*)*2);
         memset(temp_in_ifft_1,0,frame_parms->ofdm_symbol_size*sizeof(int32_t*)*2);
@@ -368,13 +473,13 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
           ul_ch_estimates_im = ((int16_t*) ul_ch_estimates[aa])[(i<<1)+1];
           //    ((int16_t*) ul_ch_estimates[aa])[i<<1] =  (i%2 == 1? 1:-1) * ul_ch_estimates_re;
           ((int16_t*) ul_ch_estimates[aa])[i<<1] =
-            (int16_t) (((int32_t) (alpha_re[alpha_ind]) * (int32_t) (ul_ch_estimates_re) +
-                        (int32_t) (alpha_im[alpha_ind]) * (int32_t) (ul_ch_estimates_im))>>15);
+            (int16_t) (((int32_t) (ul_cs_alpha_re[alpha_ind]) * (int32_t) (ul_ch_estimates_re) +
+                        (int32_t) (ul_cs_alpha_im[alpha_ind]) * (int32_t) (ul_ch_estimates_im))>>15);
 
           //((int16_t*) ul_ch_estimates[aa])[(i<<1)+1] =  (i%2 == 1? 1:-1) * ul_ch_estimates_im;
           ((int16_t*) ul_ch_estimates[aa])[(i<<1)+1] =
-            (int16_t) (((int32_t) (alpha_re[alpha_ind]) * (int32_t) (ul_ch_estimates_im) -
-                        (int32_t) (alpha_im[alpha_ind]) * (int32_t) (ul_ch_estimates_re))>>15);
+            (int16_t) (((int32_t) (ul_cs_alpha_re[alpha_ind]) * (int32_t) (ul_ch_estimates_im) -
+                        (int32_t) (ul_cs_alpha_im[alpha_ind]) * (int32_t) (ul_ch_estimates_re))>>15);
 
           alpha_ind+=10;
 
@@ -532,6 +637,7 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
 
       }//cooperation_flag == 2
 
+
       if (Ns&1) {//we are in the second slot of the sub-frame, so do the interpolation
 
         ul_ch1 = &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*pilot_pos1];
@@ -557,88 +663,55 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
         msg("lte_ul_channel_estimation: ul_ch1 = %p, ul_ch2 = %p, pilot_pos1=%d, pilot_pos2=%d\n",ul_ch1, ul_ch2, pilot_pos1,pilot_pos2);
 #endif
 
-        for (k=0; k<frame_parms->symbols_per_tti; k++) {
+        nb_k = 0;
 
-          // we scale alpha and beta by SCALE (instead of 0x7FFF) to avoid overflows
-          alpha = (int16_t) (((int32_t) SCALE * (int32_t) (pilot_pos2-k))/(pilot_pos2-pilot_pos1));
-          beta  = (int16_t) (((int32_t) SCALE * (int32_t) (k-pilot_pos1))/(pilot_pos2-pilot_pos1));
-
-
-#ifdef DEBUG_CH
-          msg("lte_ul_channel_estimation: k=%d, alpha = %d, beta = %d\n",k,alpha,beta);
-#endif
-          //symbol_offset_subframe = frame_parms->N_RB_UL*12*k;
+        for (k=0; k<frame_parms->symbols_per_tti; k++) {
 
           // interpolate between estimates
           if ((k != pilot_pos1) && (k != pilot_pos2))  {
-            //          multadd_complex_vector_real_scalar((int16_t*) ul_ch1,alpha,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],1,Msc_RS);
-            //          multadd_complex_vector_real_scalar((int16_t*) ul_ch2,beta ,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],0,Msc_RS);
-
-            //          multadd_complex_vector_real_scalar((int16_t*) ul_ch1,SCALE,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],1,Msc_RS);
-            //          multadd_complex_vector_real_scalar((int16_t*) ul_ch2,SCALE,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],0,Msc_RS);
-            //          msg("phase = %d\n",ru[2*cmax(((delta_phase/7)*(k-3)),0)]);
-
             // the phase is linearly interpolated
             current_phase1 = (delta_phase/7)*(k-pilot_pos1);
             current_phase2 = (delta_phase/7)*(k-pilot_pos2);
             //          msg("sym: %d, current_phase1: %d, current_phase2: %d\n",k,current_phase1,current_phase2);
-            // set the right quadrant
-            (current_phase1 > 0) ? (ru1 = ru_90) : (ru1 = ru_90c);
-            (current_phase2 > 0) ? (ru2 = ru_90) : (ru2 = ru_90c);
-            // take absolute value and clip
-            current_phase1 = cmin(abs(current_phase1),127);
-            current_phase2 = cmin(abs(current_phase2),127);
-
-            //          msg("sym: %d, current_phase1: %d, ru: %d + j%d, current_phase2: %d, ru: %d + j%d\n",k,current_phase1,ru1[2*current_phase1],ru1[2*current_phase1+1],current_phase2,ru2[2*current_phase2],ru2[2*current_phase2+1]);
-
-            // rotate channel estimates by estimated phase
-            rotate_cpx_vector((int16_t*) ul_ch1,
-                              &ru1[2*current_phase1],
-                              (int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],
-                              Msc_RS,
-                              15);
-
-            rotate_cpx_vector((int16_t*) ul_ch2,
-                              &ru2[2*current_phase2],
-                              (int16_t*) &tmp_estimates[0],
-                              Msc_RS,
-                              15);
-
-            // Combine the two rotated estimates
-            multadd_complex_vector_real_scalar((int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],SCALE,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],1,Msc_RS);
-            multadd_complex_vector_real_scalar((int16_t*) &tmp_estimates[0],SCALE,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],0,Msc_RS);
-
-            /*
-            if ((k<pilot_pos1) || ((k>pilot_pos2))) {
-
-                multadd_complex_vector_real_scalar((int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],SCALE>>1,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],1,Msc_RS);
-
-                multadd_complex_vector_real_scalar((int16_t*) &tmp_estimates[0],SCALE>>1,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],0,Msc_RS);
-
-            } else {
-
-                multadd_complex_vector_real_scalar((int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],SCALE>>1,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],1,Msc_RS);
+            // set the right quadrant, take absolute value and clip
+            ru1[nb_k] = (current_phase1 > 0) ? ru_90 : ru_90c;
+            ru2[nb_k] = (current_phase2 > 0) ? ru_90 : ru_90c;
+            ru1[nb_k] += 2*cmin(abs(current_phase1),127);
+            ru2[nb_k] += 2*cmin(abs(current_phase2),127);
+            ul_ch_k[nb_k] = (int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k];
+            nb_k++;
+          }
+        }
 
-                multadd_complex_vector_real_scalar((int16_t*) &tmp_estimates[0],SCALE>>1,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],0,Msc_RS);
+        // rotate the two channel estimates by the estimated phase and combine them
+        lte_ul_interp_rotate((int16_t*) ul_ch1,
+                             (int16_t*) ul_ch2,
+                             ru1,
+                             ru2,
+                             ul_ch_k,
+                             nb_k,
+                             Msc_RS);
 
-                //              multadd_complex_vector_real_scalar((int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],alpha,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],1,Msc_RS);
+        if(cooperation_flag == 2) { // For Distributed Alamouti
+          for (k=0; k<frame_parms->symbols_per_tti; k++) {
 
-                //              multadd_complex_vector_real_scalar((int16_t*) &tmp_estimates[0],beta ,(int16_t*) &ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],0,Msc_RS);
+            // we scale alpha and beta by SCALE (instead of 0x7FFF) to avoid overflows
+            alpha = (int16_t) (((int32_t) SCALE * (int32_t) (pilot_pos2-k))/(pilot_pos2-pilot_pos1));
+            beta  = (int16_t) (((int32_t) SCALE * (int32_t) (k-pilot_pos1))/(pilot_pos2-pilot_pos1));
 
-            }
-            */
+#ifdef DEBUG_CH
+            msg("lte_ul_channel_estimation: k=%d, alpha = %d, beta = %d\n",k,alpha,beta);
+#endif
 
-            //      memcpy(&ul_ch_estimates[aa][frame_parms->N_RB_UL*12*k],ul_ch1,Msc_RS*sizeof(int32_t));
-            if(cooperation_flag == 2) { // For Distributed Alamouti
+            if ((k != pilot_pos1) && (k != pilot_pos2))  {
               multadd_complex_vector_real_scalar((int16_t*) ul_ch1_0,beta ,(int16_t*) &ul_ch_estimates_0[aa][frame_parms->N_RB_UL*12*k],1,Msc_RS);
               multadd_complex_vector_real_scalar((int16_t*) ul_ch2_0,alpha,(int16_t*) &ul_ch_estimates_0[aa][frame_parms->N_RB_UL*12*k],0,Msc_RS);
 
               multadd_complex_vector_real_scalar((int16_t*) ul_ch1_1,beta ,(int16_t*) &ul_ch_estimates_1[aa][frame_parms->N_RB_UL*12*k],1,Msc_RS);
               multadd_complex_vector_real_scalar((int16_t*) ul_ch2_1,alpha,(int16_t*) &ul_ch_estimates_1[aa][frame_parms->N_RB_UL*12*k],0,Msc_RS);
             }
-
           }
-        } //for(k=...
+        }
 
         // because of the scaling of alpha and beta we also need to scale the final channel estimate at the pilot positions
 
@@ -660,11 +733,70 @@ int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
 
   } //if(l==...
 
+}
 
+int32_t lte_ul_channel_estimation(PHY_VARS_eNB *phy_vars_eNB,
+                                  uint8_t eNB_id,
+                                  uint8_t UE_id,
+                                  uint8_t sched_subframe,
+                                  unsigned char l,
+                                  unsigned char Ns,
+                                  uint8_t cooperation_flag)
+{
+
+  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
+  int subframe = phy_vars_eNB->proc[sched_subframe].subframe_rx;
+  uint8_t harq_pid = subframe2harq_pid(frame_parms,phy_vars_eNB->proc[sched_subframe].frame_rx,subframe);
+  uint8_t cyclic_shift;
+  int16_t *ul_ref;
+
+  if (l != (3 - frame_parms->Ncp))
+    return(0);
+
+  ul_ref = lte_ul_dmrs_ref(phy_vars_eNB,UE_id,harq_pid,subframe,Ns,&cyclic_shift);
+
+  if (ul_ref == NULL)
+    return(-1);
+
+  lte_ul_channel_estimation_ue(phy_vars_eNB,eNB_id,UE_id,harq_pid,ul_ref,cyclic_shift,l,Ns,cooperation_flag);
 
   return(0);
 }
 
+int32_t lte_ul_channel_estimation_multi(PHY_VARS_eNB *phy_vars_eNB,
+                                        uint8_t *eNB_id,
+                                        uint8_t *UE_list,
+                                        uint8_t nb_UE,
+                                        uint8_t sched_subframe,
+                                        unsigned char l,
+                                        unsigned char Ns)
+{
+
+  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
+  int subframe = phy_vars_eNB->proc[sched_subframe].subframe_rx;
+  uint8_t harq_pid = subframe2harq_pid(frame_parms,phy_vars_eNB->proc[sched_subframe].frame_rx,subframe);
+  uint8_t cyclic_shift;
+  int16_t *ul_ref;
+  int32_t ret = 0;
+  int n;
+
+  if (l != (3 - frame_parms->Ncp))
+    return(0);
+
+  for (n=0; n<nb_UE; n++) {
+    ul_ref = lte_ul_dmrs_ref(phy_vars_eNB,UE_list[n],harq_pid,subframe,Ns,&cyclic_shift);
+
+    if (ul_ref == NULL) {
+      ret = -1;
+      continue;
+    }
+
+    lte_ul_channel_estimation_ue(phy_vars_eNB,eNB_id[UE_list[n]],UE_list[n],harq_pid,ul_ref,cyclic_shift,l,Ns,0);
+  }
+
+  return(ret);
+}
+
 extern uint16_t transmission_offset_tdd[16];
 #define DEBUG_SRS
 
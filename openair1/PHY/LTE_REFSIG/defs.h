@@ -44,6 +44,27 @@
 */
 unsigned int lte_gold_generic(unsigned int *x1, unsigned int *x2, unsigned char reset);
 
+/*! \brief Precomputes the jump-ahead matrices of the gold sequence generator. Until it is called,
+lte_gold_generic() runs the 1600-bit warm-up of each reset step by step.
+*/
+void lte_gold_init(void);
+
+/*! \brief gold sequence generator starting at an arbitrary position, in O(log n) with the jump-ahead matrices
+\param x1 generator state, to be passed to the next calls of lte_gold_generic(x1,x2,0)
+\param x2 generator state
+\param c_init initialization of the second m-sequence
+\param n index of the first 32-bit word returned
+\return word n (bits 32n..32n+31) of the gold sequence
+*/
+uint32_t lte_gold_seek(uint32_t *x1, uint32_t *x2, uint32_t c_init, uint32_t n);
+
+/*! \brief Gold sequence for scrambling (36-211 Sec 7.2), kept in a per-thread LRU cache indexed by c_init
+\param c_init initialization of the second m-sequence (rnti, q, slot and cell id for the PDSCH/PUSCH)
+\param nb_words number of 32-bit words needed, bit j of word i is c(32i+j)
+\return pointer to the sequence, valid in the calling thread until its next call, the sequences are freed when the thread exits
+*/
+uint32_t *lte_gold_scrambling_sequence(uint32_t c_init, uint32_t nb_words);
+
 
 /*!\brief This function generates the LTE Gold sequence (36-211, Sec 7.2), specifically for DL reference signals.
 @param frame_parms LTE DL Frame parameters
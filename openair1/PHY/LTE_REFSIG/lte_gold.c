@@ -65,27 +65,10 @@ void lte_gold(LTE_DL_FRAME_PARMS *frame_parms,uint32_t lte_gold_table[20][2][14]
       //x2 = frame_parms->Ncp + (Nid_cell<<1) + (1+(Nid_cell<<1))*(1 + (3*l) + (7*(1+ns))); //cinit
       //n = 0
       //      printf("cinit (ns %d, l %d) => %d\n",ns,l,x2);
-      x1 = 1+ (1<<31);
-      x2=x2 ^ ((x2 ^ (x2>>1) ^ (x2>>2) ^ (x2>>3))<<31);
-
-      // skip first 50 double words (1600 bits)
-      //printf("n=0 : x1 %x, x2 %x\n",x1,x2);
-      for (n=1; n<50; n++) {
-        x1 = (x1>>1) ^ (x1>>4);
-        x1 = x1 ^ (x1<<31) ^ (x1<<28);
-        x2 = (x2>>1) ^ (x2>>2) ^ (x2>>3) ^ (x2>>4);
-        x2 = x2 ^ (x2<<31) ^ (x2<<30) ^ (x2<<29) ^ (x2<<28);
-        //  printf("x1 : %x, x2 : %x\n",x1,x2);
-      }
+      lte_gold_table[ns][l][0] = lte_gold_generic(&x1,&x2,1);
 
-      for (n=0; n<14; n++) {
-        x1 = (x1>>1) ^ (x1>>4);
-        x1 = x1 ^ (x1<<31) ^ (x1<<28);
-        x2 = (x2>>1) ^ (x2>>2) ^ (x2>>3) ^ (x2>>4);
-        x2 = x2 ^ (x2<<31) ^ (x2<<30) ^ (x2<<29) ^ (x2<<28);
-        lte_gold_table[ns][l][n] = x1^x2;
-        //  printf("n=%d : c %x\n",n,x1^x2);
-      }
+      for (n=1; n<14; n++)
+        lte_gold_table[ns][l][n] = lte_gold_generic(&x1,&x2,0);
 
     }
 
@@ -115,33 +98,95 @@ void lte_gold_ue_spec(LTE_DL_FRAME_PARMS *frame_parms,uint32_t lte_gold_uespec_t
         //x2 = frame_parms->Ncp + (Nid_cell<<1) + (1+(Nid_cell<<1))*(1 + (3*l) + (7*(1+ns))); //cinit
         //n = 0
         //      printf("cinit (ns %d, l %d) => %d\n",ns,l,x2);
-        x1 = 1+ (1<<31);
-        x2=x2 ^ ((x2 ^ (x2>>1) ^ (x2>>2) ^ (x2>>3))<<31);
-
-        // skip first 50 double words (1600 bits)
-        //printf("n=0 : x1 %x, x2 %x\n",x1,x2);
-        for (n=1; n<50; n++) {
-          x1 = (x1>>1) ^ (x1>>4);
-          x1 = x1 ^ (x1<<31) ^ (x1<<28);
-          x2 = (x2>>1) ^ (x2>>2) ^ (x2>>3) ^ (x2>>4);
-          x2 = x2 ^ (x2<<31) ^ (x2<<30) ^ (x2<<29) ^ (x2<<28);
-          //  printf("x1 : %x, x2 : %x\n",x1,x2);
-        }
-
-        for (n=0; n<14; n++) {
-          x1 = (x1>>1) ^ (x1>>4);
-          x1 = x1 ^ (x1<<31) ^ (x1<<28);
-          x2 = (x2>>1) ^ (x2>>2) ^ (x2>>3) ^ (x2>>4);
-          x2 = x2 ^ (x2<<31) ^ (x2<<30) ^ (x2<<29) ^ (x2<<28);
-          lte_gold_uespec_table[nscid][ns][l][n] = x1^x2;
-          //  printf("n=%d : c %x\n",n,x1^x2);
-        }
+        lte_gold_uespec_table[nscid][ns][l][0] = lte_gold_generic(&x1,&x2,1);
+
+        for (n=1; n<14; n++)
+          lte_gold_uespec_table[nscid][ns][l][n] = lte_gold_generic(&x1,&x2,0);
 
       }
     }
   }
 }
 
+static inline uint32_t lte_gold_x1_step(uint32_t x1)
+{
+  x1 = (x1>>1) ^ (x1>>4);
+  return(x1 ^ (x1<<31) ^ (x1<<28));
+}
+
+static inline uint32_t lte_gold_x2_step(uint32_t x2)
+{
+  x2 = (x2>>1) ^ (x2>>2) ^ (x2>>3) ^ (x2>>4);
+  return(x2 ^ (x2<<31) ^ (x2<<30) ^ (x2<<29) ^ (x2<<28));
+}
+
+// Jump-ahead. Both m-sequences are linear over GF(2), so advancing a register by any number of
+// words is a 32x32 binary matrix product. lte_gold_jump_x1/x2[k] hold the columns of the matrix
+// advancing by 2^k words, and lte_gold_x2_init[j][b] the x2 register producing the first word
+// of the sequence for c_init=b<<(8j) (the 1600-bit warm-up included), so that a reset costs
+// four table lookups instead of 50 generator steps.
+#define LTE_GOLD_JUMP_LOG2 12
+
+static uint32_t lte_gold_jump_x1[LTE_GOLD_JUMP_LOG2][32];
+static uint32_t lte_gold_jump_x2[LTE_GOLD_JUMP_LOG2][32];
+static uint32_t lte_gold_x2_init[4][256];
+static uint32_t lte_gold_x1_init;
+static int lte_gold_jump_ready = 0;
+
+static inline uint32_t lte_gold_gf2_apply(const uint32_t *m, uint32_t x)
+{
+  uint32_t y=0;
+  int i;
+
+  for (i=0; x!=0; i++,x>>=1)
+    if (x&1)
+      y ^= m[i];
+
+  return(y);
+}
+
+// x2 register producing the first word of the sequence, by running the generator
+static uint32_t lte_gold_x2_reset(uint32_t c_init)
+{
+  uint32_t x2 = c_init ^ ((c_init ^ (c_init>>1) ^ (c_init>>2) ^ (c_init>>3))<<31);
+  int n;
+
+  for (n=0; n<50; n++)
+    x2 = lte_gold_x2_step(x2);
+
+  return(x2);
+}
+
+void lte_gold_init(void)
+{
+  int i,j,k;
+
+  if (lte_gold_jump_ready == 1)
+    return;
+
+  for (i=0; i<32; i++) {
+    lte_gold_jump_x1[0][i] = lte_gold_x1_step(1U<<i);
+    lte_gold_jump_x2[0][i] = lte_gold_x2_step(1U<<i);
+  }
+
+  for (k=1; k<LTE_GOLD_JUMP_LOG2; k++)
+    for (i=0; i<32; i++) {
+      lte_gold_jump_x1[k][i] = lte_gold_gf2_apply(lte_gold_jump_x1[k-1],lte_gold_jump_x1[k-1][i]);
+      lte_gold_jump_x2[k][i] = lte_gold_gf2_apply(lte_gold_jump_x2[k-1],lte_gold_jump_x2[k-1][i]);
+    }
+
+  lte_gold_x1_init = 1+(1U<<31);
+
+  for (i=0; i<50; i++)
+    lte_gold_x1_init = lte_gold_x1_step(lte_gold_x1_init);
+
+  for (j=0; j<4; j++)
+    for (i=0; i<256; i++)
+      lte_gold_x2_init[j][i] = lte_gold_x2_reset((uint32_t)i<<(j<<3));
+
+  lte_gold_jump_ready = 1;
+}
+
 /*! \brief gold sequenquence generator
 \param x1
 \param x2 this should be set to c_init if reset=1
@@ -153,6 +198,15 @@ unsigned int lte_gold_generic(unsigned int *x1, unsigned int *x2, unsigned char
   int n;
 
   if (reset) {
+    if (lte_gold_jump_ready == 1) {
+      *x1 = lte_gold_x1_init;
+      *x2 = lte_gold_x2_init[0][*x2&0xff] ^
+            lte_gold_x2_init[1][(*x2>>8)&0xff] ^
+            lte_gold_x2_init[2][(*x2>>16)&0xff] ^
+            lte_gold_x2_init[3][*x2>>24];
+      return(*x1^*x2);
+    }
+
     *x1 = 1+ (1<<31);
     *x2=*x2 ^ ((*x2 ^ (*x2>>1) ^ (*x2>>2) ^ (*x2>>3))<<31);
 
@@ -175,6 +229,132 @@ unsigned int lte_gold_generic(unsigned int *x1, unsigned int *x2, unsigned char
 
 }
 
+uint32_t lte_gold_seek(uint32_t *x1, uint32_t *x2, uint32_t c_init, uint32_t n)
+{
+  int k;
+
+  *x2 = c_init;
+  lte_gold_generic(x1,x2,1);
+
+  if (lte_gold_jump_ready == 0) {
+    for (; n>0; n--)
+      lte_gold_generic(x1,x2,0);
+
+    return(*x1^*x2);
+  }
+
+  for (k=0; (n!=0) && (k<LTE_GOLD_JUMP_LOG2-1); k++,n>>=1)
+    if (n&1) {
+      *x1 = lte_gold_gf2_apply(lte_gold_jump_x1[k],*x1);
+      *x2 = lte_gold_gf2_apply(lte_gold_jump_x2[k],*x2);
+    }
+
+  // what is left is a number of jumps by the largest power of two
+  for (; n>0; n--) {
+    *x1 = lte_gold_gf2_apply(lte_gold_jump_x1[LTE_GOLD_JUMP_LOG2-1],*x1);
+    *x2 = lte_gold_gf2_apply(lte_gold_jump_x2[LTE_GOLD_JUMP_LOG2-1],*x2);
+  }
+
+  return(*x1^*x2);
+}
+
+
+// Scrambling sequences (36-211 Sec 7.2) of the last c_init values seen by each thread, least
+// recently used first out. The eNB TX/RX threads each handle one subframe, so the sequence of a
+// (rnti,q,subframe,cell) comes back every frame in the same thread and is found here instead of
+// being regenerated, as long as less than LTE_GOLD_CACHE_SIZE sequences were used in between.
+#define LTE_GOLD_CACHE_SIZE 32
+
+typedef struct {
+  uint32_t c_init;
+  uint32_t nb_words;
+  uint32_t max_words;
+  uint32_t last_use;
+  uint32_t x1,x2;
+  uint32_t *s;
+} lte_gold_cache_entry_t;
+
+static __thread lte_gold_cache_entry_t lte_gold_cache[LTE_GOLD_CACHE_SIZE];
+static __thread uint32_t lte_gold_cache_time;
+
+// the sequences of a thread are freed when it exits, through the destructor of this key
+static pthread_key_t lte_gold_cache_key;
+static pthread_once_t lte_gold_cache_once = PTHREAD_ONCE_INIT;
+
+static void lte_gold_cache_free(void *cache)
+{
+
+  lte_gold_cache_entry_t *entry = (lte_gold_cache_entry_t *)cache;
+  int i;
+
+  for (i=0; i<LTE_GOLD_CACHE_SIZE; i++) {
+    free(entry[i].s);
+    entry[i].s         = NULL;
+    entry[i].nb_words  = 0;
+    entry[i].max_words = 0;
+  }
+}
+
+static void lte_gold_cache_key_create(void)
+{
+
+  AssertFatal(pthread_key_create(&lte_gold_cache_key,lte_gold_cache_free) == 0,"lte_gold_scrambling_sequence: cannot create the cache key\n");
+}
+
+uint32_t *lte_gold_scrambling_sequence(uint32_t c_init, uint32_t nb_words)
+{
+
+  lte_gold_cache_entry_t *entry=NULL,*lru=&lte_gold_cache[0];
+  uint32_t n;
+  int i;
+
+  for (i=0; i<LTE_GOLD_CACHE_SIZE; i++) {
+    if ((lte_gold_cache[i].s != NULL) && (lte_gold_cache[i].c_init == c_init)) {
+      entry = &lte_gold_cache[i];
+      break;
+    }
+
+    if (lte_gold_cache[i].last_use < lru->last_use)
+      lru = &lte_gold_cache[i];
+  }
+
+  if (entry == NULL) {
+    entry = lru;
+    entry->c_init   = c_init;
+    entry->nb_words = 0;
+  }
+
+  entry->last_use = ++lte_gold_cache_time;
+
+  if (nb_words == 0)
+    nb_words = 1;
+
+  if (nb_words > entry->max_words) {
+    if (entry->s == NULL) {
+      pthread_once(&lte_gold_cache_once,lte_gold_cache_key_create);
+      pthread_setspecific(lte_gold_cache_key,lte_gold_cache);
+    }
+
+    entry->max_words = (nb_words+63)&~63;
+    entry->s = (uint32_t *)realloc(entry->s,entry->max_words*sizeof(uint32_t));
+    AssertFatal(entry->s != NULL,"lte_gold_scrambling_sequence: cannot allocate %d words\n",entry->max_words);
+  }
+
+  if (entry->nb_words == 0) {
+    entry->x2 = c_init;
+    entry->s[0] = lte_gold_generic(&entry->x1,&entry->x2,1);
+    entry->nb_words = 1;
+  }
+
+  // continue from the state after the last word generated
+  for (n=entry->nb_words; n<nb_words; n++)
+    entry->s[n] = lte_gold_generic(&entry->x1,&entry->x2,0);
+
+  if (nb_words > entry->nb_words)
+    entry->nb_words = nb_words;
+
+  return(entry->s);
+}
 
 
 #ifdef LTE_GOLD_MAIN
@@ -71,30 +71,10 @@ void lte_gold_mbsfn(LTE_DL_FRAME_PARMS *frame_parms,uint32_t lte_gold_mbsfn_tabl
 
       // Initializing the Sequence
 
-      x1 = 1+ (1<<31);
-      x2=x2 ^ ((x2 ^ (x2>>1) ^ (x2>>2) ^ (x2>>3))<<31);
-      // skip first 50 double words (1600 bits)
-      //      printf("n=0 : x1 %x, x2 %x\n",x1,x2);
-
-      for (n=1; n<50; n++) {
-
-        x1 = (x1>>1) ^ (x1>>4);
-        x1 = x1 ^ (x1<<31) ^ (x1<<28);
-        x2 = (x2>>1) ^ (x2>>2) ^ (x2>>3) ^ (x2>>4);
-        x2 = x2 ^ (x2<<31) ^ (x2<<30) ^ (x2<<29) ^ (x2<<28);
-        //  printf("x1 : %x, x2 : %x\n",x1,x2);
-
-      }
-
-      for (n=0; n<42; n++) {
-
-        x1 = (x1>>1) ^ (x1>>4);
-        x1 = x1 ^ (x1<<31) ^ (x1<<28);
-        x2 = (x2>>1) ^ (x2>>2) ^ (x2>>3) ^ (x2>>4);
-        x2 = x2 ^ (x2<<31) ^ (x2<<30) ^ (x2<<29) ^ (x2<<28);
-        lte_gold_mbsfn_table[sfn][l][n] = x1^x2;
-        //  printf("n=%d : c %x\n",n,x1^x2);
-      }
+      lte_gold_mbsfn_table[sfn][l][0] = lte_gold_generic(&x1,&x2,1);
+
+      for (n=1; n<42; n++)
+        lte_gold_mbsfn_table[sfn][l][n] = lte_gold_generic(&x1,&x2,0);
 
     }
 
@@ -1906,26 +1906,13 @@ void pdcch_scrambling(LTE_DL_FRAME_PARMS *frame_parms,
                       uint8_t *e,
                       uint32_t length)
 {
-  int i;
-  uint8_t reset;
-  uint32_t x1, x2, s=0;
 
-  reset = 1;
-  // x1 is set in lte_gold_generic
+  uint32_t x2;
 
   x2 = (subframe<<9) + frame_parms->Nid_cell; //this is c_init in 36.211 Sec 6.8.2
 
-  for (i=0; i<length; i++) {
-    if ((i&0x1f)==0) {
-      s = lte_gold_generic(&x1, &x2, reset);
-      //printf("lte_gold[%d]=%x\n",i,s);
-      reset = 0;
-    }
-
-    //    printf("scrambling %d : e %d, c %d\n",i,e[i],((s>>(i&0x1f))&1));
-    if (e[i] != 2) // <NIL> element is 2
-      e[i] = (e[i]&1) ^ ((s>>(i&0x1f))&1);
-  }
+  // <NIL> elements (2) are left untouched
+  scramble_bits(e,lte_gold_scrambling_sequence(x2,(length+31)>>5),length);
 }
 
 void pdcch_unscrambling(LTE_DL_FRAME_PARMS *frame_parms,
@@ -1934,29 +1921,11 @@ void pdcch_unscrambling(LTE_DL_FRAME_PARMS *frame_parms,
                         uint32_t length)
 {
 
-  int i;
-  uint8_t reset;
-  uint32_t x1, x2, s=0;
-
-  reset = 1;
-  // x1 is set in first call to lte_gold_generic
+  uint32_t x2;
 
   x2 = (subframe<<9) + frame_parms->Nid_cell; //this is c_init in 36.211 Sec 6.8.2
 
-  for (i=0; i<length; i++) {
-    if ((i&0x1f)==0) {
-      s = lte_gold_generic(&x1, &x2, reset);
-      //      printf("lte_gold[%d]=%x\n",i,s);
-      reset = 0;
-    }
-
-    
-    //    printf("unscrambling %d : e %d, c %d => ",i,llr[i],((s>>(i&0x1f))&1));
-    if (((s>>(i%32))&1)==0)
-      llr[i] = -llr[i];
-    //    printf("%d\n",llr[i]);
-
-  }
+  unscramble_llr8(llr,lte_gold_scrambling_sequence(x2,(length+31)>>5),length);
 }
 
 
@@ -2422,26 +2391,24 @@ uint8_t generate_dci_top_emul(PHY_VARS_eNB *phy_vars_eNB,
 #endif
 
 
-void dci_decoding(uint8_t DCI_LENGTH,
-                  uint8_t aggregation_level,
-                  int8_t *e,
-                  uint8_t *decoded_output)
+// rate dematching and sub-block deinterleaving of a PDCCH candidate, d_rx+96 is the input of the Viterbi decoder
+static int dci_dematching(uint8_t DCI_LENGTH,
+                          uint8_t aggregation_level,
+                          int8_t *e,
+                          int8_t *d_rx)
 {
 
   uint8_t dummy_w_rx[3*(MAX_DCI_SIZE_BITS+16+64)];
-  int8_t w_rx[3*(MAX_DCI_SIZE_BITS+16+32)],d_rx[96+(3*(MAX_DCI_SIZE_BITS+16))];
+  int8_t w_rx[3*(MAX_DCI_SIZE_BITS+16+32)];
 
   uint16_t RCC;
 
   uint16_t D=(DCI_LENGTH+16+64);
   uint16_t coded_bits;
-#ifdef DEBUG_DCI_DECODING
-  int32_t i;
-#endif
 
   if (aggregation_level>3) {
     LOG_I(PHY," dci.c: dci_decoding FATAL, illegal aggregation_level %d\n",aggregation_level);
-    return;
+    return(-1);
   }
 
   coded_bits = 72 * (1<<aggregation_level);
@@ -2467,6 +2434,23 @@ void dci_decoding(uint8_t DCI_LENGTH,
                               &d_rx[96],
                               &w_rx[0]);
 
+  return(0);
+}
+
+void dci_decoding(uint8_t DCI_LENGTH,
+                  uint8_t aggregation_level,
+                  int8_t *e,
+                  uint8_t *decoded_output)
+{
+
+  int8_t d_rx[96+(3*(MAX_DCI_SIZE_BITS+16))];
+#ifdef DEBUG_DCI_DECODING
+  int32_t i;
+#endif
+
+  if (dci_dematching(DCI_LENGTH,aggregation_level,e,d_rx) < 0)
+    return;
+
 #ifdef DEBUG_DCI_DECODING
 
   for (i=0; i<16+DCI_LENGTH; i++)
@@ -2543,40 +2527,28 @@ uint16_t get_nCCE_max(uint8_t Mod_id,uint8_t CC_id)
   return(get_nCCE(3,&PHY_vars_eNB_g[Mod_id][CC_id]->lte_frame_parms,1)); // 5, 15,21
 }
 
-void dci_decoding_procedure0(LTE_UE_PDCCH **lte_ue_pdcch_vars,int do_common,uint8_t subframe,
-                             DCI_ALLOC_t *dci_alloc,
-                             int16_t eNB_id,
-                             LTE_DL_FRAME_PARMS *frame_parms,
-                             uint8_t mi,
-                             uint16_t si_rnti,
-                             uint16_t ra_rnti,
-                             uint8_t L,
-                             uint8_t format_si,
-                             uint8_t format_ra,
-                             uint8_t format_c,
-                             uint8_t sizeof_bits,
-                             uint8_t sizeof_bytes,
-                             uint8_t *dci_cnt,
-                             uint8_t *format0_found,
-                             uint8_t *format_c_found,
-                             uint32_t *CCEmap0,
-                             uint32_t *CCEmap1,
-                             uint32_t *CCEmap2)
+// First CCE of the candidates of aggregation level 2^L in the common (do_common==1) or UE specific search space,
+// returns the number of candidates
+static unsigned int dci_search_space(LTE_UE_PDCCH *lte_ue_pdcch_vars,
+                                     int do_common,
+                                     uint8_t subframe,
+                                     LTE_DL_FRAME_PARMS *frame_parms,
+                                     uint8_t mi,
+                                     uint8_t L,
+                                     uint16_t *CCEind)
 {
 
-  uint16_t crc,CCEind,nCCE;
-  uint32_t *CCEmap=NULL,CCEmap_mask=0;
+  uint16_t nCCE;
   int L2=(1<<L);
   unsigned int Yk,nb_candidates = 0,i,m;
-  unsigned int CCEmap_cand;
 
-  nCCE = get_nCCE(lte_ue_pdcch_vars[eNB_id]->num_pdcch_symbols,frame_parms,mi);
+  nCCE = get_nCCE(lte_ue_pdcch_vars->num_pdcch_symbols,frame_parms,mi);
 
   if (nCCE > get_nCCE(3,frame_parms,1))
-    return;
+    return(0);
 
   if (nCCE<L2)
-    return;
+    return(0);
 
   if (do_common == 1) {
     nb_candidates = (L2==4) ? 4 : 2;
@@ -2585,7 +2557,7 @@ void dci_decoding_procedure0(LTE_UE_PDCCH **lte_ue_pdcch_vars,int do_common,uint
     // Find first available in ue specific search space
     // according to procedure in Section 9.1.1 of 36.213 (v. 8.6)
     // compute Yk
-    Yk = (unsigned int)lte_ue_pdcch_vars[eNB_id]->crnti;
+    Yk = (unsigned int)lte_ue_pdcch_vars->crnti;
 
     for (i=0; i<=subframe; i++)
       Yk = (Yk*39827)%65537;
@@ -2604,21 +2576,123 @@ void dci_decoding_procedure0(LTE_UE_PDCCH **lte_ue_pdcch_vars,int do_common,uint
       break;
 
     default:
-      DevParam(L2, do_common, eNB_id);
+      DevParam(L2, do_common, subframe);
       break;
     }
   }
 
-  /*  for (CCEind=0;
-       CCEind<nCCE2;
-       CCEind+=(1<<L)) {*/
-
   if (nb_candidates*L2 > nCCE)
     nb_candidates = nCCE/L2;
 
+  for (m=0; m<nb_candidates; m++)
+    CCEind[m] = (((Yk+m)%(nCCE/L2))*L2);
+
+  return(nb_candidates);
+}
+
+// The candidates of the current dci_decoding_procedure() call already decoded by dci_decode_candidates() are kept in
+// lte_ue_pdcch_vars->dci_candidates, per UE and eNB like the rest of the PDCCH state
+static LTE_UE_DCI_CANDIDATE *dci_candidate_find(LTE_UE_PDCCH *lte_ue_pdcch_vars,uint8_t sizeof_bits,uint8_t L,uint16_t CCEind)
+{
+
+  LTE_UE_DCI_CANDIDATE *cand = lte_ue_pdcch_vars->dci_candidates;
+  int i;
+
+  for (i=0; i<lte_ue_pdcch_vars->nb_dci_candidates; i++)
+    if ((cand[i].CCEind == CCEind) &&
+        (cand[i].L == L) &&
+        (cand[i].sizeof_bits == sizeof_bits))
+      return(&cand[i]);
+
+  return(NULL);
+}
+
+// copies the Viterbi output of a candidate decoded by dci_decode_candidates(), returns 0 if it was not
+static int dci_candidate_output(LTE_UE_PDCCH *lte_ue_pdcch_vars,uint8_t sizeof_bits,uint8_t L,uint16_t CCEind,uint8_t *decoded_output)
+{
+
+  LTE_UE_DCI_CANDIDATE *cand = dci_candidate_find(lte_ue_pdcch_vars,sizeof_bits,L,CCEind);
+
+  if (cand == NULL)
+    return(0);
+
+  memcpy(decoded_output,cand->decoded_output,2+((16+sizeof_bits)>>3));
+  return(1);
+}
+
+// Viterbi decoding of the candidates of a search space in one phy_viterbi_lte_batch() call, skipping those already decoded in this subframe
+// (the common and UE specific search spaces overlap at aggregation levels 4 and 8, and formats 0 and 1A have the same size)
+static void dci_decode_candidates(LTE_UE_PDCCH *lte_ue_pdcch_vars,
+                                  uint8_t L,
+                                  uint8_t sizeof_bits,
+                                  unsigned int nb_candidates,
+                                  uint16_t *CCEind)
+{
+
+  int8_t d_rx[6][96+(3*(MAX_DCI_SIZE_BITS+16))];
+  int8_t *y[6];
+  uint8_t *decoded_output[6];
+  unsigned int m;
+  int nb_cw=0;
+  LTE_UE_DCI_CANDIDATE *cand;
+
+  for (m=0; m<nb_candidates; m++) {
+    if ((CCEind[m] >= 96) ||
+        (lte_ue_pdcch_vars->nb_dci_candidates == MAX_DCI_CANDIDATES) ||
+        (dci_candidate_find(lte_ue_pdcch_vars,sizeof_bits,L,CCEind[m]) != NULL))
+      continue;
+
+    if (dci_dematching(sizeof_bits,L,&lte_ue_pdcch_vars->e_rx[CCEind[m]*72],d_rx[nb_cw]) < 0)
+      continue;
+
+    cand = &lte_ue_pdcch_vars->dci_candidates[lte_ue_pdcch_vars->nb_dci_candidates++];
+    cand->CCEind      = CCEind[m];
+    cand->L           = L;
+    cand->sizeof_bits = sizeof_bits;
+    memset(cand->decoded_output,0,2+((16+sizeof_bits)>>3));
+
+    y[nb_cw]              = d_rx[nb_cw]+96;
+    decoded_output[nb_cw] = cand->decoded_output;
+    nb_cw++;
+  }
+
+  phy_viterbi_lte_batch(y,decoded_output,16+sizeof_bits,nb_cw);
+}
+
+void dci_decoding_procedure0(LTE_UE_PDCCH **lte_ue_pdcch_vars,int do_common,uint8_t subframe,
+                             DCI_ALLOC_t *dci_alloc,
+                             int16_t eNB_id,
+                             LTE_DL_FRAME_PARMS *frame_parms,
+                             uint8_t mi,
+                             uint16_t si_rnti,
+                             uint16_t ra_rnti,
+                             uint8_t L,
+                             uint8_t format_si,
+                             uint8_t format_ra,
+                             uint8_t format_c,
+                             uint8_t sizeof_bits,
+                             uint8_t sizeof_bytes,
+                             uint8_t *dci_cnt,
+                             uint8_t *format0_found,
+                             uint8_t *format_c_found,
+                             uint32_t *CCEmap0,
+                             uint32_t *CCEmap1,
+                             uint32_t *CCEmap2)
+{
+
+  uint16_t crc,CCEind,CCEind_cand[6];
+  uint32_t *CCEmap=NULL,CCEmap_mask=0;
+  int L2=(1<<L);
+  unsigned int nb_candidates,m;
+  unsigned int CCEmap_cand;
+
+  nb_candidates = dci_search_space(lte_ue_pdcch_vars[eNB_id],do_common,subframe,frame_parms,mi,L,CCEind_cand);
+
+  dci_decode_candidates(lte_ue_pdcch_vars[eNB_id],L,sizeof_bits,nb_candidates,CCEind_cand);
+
   for (m=0; m<nb_candidates; m++) {
 
-    CCEind = (((Yk+m)%(nCCE/L2))*L2);
+    CCEind = CCEind_cand[m];
 
     if (CCEind<32)
       CCEmap = CCEmap0;
@@ -2627,7 +2701,7 @@ void dci_decoding_procedure0(LTE_UE_PDCCH **lte_ue_pdcch_vars,int do_common,uint
     else if (CCEind<96)
       CCEmap = CCEmap2;
     else {
-      LOG_E(PHY,"Illegal CCEind %d (Yk %d, m %d, nCCE %d, L2 %d\n",CCEind,Yk,m,nCCE,L2);
+      LOG_E(PHY,"Illegal CCEind %d (m %d, L2 %d)\n",CCEind,m,L2);
       mac_xface->macphy_exit("Illegal CCEind\n");
       return; // not reached
     }
@@ -2669,10 +2743,11 @@ void dci_decoding_procedure0(LTE_UE_PDCCH **lte_ue_pdcch_vars,int do_common,uint
 
 #endif
 
-      dci_decoding(sizeof_bits,
-                   L,
-                   &lte_ue_pdcch_vars[eNB_id]->e_rx[CCEind*72],
-                   dci_decoded_output);
+      if (dci_candidate_output(lte_ue_pdcch_vars[eNB_id],sizeof_bits,L,CCEind,dci_decoded_output) == 0)
+        dci_decoding(sizeof_bits,
+                     L,
+                     &lte_ue_pdcch_vars[eNB_id]->e_rx[CCEind*72],
+                     dci_decoded_output);
       /*
         for (i=0;i<3+(sizeof_bits>>3);i++)
         printf("dci_decoded_output[%d] => %x\n",i,dci_decoded_output[i]);
@@ -2804,6 +2879,9 @@ uint16_t dci_decoding_procedure(PHY_VARS_UE *phy_vars_ue,
   uint8_t format2_size_bits=0,format2_size_bytes=0;
   uint8_t format2A_size_bits=0,format2A_size_bytes=0;
 
+  // the candidates decoded by dci_decode_candidates() are those of this subframe only
+  lte_ue_pdcch_vars[eNB_id]->nb_dci_candidates = 0;
+
   switch (frame_parms->N_RB_DL) {
   case 6:
     if (frame_type == TDD) {
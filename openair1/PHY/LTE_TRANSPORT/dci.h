@@ -2917,4 +2917,5 @@ struct DCI0A_20_MHz {
 } __attribute__ ((__packed__));
 #define sizeof_DCI0A_20MHz 17
 
-#define MAX_DCI_SIZE_BITS 45
+// largest DCI, format 2 for 20 MHz TDD with 4 antennas (sizeof_DCI2_20MHz_4A_TDD_t)
+#define MAX_DCI_SIZE_BITS 58
@@ -154,6 +154,12 @@ typedef struct {
   uint32_t Kplus;
   /// Number of "Filler" bits (for definition see 36-212 V8.6 2009-03, p.10)
   uint32_t F;
+  /// Number of coded bits of the DLSCH in the current subframe
+  uint32_t G;
+  /// Offset of each code block in the "e"-sequence
+  uint32_t e_offset[MAX_NUM_DLSCH_SEGMENTS];
+  /// Flag indicating that the code blocks are ready for encoding (dlsch_encoding_start() done, dlsch_encoding_segments() not yet)
+  uint8_t cb_pending;
   /// Number of MIMO layers (streams) (for definition see 36-212 V8.6 2009-03, p.17, TM3-4)
   uint8_t Nl;
   /// Number of layers for this PDSCH transmission (TM8-10)
@@ -434,6 +440,17 @@ typedef struct {
   uint32_t Kplus;
   /// Number of "Filler" bits (for definition see 36-212 V8.6 2009-03, p.10)
   uint32_t F;
+  /// Number of coded bits of the ULSCH data (G after multiplexing of CQI and RI)
+  uint32_t G;
+  /// Offset of each code block in the "e"-sequence
+  uint32_t e_offset[MAX_NUM_ULSCH_SEGMENTS];
+  /// Turbo decoder return value of each code block (iterations, 1+max_turbo_iterations on CRC error,
+  /// 2+max_turbo_iterations if not decoded since another code block failed, -1 on error)
+  int cb_status[MAX_NUM_ULSCH_SEGMENTS];
+  /// Flag set when a code block failed, the remaining code blocks are then not decoded
+  volatile uint8_t cb_failed;
+  /// Flag indicating that the code blocks are ready for decoding (ulsch_decoding_start() done, ulsch_decoding_reassembly() not yet)
+  uint8_t cb_pending;
   /// Number of MIMO layers (streams) (for definition see 36-212 V8.6 2009-03, p.17)
   uint8_t Nl;
   /// Msc_initial, Initial number of subcarriers for ULSCH (36-212, v8.6 2009-03, p.26-27)
@@ -450,6 +467,20 @@ typedef struct {
   int32_t delta_TF;
 } LTE_UL_eNB_HARQ_t;
 
+/// Timing of the ULSCH code block decoding, one set per thread decoding code blocks
+typedef struct {
+  time_stats_t rate_unmatching;
+  time_stats_t deinterleaving;
+  time_stats_t turbo_decoding;
+  time_stats_t tc_init;
+  time_stats_t tc_alpha;
+  time_stats_t tc_beta;
+  time_stats_t tc_gamma;
+  time_stats_t tc_ext;
+  time_stats_t tc_intl1;
+  time_stats_t tc_intl2;
+} ulsch_decoding_stats_t;
+
 typedef struct {
   /// Pointers to 8 HARQ processes for the ULSCH
   LTE_UL_eNB_HARQ_t *harq_processes[8];
@@ -635,6 +666,8 @@ typedef struct {
   /// Bitrate on the PDSCH [bps]
   unsigned int dlsch_bitrate;
   //  unsigned int total_transmitted_bits;
+  /// Turbo decoder iterations per code block on PUSCH
+  count_stats_t ulsch_turbo_iterations;
 #ifdef LOCALIZATION
   eNB_UE_estimated_distances distance;
   int32_t *subcarrier_rssi;
@@ -711,6 +744,16 @@ typedef enum {
   PMCH
 } PDSCH_t;
 
+/// Stream 0 LLRs of the interference-aware (dual-stream) 16/64QAM receiver with a 16/64QAM stream 1
+typedef enum {
+  /// all 16/64 stream 0 hypotheses
+  IA_LLR_EXACT=0,
+  /// hard decision and closest bit-flipped levels in both dimensions (16/9 hypotheses)
+  IA_LLR_APPROX_HIGH,
+  /// hard decision and closest bit-flipped levels in one dimension at a time (7/5 hypotheses)
+  IA_LLR_APPROX_LOW
+} ia_llr_mode_t;
+
 typedef enum {
   pucch_format1=0,
   pucch_format1a,
@@ -720,6 +763,26 @@ typedef enum {
   pucch_format2b
 } PUCCH_FMT_t;
 
+/// PUCCH detection on one resource, as served by rx_pucch_multi
+typedef struct {
+  /// PUCCH format
+  PUCCH_FMT_t fmt;
+  /// UE index (for the PUCCH power statistics)
+  uint8_t UE_id;
+  /// n1_pucch resource index
+  uint16_t n1_pucch;
+  /// n2_pucch resource index
+  uint16_t n2_pucch;
+  /// Shortened format flag (SRS in last symbol)
+  uint8_t shortened_format;
+  /// Detection threshold above the noise level (dB)
+  uint8_t pucch1_thres;
+  /// Detected payload (output)
+  uint8_t payload[2];
+  /// Detection metric (output, as returned by rx_pucch)
+  int32_t stat;
+} LTE_eNB_PUCCH_t;
+
 
 typedef struct {
   /// Length of DCI in bits
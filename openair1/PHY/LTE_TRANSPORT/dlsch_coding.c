@@ -251,39 +251,35 @@ void clean_eNb_dlsch(LTE_eNB_DLSCH_t *dlsch, uint8_t abstraction_flag)
 }
 
 
-int dlsch_encoding(unsigned char *a,
-                   LTE_DL_FRAME_PARMS *frame_parms,
-                   uint8_t num_pdcch_symbols,
-                   LTE_eNB_DLSCH_t *dlsch,
-                   int frame,
-                   uint8_t subframe,
-                   time_stats_t *rm_stats,
-                   time_stats_t *te_stats,
-                   time_stats_t *i_stats)
+int dlsch_encoding_start(unsigned char *a,
+                         LTE_DL_FRAME_PARMS *frame_parms,
+                         uint8_t num_pdcch_symbols,
+                         LTE_eNB_DLSCH_t *dlsch,
+                         int frame,
+                         uint8_t subframe)
 {
 
   unsigned int G;
   unsigned int crc=1;
-  unsigned short iind;
 
   unsigned char harq_pid = dlsch->current_harq_pid;
-  unsigned short nb_rb = dlsch->harq_processes[harq_pid]->nb_rb;
+  LTE_DL_eNB_HARQ_t *dlsch_harq = dlsch->harq_processes[harq_pid];
+  unsigned short nb_rb = dlsch_harq->nb_rb;
   unsigned int A;
   unsigned char mod_order;
-  unsigned int Kr=0,Kr_bytes,r,r_offset=0;
-  unsigned short m=dlsch->harq_processes[harq_pid]->mcs;
+  unsigned int Kr_bytes,r,r_offset=0,Gp,GpmodC;
 
-  VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_ENB_DLSCH_ENCODING, VCD_FUNCTION_IN);
+  dlsch_harq->cb_pending = 0;
 
-  A = dlsch->harq_processes[harq_pid]->TBS; //6228
+  A = dlsch_harq->TBS; //6228
   // printf("Encoder: A: %d\n",A);
-  mod_order = get_Qm(dlsch->harq_processes[harq_pid]->mcs);
+  mod_order = get_Qm(dlsch_harq->mcs);
 
-  G = get_G(frame_parms,nb_rb,dlsch->harq_processes[harq_pid]->rb_alloc,mod_order,dlsch->harq_processes[harq_pid]->Nl,num_pdcch_symbols,frame,subframe);
+  G = get_G(frame_parms,nb_rb,dlsch_harq->rb_alloc,mod_order,dlsch_harq->Nl,num_pdcch_symbols,frame,subframe);
 
 
-  //  if (dlsch->harq_processes[harq_pid]->Ndi == 1) {  // this is a new packet
-  if (dlsch->harq_processes[harq_pid]->round == 0) {  // this is a new packet
+  //  if (dlsch_harq->Ndi == 1) {  // this is a new packet
+  if (dlsch_harq->round == 0) {  // this is a new packet
 
     /*
     int i;
@@ -300,119 +296,164 @@ int dlsch_encoding(unsigned char *a,
     a[2+(A>>3)] = ((uint8_t*)&crc)[0];
     //    printf("CRC %x (A %d)\n",crc,A);
 
-    dlsch->harq_processes[harq_pid]->B = A+24;
-    //    dlsch->harq_processes[harq_pid]->b = a;
-    memcpy(dlsch->harq_processes[harq_pid]->b,a,(A/8)+4);
-
-    if (lte_segmentation(dlsch->harq_processes[harq_pid]->b,
-                         dlsch->harq_processes[harq_pid]->c,
-                         dlsch->harq_processes[harq_pid]->B,
-                         &dlsch->harq_processes[harq_pid]->C,
-                         &dlsch->harq_processes[harq_pid]->Cplus,
-                         &dlsch->harq_processes[harq_pid]->Cminus,
-                         &dlsch->harq_processes[harq_pid]->Kplus,
-                         &dlsch->harq_processes[harq_pid]->Kminus,
-                         &dlsch->harq_processes[harq_pid]->F)<0)
+    dlsch_harq->B = A+24;
+    //    dlsch_harq->b = a;
+    memcpy(dlsch_harq->b,a,(A/8)+4);
+
+    if (lte_segmentation(dlsch_harq->b,
+                         dlsch_harq->c,
+                         dlsch_harq->B,
+                         &dlsch_harq->C,
+                         &dlsch_harq->Cplus,
+                         &dlsch_harq->Cminus,
+                         &dlsch_harq->Kplus,
+                         &dlsch_harq->Kminus,
+                         &dlsch_harq->F)<0)
       return(-1);
 
-    for (r=0; r<dlsch->harq_processes[harq_pid]->C; r++) {
-      if (r<dlsch->harq_processes[harq_pid]->Cminus)
-        Kr = dlsch->harq_processes[harq_pid]->Kminus;
-      else
-        Kr = dlsch->harq_processes[harq_pid]->Kplus;
-
-      Kr_bytes = Kr>>3;
-
-      // get interleaver index for Turbo code (lookup in Table 5.1.3-3 36-212, V8.6 2009-03, p. 13-14)
-      if (Kr_bytes<=64)
-        iind = (Kr_bytes-5);
-      else if (Kr_bytes <=128)
-        iind = 59 + ((Kr_bytes-64)>>1);
-      else if (Kr_bytes <= 256)
-        iind = 91 + ((Kr_bytes-128)>>2);
-      else if (Kr_bytes <= 768)
-        iind = 123 + ((Kr_bytes-256)>>3);
-      else {
+    for (r=0; r<dlsch_harq->C; r++) {
+      Kr_bytes = ((r<dlsch_harq->Cminus) ? dlsch_harq->Kminus : dlsch_harq->Kplus)>>3;
+
+      // the interleaver index is looked up again by dlsch_encoding_segments()
+      if ((Kr_bytes<5) || (Kr_bytes>768)) {
         msg("dlsch_coding: Illegal codeword size %d!!!\n",Kr_bytes);
         return(-1);
       }
+    }
+  }
 
+  // Position of each code block in the "e"-sequence (E from 36-212, V8.6 2009-03, p. 17), so that
+  // the code blocks can be rate-matched independently, see lte_rate_matching_turbo()
+  Gp = G/dlsch_harq->Nl/mod_order;
+  GpmodC = Gp%dlsch_harq->C;
 
-#ifdef DEBUG_DLSCH_CODING
-      printf("Generating Code Segment %d (%d bits)\n",r,Kr);
-      // generate codewords
+  for (r=0; r<dlsch_harq->C; r++) {
+    dlsch_harq->e_offset[r] = r_offset;
 
-      msg("bits_per_codeword (Kr)= %d, A %d\n",Kr,A);
-      msg("N_RB = %d\n",nb_rb);
-      msg("Ncp %d\n",frame_parms->Ncp);
-      msg("mod_order %d\n",mod_order);
-#endif
+    if (r < (dlsch_harq->C-GpmodC))
+      r_offset += dlsch_harq->Nl*mod_order * (Gp/dlsch_harq->C);
+    else
+      r_offset += dlsch_harq->Nl*mod_order * ((GpmodC==0?0:1) + (Gp/dlsch_harq->C));
+  }
 
+  dlsch_harq->G = G;
+  dlsch_harq->cb_pending = 1;
+
+  return(0);
+}
+
+void dlsch_encoding_segments(LTE_eNB_DLSCH_t *dlsch,
+                             uint8_t r0,
+                             uint8_t nb_segments,
+                             time_stats_t *rm_stats,
+                             time_stats_t *te_stats,
+                             time_stats_t *i_stats)
+{
+
+  unsigned char harq_pid = dlsch->current_harq_pid;
+  LTE_DL_eNB_HARQ_t *dlsch_harq = dlsch->harq_processes[harq_pid];
+  unsigned short nb_rb = dlsch_harq->nb_rb;
+  unsigned int Kr=0,Kr_bytes,r;
+  unsigned short m=dlsch_harq->mcs;
+  unsigned char *enc_in[MAX_NUM_DLSCH_SEGMENTS],*enc_out[MAX_NUM_DLSCH_SEGMENTS];
+  unsigned short enc_bytes[MAX_NUM_DLSCH_SEGMENTS];
+
+  if (dlsch_harq->round == 0) {  // this is a new packet
+    // Turbo encode the code blocks in one call, the interleavers (Table 5.1.3-3 36-212, V8.6 2009-03, p. 13-14)
+    // are looked up once per code block size
+    for (r=r0; r<r0+nb_segments; r++) {
+      enc_in[r-r0]    = dlsch_harq->c[r];
+      enc_out[r-r0]   = &dlsch_harq->d[r][96];
+      enc_bytes[r-r0] = ((r<dlsch_harq->Cminus) ? dlsch_harq->Kminus : dlsch_harq->Kplus)>>3;
+    }
 
 #ifdef DEBUG_DLSCH_CODING
-      msg("Encoding ... iind %d f1 %d, f2 %d\n",iind,f1f2mat_old[iind*2],f1f2mat_old[(iind*2)+1]);
+    msg("Encoding code segments %d..%d, A %d, N_RB %d, mod_order %d\n",r0,r0+nb_segments-1,dlsch_harq->TBS,nb_rb,get_Qm(m));
 #endif
-      start_meas(te_stats);
-      threegpplte_turbo_encoder(dlsch->harq_processes[harq_pid]->c[r],
-                                Kr>>3,
-                                &dlsch->harq_processes[harq_pid]->d[r][96],
-                                (r==0) ? dlsch->harq_processes[harq_pid]->F : 0,
-                                f1f2mat_old[iind*2],   // f1 (see 36121-820, page 14)
-                                f1f2mat_old[(iind*2)+1]  // f2 (see 36121-820, page 14)
-                               );
-      stop_meas(te_stats);
+    start_meas(te_stats);
+    threegpplte_turbo_encoder_segments(enc_in,enc_bytes,enc_out,nb_segments);
+    stop_meas(te_stats);
+  }
+
+  for (r=r0; r<r0+nb_segments; r++) {
+    if (r<dlsch_harq->Cminus)
+      Kr = dlsch_harq->Kminus;
+    else
+      Kr = dlsch_harq->Kplus;
+
+    Kr_bytes = Kr>>3;
+
+    if (dlsch_harq->round == 0) {
 #ifdef DEBUG_DLSCH_CODING
 
       if (r==0)
-        write_output("enc_output0.m","enc0",&dlsch->harq_processes[harq_pid]->d[r][96],(3*8*Kr_bytes)+12,1,4);
+        write_output("enc_output0.m","enc0",&dlsch_harq->d[r][96],(3*8*Kr_bytes)+12,1,4);
 
 #endif
       start_meas(i_stats);
-      dlsch->harq_processes[harq_pid]->RTC[r] =
+      dlsch_harq->RTC[r] =
         sub_block_interleaving_turbo(4+(Kr_bytes*8),
-                                     &dlsch->harq_processes[harq_pid]->d[r][96],
-                                     dlsch->harq_processes[harq_pid]->w[r]);
+                                     &dlsch_harq->d[r][96],
+                                     dlsch_harq->w[r]);
       stop_meas(i_stats);
     }
 
-  }
-
-  // Fill in the "e"-sequence from 36-212, V8.6 2009-03, p. 16-17 (for each "e") and concatenate the
-  // outputs for each code segment, see Section 5.1.5 p.20
-
-  for (r=0; r<dlsch->harq_processes[harq_pid]->C; r++) {
+    // Fill in the "e"-sequence from 36-212, V8.6 2009-03, p. 16-17 (for each "e"), the code
+    // segments are concatenated at the offsets computed by dlsch_encoding_start(), see Section 5.1.5 p.20
 #ifdef DEBUG_DLSCH_CODING
     msg("Rate Matching, Code segment %d (coded bits (G) %d,unpunctured/repeated bits per code segment %d,mod_order %d, nb_rb %d)...\n",
         r,
-        G,
+        dlsch_harq->G,
         Kr*3,
-        mod_order,nb_rb);
+        get_Qm(m),nb_rb);
 #endif
 
     start_meas(rm_stats);
-    r_offset += lte_rate_matching_turbo(dlsch->harq_processes[harq_pid]->RTC[r],
-                                        G,  //G
-                                        dlsch->harq_processes[harq_pid]->w[r],
-                                        dlsch->harq_processes[harq_pid]->e+r_offset,
-                                        dlsch->harq_processes[harq_pid]->C, // C
-                                        NSOFT,                    // Nsoft,
-                                        dlsch->Mdlharq,
-                                        dlsch->Kmimo,
-                                        dlsch->harq_processes[harq_pid]->rvidx,
-                                        get_Qm(dlsch->harq_processes[harq_pid]->mcs),
-                                        dlsch->harq_processes[harq_pid]->Nl,
-                                        r,
-                                        nb_rb,
-                                        m);                       // r
+    lte_rate_matching_turbo(dlsch_harq->RTC[r],
+                            dlsch_harq->G,  //G
+                            dlsch_harq->w[r],
+                            dlsch_harq->e+dlsch_harq->e_offset[r],
+                            dlsch_harq->C, // C
+                            NSOFT,                    // Nsoft,
+                            dlsch->Mdlharq,
+                            dlsch->Kmimo,
+                            dlsch_harq->rvidx,
+                            get_Qm(m),
+                            dlsch_harq->Nl,
+                            r,
+                            nb_rb,
+                            m);                       // r
     stop_meas(rm_stats);
-#ifdef DEBUG_DLSCH_CODING
+  }
+}
+
+int dlsch_encoding(unsigned char *a,
+                   LTE_DL_FRAME_PARMS *frame_parms,
+                   uint8_t num_pdcch_symbols,
+                   LTE_eNB_DLSCH_t *dlsch,
+                   int frame,
+                   uint8_t subframe,
+                   time_stats_t *rm_stats,
+                   time_stats_t *te_stats,
+                   time_stats_t *i_stats)
+{
 
-    if (r==dlsch->harq_processes[harq_pid]->C-1)
-      write_output("enc_output.m","enc",dlsch->harq_processes[harq_pid]->e,r_offset,1,4);
+  LTE_DL_eNB_HARQ_t *dlsch_harq = dlsch->harq_processes[dlsch->current_harq_pid];
 
-#endif
+  VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_ENB_DLSCH_ENCODING, VCD_FUNCTION_IN);
+
+  if (dlsch_encoding_start(a,frame_parms,num_pdcch_symbols,dlsch,frame,subframe) != 0) {
+    VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_ENB_DLSCH_ENCODING, VCD_FUNCTION_OUT);
+    return(-1);
   }
 
+  dlsch_encoding_segments(dlsch,0,dlsch_harq->C,rm_stats,te_stats,i_stats);
+  dlsch_harq->cb_pending = 0;
+
+#ifdef DEBUG_DLSCH_CODING
+  write_output("enc_output.m","enc",dlsch_harq->e,dlsch_harq->G,1,4);
+#endif
+
   VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_ENB_DLSCH_ENCODING, VCD_FUNCTION_OUT);
 
   return(0);
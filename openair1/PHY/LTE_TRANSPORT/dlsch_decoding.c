@@ -181,9 +181,16 @@ uint32_t  dlsch_decoding(PHY_VARS_UE *phy_vars_ue,
   uint32_t ret,offset;
   uint16_t iind;
   //  uint8_t dummy_channel_output[(3*8*block_length)+12];
-  short dummy_w[MAX_NUM_DLSCH_SEGMENTS][3*(6144+64)];
+  rm_turbo_map_t rm_map_F;
+  const rm_turbo_map_t *rm_map;
   uint32_t r,r_offset=0,Kr,Kr_bytes,err_flag=0;
   uint8_t crc_type;
+  // segments handed to the 8-bit decoder in one call once they are all rate-dematched
+  int16_t *tc_in[MAX_NUM_DLSCH_SEGMENTS];
+  uint8_t *tc_out[MAX_NUM_DLSCH_SEGMENTS];
+  uint16_t tc_n[MAX_NUM_DLSCH_SEGMENTS];
+  uint8_t tc_ret[MAX_NUM_DLSCH_SEGMENTS];
+  uint8_t tc_batch;
 #ifdef DEBUG_DLSCH_DECODING
   uint16_t i;
 #endif
@@ -224,9 +231,15 @@ uint32_t  dlsch_decoding(PHY_VARS_UE *phy_vars_ue,
   }
 
   if (llr8_flag == 0)
-    tc = phy_threegpplte_turbo_decoder16;
+    tc = phy_simd.turbo_decoder16;
   else
-    tc = phy_threegpplte_turbo_decoder8;
+    tc = phy_simd.turbo_decoder8;
+
+#ifdef TURBO_S
+  tc_batch = 0;
+#else
+  tc_batch = llr8_flag;
+#endif
 
   //  nb_rb = dlsch->nb_rb;
 
@@ -300,6 +313,13 @@ uint32_t  dlsch_decoding(PHY_VARS_UE *phy_vars_ue,
     LOG_E(PHY,"Illegal harq_process->C %d > %d\n",harq_process->C,MAX_NUM_DLSCH_SEGMENTS/bw_scaling);
     return((1+dlsch->max_turbo_iterations));
   }
+
+  // the same for all the segments, also used by the batched decoder after the loop
+  if (harq_process->C == 1)
+    crc_type = CRC24_A;
+  else
+    crc_type = CRC24_B;
+
   for (r=0; r<harq_process->C; r++) {
 
     
@@ -329,10 +349,10 @@ uint32_t  dlsch_decoding(PHY_VARS_UE *phy_vars_ue,
 #endif
 
     start_meas(dlsch_rate_unmatching_stats);
-    memset(&dummy_w[r][0],0,3*(6144+64)*sizeof(short));
-    harq_process->RTC[r] = generate_dummy_w(4+(Kr_bytes*8),
-                                            (uint8_t*) &dummy_w[r][0],
-                                            (r==0) ? harq_process->F : 0);
+    rm_map = get_rm_turbo_map(4+(Kr_bytes*8),
+                              (r==0) ? harq_process->F : 0,
+                              &rm_map_F);
+    harq_process->RTC[r] = rm_map->RTC;
 
 #ifdef DEBUG_DLSCH_DECODING
     LOG_I(PHY,"HARQ_PID %d Rate Matching Segment %d (coded bits %d,unpunctured/repeated bits %d, TBS %d, mod_order %d, nb_rb %d, Nl %d, rv %d, round %d)...\n",
@@ -347,21 +367,20 @@ uint32_t  dlsch_decoding(PHY_VARS_UE *phy_vars_ue,
 #endif
 
 
-    if (lte_rate_matching_turbo_rx(harq_process->RTC[r],
-                                   G,
-                                   harq_process->w[r],
-                                   (uint8_t*)&dummy_w[r][0],
-                                   dlsch_llr+r_offset,
-                                   harq_process->C,
-                                   NSOFT,
-                                   dlsch->Mdlharq,
-                                   dlsch->Kmimo,
-                                   harq_process->rvidx,
-                                   (harq_process->round==0)?1:0,
-                                   harq_process->Qm,
-                                   harq_process->Nl,
-                                   r,
-                                   &E)==-1) {
+    if (lte_rate_matching_turbo_rx_map(rm_map,
+                                       G,
+                                       harq_process->w[r],
+                                       dlsch_llr+r_offset,
+                                       harq_process->C,
+                                       NSOFT,
+                                       dlsch->Mdlharq,
+                                       dlsch->Kmimo,
+                                       harq_process->rvidx,
+                                       (harq_process->round==0)?1:0,
+                                       harq_process->Qm,
+                                       harq_process->Nl,
+                                       r,
+                                       &E)==-1) {
       stop_meas(dlsch_rate_unmatching_stats);
       LOG_E(PHY,"dlsch_decoding.c: Problem in rate_matching\n");
       return(dlsch->max_turbo_iterations);
@@ -398,12 +417,11 @@ uint32_t  dlsch_decoding(PHY_VARS_UE *phy_vars_ue,
 
     //    printf("Clearing c, %p\n",harq_process->c[r]);
     memset(harq_process->c[r],0,Kr_bytes);
+    tc_in[r]  = &harq_process->d[r][96];
+    tc_out[r] = harq_process->c[r];
+    tc_n[r]   = Kr;
 
     //    printf("done\n");
-    if (harq_process->C == 1)
-      crc_type = CRC24_A;
-    else
-      crc_type = CRC24_B;
 
     /*
     printf("decoder input(segment %d)\n",r);
@@ -414,7 +432,7 @@ uint32_t  dlsch_decoding(PHY_VARS_UE *phy_vars_ue,
     printf("\n");
     */
 
-    if (err_flag == 0) {
+    if ((err_flag == 0) && (tc_batch == 0)) {
 
       start_meas(dlsch_turbo_decoding_stats);
 #ifdef TURBO_S
@@ -441,6 +459,7 @@ uint32_t  dlsch_decoding(PHY_VARS_UE *phy_vars_ue,
 
 
       stop_meas(dlsch_turbo_decoding_stats);
+      count_meas(&phy_vars_ue->dlsch_turbo_iterations,ret);
     }
 
 
@@ -452,6 +471,37 @@ uint32_t  dlsch_decoding(PHY_VARS_UE *phy_vars_ue,
 
   }
 
+  if (tc_batch == 1) {
+    start_meas(dlsch_turbo_decoding_stats);
+    phy_threegpplte_turbo_decoder8_batch(tc_in,
+                                         tc_out,
+                                         tc_n,
+                                         harq_process->C,
+                                         dlsch->max_turbo_iterations,
+                                         crc_type,
+                                         harq_process->F,
+                                         tc_ret,
+                                         &phy_vars_ue->dlsch_tc_init_stats,
+                                         &phy_vars_ue->dlsch_tc_alpha_stats,
+                                         &phy_vars_ue->dlsch_tc_beta_stats,
+                                         &phy_vars_ue->dlsch_tc_gamma_stats,
+                                         &phy_vars_ue->dlsch_tc_ext_stats,
+                                         &phy_vars_ue->dlsch_tc_intl1_stats,
+                                         &phy_vars_ue->dlsch_tc_intl2_stats);
+    stop_meas(dlsch_turbo_decoding_stats);
+
+    for (r=0; r<harq_process->C; r++) {
+      // the code blocks skipped after a failed one (2+max_turbo_iterations) are not in the histogram
+      if (tc_ret[r] <= (1+dlsch->max_turbo_iterations))
+        count_meas(&phy_vars_ue->dlsch_turbo_iterations,tc_ret[r]);
+
+      if (tc_ret[r] >= (1+dlsch->max_turbo_iterations))
+        err_flag = 1;
+    }
+
+    ret = tc_ret[harq_process->C-1];
+  }
+
   if (err_flag == 1) {
     dlsch->harq_ack[subframe].ack = 0;
     dlsch->harq_ack[subframe].harq_id = harq_pid;
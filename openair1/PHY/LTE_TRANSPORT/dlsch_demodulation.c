@@ -77,6 +77,23 @@ unsigned char offset_mumimo_llr_drange[29][3]= {{0, 6, 5},{0, 4, 5},{0, 4, 5},{0
 
 extern void print_shorts(char *s,int16_t *x);
 
+// single antenna port symbols after the first one go through dlsch_extract_comp_mrc_single()
+#if defined(__x86_64__) || defined(__i386__)
+static int dlsch_fused_rx = 1;
+#else
+static int dlsch_fused_rx = 0;
+#endif
+
+int dlsch_set_fused_rx(int enable)
+{
+
+#if defined(__x86_64__) || defined(__i386__)
+  dlsch_fused_rx = enable ? 1 : 0;
+#endif
+
+  return(dlsch_fused_rx);
+}
+
 int rx_pdsch(PHY_VARS_UE *phy_vars_ue,
              PDSCH_t type,
              unsigned char eNB_id,
@@ -95,7 +112,7 @@ int rx_pdsch(PHY_VARS_UE *phy_vars_ue,
   PHY_MEASUREMENTS *phy_measurements = &phy_vars_ue->PHY_measurements;
   LTE_UE_DLSCH_t   **dlsch_ue;
 
-  unsigned char aatx,aarx;
+  unsigned char aatx,aarx,fused;
   unsigned short nb_rb;
   int avgs, rb;
   LTE_DL_UE_HARQ_t *dlsch0_harq,*dlsch1_harq = 0;
@@ -162,7 +179,30 @@ int rx_pdsch(PHY_VARS_UE *phy_vars_ue,
     pilots=0;
   */
 
-  if (frame_parms->nb_antennas_tx_eNB>1) {
+  // extraction, compensation and MRC in one pass over the allocated RBs, without the
+  // intermediate rxdataF_ext/dl_ch_estimates_ext (the separate stages are kept for the
+  // first symbol, which sets log2_maxh, and for dumping)
+  fused = (dlsch_fused_rx == 1) &&
+          (first_symbol_flag == 0) &&
+          (dual_stream_flag == 0) &&
+          (frame_parms->nb_antennas_tx_eNB == 1) &&
+          (frame_parms->mode1_flag == 1) &&
+          (dlsch0_harq->mimo_mode == SISO);
+
+  if (fused) {
+    nb_rb = dlsch_extract_comp_mrc_single(lte_ue_common_vars->rxdataF,
+                                          lte_ue_common_vars->dl_ch_estimates[eNB_id],
+                                          lte_ue_pdsch_vars[eNB_id]->rxdataF_comp0,
+                                          lte_ue_pdsch_vars[eNB_id]->dl_ch_mag0,
+                                          lte_ue_pdsch_vars[eNB_id]->dl_ch_magb0,
+                                          dlsch0_harq->rb_alloc,
+                                          symbol,
+                                          subframe,
+                                          phy_vars_ue->high_speed_flag,
+                                          dlsch0_harq->Qm,
+                                          lte_ue_pdsch_vars[eNB_id]->log2_maxh,
+                                          frame_parms);
+  } else if (frame_parms->nb_antennas_tx_eNB>1) {
 #ifdef DEBUG_DLSCH_MOD
     LOG_I(PHY,"dlsch: using pmi %x (%p), rb_alloc %x\n",pmi2hex_2Ar1(dlsch0_harq->pmi_alloc),dlsch_ue[0],dlsch0_harq->rb_alloc[0]);
 #endif
@@ -314,7 +354,9 @@ int rx_pdsch(PHY_VARS_UE *phy_vars_ue,
   aatx = frame_parms->nb_antennas_tx_eNB;
   aarx = frame_parms->nb_antennas_rx;
 
-  if (dlsch0_harq->mimo_mode<LARGE_CDD) {// SISO or ALAMOUTI
+  if (fused) {
+    // compensated and combined above
+  } else if (dlsch0_harq->mimo_mode<LARGE_CDD) {// SISO or ALAMOUTI
 
     dlsch_channel_compensation(lte_ue_pdsch_vars[eNB_id]->rxdataF_ext,
                                lte_ue_pdsch_vars[eNB_id]->dl_ch_estimates_ext,
@@ -534,7 +576,7 @@ int rx_pdsch(PHY_VARS_UE *phy_vars_ue,
   }
 
   //  printf("MRC\n");
-  if (frame_parms->nb_antennas_rx > 1) {
+  if ((fused == 0) && (frame_parms->nb_antennas_rx > 1)) {
     if (dlsch0_harq->mimo_mode == LARGE_CDD) {
       if (frame_parms->nb_antennas_tx_eNB == 2) {
         dlsch_detection_mrc(frame_parms,
@@ -3503,7 +3545,7 @@ unsigned short dlsch_extract_rbs_single(int **rxdataF,
           rxF       = &rxdataF[aarx][((symbol*(frame_parms->ofdm_symbol_size)))];
 
           for (; i<12; i++) {
-            if (i!=((frame_parms->nushift+6+poffset)%12)) {
+            if ((i-6)!=((frame_parms->nushift+poffset)%6)) {
               dl_ch0_ext[j]=dl_ch0[i];
               rxF_ext[j++]=rxF[(1+i-6)];
               //                      printf("**extract rb %d, re %d => (%d,%d)\n",rb,i,*(short *)&rxF_ext[j-1],*(1+(short*)&rxF_ext[j-1]));
@@ -3680,6 +3722,244 @@ unsigned short dlsch_extract_rbs_single(int **rxdataF,
   return(nb_rb/frame_parms->nb_antennas_rx);
 }
 
+// Allocated RBs of one OFDM symbol for single antenna eNB transmission, in the order of
+// dlsch_extract_rbs_single(): offsets of both RB halves in the symbol of rxdataF (the middle RB
+// of an odd number of RBs straddles DC), of the RB in the channel estimates, and its PDSCH REs
+typedef struct {
+  uint16_t rxF[2];
+  uint16_t ch;
+  uint16_t re_mask;
+} dlsch_rb_map_t;
+
+static unsigned short dlsch_rb_map_single(LTE_DL_FRAME_PARMS *frame_parms,
+                                          unsigned int *rb_alloc,
+                                          unsigned char symbol,
+                                          unsigned char subframe,
+                                          dlsch_rb_map_t *map)
+{
+
+  unsigned short rb,nb_rb=0,half=frame_parms->N_RB_DL>>1,re_mask,pilot_mask=0xfff,rxF;
+  unsigned char symbol_mod,nsymb,sss_symb,pss_symb,re,sync=0;
+
+  symbol_mod = (symbol>=(7-frame_parms->Ncp)) ? symbol-(7-frame_parms->Ncp) : symbol;
+  nsymb = (frame_parms->Ncp==NORMAL) ? 14:12;
+
+  if (frame_parms->frame_type == TDD) {  // TDD
+    sss_symb = nsymb-1;
+    pss_symb = 2;
+  } else {
+    sss_symb = (nsymb>>1)-2;
+    pss_symb = (nsymb>>1)-1;
+  }
+
+  if ((symbol_mod==0)||(symbol_mod==(4-frame_parms->Ncp))) {
+    re = frame_parms->nushift + ((symbol_mod==(4-frame_parms->Ncp)) ? 3 : 0);
+    pilot_mask &= ~((1<<re) | (1<<((re+6)%12)));
+  }
+
+  // PBCH, SSS and PSS in the 6 middle RBs, only skipped for an odd number of RBs
+  if (frame_parms->N_RB_DL&1)
+    sync = ((subframe==0) && (symbol>=(nsymb>>1)) && (symbol<((nsymb>>1)+4))) ||
+           (((subframe==0)||(subframe==5)) && (symbol==sss_symb)) ||
+           ((frame_parms->frame_type==FDD) && ((subframe==0)||(subframe==5)) && (symbol==pss_symb)) ||
+           ((frame_parms->frame_type==TDD) && (subframe==6) && (symbol==pss_symb));
+
+  for (rb=0; rb<frame_parms->N_RB_DL; rb++) {
+    re_mask = ((rb_alloc[rb>>5]>>(rb&31))&1) ? pilot_mask : 0;
+
+    if (sync) {
+      if ((rb+3>half) && (rb<half+3))
+        re_mask = 0;
+      else if (rb+3 == half)
+        re_mask &= 0x03f;
+      else if (rb == half+3)
+        re_mask &= 0xfc0;
+    }
+
+    if (re_mask == 0)
+      continue;
+
+    // second half of the RBs after DC
+    if (rb < half)
+      rxF = frame_parms->first_carrier_offset + (rb*12);
+    else if ((frame_parms->N_RB_DL&1) == 0)
+      rxF = 1 + ((rb-half)*12);
+    else if (rb > half)
+      rxF = ((rb-half)*12) - 5;
+    else
+      rxF = frame_parms->first_carrier_offset + (rb*12);
+
+    map[nb_rb].rxF[0]  = rxF;
+    map[nb_rb].rxF[1]  = ((frame_parms->N_RB_DL&1) && (rb==half)) ? 1 : rxF+6;
+    map[nb_rb].ch      = rb*12;
+    map[nb_rb].re_mask = re_mask;
+    nb_rb++;
+  }
+
+  return(nb_rb);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// channel compensation of 4 REs of one rx antenna, same operations as dlsch_channel_compensation()
+static inline __m128i dlsch_comp4(__m128i ch,__m128i rx,__m128i *mag,__m128i *magb,__m128i QAM_amp128,__m128i QAM_amp128b,
+                                  unsigned char mod_order,unsigned char output_shift)
+{
+
+  __m128i mmtmpD0,mmtmpD1;
+
+  if (mod_order>2) {
+    mmtmpD0 = _mm_srai_epi32(_mm_madd_epi16(ch,ch),output_shift);
+    mmtmpD0 = _mm_packs_epi32(mmtmpD0,mmtmpD0);
+    mmtmpD0 = _mm_unpacklo_epi16(mmtmpD0,mmtmpD0);
+    *mag    = _mm_slli_epi16(_mm_mulhi_epi16(mmtmpD0,QAM_amp128),1);
+    *magb   = _mm_slli_epi16(_mm_mulhi_epi16(mmtmpD0,QAM_amp128b),1);
+  }
+
+  // multiply by conjugated channel
+  mmtmpD0 = _mm_madd_epi16(ch,rx);
+  mmtmpD1 = _mm_shufflelo_epi16(ch,_MM_SHUFFLE(2,3,0,1));
+  mmtmpD1 = _mm_shufflehi_epi16(mmtmpD1,_MM_SHUFFLE(2,3,0,1));
+  mmtmpD1 = _mm_sign_epi16(mmtmpD1,*(__m128i*)&conjugate[0]);
+  mmtmpD1 = _mm_madd_epi16(mmtmpD1,rx);
+  mmtmpD0 = _mm_srai_epi32(mmtmpD0,output_shift);
+  mmtmpD1 = _mm_srai_epi32(mmtmpD1,output_shift);
+  return(_mm_packs_epi32(_mm_unpacklo_epi32(mmtmpD0,mmtmpD1),_mm_unpackhi_epi32(mmtmpD0,mmtmpD1)));
+}
+
+// compensation and MRC (as dlsch_detection_mrc()) of nb_vec groups of 4 REs
+static inline void dlsch_comp_mrc_vec(__m128i **rx128,__m128i **ch128,__m128i *comp128,__m128i *mag128,__m128i *magb128,
+                                      unsigned short nb_vec,unsigned char nb_antennas_rx,unsigned char mod_order,
+                                      unsigned char output_shift)
+{
+
+  __m128i QAM_amp128=_mm_setzero_si128(),QAM_amp128b=_mm_setzero_si128();
+  __m128i comp0,comp1,mag0=_mm_setzero_si128(),mag1=_mm_setzero_si128(),magb0=_mm_setzero_si128(),magb1=_mm_setzero_si128();
+  unsigned short i;
+
+  if (mod_order == 4) {
+    QAM_amp128 = _mm_set1_epi16(QAM16_n1);  // 2/sqrt(10)
+  } else if (mod_order == 6) {
+    QAM_amp128  = _mm_set1_epi16(QAM64_n1); //
+    QAM_amp128b = _mm_set1_epi16(QAM64_n2);
+  }
+
+  for (i=0; i<nb_vec; i++) {
+    comp0 = dlsch_comp4(_mm_loadu_si128(&ch128[0][i]),_mm_loadu_si128(&rx128[0][i]),&mag0,&magb0,
+                        QAM_amp128,QAM_amp128b,mod_order,output_shift);
+
+    if (nb_antennas_rx > 1) {
+      comp1 = dlsch_comp4(_mm_loadu_si128(&ch128[1][i]),_mm_loadu_si128(&rx128[1][i]),&mag1,&magb1,
+                          QAM_amp128,QAM_amp128b,mod_order,output_shift);
+      comp0 = _mm_adds_epi16(_mm_srai_epi16(comp0,1),_mm_srai_epi16(comp1,1));
+      mag0  = _mm_adds_epi16(_mm_srai_epi16(mag0,1),_mm_srai_epi16(mag1,1));
+      magb0 = _mm_adds_epi16(_mm_srai_epi16(magb0,1),_mm_srai_epi16(magb1,1));
+    }
+
+    _mm_storeu_si128(&comp128[i],comp0);
+
+    if (mod_order>2) {
+      _mm_storeu_si128(&mag128[i],mag0);
+      _mm_storeu_si128(&magb128[i],magb0);
+    }
+  }
+}
+
+#endif
+
+unsigned short dlsch_extract_comp_mrc_single(int **rxdataF,
+                                             int **dl_ch_estimates,
+                                             int **rxdataF_comp,
+                                             int **dl_ch_mag,
+                                             int **dl_ch_magb,
+                                             unsigned int *rb_alloc,
+                                             unsigned char symbol,
+                                             unsigned char subframe,
+                                             uint32_t high_speed_flag,
+                                             unsigned char mod_order,
+                                             unsigned char output_shift,
+                                             LTE_DL_FRAME_PARMS *frame_parms)
+{
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  dlsch_rb_map_t map[100];
+  int rx_stage[2][12] __attribute__ ((aligned(16)));
+  int ch_stage[2][12] __attribute__ ((aligned(16)));
+  __m128i *rx128[2],*ch128[2];
+  int *rxF[2],*dl_ch0[2];
+  unsigned short r,run,nb_rb,nre,pos=0;
+  unsigned char aarx,i;
+  int *comp_out = &rxdataF_comp[0][symbol*frame_parms->N_RB_DL*12];
+  int *mag_out  = &dl_ch_mag[0][symbol*frame_parms->N_RB_DL*12];
+  int *magb_out = &dl_ch_magb[0][symbol*frame_parms->N_RB_DL*12];
+
+  for (aarx=0; aarx<frame_parms->nb_antennas_rx; aarx++) {
+    rxF[aarx] = &rxdataF[aarx][symbol*frame_parms->ofdm_symbol_size];
+
+    if (high_speed_flag == 1)
+      dl_ch0[aarx] = &dl_ch_estimates[aarx][5+(symbol*(frame_parms->ofdm_symbol_size))];
+    else
+      dl_ch0[aarx] = &dl_ch_estimates[aarx][5];
+  }
+
+  nb_rb = dlsch_rb_map_single(frame_parms,rb_alloc,symbol,subframe,map);
+
+  for (r=0; r<nb_rb; r+=run) {
+    run = 1;
+
+    if ((map[r].re_mask == 0xfff) && (map[r].rxF[1] == map[r].rxF[0]+6)) {
+      // run of full RBs contiguous in rxdataF, read in place
+      while ((r+run < nb_rb) &&
+             (map[r+run].re_mask == 0xfff) &&
+             (map[r+run].rxF[0] == map[r].rxF[0]+(run*12)) &&
+             (map[r+run].rxF[1] == map[r+run].rxF[0]+6) &&
+             (map[r+run].ch == map[r].ch+(run*12)))
+        run++;
+
+      for (aarx=0; aarx<frame_parms->nb_antennas_rx; aarx++) {
+        rx128[aarx] = (__m128i *)&rxF[aarx][map[r].rxF[0]];
+        ch128[aarx] = (__m128i *)&dl_ch0[aarx][map[r].ch];
+      }
+
+      nre = run*12;
+    } else {
+      // RB with pilots, sync signals or around DC, gather its PDSCH REs
+      nre = 0;
+
+      for (i=0; i<12; i++) {
+        if ((map[r].re_mask>>i)&1) {
+          for (aarx=0; aarx<frame_parms->nb_antennas_rx; aarx++) {
+            rx_stage[aarx][nre] = rxF[aarx][map[r].rxF[i/6]+(i%6)];
+            ch_stage[aarx][nre] = dl_ch0[aarx][map[r].ch+i];
+          }
+
+          nre++;
+        }
+      }
+
+      for (aarx=0; aarx<frame_parms->nb_antennas_rx; aarx++) {
+        rx128[aarx] = (__m128i *)rx_stage[aarx];
+        ch128[aarx] = (__m128i *)ch_stage[aarx];
+      }
+    }
+
+    // REs of an RB are written after those of the previous one, the last group may
+    // spill over the next RB like in dlsch_channel_compensation()
+    dlsch_comp_mrc_vec(rx128,ch128,(__m128i *)&comp_out[pos],(__m128i *)&mag_out[pos],(__m128i *)&magb_out[pos],
+                       (nre+3)>>2,frame_parms->nb_antennas_rx,mod_order,output_shift);
+    pos += nre;
+  }
+
+  return(nb_rb);
+
+#else
+
+  return(0);
+
+#endif
+}
+
 unsigned short dlsch_extract_rbs_dual(int **rxdataF,
                                       int **dl_ch_estimates,
                                       int **rxdataF_ext,
@@ -44,6 +44,10 @@
 #include "extern.h"
 #include "PHY/sse_intrin.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 int16_t zero[8] __attribute__ ((aligned(16))) = {0,0,0,0,0,0,0,0};
 int16_t ones[8] __attribute__ ((aligned(16))) = {0xffff,0xffff,0xffff,0xffff,0xffff,0xffff,0xffff,0xffff};
 #if defined(__x86_64__) || defined(__i386__)
@@ -625,6 +629,198 @@ __m128i tmp_result4 __attribute__ ((aligned(16)));
 
 #endif
 
+// Single-stream max-log-MAP LLRs of 16/64QAM, shared by the PDSCH and PUSCH receivers.
+// rxF are the compensated symbols and ch_mag/ch_magb the matching scaled channel
+// magnitudes (same int16 re/im layout), nb_re the number of REs. Each RE produces
+// y, |h|^2-|y| (and |h|^2b-||h|^2-|y||) as pairs of int16 directly in the order of the
+// coded bits, i.e. of the rate-dematcher input, in a single pass over the three buffers.
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define AVX2_FUNC __attribute__((target("avx2")))
+
+static int llr_avx2 = -1;
+
+static inline int llr_avx2_enabled(void) __attribute__((always_inline));
+static inline int llr_avx2_enabled(void)
+{
+
+  if (llr_avx2 < 0)
+    llr_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+
+  return(llr_avx2);
+}
+
+int llr_set_avx2(int enable)
+{
+
+  llr_avx2 = (enable && __builtin_cpu_supports("avx2")) ? 1 : 0;
+
+  return(llr_avx2);
+}
+
+// 8 REs per iteration, returns the number of REs done
+static uint32_t qam16_llr_avx2(const int16_t *rxF,const int16_t *ch_mag,int16_t *llr,uint32_t nb_re) AVX2_FUNC;
+static uint32_t qam16_llr_avx2(const int16_t *rxF,const int16_t *ch_mag,int16_t *llr,uint32_t nb_re)
+{
+
+  __m256i y,m,lo,hi;
+  uint32_t i;
+
+  for (i=0; i<(nb_re>>3); i++) {
+    y  = _mm256_loadu_si256((__m256i *)&rxF[i<<4]);
+    m  = _mm256_subs_epi16(_mm256_loadu_si256((__m256i *)&ch_mag[i<<4]),_mm256_abs_epi16(y));
+    // REs 0,1,4,5 and 2,3,6,7
+    lo = _mm256_unpacklo_epi32(y,m);
+    hi = _mm256_unpackhi_epi32(y,m);
+    _mm256_storeu_si256((__m256i *)&llr[i<<5],_mm256_permute2x128_si256(lo,hi,0x20));
+    _mm256_storeu_si256((__m256i *)&llr[(i<<5)+16],_mm256_permute2x128_si256(lo,hi,0x31));
+  }
+
+  return(nb_re&~7);
+}
+
+static uint32_t qam64_llr_avx2(const int16_t *rxF,const int16_t *ch_mag,const int16_t *ch_magb,int16_t *llr,uint32_t nb_re) AVX2_FUNC;
+static uint32_t qam64_llr_avx2(const int16_t *rxF,const int16_t *ch_mag,const int16_t *ch_magb,int16_t *llr,uint32_t nb_re)
+{
+
+  // RE of 32-bit word k of the 24 output words is k/3, its component (y,m1,m2) k%3
+  const __m256i p0 = _mm256_setr_epi32(0,0,0,1,1,1,2,2);
+  const __m256i p1 = _mm256_setr_epi32(2,3,3,3,4,4,4,5);
+  const __m256i p2 = _mm256_setr_epi32(5,5,6,6,6,7,7,7);
+  __m256i y,m1,m2;
+  uint32_t i;
+
+  for (i=0; i<(nb_re>>3); i++) {
+    y  = _mm256_loadu_si256((__m256i *)&rxF[i<<4]);
+    m1 = _mm256_subs_epi16(_mm256_loadu_si256((__m256i *)&ch_mag[i<<4]),_mm256_abs_epi16(y));
+    m2 = _mm256_subs_epi16(_mm256_loadu_si256((__m256i *)&ch_magb[i<<4]),_mm256_abs_epi16(m1));
+    _mm256_storeu_si256((__m256i *)&llr[i*48],
+                        _mm256_blend_epi32(_mm256_blend_epi32(_mm256_permutevar8x32_epi32(y,p0),
+                                                              _mm256_permutevar8x32_epi32(m1,p0),0x92),
+                                           _mm256_permutevar8x32_epi32(m2,p0),0x24));
+    _mm256_storeu_si256((__m256i *)&llr[i*48+16],
+                        _mm256_blend_epi32(_mm256_blend_epi32(_mm256_permutevar8x32_epi32(y,p1),
+                                                              _mm256_permutevar8x32_epi32(m1,p1),0x24),
+                                           _mm256_permutevar8x32_epi32(m2,p1),0x49));
+    _mm256_storeu_si256((__m256i *)&llr[i*48+32],
+                        _mm256_blend_epi32(_mm256_blend_epi32(_mm256_permutevar8x32_epi32(y,p2),
+                                                              _mm256_permutevar8x32_epi32(m1,p2),0x49),
+                                           _mm256_permutevar8x32_epi32(m2,p2),0x92));
+  }
+
+  return(nb_re&~7);
+}
+
+#else
+
+int llr_set_avx2(int enable)
+{
+
+  return(0);
+}
+
+#endif
+
+// saturated m-|y| as computed by _mm_subs_epi16(m,_mm_abs_epi16(y))
+static inline int16_t llr_subs_abs(int16_t m,int16_t y)
+{
+
+  int16_t a = (y<0) ? (int16_t)-y : y;
+  int32_t r = (int32_t)m - a;
+
+  return((r > 32767) ? 32767 : ((r < -32768) ? -32768 : (int16_t)r));
+}
+
+void qam16_llr(const int16_t *rxF,const int16_t *ch_mag,int16_t *llr,uint32_t nb_re)
+{
+
+  uint32_t i=0;
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i y,m;
+
+  if (llr_avx2_enabled() == 1)
+    i = qam16_llr_avx2(rxF,ch_mag,llr,nb_re);
+
+  for (; i+4<=nb_re; i+=4) {
+    y = _mm_loadu_si128((__m128i *)&rxF[i<<1]);
+    m = _mm_subs_epi16(_mm_loadu_si128((__m128i *)&ch_mag[i<<1]),_mm_abs_epi16(y));
+    // lambda_1=y_R, lambda_2=y_I, lambda_3=|h|^2-|y_R|, lambda_4=|h|^2-|y_I|
+    _mm_storeu_si128((__m128i *)&llr[i<<2],_mm_unpacklo_epi32(y,m));
+    _mm_storeu_si128((__m128i *)&llr[(i<<2)+8],_mm_unpackhi_epi32(y,m));
+  }
+#elif defined(__arm__)
+  int16x8_t y,m;
+  int32x4x2_t z;
+
+  for (; i+4<=nb_re; i+=4) {
+    y = vld1q_s16(&rxF[i<<1]);
+    m = vqsubq_s16(vld1q_s16(&ch_mag[i<<1]),vabsq_s16(y));
+    z = vzipq_s32(vreinterpretq_s32_s16(y),vreinterpretq_s32_s16(m));
+    vst1q_s32((int32_t *)&llr[i<<2],z.val[0]);
+    vst1q_s32((int32_t *)&llr[(i<<2)+8],z.val[1]);
+  }
+#endif
+
+  for (; i<nb_re; i++) {
+    llr[(i<<2)]   = rxF[(i<<1)];
+    llr[(i<<2)+1] = rxF[(i<<1)+1];
+    llr[(i<<2)+2] = llr_subs_abs(ch_mag[(i<<1)],rxF[(i<<1)]);
+    llr[(i<<2)+3] = llr_subs_abs(ch_mag[(i<<1)+1],rxF[(i<<1)+1]);
+  }
+}
+
+void qam64_llr(const int16_t *rxF,const int16_t *ch_mag,const int16_t *ch_magb,int16_t *llr,uint32_t nb_re)
+{
+
+  uint32_t i=0;
+  int16_t m1;
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i y,t1,t2,t3;
+
+  if (llr_avx2_enabled() == 1)
+    i = qam64_llr_avx2(rxF,ch_mag,ch_magb,llr,nb_re);
+
+  for (; i+4<=nb_re; i+=4) {
+    y  = _mm_loadu_si128((__m128i *)&rxF[i<<1]);
+    t1 = _mm_subs_epi16(_mm_loadu_si128((__m128i *)&ch_mag[i<<1]),_mm_abs_epi16(y));
+    t2 = _mm_subs_epi16(_mm_loadu_si128((__m128i *)&ch_magb[i<<1]),_mm_abs_epi16(t1));
+    // 32-bit words y0 m1_0 m2_0 y1 | m1_1 m2_1 y2 m1_2 | m2_2 y3 m1_3 m2_3
+    t3 = _mm_unpackhi_epi32(t1,t2);
+    _mm_storeu_si128((__m128i *)&llr[i*6],
+                     _mm_unpacklo_epi64(_mm_unpacklo_epi32(y,t1),_mm_unpacklo_epi32(t2,_mm_srli_si128(y,4))));
+    _mm_storeu_si128((__m128i *)&llr[i*6+8],
+                     _mm_unpacklo_epi64(_mm_unpacklo_epi32(_mm_srli_si128(t1,4),_mm_srli_si128(t2,4)),_mm_unpackhi_epi32(y,t1)));
+    _mm_storeu_si128((__m128i *)&llr[i*6+16],
+                     _mm_unpacklo_epi64(_mm_unpacklo_epi32(_mm_srli_si128(t2,8),_mm_srli_si128(y,12)),_mm_srli_si128(t3,8)));
+  }
+#elif defined(__arm__)
+  int16x8_t y,t1,t2;
+  int32x4x3_t z;
+
+  for (; i+4<=nb_re; i+=4) {
+    y  = vld1q_s16(&rxF[i<<1]);
+    t1 = vqsubq_s16(vld1q_s16(&ch_mag[i<<1]),vabsq_s16(y));
+    t2 = vqsubq_s16(vld1q_s16(&ch_magb[i<<1]),vabsq_s16(t1));
+    z.val[0] = vreinterpretq_s32_s16(y);
+    z.val[1] = vreinterpretq_s32_s16(t1);
+    z.val[2] = vreinterpretq_s32_s16(t2);
+    vst3q_s32((int32_t *)&llr[i*6],z);
+  }
+#endif
+
+  for (; i<nb_re; i++) {
+    llr[i*6]   = rxF[(i<<1)];
+    llr[i*6+1] = rxF[(i<<1)+1];
+    m1         = llr_subs_abs(ch_mag[(i<<1)],rxF[(i<<1)]);
+    llr[i*6+2] = m1;
+    llr[i*6+4] = llr_subs_abs(ch_magb[(i<<1)],m1);
+    m1         = llr_subs_abs(ch_mag[(i<<1)+1],rxF[(i<<1)+1]);
+    llr[i*6+3] = m1;
+    llr[i*6+5] = llr_subs_abs(ch_magb[(i<<1)+1],m1);
+  }
+}
+
 //==============================================================================================
 // SINGLE-STREAM
 //==============================================================================================
@@ -696,44 +892,20 @@ void dlsch_16qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
                      int16_t **llr32p)
 {
 
-#if defined(__x86_64__) || defined(__i386__)
-  __m128i *rxF = (__m128i*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
-  __m128i *ch_mag;
-  __m128i llr128[2];
-  uint32_t *llr32;
-#elif defined(__arm__)
-  int16x8_t *rxF = (int16x8_t*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
-  int16x8_t *ch_mag;
-  int16x8_t xmm0;
-  int16_t *llr16;
-#endif
-
-
-  int i,len;
-  unsigned char symbol_mod,len_mod4=0;
-
+  int16_t *rxF = (int16_t*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
+  int16_t *ch_mag = (int16_t*)&dl_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
+  int16_t *llr;
+  int len;
+  unsigned char symbol_mod;
 
-#if defined(__x86_64__) || defined(__i386__)
-  if (first_symbol_flag==1) {
-    llr32 = (uint32_t*)dlsch_llr;
-  } else {
-    llr32 = (uint32_t*)*llr32p;
-  }
-#elif defined(__arm__)
   if (first_symbol_flag==1) {
-    llr16 = (int16_t*)dlsch_llr;
+    llr = dlsch_llr;
   } else {
-    llr16 = (int16_t*)*llr32p;
+    llr = *llr32p;
   }
-#endif
 
   symbol_mod = (symbol>=(7-frame_parms->Ncp)) ? symbol-(7-frame_parms->Ncp) : symbol;
 
-#if defined(__x86_64__) || defined(__i386__)
-  ch_mag = (__m128i*)&dl_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
-#elif defined(__arm__)
-  ch_mag = (int16x8_t*)&dl_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
-#endif
   if ((symbol_mod==0) || (symbol_mod==(4-frame_parms->Ncp))) {
     if (frame_parms->mode1_flag==0)
       len = nb_rb*8 - (2*pbch_pss_sss_adjust/3);
@@ -743,64 +915,11 @@ void dlsch_16qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
     len = nb_rb*12 - pbch_pss_sss_adjust;
   }
 
-  // update output pointer according to number of REs in this symbol (<<2 because 4 bits per RE)
-  if (first_symbol_flag == 1)
-    *llr32p = dlsch_llr + (len<<2);
-  else
-    *llr32p += (len<<2);
-
-  len_mod4 = len&3;
-  len>>=2;  // length in quad words (4 REs)
-  len+=(len_mod4==0 ? 0 : 1);
-
-  for (i=0; i<len; i++) {
+  // lambda_1=y_R, lambda_2=y_I, lambda_3=|h|^2-|y_R|, lambda_4=|h|^2-|y_I|
+  qam16_llr(rxF,ch_mag,llr,len);
 
-#if defined(__x86_64__) || defined(__i386)
-    xmm0 = _mm_abs_epi16(rxF[i]);
-    xmm0 = _mm_subs_epi16(ch_mag[i],xmm0);
-
-    // lambda_1=y_R, lambda_2=|y_R|-|h|^2, lamda_3=y_I, lambda_4=|y_I|-|h|^2
-    llr128[0] = _mm_unpacklo_epi32(rxF[i],xmm0);
-    llr128[1] = _mm_unpackhi_epi32(rxF[i],xmm0);
-    llr32[0] = _mm_extract_epi32(llr128[0],0); //((uint32_t *)&llr128[0])[0];
-    llr32[1] = _mm_extract_epi32(llr128[0],1); //((uint32_t *)&llr128[0])[1];
-    llr32[2] = _mm_extract_epi32(llr128[0],2); //((uint32_t *)&llr128[0])[2];
-    llr32[3] = _mm_extract_epi32(llr128[0],3); //((uint32_t *)&llr128[0])[3];
-    llr32[4] = _mm_extract_epi32(llr128[1],0); //((uint32_t *)&llr128[1])[0];
-    llr32[5] = _mm_extract_epi32(llr128[1],1); //((uint32_t *)&llr128[1])[1];
-    llr32[6] = _mm_extract_epi32(llr128[1],2); //((uint32_t *)&llr128[1])[2];
-    llr32[7] = _mm_extract_epi32(llr128[1],3); //((uint32_t *)&llr128[1])[3];
-    llr32+=8;
-#elif defined(__arm__)
-    xmm0 = vabsq_s16(rxF[i]);
-    xmm0 = vqsubq_s16(ch_mag[i],xmm0);
-    // lambda_1=y_R, lambda_2=|y_R|-|h|^2, lamda_3=y_I, lambda_4=|y_I|-|h|^2
-
-    llr16[0] = vgetq_lane_s16(rxF[i],0);
-    llr16[1] = vgetq_lane_s16(rxF[i],1);
-    llr16[2] = vgetq_lane_s16(xmm0,0);
-    llr16[3] = vgetq_lane_s16(xmm0,1);
-    llr16[4] = vgetq_lane_s16(rxF[i],2);
-    llr16[5] = vgetq_lane_s16(rxF[i],3);
-    llr16[6] = vgetq_lane_s16(xmm0,2);
-    llr16[7] = vgetq_lane_s16(xmm0,3);
-    llr16[8] = vgetq_lane_s16(rxF[i],4);
-    llr16[9] = vgetq_lane_s16(rxF[i],5);
-    llr16[10] = vgetq_lane_s16(xmm0,4);
-    llr16[11] = vgetq_lane_s16(xmm0,5);
-    llr16[12] = vgetq_lane_s16(rxF[i],6);
-    llr16[13] = vgetq_lane_s16(rxF[i],6);
-    llr16[14] = vgetq_lane_s16(xmm0,7);
-    llr16[15] = vgetq_lane_s16(xmm0,7);
-    llr16+=16;
-#endif
-
-  }
-
-#if defined(__x86_64__) || defined(__i386__)
-  _mm_empty();
-  _m_empty();
-#endif
+  // update output pointer according to number of REs in this symbol (<<2 because 4 bits per RE)
+  *llr32p = llr + (len<<2);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -818,17 +937,13 @@ void dlsch_64qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
                      uint16_t pbch_pss_sss_adjust,
                      int16_t **llr_save)
 {
-#if defined(__x86_64__) || defined(__i386__)
-  __m128i *rxF = (__m128i*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
-  __m128i *ch_mag,*ch_magb;
-#elif defined(__arm__)
-  int16x8_t *rxF = (int16x8_t*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
-  int16x8_t *ch_mag,*ch_magb,xmm1,xmm2;
-#endif
-  int i,len,len2;
-  unsigned char symbol_mod,len_mod4;
-  short *llr;
-  int16_t *llr2;
+
+  int16_t *rxF = (int16_t*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
+  int16_t *ch_mag = (int16_t*)&dl_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
+  int16_t *ch_magb = (int16_t*)&dl_ch_magb[0][(symbol*frame_parms->N_RB_DL*12)];
+  int16_t *llr;
+  int len;
+  unsigned char symbol_mod;
 
   if (first_symbol_flag==1)
     llr = dlsch_llr;
@@ -837,13 +952,6 @@ void dlsch_64qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
 
   symbol_mod = (symbol>=(7-frame_parms->Ncp)) ? symbol-(7-frame_parms->Ncp) : symbol;
 
-#if defined(__x86_64__) || defined(__i386__)
-  ch_mag = (__m128i*)&dl_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
-  ch_magb = (__m128i*)&dl_ch_magb[0][(symbol*frame_parms->N_RB_DL*12)];
-#elif defined(__arm__)
-  ch_mag = (int16x8_t*)&dl_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
-  ch_magb = (int16x8_t*)&dl_ch_magb[0][(symbol*frame_parms->N_RB_DL*12)];
-#endif
   if ((symbol_mod==0) || (symbol_mod==(4-frame_parms->Ncp))) {
     if (frame_parms->mode1_flag==0)
       len = nb_rb*8 - (2*pbch_pss_sss_adjust/3);
@@ -853,111 +961,29 @@ void dlsch_64qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
     len = nb_rb*12 - pbch_pss_sss_adjust;
   }
 
-  llr2 = llr;
-  llr += (len*6);
+  // y_R, y_I, |h|^2-|y|, |h|^2b-||h|^2-|y|| for the 6 bits of each RE
+  qam64_llr(rxF,ch_mag,ch_magb,llr,len);
 
-  len_mod4 =len&3;
-  len2=len>>2;  // length in quad words (4 REs)
-  len2+=(len_mod4?0:1);
-
-  for (i=0; i<len2; i++) {
+  *llr_save = llr + (len*6);
+}
 
-#if defined(__x86_64__) || defined(__i386__)
-    xmm1 = _mm_abs_epi16(rxF[i]);
-    xmm1 = _mm_subs_epi16(ch_mag[i],xmm1);
-    xmm2 = _mm_abs_epi16(xmm1);
-    xmm2 = _mm_subs_epi16(ch_magb[i],xmm2);
-#elif defined(__arm__)
-    xmm1 = vabsq_s16(rxF[i]);
-    xmm1 = vsubq_s16(ch_mag[i],xmm1);
-    xmm2 = vabsq_s16(xmm1);
-    xmm2 = vsubq_s16(ch_magb[i],xmm2);
-#endif
-    // loop over all LLRs in quad word (24 coded bits)
-    /*
-      for (j=0;j<8;j+=2) {
-      llr2[0] = ((short *)&rxF[i])[j];
-      llr2[1] = ((short *)&rxF[i])[j+1];
-      llr2[2] = ((short *)&xmm1)[j];
-      llr2[3] = ((short *)&xmm1)[j+1];
-      llr2[4] = ((short *)&xmm2)[j];
-      llr2[5] = ((short *)&xmm2)[j+1];
-
-      llr2+=6;
-      }
-    */
-    llr2[0] = ((short *)&rxF[i])[0];
-    llr2[1] = ((short *)&rxF[i])[1];
-#if defined(__x86_64__) || defined(__i386__)
-    llr2[2] = _mm_extract_epi16(xmm1,0);
-    llr2[3] = _mm_extract_epi16(xmm1,1);//((short *)&xmm1)[j+1];
-    llr2[4] = _mm_extract_epi16(xmm2,0);//((short *)&xmm2)[j];
-    llr2[5] = _mm_extract_epi16(xmm2,1);//((short *)&xmm2)[j+1];
-#elif defined(__arm__)
-    llr2[2] = vgetq_lane_s16(xmm1,0);
-    llr2[3] = vgetq_lane_s16(xmm1,1);//((short *)&xmm1)[j+1];
-    llr2[4] = vgetq_lane_s16(xmm2,0);//((short *)&xmm2)[j];
-    llr2[5] = vgetq_lane_s16(xmm2,1);//((short *)&xmm2)[j+1];
-#endif
 
-    llr2+=6;
-    llr2[0] = ((short *)&rxF[i])[2];
-    llr2[1] = ((short *)&rxF[i])[3];
-#if defined(__x86_64__) || defined(__i386__)
-    llr2[2] = _mm_extract_epi16(xmm1,2);
-    llr2[3] = _mm_extract_epi16(xmm1,3);//((short *)&xmm1)[j+1];
-    llr2[4] = _mm_extract_epi16(xmm2,2);//((short *)&xmm2)[j];
-    llr2[5] = _mm_extract_epi16(xmm2,3);//((short *)&xmm2)[j+1];
-#elif defined(__arm__)
-    llr2[2] = vgetq_lane_s16(xmm1,2);
-    llr2[3] = vgetq_lane_s16(xmm1,3);//((short *)&xmm1)[j+1];
-    llr2[4] = vgetq_lane_s16(xmm2,2);//((short *)&xmm2)[j];
-    llr2[5] = vgetq_lane_s16(xmm2,3);//((short *)&xmm2)[j+1];
-#endif
+//==============================================================================================
+// DUAL-STREAM
+//==============================================================================================
 
-    llr2+=6;
-    llr2[0] = ((short *)&rxF[i])[4];
-    llr2[1] = ((short *)&rxF[i])[5];
-#if defined(__x86_64__) || defined(__i386__)
-    llr2[2] = _mm_extract_epi16(xmm1,4);
-    llr2[3] = _mm_extract_epi16(xmm1,5);//((short *)&xmm1)[j+1];
-    llr2[4] = _mm_extract_epi16(xmm2,4);//((short *)&xmm2)[j];
-    llr2[5] = _mm_extract_epi16(xmm2,5);//((short *)&xmm2)[j+1];
-#elif defined(__arm__)
-    llr2[2] = vgetq_lane_s16(xmm1,4);
-    llr2[3] = vgetq_lane_s16(xmm1,5);//((short *)&xmm1)[j+1];
-    llr2[4] = vgetq_lane_s16(xmm2,4);//((short *)&xmm2)[j];
-    llr2[5] = vgetq_lane_s16(xmm2,5);//((short *)&xmm2)[j+1];
-#endif
-    llr2+=6;
-    llr2[0] = ((short *)&rxF[i])[6];
-    llr2[1] = ((short *)&rxF[i])[7];
-#if defined(__x86_64__) || defined(__i386__)
-    llr2[2] = _mm_extract_epi16(xmm1,6);
-    llr2[3] = _mm_extract_epi16(xmm1,7);//((short *)&xmm1)[j+1];
-    llr2[4] = _mm_extract_epi16(xmm2,6);//((short *)&xmm2)[j];
-    llr2[5] = _mm_extract_epi16(xmm2,7);//((short *)&xmm2)[j+1];
-#elif defined(__arm__)
-    llr2[2] = vgetq_lane_s16(xmm1,6);
-    llr2[3] = vgetq_lane_s16(xmm1,7);//((short *)&xmm1)[j+1];
-    llr2[4] = vgetq_lane_s16(xmm2,6);//((short *)&xmm2)[j];
-    llr2[5] = vgetq_lane_s16(xmm2,7);//((short *)&xmm2)[j+1];
-#endif
-    llr2+=6;
+// 16/64QAM stream 0 LLRs of the interference-aware receiver, exact or qam_qam_llr_reduced()
+static ia_llr_mode_t ia_llr_mode = IA_LLR_EXACT;
 
-  }
+ia_llr_mode_t dlsch_set_ia_llr_mode(ia_llr_mode_t mode)
+{
 
-  *llr_save = llr;
 #if defined(__x86_64__) || defined(__i386__)
-  _mm_empty();
-  _m_empty();
+  ia_llr_mode = mode;
 #endif
-}
-
 
-//==============================================================================================
-// DUAL-STREAM
-//==============================================================================================
+  return(ia_llr_mode);
+}
 
 //----------------------------------------------------------------------------------------------
 // QPSK
@@ -2888,13 +2914,16 @@ int dlsch_16qam_16qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
 
   // printf("symbol %d: qam16_llr, len %d (llr16 %p)\n",symbol,len,llr16);
 
-  qam16_qam16((short *)rxF,
-              (short *)rxF_i,
-              (short *)ch_mag,
-              (short *)ch_mag_i,
-              (short *)llr16,
-              (short *)rho,
-              len);
+  if (ia_llr_mode != IA_LLR_EXACT)
+    qam_qam_llr_reduced(4,4,(short *)rxF,(short *)rxF_i,(short *)ch_mag,(short *)ch_mag_i,(short *)llr16,(short *)rho,len,ia_llr_mode);
+  else
+    qam16_qam16((short *)rxF,
+                (short *)rxF_i,
+                (short *)ch_mag,
+                (short *)ch_mag_i,
+                (short *)llr16,
+                (short *)rho,
+                len);
 
   llr16 += (len<<2);
   *llr16p = (short *)llr16;
@@ -3524,13 +3553,16 @@ int dlsch_16qam_64qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
 
   // printf("symbol %d: qam16_llr, len %d (llr16 %p)\n",symbol,len,llr16);
 
-  qam16_qam64((short *)rxF,
-              (short *)rxF_i,
-              (short *)ch_mag,
-              (short *)ch_mag_i,
-              (short *)llr16,
-              (short *)rho,
-              len);
+  if (ia_llr_mode != IA_LLR_EXACT)
+    qam_qam_llr_reduced(4,6,(short *)rxF,(short *)rxF_i,(short *)ch_mag,(short *)ch_mag_i,(short *)llr16,(short *)rho,len,ia_llr_mode);
+  else
+    qam16_qam64((short *)rxF,
+                (short *)rxF_i,
+                (short *)ch_mag,
+                (short *)ch_mag_i,
+                (short *)llr16,
+                (short *)rho,
+                len);
 
   llr16 += (len<<2);
   *llr16p = (short *)llr16;
@@ -6633,13 +6665,16 @@ int dlsch_64qam_16qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
     len = (nb_rb*12) - pbch_pss_sss_adjust;
   }
 
-  qam64_qam16((short *)rxF,
-              (short *)rxF_i,
-              (short *)ch_mag,
-              (short *)ch_mag_i,
-              (short *)llr16,
-              (short *)rho,
-              len);
+  if (ia_llr_mode != IA_LLR_EXACT)
+    qam_qam_llr_reduced(6,4,(short *)rxF,(short *)rxF_i,(short *)ch_mag,(short *)ch_mag_i,(short *)llr16,(short *)rho,len,ia_llr_mode);
+  else
+    qam64_qam16((short *)rxF,
+                (short *)rxF_i,
+                (short *)ch_mag,
+                (short *)ch_mag_i,
+                (short *)llr16,
+                (short *)rho,
+                len);
 
   llr16 += (6*len);
   *llr16p = (short *)llr16;
@@ -8446,15 +8481,401 @@ int dlsch_64qam_64qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
     len = (nb_rb*12) - pbch_pss_sss_adjust;
   }
 
-  qam64_qam64((short *)rxF,
-              (short *)rxF_i,
-              (short *)ch_mag,
-              (short *)ch_mag_i,
-              (short *)llr16,
-              (short *)rho,
-              len);
+  if (ia_llr_mode != IA_LLR_EXACT)
+    qam_qam_llr_reduced(6,6,(short *)rxF,(short *)rxF_i,(short *)ch_mag,(short *)ch_mag_i,(short *)llr16,(short *)rho,len,ia_llr_mode);
+  else
+    qam64_qam64((short *)rxF,
+                (short *)rxF_i,
+                (short *)ch_mag,
+                (short *)ch_mag_i,
+                (short *)llr16,
+                (short *)rho,
+                len);
 
   llr16 += (6*len);
   *llr16p = (short *)llr16;
   return(0);
 }
+
+//==============================================================================================
+// DUAL-STREAM, REDUCED HYPOTHESIS SET
+//==============================================================================================
+
+// Max-log LLRs of a 16/64QAM stream 0 interfered by a 16/64QAM stream 1, using the same
+// metric as the exact kernels above but only a few stream 0 hypotheses per RE.
+// Per dimension the candidates are the hard decision of the zero-forcing estimate of x0 and,
+// for each of its bits, the closest level with this bit flipped (ia_flip*), so that every bit
+// keeps a hypothesis on both sides. IA_LLR_APPROX_HIGH evaluates all their combinations (16 of 64 for 64QAM, 9 of 16 for
+// 16QAM), IA_LLR_APPROX_LOW only changes one dimension at a time (7 and 5 hypotheses).
+// The interference term, max-log over the stream 1 levels of each dimension, is piecewise linear
+// in |psi| with the slicing thresholds of the exact kernels; its segments are set up once per RE.
+// When the channel is ill-conditioned the zero-forcing error spans more levels than the candidates
+// cover, and the best hypothesis on one side of a bit can be missing: the LLR is then too large and
+// possibly of the wrong sign. The magnitudes are therefore bounded by ch_mag*det/(|h0|^2*|h1|^2),
+// ch_mag on an orthogonal channel and going to 0 as the streams become collinear.
+// Like the exact kernels, the inputs must keep the int16 headroom of dlsch_channel_compensation():
+// above about 2^11 per unit amplitude the exact kernels saturate their metrics before these do.
+// A QPSK stream 1 has no |h1|^2 for the zero-forcing estimate and keeps the exact kernels.
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// pshufb control selecting the 16-bit entry n of a table
+#define IA_C(n) (0x0100+(n)*0x0202)
+
+// a/sqrt(42) and a^2/(8*sqrt(42)) of the 64QAM levels a=-7,-5,...,7, Q2.14 and Q15
+static const int16_t ia_level64[8] __attribute__ ((aligned(16))) = {-17697,-12641,-7584,-2528,2528,7584,12641,17697};
+static const int16_t ia_energy64[8] __attribute__ ((aligned(16))) = {30969,15801,5688,632,632,5688,15801,30969};
+// closest level with bit 0 (sign), 1 (|a|>4) and 2 (|a|=1 or 7) flipped
+static const int16_t ia_flip64[3][8] __attribute__ ((aligned(16))) = {
+  {IA_C(4),IA_C(4),IA_C(4),IA_C(4),IA_C(3),IA_C(3),IA_C(3),IA_C(3)},
+  {IA_C(2),IA_C(2),IA_C(1),IA_C(1),IA_C(6),IA_C(6),IA_C(5),IA_C(5)},
+  {IA_C(1),IA_C(0),IA_C(3),IA_C(2),IA_C(5),IA_C(4),IA_C(7),IA_C(6)}
+};
+// 32767 where the bit is 1, -32768 where it is 0
+static const int16_t ia_bit64[3][8] __attribute__ ((aligned(16))) = {
+  {32767,32767,32767,32767,-32768,-32768,-32768,-32768},
+  {32767,32767,-32768,-32768,-32768,-32768,32767,32767},
+  {32767,-32768,-32768,32767,32767,-32768,-32768,32767}
+};
+
+// a/sqrt(10) and a^2/(4*sqrt(10)) of the 16QAM levels a=-3,-1,1,3
+static const int16_t ia_level16[8] __attribute__ ((aligned(16))) = {-15543,-5181,5181,15543,0,0,0,0};
+static const int16_t ia_energy16[8] __attribute__ ((aligned(16))) = {23315,2591,2591,23315,0,0,0,0};
+// closest level with bit 0 (sign) and 1 (|a|=3) flipped
+static const int16_t ia_flip16[2][8] __attribute__ ((aligned(16))) = {
+  {IA_C(2),IA_C(2),IA_C(1),IA_C(1),0,0,0,0},
+  {IA_C(1),IA_C(0),IA_C(3),IA_C(2),0,0,0,0}
+};
+static const int16_t ia_bit16[2][8] __attribute__ ((aligned(16))) = {
+  {32767,32767,-32768,-32768,0,0,0,0},
+  {32767,-32768,-32768,32767,0,0,0,0}
+};
+
+// Interference term of one dimension, level a and energy s of segment k selected by |psi|>t[k]
+typedef struct {
+  __m128i t[4];
+  __m128i da[4];
+  __m128i ds[4];
+} ia_segments_t;
+
+static inline __m128i ia_lut_epi16(const int16_t *table,__m128i c) __attribute__((always_inline));
+static inline __m128i ia_lut_epi16(const int16_t *table,__m128i c)
+{
+
+  return(_mm_shuffle_epi8(_mm_load_si128((__m128i *)table),c));
+}
+
+// int16 re/im pairs of 8 REs to one vector of real and one of imaginary parts
+static inline void ia_deinterleave(const int16_t *x,__m128i *re,__m128i *im) __attribute__((always_inline));
+static inline void ia_deinterleave(const int16_t *x,__m128i *re,__m128i *im)
+{
+
+  __m128i a = _mm_loadu_si128((__m128i *)x);
+  __m128i b = _mm_loadu_si128((__m128i *)(x+8));
+
+  *re = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a,16),16),_mm_srai_epi32(_mm_slli_epi32(b,16),16));
+  *im = _mm_packs_epi32(_mm_srai_epi32(a,16),_mm_srai_epi32(b,16));
+}
+
+// lower (half 0) or upper 4 int16 of x as floats
+static inline __m128 ia_cvt_ps(__m128i x,int half) __attribute__((always_inline));
+static inline __m128 ia_cvt_ps(__m128i x,int half)
+{
+
+  x = (half==0) ? _mm_unpacklo_epi16(x,x) : _mm_unpackhi_epi16(x,x);
+
+  return(_mm_cvtepi32_ps(_mm_srai_epi32(x,16)));
+}
+
+// x limited to [-bound,bound]
+static inline __m128i ia_bound_epi16(__m128i x,__m128i bound) __attribute__((always_inline));
+static inline __m128i ia_bound_epi16(__m128i x,__m128i bound)
+{
+
+  return(_mm_min_epi16(_mm_max_epi16(x,_mm_sign_epi16(bound,_mm_set1_epi16(-1))),bound));
+}
+
+// x clipped to [0,max], a NaN gives 0 (maxps returns its second operand)
+static inline __m128 ia_clip_ps(__m128 x,float max) __attribute__((always_inline));
+static inline __m128 ia_clip_ps(__m128 x,float max)
+{
+
+  return(_mm_min_ps(_mm_max_ps(x,_mm_setzero_ps()),_mm_set1_ps(max)));
+}
+
+static inline __m128i ia_interference(__m128i psi,const ia_segments_t *seg,const int nb_seg) __attribute__((always_inline));
+static inline __m128i ia_interference(__m128i psi,const ia_segments_t *seg,const int nb_seg)
+{
+
+  __m128i a = seg->da[0];
+  __m128i s = seg->ds[0];
+  __m128i m;
+  int k;
+
+  psi = _mm_abs_epi16(psi);
+
+  for (k=1; k<nb_seg; k++) {
+    m = _mm_cmpgt_epi16(psi,seg->t[k]);
+    a = _mm_add_epi16(a,_mm_and_si128(m,seg->da[k]));
+    s = _mm_add_epi16(s,_mm_and_si128(m,seg->ds[k]));
+  }
+
+  // |psi|*a - |h1|^2*a^2/2
+  return(_mm_subs_epi16(_mm_slli_epi16(_mm_mulhi_epi16(psi,a),2),s));
+}
+
+// LLRs of 8 REs
+static inline void ia_llr8(const int mod0,const int mod1,const int low,
+                           const int16_t *y0p,const int16_t *y1p,const int16_t *ch_magp,const int16_t *ch_mag_ip,
+                           const int16_t *rhop,int16_t *out) __attribute__((always_inline));
+static inline void ia_llr8(const int mod0,const int mod1,const int low,
+                           const int16_t *y0p,const int16_t *y1p,const int16_t *ch_magp,const int16_t *ch_mag_ip,
+                           const int16_t *rhop,int16_t *out)
+{
+
+  const int nb_bits = mod0>>1;                   // bits per dimension
+  const int nb_cand = 1+nb_bits;                 // candidate levels per dimension
+  const int nb_seg  = (mod1==6) ? 4 : 2;         // interference amplitudes
+  const int16_t *level  = (mod0==6) ? ia_level64 : ia_level16;
+  const int16_t *energy = (mod0==6) ? ia_energy64 : ia_energy16;
+  const int16_t *flip   = (mod0==6) ? &ia_flip64[0][0] : &ia_flip16[0][0];
+  const int16_t *bit    = (mod0==6) ? &ia_bit64[0][0] : &ia_bit16[0][0];
+  const int16_t *level_i  = (mod1==6) ? ia_level64 : ia_level16;
+  const int16_t *energy_i = (mod1==6) ? ia_energy64 : ia_energy16;
+  __m128i y0r,y0i,y1r,y1i,rho_r,rho_i,ch_mag,ch_mag_i,tmp;
+  __m128i cr[4],ci[4];               // candidate levels as pshufb controls
+  __m128i ar[4],ai[4];               // y0*a - |h0|^2*a^2/2
+  __m128i pr[4],qr[4],pj[4],qj[4];   // rho*a
+  __m128i mr[4],mi[4];               // best metric per candidate level
+  __m128i nr[2],ni[2],nc[2];
+  __m128 fy0r,fy0i,fy1r,fy1i,frr,fri,fe1,fp,fd;
+  __m128i llr[6],max0,max1,met,psi_r,psi_i,clip;
+  ia_segments_t seg;
+  int r,j,k;
+
+  ia_deinterleave(y0p,&y0r,&y0i);
+  ia_deinterleave(y1p,&y1r,&y1i);
+  ia_deinterleave(rhop,&rho_r,&rho_i);
+  ia_deinterleave(ch_magp,&ch_mag,&tmp);
+
+  // interference segments, stream 1 levels 1,3(,5,7) from |psi| > |h1|^2*(2,4,6)/sqrt(42) or 2/sqrt(10)
+  ia_deinterleave(ch_mag_ip,&ch_mag_i,&tmp);
+
+  if (mod1 == 6) {
+    seg.t[1] = _mm_srai_epi16(ch_mag_i,1);
+    seg.t[2] = ch_mag_i;
+    seg.t[3] = _mm_adds_epi16(seg.t[1],ch_mag_i);
+  } else
+    seg.t[1] = ch_mag_i;
+
+  for (k=0; k<nb_seg; k++) {
+    seg.da[k] = _mm_set1_epi16(level_i[nb_seg+k]);
+    seg.ds[k] = _mm_slli_epi16(_mm_mulhi_epi16(ch_mag_i,_mm_set1_epi16(energy_i[nb_seg+k])),1);
+  }
+
+  // the segments accumulate, keep the differences to the previous one
+  for (k=nb_seg-1; k>0; k--) {
+    seg.da[k] = _mm_sub_epi16(seg.da[k],seg.da[k-1]);
+    seg.ds[k] = _mm_sub_epi16(seg.ds[k],seg.ds[k-1]);
+  }
+
+  // hard decision of the zero-forcing estimate (|h1|^2*y0 - rho*y1)/(|h0|^2*|h1|^2 - |rho|^2)
+  for (k=0; k<2; k++) {
+    fy0r = ia_cvt_ps(y0r,k);
+    fy0i = ia_cvt_ps(y0i,k);
+    fy1r = ia_cvt_ps(y1r,k);
+    fy1i = ia_cvt_ps(y1i,k);
+    frr  = ia_cvt_ps(rho_r,k);
+    fri  = ia_cvt_ps(rho_i,k);
+    fe1  = _mm_mul_ps(ia_cvt_ps(ch_mag_i,k),_mm_set1_ps((mod1==6) ? 1.6201852f : 1.5811388f));
+    fp   = _mm_mul_ps(_mm_mul_ps(ia_cvt_ps(ch_mag,k),_mm_set1_ps((mod0==6) ? 1.6201852f : 1.5811388f)),fe1);
+    fd   = _mm_sub_ps(fp,_mm_add_ps(_mm_mul_ps(frr,frr),_mm_mul_ps(fri,fri)));
+    // LLR bound ch_mag*det/(|h0|^2*|h1|^2), see above
+    nc[k] = _mm_cvtps_epi32(ia_clip_ps(_mm_div_ps(_mm_mul_ps(ia_cvt_ps(ch_mag,k),fd),_mm_max_ps(fp,_mm_set1_ps(1.0f))),32767.0f));
+    // a singular channel (det below one unit of the int16 inputs, or negative after rounding) only
+    // gives a poor estimate, never an inf/NaN index: the candidates still cover every bit
+    fd   = _mm_max_ps(fd,_mm_set1_ps(1.0f));
+    // level index (a+M-1)/2 of a = sqrt(42)*x or sqrt(10)*x, clipped to the constellation in float
+    // so that the conversion cannot overflow
+    fd   = _mm_div_ps(_mm_set1_ps((mod0==6) ? 3.2403703f : 1.5811388f),fd);
+    nr[k] = _mm_cvtps_epi32(ia_clip_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(fe1,fy0r),_mm_sub_ps(_mm_mul_ps(frr,fy1r),_mm_mul_ps(fri,fy1i))),fd),
+                                                  _mm_set1_ps((mod0==6) ? 3.5f : 1.5f)),(mod0==6) ? 7.0f : 3.0f));
+    ni[k] = _mm_cvtps_epi32(ia_clip_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(fe1,fy0i),_mm_add_ps(_mm_mul_ps(frr,fy1i),_mm_mul_ps(fri,fy1r))),fd),
+                                                  _mm_set1_ps((mod0==6) ? 3.5f : 1.5f)),(mod0==6) ? 7.0f : 3.0f));
+  }
+
+  cr[0] = _mm_packs_epi32(nr[0],nr[1]);
+  ci[0] = _mm_packs_epi32(ni[0],ni[1]);
+  clip  = _mm_packs_epi32(nc[0],nc[1]);
+  cr[0] = _mm_add_epi16(_mm_mullo_epi16(cr[0],_mm_set1_epi16(0x0202)),_mm_set1_epi16(IA_C(0)));
+  ci[0] = _mm_add_epi16(_mm_mullo_epi16(ci[0],_mm_set1_epi16(0x0202)),_mm_set1_epi16(IA_C(0)));
+
+  for (r=0; r<nb_cand; r++) {
+    if (r > 0) {
+      cr[r] = ia_lut_epi16(&flip[(r-1)*8],cr[0]);
+      ci[r] = ia_lut_epi16(&flip[(r-1)*8],ci[0]);
+    }
+
+    tmp   = ia_lut_epi16(level,cr[r]);
+    ar[r] = _mm_subs_epi16(_mm_slli_epi16(_mm_mulhi_epi16(y0r,tmp),2),
+                           _mm_slli_epi16(_mm_mulhi_epi16(ch_mag,ia_lut_epi16(energy,cr[r])),1));
+    pr[r] = _mm_slli_epi16(_mm_mulhi_epi16(rho_r,tmp),2);
+    qr[r] = _mm_slli_epi16(_mm_mulhi_epi16(rho_i,tmp),2);
+    tmp   = ia_lut_epi16(level,ci[r]);
+    ai[r] = _mm_subs_epi16(_mm_slli_epi16(_mm_mulhi_epi16(y0i,tmp),2),
+                           _mm_slli_epi16(_mm_mulhi_epi16(ch_mag,ia_lut_epi16(energy,ci[r])),1));
+    pj[r] = _mm_slli_epi16(_mm_mulhi_epi16(rho_i,tmp),2);
+    qj[r] = _mm_slli_epi16(_mm_mulhi_epi16(rho_r,tmp),2);
+  }
+
+  // metric of x0 = (a_r + j*a_i): psi_r = Re(rho)a_r + Im(rho)a_i - y1r, psi_i = Re(rho)a_i - Im(rho)a_r - y1i
+#define IA_METRIC(r,j) psi_r = _mm_subs_epi16(_mm_adds_epi16(pr[r],pj[j]),y1r); \
+  psi_i = _mm_subs_epi16(_mm_subs_epi16(qj[j],qr[r]),y1i); \
+  met = _mm_adds_epi16(_mm_adds_epi16(ia_interference(psi_r,&seg,nb_seg),ia_interference(psi_i,&seg,nb_seg)), \
+                       _mm_adds_epi16(ar[r],ai[j]));
+
+  IA_METRIC(0,0);
+  mr[0] = met;
+  mi[0] = met;
+
+  if (low) {
+    for (r=1; r<nb_cand; r++) {
+      IA_METRIC(r,0);
+      mr[r] = met;
+      mi[0] = _mm_max_epi16(mi[0],met);
+      IA_METRIC(0,r);
+      mi[r] = met;
+      mr[0] = _mm_max_epi16(mr[0],met);
+    }
+  } else {
+    for (r=0; r<nb_cand; r++) {
+      for (j=0; j<nb_cand; j++) {
+        if ((r|j) == 0)
+          continue;
+
+        IA_METRIC(r,j);
+        mr[r] = (j==0) ? met : _mm_max_epi16(mr[r],met);
+        mi[j] = (r==0) ? met : _mm_max_epi16(mi[j],met);
+      }
+    }
+  }
+
+#undef IA_METRIC
+
+  // LLR = best metric with bit 0 - best metric with bit 1
+  for (k=0; k<nb_bits; k++) {
+    max0 = _mm_set1_epi16(-32768);
+    max1 = max0;
+
+    for (r=0; r<nb_cand; r++) {
+      tmp  = ia_lut_epi16(&bit[k*8],cr[r]);
+      max1 = _mm_max_epi16(max1,_mm_min_epi16(mr[r],tmp));
+      max0 = _mm_max_epi16(max0,_mm_min_epi16(mr[r],_mm_xor_si128(tmp,_mm_set1_epi16(-1))));
+    }
+
+    llr[2*k] = ia_bound_epi16(_mm_subs_epi16(max0,max1),clip);
+    max0 = _mm_set1_epi16(-32768);
+    max1 = max0;
+
+    for (r=0; r<nb_cand; r++) {
+      tmp  = ia_lut_epi16(&bit[k*8],ci[r]);
+      max1 = _mm_max_epi16(max1,_mm_min_epi16(mi[r],tmp));
+      max0 = _mm_max_epi16(max0,_mm_min_epi16(mi[r],_mm_xor_si128(tmp,_mm_set1_epi16(-1))));
+    }
+
+    llr[2*k+1] = ia_bound_epi16(_mm_subs_epi16(max0,max1),clip);
+  }
+
+  // coded bit order, real/imaginary LLR pairs of bit 0, 1 (and 2) per RE
+  for (k=0; k<nb_bits; k++) {
+    tmp        = _mm_unpacklo_epi16(llr[2*k],llr[2*k+1]);
+    llr[2*k+1] = _mm_unpackhi_epi16(llr[2*k],llr[2*k+1]);
+    llr[2*k]   = tmp;
+  }
+
+  if (mod0 == 4) {
+    _mm_storeu_si128((__m128i *)&out[0], _mm_unpacklo_epi32(llr[0],llr[2]));
+    _mm_storeu_si128((__m128i *)&out[8], _mm_unpackhi_epi32(llr[0],llr[2]));
+    _mm_storeu_si128((__m128i *)&out[16],_mm_unpacklo_epi32(llr[1],llr[3]));
+    _mm_storeu_si128((__m128i *)&out[24],_mm_unpackhi_epi32(llr[1],llr[3]));
+  } else {
+    for (k=0; k<2; k++) {
+      tmp = _mm_unpackhi_epi32(llr[2+k],llr[4+k]);
+      _mm_storeu_si128((__m128i *)&out[k*24],
+                       _mm_unpacklo_epi64(_mm_unpacklo_epi32(llr[k],llr[2+k]),_mm_unpacklo_epi32(llr[4+k],_mm_srli_si128(llr[k],4))));
+      _mm_storeu_si128((__m128i *)&out[k*24+8],
+                       _mm_unpacklo_epi64(_mm_unpacklo_epi32(_mm_srli_si128(llr[2+k],4),_mm_srli_si128(llr[4+k],4)),_mm_unpackhi_epi32(llr[k],llr[2+k])));
+      _mm_storeu_si128((__m128i *)&out[k*24+16],
+                       _mm_unpacklo_epi64(_mm_unpacklo_epi32(_mm_srli_si128(llr[4+k],8),_mm_srli_si128(llr[k],12)),_mm_srli_si128(tmp,8)));
+    }
+  }
+}
+
+static inline void ia_llr(const int mod0,const int mod1,const int low,
+                          const int16_t *stream0_in,const int16_t *stream1_in,const int16_t *ch_mag,const int16_t *ch_mag_i,
+                          int16_t *stream0_out,const int16_t *rho01,int length) __attribute__((always_inline));
+static inline void ia_llr(const int mod0,const int mod1,const int low,
+                          const int16_t *stream0_in,const int16_t *stream1_in,const int16_t *ch_mag,const int16_t *ch_mag_i,
+                          int16_t *stream0_out,const int16_t *rho01,int length)
+{
+
+  int16_t tail[5][16] __attribute__ ((aligned(16)));
+  int16_t tail_out[48] __attribute__ ((aligned(16)));
+  int i,n;
+
+  for (i=0; i+8<=length; i+=8)
+    ia_llr8(mod0,mod1,low,
+            &stream0_in[i<<1],&stream1_in[i<<1],&ch_mag[i<<1],&ch_mag_i[i<<1],
+            &rho01[i<<1],&stream0_out[i*mod0]);
+
+  n = length-i;
+
+  if (n > 0) {
+    memset(tail,0,sizeof(tail));
+    memcpy(tail[0],&stream0_in[i<<1],n*4);
+    memcpy(tail[1],&stream1_in[i<<1],n*4);
+    memcpy(tail[2],&ch_mag[i<<1],n*4);
+    memcpy(tail[3],&ch_mag_i[i<<1],n*4);
+    memcpy(tail[4],&rho01[i<<1],n*4);
+
+    ia_llr8(mod0,mod1,low,tail[0],tail[1],tail[2],tail[3],tail[4],tail_out);
+    memcpy(&stream0_out[i*mod0],tail_out,n*mod0*sizeof(int16_t));
+  }
+}
+
+#undef IA_C
+
+#endif
+
+void qam_qam_llr_reduced(int mod_order0,
+                         int mod_order1,
+                         short *stream0_in,
+                         short *stream1_in,
+                         short *ch_mag,
+                         short *ch_mag_i,
+                         short *stream0_out,
+                         short *rho01,
+                         int length,
+                         ia_llr_mode_t mode)
+{
+
+#if defined(__x86_64__) || defined(__i386__)
+  // one specialization per combination
+#define IA_LLR_CASE(m0,m1) \
+  if ((mod_order0==m0) && (mod_order1==m1)) { \
+    if (mode == IA_LLR_APPROX_LOW) \
+      ia_llr(m0,m1,1,stream0_in,stream1_in,ch_mag,ch_mag_i,stream0_out,rho01,length); \
+    else \
+      ia_llr(m0,m1,0,stream0_in,stream1_in,ch_mag,ch_mag_i,stream0_out,rho01,length); \
+    return; \
+  }
+
+  IA_LLR_CASE(4,4);
+  IA_LLR_CASE(4,6);
+  IA_LLR_CASE(6,4);
+  IA_LLR_CASE(6,6);
+#undef IA_LLR_CASE
+
+  msg("qam_qam_llr_reduced: unsupported modulations %d/%d\n",mod_order0,mod_order1);
+#endif
+}
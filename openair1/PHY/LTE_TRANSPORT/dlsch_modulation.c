@@ -136,6 +136,206 @@ void layer1prec2A(int32_t *antenna0_sample, int32_t *antenna1_sample, uint8_t pr
   ((int16_t *)antenna1_sample)[1] = (int16_t)((((int16_t *)antenna1_sample)[1]*ONE_OVER_SQRT2_Q15)>>15);  */
 }
 
+// Data REs of an RB for each (pilots,nushift,use2ndpilots), as given by is_not_pilot(), filled by init_dlsch_re_list()
+static uint8_t dlsch_re_list[3][6][2][12];
+static uint8_t dlsch_re_cnt[3][6][2];
+
+void init_dlsch_re_list(void)
+{
+
+  uint8_t pilots,nushift,use2ndpilots,re;
+
+  for (pilots=0; pilots<3; pilots++)
+    for (nushift=0; nushift<6; nushift++)
+      for (use2ndpilots=0; use2ndpilots<2; use2ndpilots++) {
+        dlsch_re_cnt[pilots][nushift][use2ndpilots] = 0;
+
+        for (re=0; re<12; re++)
+          if (is_not_pilot(pilots,re,nushift,use2ndpilots)==1)
+            dlsch_re_list[pilots][nushift][use2ndpilots][dlsch_re_cnt[pilots][nushift][use2ndpilots]++] = re;
+      }
+}
+
+/* Modulation of the next nb_re REs of x through table, which is indexed like the qam tables in
+   allocate_REs_in_RB() (QPSK : 0 for bit 0, 1 for bit 1). The output is I/Q interleaved, nb_re is
+   rounded up to a multiple of 4 (x is read up to 28 bytes past the last bit used). */
+static inline void dlsch_modulate_REs(uint8_t *x,
+                                      uint8_t mod_order,
+                                      int16_t *table,
+                                      int16_t *out,
+                                      int nb_re)
+{
+
+  int i;
+#if defined(__SSSE3__)
+  const __m128i one   = _mm_set1_epi8(1);
+  const __m128i zero  = _mm_setzero_si128();
+  const __m128i c16   = _mm_setr_epi8(0,-1,1,-1,4,-1,5,-1,8,-1,9,-1,12,-1,13,-1);
+  const __m128i c64lo = _mm_setr_epi8(0,-1,1,-1,6,-1,7,-1,-1,-1,-1,-1,-1,-1,-1,-1);
+  const __m128i c64hi = _mm_setr_epi8(-1,-1,-1,-1,-1,-1,-1,-1,0,-1,1,-1,6,-1,7,-1);
+  __m128i tab = _mm_loadu_si128((__m128i *)table);
+  __m128i b0,b1,t0,t1,idx;
+
+  for (i=0; i<nb_re; i+=4) {
+    switch (mod_order) {
+    case 2:
+      b0  = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadl_epi64((__m128i *)x),one),one);
+      idx = _mm_unpacklo_epi8(b0,zero);
+      x  += 8;
+      break;
+
+    case 4:
+      // re/im index 2*b(4k)+b(4k+2) and 2*b(4k+1)+b(4k+3)
+      b0  = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)x),one),one);
+      t0  = _mm_add_epi8(_mm_add_epi8(b0,b0),_mm_srli_si128(b0,2));
+      idx = _mm_shuffle_epi8(t0,c16);
+      x  += 16;
+      break;
+
+    default:
+      // re/im index 4*b(6k)+2*b(6k+2)+b(6k+4) and the same from 6k+1, two REs per load
+      b0  = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)x),one),one);
+      b1  = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(x+12)),one),one);
+      t0  = _mm_add_epi8(_mm_add_epi8(_mm_slli_epi16(b0,2),_mm_slli_epi16(_mm_srli_si128(b0,2),1)),_mm_srli_si128(b0,4));
+      t1  = _mm_add_epi8(_mm_add_epi8(_mm_slli_epi16(b1,2),_mm_slli_epi16(_mm_srli_si128(b1,2),1)),_mm_srli_si128(b1,4));
+      idx = _mm_or_si128(_mm_shuffle_epi8(t0,c64lo),_mm_shuffle_epi8(t1,c64hi));
+      x  += 24;
+      break;
+    }
+
+    // int16 table lookup : bytes 2*idx and 2*idx+1 of the table
+    idx = _mm_add_epi16(_mm_mullo_epi16(idx,_mm_set1_epi16(0x0202)),_mm_set1_epi16(0x0100));
+    _mm_storeu_si128((__m128i *)&out[i<<1],_mm_shuffle_epi8(tab,idx));
+  }
+
+#else
+  int j,k,idx;
+
+  for (i=0; i<(nb_re<<1); i++) {
+    idx = 0;
+
+    for (j=0,k=i&1; j<(mod_order>>1); j++,k+=2)
+      idx = (idx<<1) + ((x[k]==1) ? 1 : 0);
+
+    out[i] = table[idx];
+
+    if (i&1)
+      x += mod_order;
+  }
+
+#endif
+}
+
+/* Adds the modulated REs of one full RB (no DC, PBCH or sync signal inside) to txdataF. SISO puts
+   the same symbols on every antenna. For the 1-layer precoded modes the second antenna gets the
+   layer1prec2A() image of the first: neg is the value of table[0]+table[1] for QPSK, where the
+   symbols are scaled after precoding, and 0 for 16/64QAM. */
+static inline void dlsch_map_RB(LTE_DL_FRAME_PARMS *frame_parms,
+                                mod_sym_t **txdataF,
+                                uint32_t tti_offset,
+                                uint8_t *re_list,
+                                uint8_t nb_re,
+                                int16_t *s,
+                                MIMO_mode_t mimo_mode,
+                                uint8_t precoder_index,
+                                int16_t neg)
+{
+
+  int16_t s1[24] __attribute__((aligned(16)));
+  int16_t *sa;
+  uint8_t aa,nb_antennas,re;
+  int i;
+
+  nb_antennas = (mimo_mode == SISO) ? frame_parms->nb_antennas_tx : 1;
+
+  if ((mimo_mode != SISO) && (frame_parms->nb_antennas_tx == 2)) {
+#if defined(__SSSE3__)
+    __m128i v,sgn,off;
+
+    switch (precoder_index) {
+    case 0: // 1 1
+      sgn = _mm_set1_epi16(1);
+      off = _mm_setzero_si128();
+      break;
+
+    case 1: // 1 -1
+      sgn = _mm_set1_epi16(-1);
+      off = _mm_set1_epi16(neg);
+      break;
+
+    case 2: // 1 j
+      sgn = _mm_setr_epi16(-1,1,-1,1,-1,1,-1,1);
+      off = _mm_setr_epi16(neg,0,neg,0,neg,0,neg,0);
+      break;
+
+    default: // 1 -j
+      sgn = _mm_setr_epi16(1,-1,1,-1,1,-1,1,-1);
+      off = _mm_setr_epi16(0,neg,0,neg,0,neg,0,neg);
+      break;
+    }
+
+    for (i=0; i<24; i+=8) {
+      v = _mm_loadu_si128((__m128i *)&s[i]);
+
+      if (precoder_index >= 2)
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v,0xb1),0xb1);
+
+      _mm_store_si128((__m128i *)&s1[i],_mm_add_epi16(_mm_sign_epi16(v,sgn),off));
+    }
+
+#else
+
+    for (i=0; i<24; i+=2) {
+      switch (precoder_index) {
+      case 0: // 1 1
+        s1[i]   = s[i];
+        s1[i+1] = s[i+1];
+        break;
+
+      case 1: // 1 -1
+        s1[i]   = neg-s[i];
+        s1[i+1] = neg-s[i+1];
+        break;
+
+      case 2: // 1 j
+        s1[i]   = neg-s[i+1];
+        s1[i+1] = s[i];
+        break;
+
+      default: // 1 -j
+        s1[i]   = s[i+1];
+        s1[i+1] = neg-s[i];
+        break;
+      }
+    }
+
+#endif
+    nb_antennas = 2;
+  }
+
+  for (aa=0; aa<nb_antennas; aa++) {
+    sa = ((aa == 0) || (mimo_mode == SISO)) ? s : s1;
+
+    if (nb_re == 12) {
+#if defined(__SSE2__)
+
+      for (i=0; i<3; i++)
+        _mm_storeu_si128((__m128i *)&txdataF[aa][tti_offset+(i<<2)],
+                         _mm_add_epi16(_mm_loadu_si128((__m128i *)&txdataF[aa][tti_offset+(i<<2)]),
+                                       _mm_loadu_si128((__m128i *)&sa[i<<3])));
+
+      continue;
+#endif
+    }
+
+    for (i=0; i<nb_re; i++) {
+      re = re_list[i];
+      ((int16_t *)&txdataF[aa][tti_offset+re])[0] += sa[i<<1];
+      ((int16_t *)&txdataF[aa][tti_offset+re])[1] += sa[1+(i<<1)];
+    }
+  }
+}
+
 int allocate_REs_in_RB(LTE_DL_FRAME_PARMS *frame_parms,
                        mod_sym_t **txdataF,
                        uint32_t *jj,
@@ -1203,6 +1403,10 @@ int dlsch_modulation(mod_sym_t **txdataF,
   int16_t qam16_table_a0[4],qam64_table_a0[8],qam16_table_b0[4],qam64_table_b0[8];
   int16_t qam16_table_a1[4],qam64_table_a1[8],qam16_table_b1[4],qam64_table_b1[8];
   int16_t *qam_table_s0,*qam_table_s1;
+  MIMO_mode_t mimo_mode = dlsch0_harq->mimo_mode;
+  uint8_t map_RB = 0,pilots_ind,use2ndpilots = (frame_parms->mode1_flag==1)?1:0;
+  int16_t map_table[2][8],map_neg[2],amp_p,gain_p;
+  int16_t map_s[24] __attribute__((aligned(16)));
 #ifdef DEBUG_DLSCH_MODULATION
   uint8_t Nl0 = dlsch0_harq->Nl;
   uint8_t Nl1;
@@ -1245,6 +1449,37 @@ int dlsch_modulation(mod_sym_t **txdataF,
       qam64_table_b1[i] = (int16_t)(((int32_t)qam64_table[i]*amp_rho_b)>>15);
     }
 
+  // Full RBs of SISO and 1-layer precoded PDSCH are mapped with dlsch_map_RB() from per-RB RE lists and
+  // symbol tables for the rho_a (index 0) and rho_b (index 1) symbols, everything else by allocate_REs_in_RB()
+  if (((mimo_mode == SISO) || ((mimo_mode >= UNIFORM_PRECODING11) && (mimo_mode <= PUSCH_PRECODING1))) &&
+      ((mod_order0 == 2) || (mod_order0 == 4) || (mod_order0 == 6))) {
+    map_RB = 1;
+
+    for (pilots_ind=0; pilots_ind<2; pilots_ind++) {
+      amp_p  = (pilots_ind) ? amp_rho_b : amp_rho_a;
+      gain_p = (int16_t)((amp_p*ONE_OVER_SQRT2_Q15)>>15);
+      memset(map_table[pilots_ind],0,sizeof(map_table[pilots_ind]));
+      map_neg[pilots_ind] = 0;
+
+      if (mimo_mode == SISO) {
+        if (mod_order0 == 2) {
+          map_table[pilots_ind][0] = gain_p;
+          map_table[pilots_ind][1] = -gain_p;
+        } else
+          memcpy(map_table[pilots_ind],
+                 (mod_order0 == 4) ? ((pilots_ind) ? qam16_table_b0 : qam16_table_a0) : ((pilots_ind) ? qam64_table_b0 : qam64_table_a0),
+                 (1<<(mod_order0>>1))*sizeof(int16_t));
+      } else if (mod_order0 == 2) {
+        map_table[pilots_ind][0] = (int16_t)((gain_p*ONE_OVER_SQRT2_Q15)>>15);
+        map_table[pilots_ind][1] = (int16_t)((-gain_p*ONE_OVER_SQRT2_Q15)>>15);
+        map_neg[pilots_ind]      = map_table[pilots_ind][0]+map_table[pilots_ind][1];
+      } else {
+        for (i=0; i<(1<<(mod_order0>>1)); i++)
+          map_table[pilots_ind][i] = (int16_t)(((int32_t)gain_p*((mod_order0 == 4) ? qam16_table[i] : qam64_table[i]))>>15);
+      }
+    }
+  }
+
   //Modulation mapping (difference w.r.t. LTE specs)
 
   jj=0;
@@ -1446,7 +1681,22 @@ int dlsch_modulation(mod_sym_t **txdataF,
       else
         qam_table_s1 = NULL;
 
-      if (rb_alloc_ind > 0) {
+      if ((rb_alloc_ind > 0) && (map_RB == 1) && (skip_dc == 0) && (skip_half == 0)) {
+        pilots_ind = (pilots) ? 1 : 0;
+        i = dlsch_re_cnt[pilots][frame_parms->nushift][use2ndpilots];
+        dlsch_modulate_REs(&dlsch0_harq->e[jj],mod_order0,map_table[pilots_ind],map_s,i);
+        dlsch_map_RB(frame_parms,
+                     txdataF,
+                     symbol_offset+re_offset,
+                     dlsch_re_list[pilots][frame_parms->nushift][use2ndpilots],
+                     i,
+                     map_s,
+                     mimo_mode,
+                     (mimo_mode == SISO) ? 0 : get_pmi(frame_parms->N_RB_DL,dlsch0_harq,rb),
+                     map_neg[pilots_ind]);
+        jj           += i*mod_order0;
+        re_allocated += i;
+      } else if (rb_alloc_ind > 0) {
         //    printf("Allocated rb %d/symbol %d, skip_half %d, subframe_offset %d, symbol_offset %d, re_offset %d, jj %d\n",rb,l,skip_half,subframe_offset,symbol_offset,re_offset,jj);
         allocate_REs_in_RB(frame_parms,
                            txdataF,
@@ -48,6 +48,285 @@
 #include "PHY/extern.h"
 #include "UTIL/LOG/vcd_signal_dumper.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Scrambling kernels. Position k of the input uses bit k&31 of word k>>5 of the Gold sequence
+// (as returned by lte_gold_scrambling_sequence()). The bits of one word are expanded to 32 byte
+// masks (or 16 int16 masks) with a byte shuffle and a compare, so that 16 or 32 positions are
+// scrambled per instruction instead of one per iteration of a bit loop.
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define AVX2_FUNC __attribute__((target("avx2")))
+
+static int scrambling_avx2 = -1;
+
+static inline int scrambling_avx2_enabled(void) __attribute__((always_inline));
+static inline int scrambling_avx2_enabled(void)
+{
+
+  if (scrambling_avx2 < 0)
+    scrambling_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+
+  return(scrambling_avx2);
+}
+
+int scrambling_set_avx2(int enable)
+{
+
+  scrambling_avx2 = (enable && __builtin_cpu_supports("avx2")) ? 1 : 0;
+
+  return(scrambling_avx2);
+}
+
+// 0xff in byte k if bit k of s is set (k=0..31)
+static inline __m256i scrambling_mask8_256(uint32_t s) AVX2_FUNC;
+static inline __m256i scrambling_mask8_256(uint32_t s)
+{
+
+  const __m256i shuf = _mm256_setr_epi8(0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,
+                                        2,2,2,2,2,2,2,2,3,3,3,3,3,3,3,3);
+  const __m256i bits = _mm256_set1_epi64x(0x8040201008040201LL);
+
+  return(_mm256_cmpeq_epi8(_mm256_and_si256(_mm256_shuffle_epi8(_mm256_set1_epi32(s),shuf),bits),bits));
+}
+
+// 0xffff in int16 k if bit k of s is set (k=0..15)
+static inline __m256i scrambling_mask16_256(uint32_t s) AVX2_FUNC;
+static inline __m256i scrambling_mask16_256(uint32_t s)
+{
+
+  const __m256i bits = _mm256_setr_epi16(1<<0,1<<1,1<<2,1<<3,1<<4,1<<5,1<<6,1<<7,
+                                         1<<8,1<<9,1<<10,1<<11,1<<12,1<<13,1<<14,(short)(1<<15));
+
+  return(_mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16((short)s),bits),bits));
+}
+
+static void scramble_bits_avx2(uint8_t *e, const uint32_t *c, uint32_t n) AVX2_FUNC;
+static void scramble_bits_avx2(uint8_t *e, const uint32_t *c, uint32_t n)
+{
+
+  const __m256i one = _mm256_set1_epi8(1);
+  const __m256i nil = _mm256_set1_epi8(2);
+  __m256i e256,nil256;
+  uint32_t i;
+
+  for (i=0; i<(n>>5); i++) {
+    e256   = _mm256_loadu_si256((__m256i *)&e[i<<5]);
+    nil256 = _mm256_cmpeq_epi8(e256,nil);
+    _mm256_storeu_si256((__m256i *)&e[i<<5],
+                        _mm256_blendv_epi8(_mm256_xor_si256(_mm256_and_si256(e256,one),
+                                                            _mm256_and_si256(scrambling_mask8_256(c[i]),one)),
+                                           e256,nil256));
+  }
+}
+
+static void unscramble_llr16_avx2(int16_t *llr, const uint32_t *c, uint32_t n) AVX2_FUNC;
+static void unscramble_llr16_avx2(int16_t *llr, const uint32_t *c, uint32_t n)
+{
+
+  __m256i llr256,m;
+  uint32_t i;
+
+  for (i=0; i<(n>>4); i++) {
+    // all ones where the sequence bit is 0, llr is then negated
+    m      = _mm256_xor_si256(scrambling_mask16_256(c[i>>1]>>((i&1)<<4)),_mm256_set1_epi8(-1));
+    llr256 = _mm256_loadu_si256((__m256i *)&llr[i<<4]);
+    _mm256_storeu_si256((__m256i *)&llr[i<<4],_mm256_sub_epi16(_mm256_xor_si256(llr256,m),m));
+  }
+}
+
+static void unscramble_llr8_avx2(int8_t *llr, const uint32_t *c, uint32_t n) AVX2_FUNC;
+static void unscramble_llr8_avx2(int8_t *llr, const uint32_t *c, uint32_t n)
+{
+
+  __m256i llr256,m;
+  uint32_t i;
+
+  for (i=0; i<(n>>5); i++) {
+    m      = _mm256_xor_si256(scrambling_mask8_256(c[i]),_mm256_set1_epi8(-1));
+    llr256 = _mm256_loadu_si256((__m256i *)&llr[i<<5]);
+    _mm256_storeu_si256((__m256i *)&llr[i<<5],_mm256_sub_epi8(_mm256_xor_si256(llr256,m),m));
+  }
+}
+
+static void scrambling_sign16_avx2(int16_t *cseq, const uint32_t *c, uint32_t n) AVX2_FUNC;
+static void scrambling_sign16_avx2(int16_t *cseq, const uint32_t *c, uint32_t n)
+{
+
+  const __m256i two   = _mm256_set1_epi16(2);
+  const __m256i m_one = _mm256_set1_epi16(-1);
+  uint32_t i;
+
+  for (i=0; i<(n>>4); i++)
+    _mm256_storeu_si256((__m256i *)&cseq[i<<4],
+                        _mm256_add_epi16(_mm256_and_si256(scrambling_mask16_256(c[i>>1]>>((i&1)<<4)),two),m_one));
+}
+
+#else
+
+int scrambling_set_avx2(int enable)
+{
+
+  return(0);
+}
+
+#endif
+
+#if defined(__SSSE3__)
+
+// 0xff in byte k if bit k of s is set (k=0..15)
+static inline __m128i scrambling_mask8_128(uint32_t s)
+{
+
+  const __m128i shuf = _mm_setr_epi8(0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1);
+  const __m128i bits = _mm_set1_epi64x(0x8040201008040201LL);
+
+  return(_mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(_mm_set1_epi16((short)s),shuf),bits),bits));
+}
+
+// 0xffff in int16 k if bit k of s is set (k=0..7)
+static inline __m128i scrambling_mask16_128(uint32_t s)
+{
+
+  const __m128i bits = _mm_setr_epi16(1<<0,1<<1,1<<2,1<<3,1<<4,1<<5,1<<6,1<<7);
+
+  return(_mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16((short)s),bits),bits));
+}
+
+#endif
+
+static inline uint32_t scrambling_bit(const uint32_t *c, uint32_t k)
+{
+  return((c[k>>5]>>(k&31))&1);
+}
+
+void scramble_bits(uint8_t *e, const uint32_t *c, uint32_t n)
+{
+
+  uint32_t k=0;
+#if defined(__SSSE3__)
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i nil = _mm_set1_epi8(2);
+  __m128i e128,nil128,out128;
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  if (scrambling_avx2_enabled()) {
+    scramble_bits_avx2(e,c,n);
+    k = n&~31;
+  }
+
+#endif
+#if defined(__SSSE3__)
+
+  for (; k+16<=n; k+=16) {
+    e128   = _mm_loadu_si128((__m128i *)&e[k]);
+    nil128 = _mm_cmpeq_epi8(e128,nil);
+    out128 = _mm_xor_si128(_mm_and_si128(e128,one),
+                           _mm_and_si128(scrambling_mask8_128(c[k>>5]>>(k&16)),one));
+    _mm_storeu_si128((__m128i *)&e[k],_mm_or_si128(_mm_and_si128(nil128,e128),
+                                                   _mm_andnot_si128(nil128,out128)));
+  }
+
+#endif
+
+  for (; k<n; k++)
+    if (e[k] != 2)
+      e[k] = (e[k]&1) ^ scrambling_bit(c,k);
+}
+
+void unscramble_llr16(int16_t *llr, const uint32_t *c, uint32_t n)
+{
+
+  uint32_t k=0;
+#if defined(__SSSE3__)
+  __m128i m;
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  if (scrambling_avx2_enabled()) {
+    unscramble_llr16_avx2(llr,c,n);
+    k = n&~15;
+  }
+
+#endif
+#if defined(__SSSE3__)
+
+  for (; k+8<=n; k+=8) {
+    m = _mm_xor_si128(scrambling_mask16_128(c[k>>5]>>(k&24)),_mm_set1_epi8(-1));
+    _mm_storeu_si128((__m128i *)&llr[k],_mm_sub_epi16(_mm_xor_si128(_mm_loadu_si128((__m128i *)&llr[k]),m),m));
+  }
+
+#endif
+
+  for (; k<n; k++)
+    if (scrambling_bit(c,k) == 0)
+      llr[k] = -llr[k];
+}
+
+void unscramble_llr8(int8_t *llr, const uint32_t *c, uint32_t n)
+{
+
+  uint32_t k=0;
+#if defined(__SSSE3__)
+  __m128i m;
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  if (scrambling_avx2_enabled()) {
+    unscramble_llr8_avx2(llr,c,n);
+    k = n&~31;
+  }
+
+#endif
+#if defined(__SSSE3__)
+
+  for (; k+16<=n; k+=16) {
+    m = _mm_xor_si128(scrambling_mask8_128(c[k>>5]>>(k&16)),_mm_set1_epi8(-1));
+    _mm_storeu_si128((__m128i *)&llr[k],_mm_sub_epi8(_mm_xor_si128(_mm_loadu_si128((__m128i *)&llr[k]),m),m));
+  }
+
+#endif
+
+  for (; k<n; k++)
+    if (scrambling_bit(c,k) == 0)
+      llr[k] = -llr[k];
+}
+
+void scrambling_sign16(int16_t *cseq, const uint32_t *c, uint32_t n)
+{
+
+  uint32_t k=0;
+#if defined(__SSSE3__)
+  const __m128i two   = _mm_set1_epi16(2);
+  const __m128i m_one = _mm_set1_epi16(-1);
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  if (scrambling_avx2_enabled()) {
+    scrambling_sign16_avx2(cseq,c,n);
+    k = n&~15;
+  }
+
+#endif
+#if defined(__SSSE3__)
+
+  for (; k+8<=n; k+=8)
+    _mm_storeu_si128((__m128i *)&cseq[k],_mm_add_epi16(_mm_and_si128(scrambling_mask16_128(c[k>>5]>>(k&24)),two),m_one));
+
+#endif
+
+  for (; k<n; k++)
+    cseq[k] = (int16_t)((scrambling_bit(c,k)<<1)-1);
+}
+
 void dlsch_scrambling(LTE_DL_FRAME_PARMS *frame_parms,
                       int mbsfn_flag,
                       LTE_eNB_DLSCH_t *dlsch,
@@ -56,15 +335,11 @@ void dlsch_scrambling(LTE_DL_FRAME_PARMS *frame_parms,
                       uint8_t Ns)
 {
 
-  int i,j,k=0;
-  //  uint8_t reset;
-  uint32_t x1, x2, s=0;
+  uint32_t x2;
   uint8_t *e=dlsch->harq_processes[dlsch->current_harq_pid]->e;
 
   VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_ENB_DLSCH_SCRAMBLING, VCD_FUNCTION_IN);
 
-  //  reset = 1;
-  // x1 is set in lte_gold_generic
   if (mbsfn_flag == 0) {
     x2 = (dlsch->rnti<<14) + (q<<13) + ((Ns>>1)<<9) + frame_parms->Nid_cell; //this is c_init in 36.211 Sec 6.3.1
   } else {
@@ -74,22 +349,7 @@ void dlsch_scrambling(LTE_DL_FRAME_PARMS *frame_parms,
 #ifdef DEBUG_SCRAMBLING
   printf("scrambling: rnti %x, q %d, Ns %d, Nid_cell %d, length %d\n",dlsch->rnti,q,Ns,frame_parms->Nid_cell, G);
 #endif
-  s = lte_gold_generic(&x1, &x2, 1);
-
-  for (i=0; i<(1+(G>>5)); i++) {
-
-    for (j=0; j<32; j++,k++) {
-#ifdef DEBUG_SCRAMBLING
-      printf("scrambling %d : %d => ",k,e[k]);
-#endif
-      e[k] = (e[k]&1) ^ ((s>>j)&1);
-#ifdef DEBUG_SCRAMBLING
-      printf("%d\n",e[k]);
-#endif
-    }
-
-    s = lte_gold_generic(&x1, &x2, 0);
-  }
+  scramble_bits(e,lte_gold_scrambling_sequence(x2,(G+31)>>5),G);
 
   VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_ENB_DLSCH_SCRAMBLING, VCD_FUNCTION_OUT);
 
@@ -105,12 +365,7 @@ void dlsch_unscrambling(LTE_DL_FRAME_PARMS *frame_parms,
                         uint8_t Ns)
 {
 
-  int i,j,k=0;
-  //  uint8_t reset;
-  uint32_t x1, x2, s=0;
-
-  //  reset = 1;
-  // x1 is set in first call to lte_gold_generic
+  uint32_t x2;
 
   if (mbsfn_flag == 0)
     x2 = (dlsch->rnti<<14) + (q<<13) + ((Ns>>1)<<9) + frame_parms->Nid_cell; //this is c_init in 36.211 Sec 6.3.1
@@ -120,19 +375,5 @@ void dlsch_unscrambling(LTE_DL_FRAME_PARMS *frame_parms,
 #ifdef DEBUG_SCRAMBLING
   printf("unscrambling: rnti %x, q %d, Ns %d, Nid_cell %d length %d\n",dlsch->rnti,q,Ns,frame_parms->Nid_cell,G);
 #endif
-  s = lte_gold_generic(&x1, &x2, 1);
-
-  for (i=0; i<(1+(G>>5)); i++) {
-    for (j=0; j<32; j++,k++) {
-#ifdef DEBUG_SCRAMBLING
-      printf("unscrambling %d : %d => ",k,llr[k]);
-#endif
-      llr[k] = ((2*((s>>j)&1))-1)*llr[k];
-#ifdef DEBUG_SCRAMBLING
-      printf("%d\n",llr[k]);
-#endif
-    }
-
-    s = lte_gold_generic(&x1, &x2, 0);
-  }
+  unscramble_llr16(llr,lte_gold_scrambling_sequence(x2,(G+31)>>5),G);
 }
@@ -788,28 +788,20 @@ void pbch_unscrambling(LTE_DL_FRAME_PARMS *frame_parms,
                        uint8_t frame_mod4)
 {
   int i;
-  uint8_t reset;
   uint32_t x1, x2, s=0;
+  // only the quarter of the PBCH that corresponds to this frame is unscrambled
+  uint32_t first = frame_mod4*(length>>2);
+  uint32_t last  = first+(length>>2);
 
-  reset = 1;
-  // x1 is set in first call to lte_gold_generic
-  x2 = frame_parms->Nid_cell; //this is c_init in 36.211 Sec 6.6.1
-  //  msg("pbch_unscrambling: Nid_cell = %d\n",x2);
-
-  for (i=0; i<length; i++) {
-    if (i%32==0) {
-      s = lte_gold_generic(&x1, &x2, reset);
-      //      printf("lte_gold[%d]=%x\n",i,s);
-      reset = 0;
-    }
+  // c_init is Nid_cell (36.211 Sec 6.6.1), jump to the word of the first bit of this quarter
+  s = lte_gold_seek(&x1,&x2,frame_parms->Nid_cell,first>>5);
 
-    // take the quarter of the PBCH that corresponds to this frame
-    if ((i>=(frame_mod4*(length>>2))) && (i<((1+frame_mod4)*(length>>2)))) {
-      //      if (((s>>(i%32))&1)==1)
+  for (i=first; i<last; i++) {
+    if ((i>first) && ((i&0x1f)==0))
+      s = lte_gold_generic(&x1, &x2, 0);
 
-      if (((s>>(i%32))&1)==0)
-        llr[i] = -llr[i];
-    }
+    if (((s>>(i&0x1f))&1)==0)
+      llr[i] = -llr[i];
   }
 }
 
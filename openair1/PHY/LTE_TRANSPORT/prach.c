@@ -1058,6 +1058,126 @@ int32_t generate_prach( PHY_VARS_UE *phy_vars_ue, uint8_t eNB_id, uint8_t subfra
 }
 //__m128i mmtmpX0,mmtmpX1,mmtmpX2,mmtmpX3;
 
+// y = conj(Xu).rxF >> 15 over n REs, none of the buffers needs to be aligned
+static inline void prach_conj_mult(int16_t *Xu, int16_t *rxF, int16_t *y, int n)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i conj = _mm_set_epi16(1,-1,1,-1,1,-1,1,-1);
+  __m128i x128,rx128,re128,im128;
+
+  for (; n>=4; n-=4) {
+    x128  = _mm_loadu_si128((__m128i *)Xu);
+    rx128 = _mm_loadu_si128((__m128i *)rxF);
+    re128 = _mm_madd_epi16(x128,rx128);
+    im128 = _mm_shufflelo_epi16(x128,_MM_SHUFFLE(2,3,0,1));
+    im128 = _mm_shufflehi_epi16(im128,_MM_SHUFFLE(2,3,0,1));
+    im128 = _mm_sign_epi16(im128,conj);
+    im128 = _mm_madd_epi16(im128,rx128);
+    re128 = _mm_srai_epi32(re128,15);
+    im128 = _mm_srai_epi32(im128,15);
+    _mm_storeu_si128((__m128i *)y,_mm_packs_epi32(_mm_unpacklo_epi32(re128,im128),_mm_unpackhi_epi32(re128,im128)));
+    Xu+=8;
+    rxF+=8;
+    y+=8;
+  }
+
+#endif
+
+  for (; n>0; n--) {
+    y[0] = (int16_t)(((int32_t)Xu[0]*rxF[0] + (int32_t)Xu[1]*rxF[1])>>15);
+    y[1] = (int16_t)(((int32_t)Xu[0]*rxF[1] - (int32_t)Xu[1]*rxF[0])>>15);
+    Xu+=2;
+    rxF+=2;
+    y+=2;
+  }
+}
+
+// DFT of the PRACH symbol (after the CP) of one rx antenna, returns the DFT size used for the delay estimates
+static int prach_rx_dft(PHY_VARS_eNB *phy_vars_eNB, int16_t *prach2, int16_t *rxsigF, uint8_t prach_fmt)
+{
+  int fft_size = 6144;
+
+  switch (phy_vars_eNB->lte_frame_parms.N_RB_UL) {
+  case 6:
+    if (prach_fmt == 4) {
+      dft256(prach2,rxsigF,1);
+    } else {
+      dft1536(prach2,rxsigF);
+
+      if (prach_fmt>1)
+        dft1536(prach2+3072,rxsigF+3072);
+    }
+
+    break;
+
+  case 15:
+    if (prach_fmt == 4) {
+      dft256(prach2,rxsigF,1);
+    } else {
+      dft3072(prach2,rxsigF);
+
+      if (prach_fmt>1)
+        dft3072(prach2+6144,rxsigF+6144);
+    }
+
+    break;
+
+  case 25:
+  default:
+    if (prach_fmt == 4) {
+      dft1024(prach2,rxsigF,1);
+      fft_size = 1024;
+    } else {
+      dft6144(prach2,rxsigF);
+
+      if (prach_fmt>1)
+        dft6144(prach2+12288,rxsigF+12288);
+
+      fft_size = 6144;
+    }
+
+    break;
+
+  case 50:
+    if (prach_fmt == 4) {
+      dft2048(prach2,rxsigF,1);
+    } else {
+      dft12288(prach2,rxsigF);
+
+      if (prach_fmt>1)
+        dft12288(prach2+24576,rxsigF+24576);
+    }
+
+    break;
+
+  case 75:
+    if (prach_fmt == 4) {
+      dft3072(prach2,rxsigF);
+    } else {
+      dft18432(prach2,rxsigF);
+
+      if (prach_fmt>1)
+        dft18432(prach2+36864,rxsigF+36864);
+    }
+
+    break;
+
+  case 100:
+    if (prach_fmt == 4) {
+      dft4096(prach2,rxsigF,1);
+    } else {
+      dft24576(prach2,rxsigF);
+
+      if (prach_fmt>1)
+        dft24576(prach2+49152,rxsigF+49152);
+    }
+
+    break;
+  }
+
+  return(fft_size);
+}
+
 void rx_prach(PHY_VARS_eNB *phy_vars_eNB,uint8_t subframe,uint16_t *preamble_energy_list, uint16_t *preamble_delay_list, uint16_t Nf, uint8_t tdd_mapindex)
 {
 
@@ -1074,7 +1194,6 @@ void rx_prach(PHY_VARS_eNB *phy_vars_eNB,uint8_t subframe,uint16_t *preamble_ene
   int16_t **rxsigF          = phy_vars_eNB->lte_eNB_prach_vars.rxsigF;
   int16_t **prach_ifft      = phy_vars_eNB->lte_eNB_prach_vars.prach_ifft;
   int16_t *prach[4];
-  int16_t *prach2;
   uint8_t n_ra_prb;
   uint8_t preamble_index;
   uint16_t NCS,NCS2;
@@ -1092,17 +1211,18 @@ void rx_prach(PHY_VARS_eNB *phy_vars_eNB,uint8_t subframe,uint16_t *preamble_ene
   uint8_t not_found;
   //  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
   //  uint16_t subframe_offset;
-  int k;
+  int k,k0;
   uint16_t u;
   int16_t *Xu;
-  uint16_t offset;
+  uint16_t offset,nb_re;
   int16_t Ncp;
   uint16_t first_nonzero_root_idx=0;
   uint8_t new_dft=0;
   uint8_t aa;
   int32_t lev;
   int16_t levdB;
-  int fft_size,log2_ifft_size;
+  int fft_size=6144,log2_ifft_size;
+  int32_t prach_pdp[1024];
   uint8_t nb_ant_rx = 1; //phy_vars_eNB->lte_frame_parms.nb_antennas_rx;
 
   for (aa=0; aa<nb_ant_rx; aa++) {
@@ -1220,6 +1340,24 @@ void rx_prach(PHY_VARS_eNB *phy_vars_eNB,uint8_t subframe,uint16_t *preamble_ene
   //  nsymb = (frame_parms->Ncp==0) ? 14:12;
   //  subframe_offset = (unsigned int)frame_parms->ofdm_symbol_size*subframe*nsymb;
 
+  // DFT of the received signal, shared by all the root sequences
+  k0 = (12*n_ra_prb) - 6*phy_vars_eNB->lte_frame_parms.N_RB_UL;
+
+  if (k0<0)
+    k0+=(phy_vars_eNB->lte_frame_parms.ofdm_symbol_size);
+
+  k0*=12;
+  k0+=13; // phi + K/2
+  k0*=2;
+
+  for (aa=0; aa<nb_ant_rx; aa++)
+    fft_size = prach_rx_dft(phy_vars_eNB,prach[aa] + (Ncp<<1),rxsigF[aa],prach_fmt);
+
+#ifdef PRACH_DEBUG
+  write_output("prach_rx0.m","prach_rx0",prach[0],6144+792,1,1);
+#endif
+
+  log2_ifft_size = (N_ZC == 839) ? 10 : 8;
   preamble_offset_old = 99;
 
   for (preamble_index=0 ; preamble_index<64 ; preamble_index++) {
@@ -1304,166 +1442,53 @@ void rx_prach(PHY_VARS_eNB *phy_vars_eNB,uint8_t subframe,uint16_t *preamble_ene
         first_nonzero_root_idx = preamble_offset;
     }
 
-    // Compute DFT of RX signal (conjugate input, results in conjugate output) for each new rootSequenceIndex
 #ifdef PRACH_DEBUG
     LOG_I(PHY,"preamble index %d: offset %d, preamble shift %d\n",preamble_index,preamble_offset,preamble_shift);
 #endif
-    log2_ifft_size = 10;
-    fft_size = 6144;
 
+    // Correlate with Xu* once per root sequence
     if (new_dft == 1) {
       new_dft = 0;
       Xu=(int16_t*)phy_vars_eNB->X_u[preamble_offset-first_nonzero_root_idx];
 
       for (aa=0; aa<nb_ant_rx; aa++) {
-        prach2 = prach[aa] + (Ncp<<1);
-
-        k = (12*n_ra_prb) - 6*phy_vars_eNB->lte_frame_parms.N_RB_UL;
-
-        if (k<0)
-          k+=(phy_vars_eNB->lte_frame_parms.ofdm_symbol_size);
-
-        k*=12;
-        k+=13; // phi + K/2
-        //      k+=(12*phy_vars_eNB->lte_frame_parms.first_carrier_offset);
-        //      if (k>(12*phy_vars_eNB->lte_frame_parms.ofdm_symbol_size))
-        //  k-=(12*phy_vars_eNB->lte_frame_parms.ofdm_symbol_size);
-
-        // printf("First prach carrier : k %d\n",k);
-        k*=2;
-
-        // do DFT
-        switch (phy_vars_eNB->lte_frame_parms.N_RB_UL) {
-        case 6:
-          if (prach_fmt == 4) {
-            dft256(prach2,rxsigF[aa],1);
-          } else {
-            dft1536(prach2,rxsigF[aa]);
-
-            if (prach_fmt>1)
-              dft1536(prach2+3072,rxsigF[aa]+3072);
-          }
-
-          break;
-
-        case 15:
-          if (prach_fmt == 4) {
-            dft256(prach2,rxsigF[aa],1);
-          } else {
-            dft3072(prach2,rxsigF[aa]);
-
-            if (prach_fmt>1)
-              dft3072(prach2+6144,rxsigF[aa]+6144);
-          }
-
-          break;
-
-        case 25:
-        default:
-          if (prach_fmt == 4) {
-            dft1024(prach2,rxsigF[aa],1);
-            fft_size = 1024;
-          } else {
-            dft6144(prach2,rxsigF[aa]);
-
-            if (prach_fmt>1)
-              dft6144(prach2+12288,rxsigF[aa]+12288);
-
-            fft_size = 6144;
-          }
-
-          break;
-
-        case 50:
-          if (prach_fmt == 4) {
-            dft2048(prach2,rxsigF[aa],1);
-          } else {
-            dft12288(prach2,rxsigF[aa]);
-
-            if (prach_fmt>1)
-              dft12288(prach2+24576,rxsigF[aa]+24576);
-          }
-
-          break;
-
-        case 75:
-          if (prach_fmt == 4) {
-            dft3072(prach2,rxsigF[aa]);
-          } else {
-            dft18432(prach2,rxsigF[aa]);
-
-            if (prach_fmt>1)
-              dft18432(prach2+36864,rxsigF[aa]+36864);
-          }
-
-          break;
-
-        case 100:
-          if (prach_fmt == 4) {
-            dft4096(prach2,rxsigF[aa],1);
-          } else {
-            dft24576(prach2,rxsigF[aa]);
-
-            if (prach_fmt>1)
-              dft24576(prach2+49152,rxsigF[aa]+49152);
-          }
-
-          break;
-        }
-
+        k = k0;
         memset( prachF, 0, sizeof(int16_t)*2*1024 );
-#ifdef PRACH_DEBUG
-	write_output("prach_rx0.m","prach_rx0",prach[0],6144+792,1,1);
-#endif
-        // write_output("prach_rx1.m","prach_rx1",prach[1],6144+792,1,1);
-	//       write_output("prach_rxF0.m","prach_rxF0",rxsigF[0],24576,1,1);
-        // write_output("prach_rxF1.m","prach_rxF1",rxsigF[1],6144,1,1);
-
-        // Do componentwise product with Xu*
-        for (offset=0; offset<(N_ZC<<1); offset+=2) {
-          prachF[offset]   = (int16_t)(((int32_t)Xu[offset]*rxsigF[aa][k]   + (int32_t)Xu[offset+1]*rxsigF[aa][k+1])>>15);
-          prachF[offset+1] = (int16_t)(((int32_t)Xu[offset]*rxsigF[aa][k+1] - (int32_t)Xu[offset+1]*rxsigF[aa][k])>>15);
-          /*
-          if (offset<16)
-            printf("Xu[%d] %d %d, rxsigF[%d][%d] %d %d\n",offset,Xu[offset],Xu[offset+1],aa,k,rxsigF[aa][k],rxsigF[aa][k+1]);
-          */
-          /*
-              mmtmpX0 = _mm_madd_epi16(*(__m128i*)&Xu[offset],*(__m128i*)&rxsigF[aa][k<<1]);
-              mmtmpX1 = _mm_shufflelo_epi16(*(__m128i*)&Xu[offset],_MM_SHUFFLE(2,3,0,1));
-              mmtmpX1 = _mm_shufflehi_epi16(mmtmpX1,_MM_SHUFFLE(2,3,0,1));
-              mmtmpX1 = _mm_sign_epi16(mmtmpX1,*(__m128i*)&conjugate[0]);
-              mmtmpX1 = _mm_madd_epi16(mmtmpX1,*(__m128i*)&rxsigF[aa][k<<1]);
-              mmtmpX0 = _mm_srai_epi32(mmtmpX0,15);
-              mmtmpX1 = _mm_srai_epi32(mmtmpX1,15);
-              mmtmpX2 = _mm_unpacklo_epi32(mmtmpX0,mmtmpX1);
-              mmtmpX3 = _mm_unpackhi_epi32(mmtmpX0,mmtmpX1);
-              *(__m128i*)&prachF[offset] = _mm_packs_epi32(mmtmpX2,mmtmpX3);
-              */
-          k+=2;
+
+        // Do componentwise product with Xu*, in two pieces if the PRACH wraps around the DFT
+        for (offset=0; offset<(N_ZC<<1); offset+=(nb_re<<1)) {
+          nb_re = min((N_ZC<<1)-offset,(12*2*phy_vars_eNB->lte_frame_parms.ofdm_symbol_size)-k)>>1;
+          prach_conj_mult(&Xu[offset],&rxsigF[aa][k],&prachF[offset],nb_re);
+          k+=(nb_re<<1);
 
           if (k==(12*2*phy_vars_eNB->lte_frame_parms.ofdm_symbol_size))
             k=0;
         }
 
         // Now do IFFT of size 1024 (N_ZC=839) or 256 (N_ZC=139)
-        if (N_ZC == 839) {
-          log2_ifft_size = 10;
+        if (N_ZC == 839)
           idft1024(prachF,prach_ifft[aa],1);
-        } else {
+        else
           idft256(prachF,prach_ifft[aa],1);
-          log2_ifft_size = 8;
-        }
+
 #ifdef PRACH_DEBUG
         write_output("prach_rxF_comp0.m","prach_rxF_comp0",prachF,1024,1,1);
 #endif
-        // write_output("prach_rxF_comp1.m","prach_rxF_comp1",prachF,1024,1,1);
-
       }// antennas_rx
+
 #ifdef PRACH_DEBUG
       write_output("prach_ifft0.m","prach_t0",prach_ifft[0],2048,1,1);
 #endif
-      // write_output("prach_ifft1.m","prach_t1",prach_ifft[1],2048,1,1);
 
+      // power delay profile of the root sequence, the cyclic shifts of its preambles are windows of it
+      for (i=0; i<(1<<log2_ifft_size); i++) {
+        lev = 0;
+
+        for (aa=0; aa<nb_ant_rx; aa++)
+          lev += (int32_t)prach_ifft[aa][i<<1]*prach_ifft[aa][i<<1] + (int32_t)prach_ifft[aa][1+(i<<1)]*prach_ifft[aa][1+(i<<1)];
+
+        prach_pdp[i] = lev;
+      }
     } // new dft
 
     // check energy in nth time shift
@@ -1471,13 +1496,7 @@ void rx_prach(PHY_VARS_eNB *phy_vars_eNB,uint8_t subframe,uint16_t *preamble_ene
     preamble_energy_list[preamble_index] = 0;
 
     for (i=0; i<NCS2; i++) {
-      lev = 0;
-
-      for (aa=0; aa<nb_ant_rx; aa++) {
-        lev += (int32_t)prach_ifft[aa][(preamble_shift2+i)<<1]*prach_ifft[aa][(preamble_shift2+i)<<1] + (int32_t)prach_ifft[aa][1+((preamble_shift2+i)<<1)]*prach_ifft[aa][1+((preamble_shift2+i)<<1)];
-      }
-
-      levdB = dB_fixed_times10(lev);
+      levdB = dB_fixed_times10(prach_pdp[(preamble_shift2+i)&((1<<log2_ifft_size)-1)]);
 
       if (levdB>preamble_energy_list[preamble_index] ) {
         preamble_energy_list[preamble_index]  = levdB;
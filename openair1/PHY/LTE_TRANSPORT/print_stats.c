@@ -55,6 +55,26 @@ extern int mac_get_rrc_status(uint8_t Mod_id,uint8_t eNB_flag,uint8_t index);
 extern openair0_config_t openair0_cfg[];
 #endif
 
+// prints the average and the non-empty bins of a histogram, e.g. turbo decoder iterations
+static int sprint_count_stats(char *buffer,count_stats_t *cs)
+{
+
+  int i,len=0;
+
+  if (cs->trials == 0)
+    return(sprintf(buffer,"no trials\n"));
+
+  len += sprintf(&buffer[len],"average %.2f (%d trials):",(double)cs->sum/cs->trials,cs->trials);
+
+  for (i=0; i<COUNT_STATS_BINS; i++)
+    if (cs->bin[i] > 0)
+      len += sprintf(&buffer[len]," %d:%d",i,cs->bin[i]);
+
+  len += sprintf(&buffer[len],"\n");
+
+  return(len);
+}
+
 int dump_ue_stats(PHY_VARS_UE *phy_vars_ue, char* buffer, int length, runmode_t mode, int input_level_dBm)
 {
 
@@ -497,6 +517,8 @@ int dump_ue_stats(PHY_VARS_UE *phy_vars_ue, char* buffer, int length, runmode_t
       }
 
       len += sprintf(&buffer[len], "[UE PROC] DLSCH Total %d, Error %d, FER %d\n",phy_vars_ue->dlsch_received[0],phy_vars_ue->dlsch_errors[0],phy_vars_ue->dlsch_fer[0]);
+      len += sprintf(&buffer[len], "[UE PROC] DLSCH turbo iterations per code block: ");
+      len += sprint_count_stats(&buffer[len],&phy_vars_ue->dlsch_turbo_iterations);
       len += sprintf(&buffer[len], "[UE PROC] DLSCH (SI) Total %d, Error %d\n",phy_vars_ue->dlsch_SI_received[0],phy_vars_ue->dlsch_SI_errors[0]);
       len += sprintf(&buffer[len], "[UE PROC] DLSCH (RA) Total %d, Error %d\n",phy_vars_ue->dlsch_ra_received[0],phy_vars_ue->dlsch_ra_errors[0]);
 #ifdef Rel10
@@ -741,6 +763,9 @@ int dump_eNB_stats(PHY_VARS_eNB *phy_vars_eNB, char* buffer, int length)
                        ulsch_round_errors[2],ulsch_round_attempts[2],
                        ulsch_round_errors[3],ulsch_round_attempts[3]);
 
+        len += sprintf(&buffer[len],"[eNB PROC] ULSCH turbo iterations per code block: ");
+        len += sprint_count_stats(&buffer[len],&phy_vars_eNB->eNB_UE_stats[UE_id].ulsch_turbo_iterations);
+
         dlsch_errors = 0;
 
         for (j=0; j<4; j++) {
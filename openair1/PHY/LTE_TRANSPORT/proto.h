@@ -117,6 +117,38 @@ int32_t dlsch_encoding(uint8_t *a,
                        time_stats_t *te_stats,
                        time_stats_t *i_stats);
 
+/*! \brief First part of dlsch_encoding(): CRC addition, code block segmentation (first round only) and computation of the position of each code block in the "e"-sequence.
+  @param a Pointer to the transport block
+  @param frame_parms Pointer to frame descriptor structure
+  @param num_pdcch_symbols Number of PDCCH symbols in this subframe
+  @param dlsch Pointer to dlsch to be encoded
+  @param frame Frame number
+  @param subframe Subframe number
+  @returns 0 on success, -1 on error
+*/
+int dlsch_encoding_start(uint8_t *a,
+                         LTE_DL_FRAME_PARMS *frame_parms,
+                         uint8_t num_pdcch_symbols,
+                         LTE_eNB_DLSCH_t *dlsch,
+                         int frame,
+                         uint8_t subframe);
+
+/*! \brief Turbo-encodes (first round only) and rate-matches code blocks r0..r0+nb_segments-1 of a DLSCH prepared by dlsch_encoding_start().
+  The code blocks are independent, so disjoint sets of code blocks may be encoded by different threads.
+  @param dlsch Pointer to dlsch to be encoded
+  @param r0 First code block
+  @param nb_segments Number of code blocks
+  @param rm_stats Time statistics for rate-matching
+  @param te_stats Time statistics for turbo-encoding
+  @param i_stats Time statistics for interleaving
+*/
+void dlsch_encoding_segments(LTE_eNB_DLSCH_t *dlsch,
+                             uint8_t r0,
+                             uint8_t nb_segments,
+                             time_stats_t *rm_stats,
+                             time_stats_t *te_stats,
+                             time_stats_t *i_stats);
+
 void dlsch_encoding_emul(PHY_VARS_eNB *phy_vars_eNB,
                          uint8_t *DLSCH_pdu,
                          LTE_eNB_DLSCH_t *dlsch);
@@ -201,6 +233,11 @@ int32_t dlsch_modulation(mod_sym_t **txdataF,
                          uint8_t num_pdcch_symbols,
                          LTE_eNB_DLSCH_t *dlsch0,
                          LTE_eNB_DLSCH_t *dlsch1);
+
+/** \brief Builds the per-RB data RE lists used by dlsch_modulation(), once from phy_init_lte_eNB() before the TX threads start.
+*/
+void init_dlsch_re_list(void);
+
 /*
   \brief This function is the top-level routine for generation of the sub-frame signal (frequency-domain) for MCH.
   @param txdataF Table of pointers for frequency-domain TX signals
@@ -642,6 +679,36 @@ void qam64_qam64(short *stream0_in,
                  short *rho01,
                  int length);
 
+/** \brief Dual-stream LLRs of a 16/64QAM stream 0 with a 16/64QAM stream 1 over a reduced set of
+    stream 0 hypotheses around its zero-forcing hard decision. Same inputs, scaling and output order as qam16_qam16() ... qam64_qam64(),
+    the magnitudes are bounded by ch_mag*det/(|h0|^2*|h1|^2) of the RE.
+    @param mod_order0 Modulation order of stream 0 (4 or 6)
+    @param mod_order1 Modulation order of stream 1 (4 or 6)
+    @param stream0_in Input from channel compensated (MR combined) stream 0
+    @param stream1_in Input from channel compensated (MR combined) stream 1
+    @param ch_mag   Input from scaled channel magnitude square of h0'*g0
+    @param ch_mag_i Input from scaled channel magnitude square of h0'*g1
+    @param stream0_out Output from LLR unit for stream0
+    @param rho01 Cross-correlation between channels (MR combined)
+    @param length in complex channel outputs
+    @param mode IA_LLR_APPROX_HIGH or IA_LLR_APPROX_LOW*/
+void qam_qam_llr_reduced(int mod_order0,
+                         int mod_order1,
+                         short *stream0_in,
+                         short *stream1_in,
+                         short *ch_mag,
+                         short *ch_mag_i,
+                         short *stream0_out,
+                         short *rho01,
+                         int length,
+                         ia_llr_mode_t mode);
+
+/** \brief Selects the stream 0 LLRs used by dlsch_16qam_16qam_llr() ... dlsch_64qam_64qam_llr(), a QPSK
+    stream 1 always uses the exact kernels.
+    @param mode IA_LLR_EXACT (default), IA_LLR_APPROX_HIGH or IA_LLR_APPROX_LOW
+    @returns the mode applied (always IA_LLR_EXACT without SSE)*/
+ia_llr_mode_t dlsch_set_ia_llr_mode(ia_llr_mode_t mode);
+
 /** \brief This function perform LLR computation for dual-stream (64QAM/64QAM) transmission.
     @param frame_parms Frame descriptor structure
     @param rxdataF_comp Compensated channel output
@@ -734,6 +801,29 @@ void dlsch_64qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
                      uint16_t pbch_pss_sss_adjust,
                      short **llr_save);
 
+/** \brief Single-stream 16QAM LLRs of nb_re REs in one pass over the symbols and magnitudes.
+    @param rxF Compensated symbols (int16 re/im pairs)
+    @param ch_mag Channel magnitudes weighted for the 16QAM mid-point, same layout as rxF
+    @param llr Output, 4 LLRs per RE in coded bit order (y_R,y_I,|h|^2-|y_R|,|h|^2-|y_I|)
+    @param nb_re Number of REs
+*/
+void qam16_llr(const int16_t *rxF,const int16_t *ch_mag,int16_t *llr,uint32_t nb_re);
+
+/** \brief Single-stream 64QAM LLRs of nb_re REs in one pass over the symbols and magnitudes.
+    @param rxF Compensated symbols (int16 re/im pairs)
+    @param ch_mag Channel magnitudes weighted by the first 64QAM mid-point
+    @param ch_magb Channel magnitudes weighted by the second 64QAM mid-point
+    @param llr Output, 6 LLRs per RE in coded bit order
+    @param nb_re Number of REs
+*/
+void qam64_llr(const int16_t *rxF,const int16_t *ch_mag,const int16_t *ch_magb,int16_t *llr,uint32_t nb_re);
+
+/** \brief Selects the 256-bit versions of qam16_llr() and qam64_llr() (8 REs per iteration).
+    @param enable 1 to use AVX2 when the host supports it
+    @returns 1 if the AVX2 versions are used
+*/
+int llr_set_avx2(int enable);
+
 /** \fn dlsch_siso(LTE_DL_FRAME_PARMS *frame_parms,
     int32_t **rxdataF_comp,
     int32_t **rxdataF_comp_i,
@@ -867,6 +957,45 @@ uint16_t dlsch_extract_rbs_single(int32_t **rxdataF,
                                   uint32_t high_speed_flag,
                                   LTE_DL_FRAME_PARMS *frame_parms);
 
+/** \brief Single pass version of dlsch_extract_rbs_single(), dlsch_channel_compensation() and
+    dlsch_detection_mrc() for single antenna eNB transmission. The allocated REs are compensated
+    and combined over the receive antennas straight from the FFT output, rxdataF_ext and
+    dl_ch_estimates_ext are not written.
+    @param rxdataF Raw FFT output of received signal
+    @param dl_ch_estimates Channel estimates of current slot
+    @param rxdataF_comp Compensated and combined data symbols (antenna 0)
+    @param dl_ch_mag First magnitude threshold for 16/64QAM (antenna 0)
+    @param dl_ch_magb Second magnitude threshold for 64QAM (antenna 0)
+    @param rb_alloc RB allocation vector
+    @param symbol Symbol to process
+    @param subframe Subframe number
+    @param high_speed_flag
+    @param mod_order Modulation order
+    @param output_shift Rescaling of the compensated symbols (log2_maxh)
+    @param frame_parms Pointer to frame descriptor
+    @returns the number of allocated RBs in the symbol
+*/
+uint16_t dlsch_extract_comp_mrc_single(int32_t **rxdataF,
+                                       int32_t **dl_ch_estimates,
+                                       int32_t **rxdataF_comp,
+                                       int32_t **dl_ch_mag,
+                                       int32_t **dl_ch_magb,
+                                       uint32_t *rb_alloc,
+                                       uint8_t symbol,
+                                       uint8_t subframe,
+                                       uint32_t high_speed_flag,
+                                       uint8_t mod_order,
+                                       uint8_t output_shift,
+                                       LTE_DL_FRAME_PARMS *frame_parms);
+
+/** \brief Selects dlsch_extract_comp_mrc_single() in rx_pdsch() for single antenna port transmission
+    (except on the first PDSCH symbol where the channel level is measured). Disable it to keep
+    rxdataF_ext and dl_ch_estimates_ext for debugging.
+    @param enable 1 to use the single pass front-end
+    @returns 1 if it is used
+*/
+int dlsch_set_fused_rx(int enable);
+
 /** \fn dlsch_extract_rbs_dual(int32_t **rxdataF,
     int32_t **dl_ch_estimates,
     int32_t **rxdataF_ext,
@@ -1460,6 +1589,23 @@ void rx_ulsch(PHY_VARS_eNB *phy_vars_eNB,
               LTE_eNB_ULSCH_t **ulsch,
               uint8_t cooperation_flag);
 
+/*!
+  \brief Front-end of the ULSCH receiver for all the UEs scheduled in a subframe (no cooperation). Each stage
+  runs over all the UEs before the next one: the allocations of a symbol are extracted from rxdataF in one sweep
+  in frequency order, compensation and MRC run symbol by symbol over the allocations and the DFT-despreading is
+  done grouped by size. The outputs (llr, ulsch_power, ...) are the same as calling rx_ulsch() for each UE.
+  @param phy_vars_eNB Pointer to eNB variables
+  @param sched_subframe Index of the scheduled subframe
+  @param UE_list Indices of the UEs with a ULSCH to demodulate in the subframe
+  @param nb_UE Number of entries of UE_list
+  @param ulsch Pointer to the ULSCH descriptors of all the UEs
+*/
+void rx_ulsch_multi(PHY_VARS_eNB *phy_vars_eNB,
+                    uint32_t sched_subframe,
+                    uint8_t *UE_list,
+                    uint8_t nb_UE,
+                    LTE_eNB_ULSCH_t **ulsch);
+
 void rx_ulsch_emul(PHY_VARS_eNB *phy_vars_eNB,
                    uint8_t subframe,
                    uint8_t sect_id,
@@ -1514,6 +1660,52 @@ unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
                              uint8_t Nbundled,
                              uint8_t llr8_flag);
 
+/*!
+  \brief First part of ulsch_decoding(): demultiplexing and decoding of the control information, preparation of the code blocks.
+  The code blocks are then decoded independently by ulsch_decoding_segments() and put together by ulsch_decoding_reassembly().
+  @param phy_vars_eNB Pointer to eNB top-level descriptor
+  @param UE_id ID of UE transmitting this PUSCH
+  @param subframe Index of subframe for PUSCH
+  @param control_only_flag Receive PUSCH with control information only
+  @param Nbundled Nbundled parameter for ACK/NAK scrambling from 36-212/36-213
+  @returns 0 when the code blocks are ready to be decoded, otherwise the value to be returned by ulsch_decoding()
+*/
+int ulsch_decoding_start(PHY_VARS_eNB *phy_vars_eNB,
+                         uint8_t UE_id,
+                         uint8_t subframe,
+                         uint8_t control_only_flag,
+                         uint8_t Nbundled);
+
+/*!
+  \brief Rate dematching, turbo decoding and CRC check of code blocks r0..r0+nb_segments-1 of a ULSCH prepared by ulsch_decoding_start().
+  Different code blocks can be handled concurrently by different threads.
+  @param phy_vars_eNB Pointer to eNB top-level descriptor
+  @param UE_id ID of UE transmitting this PUSCH
+  @param harq_pid HARQ process of the PUSCH
+  @param r0 First code block
+  @param nb_segments Number of code blocks
+  @param llr8_flag If 1, indicate that the 8-bit turbo decoder should be used
+  @param stats Timing of the calling thread, NULL to account in the eNB statistics
+*/
+void ulsch_decoding_segments(PHY_VARS_eNB *phy_vars_eNB,
+                             uint8_t UE_id,
+                             uint8_t harq_pid,
+                             uint8_t r0,
+                             uint8_t nb_segments,
+                             uint8_t llr8_flag,
+                             ulsch_decoding_stats_t *stats);
+
+/*!
+  \brief Last part of ulsch_decoding(): reassembly of the transport block once all its code blocks are decoded.
+  @param phy_vars_eNB Pointer to eNB top-level descriptor
+  @param UE_id ID of UE transmitting this PUSCH
+  @param harq_pid HARQ process of the PUSCH
+  @returns same as ulsch_decoding()
+*/
+unsigned int ulsch_decoding_reassembly(PHY_VARS_eNB *phy_vars_eNB,
+                                       uint8_t UE_id,
+                                       uint8_t harq_pid);
+
 uint32_t ulsch_decoding_emul(PHY_VARS_eNB *phy_vars_eNB,
                              uint8_t subframe,
                              uint8_t UE_index,
@@ -1594,6 +1786,40 @@ void pdcch_scrambling(LTE_DL_FRAME_PARMS *frame_parms,
                       uint8_t *e,
                       uint32_t length);
 
+/*! \brief Scrambles bits: e[k] = (e[k]&1) ^ c(k), <NIL> elements (2) are left untouched.
+  @param e Bits to scramble, one per byte
+  @param c Scrambling sequence, bit k&31 of word k>>5 is c(k) (see lte_gold_scrambling_sequence())
+  @param n Number of bits
+*/
+void scramble_bits(uint8_t *e, const uint32_t *c, uint32_t n);
+
+/*! \brief Descrambles 16-bit LLRs: llr[k] is negated where c(k)=0.
+  @param llr LLRs to descramble
+  @param c Scrambling sequence
+  @param n Number of LLRs
+*/
+void unscramble_llr16(int16_t *llr, const uint32_t *c, uint32_t n);
+
+/*! \brief Descrambles 8-bit LLRs: llr[k] is negated where c(k)=0.
+  @param llr LLRs to descramble
+  @param c Scrambling sequence
+  @param n Number of LLRs
+*/
+void unscramble_llr8(int8_t *llr, const uint32_t *c, uint32_t n);
+
+/*! \brief Expands a scrambling sequence to signs: cseq[k] = 2c(k)-1.
+  @param cseq Output signs
+  @param c Scrambling sequence
+  @param n Number of signs
+*/
+void scrambling_sign16(int16_t *cseq, const uint32_t *c, uint32_t n);
+
+/*! \brief Selects the 256-bit versions of the scrambling kernels.
+  @param enable 1 to use AVX2 when the host supports it, 0 to force the 128-bit path
+  @returns 1 if the AVX2 kernels are in use, 0 otherwise
+*/
+int scrambling_set_avx2(int enable);
+
 void dlsch_scrambling(LTE_DL_FRAME_PARMS *frame_parms,
                       int mbsfn_flag,
                       LTE_eNB_DLSCH_t *dlsch,
@@ -1641,6 +1867,21 @@ int32_t rx_pucch(PHY_VARS_eNB *phy_vars_eNB,
                  uint8_t subframe,
                  uint8_t pucch1_thres);
 
+/*!
+  \brief Detection of the PUCCH format 1/1a/1b transmissions of several UEs in one subframe.
+  The requests are served RB by RB: the RB is extracted from rxdataF once for all the resources
+  it carries and the cyclic shifts of the base sequences are computed once per subframe.
+  @param phy_vars_eNB Pointer to eNB top-level descriptor
+  @param pucch Array of detection requests, payload and stat are filled in as by rx_pucch
+  @param nb_pucch Number of requests
+  @param subframe Subframe index
+  @returns 0 on success, -1 on an illegal PUCCH configuration
+*/
+int32_t rx_pucch_multi(PHY_VARS_eNB *phy_vars_eNB,
+                       LTE_eNB_PUCCH_t *pucch,
+                       int nb_pucch,
+                       uint8_t subframe);
+
 int32_t rx_pucch_emul(PHY_VARS_eNB *phy_vars_eNB,
                       uint8_t UE_index,
                       PUCCH_FMT_t fmt,
@@ -40,6 +40,7 @@
 #include "PHY/defs.h"
 #include "PHY/extern.h"
 #include "LAYER2/MAC/extern.h"
+#include "PHY/sse_intrin.h"
 
 //uint8_t ncs_cell[20][7];
 //#define DEBUG_PUCCH_TX
@@ -430,56 +431,12 @@ void generate_pucch_emul(PHY_VARS_UE *phy_vars_ue,
 
 }
 
-int32_t rx_pucch(PHY_VARS_eNB *phy_vars_eNB,
-                 PUCCH_FMT_t fmt,
-                 uint8_t UE_id,
-                 uint16_t n1_pucch,
-                 uint16_t n2_pucch,
-                 uint8_t shortened_format,
-                 uint8_t *payload,
-                 uint8_t subframe,
-                 uint8_t pucch1_thres)
+static int8_t pucch_sigma2_dB(PHY_VARS_eNB *phy_vars_eNB)
 {
 
+  int8_t sigma2_dB = phy_vars_eNB->PHY_measurements_eNB[0].n0_power_tot_dB;
 
-  LTE_eNB_COMMON *eNB_common_vars                = &phy_vars_eNB->lte_eNB_common_vars;
-  LTE_DL_FRAME_PARMS *frame_parms                    = &phy_vars_eNB->lte_frame_parms;
-  //  PUCCH_CONFIG_DEDICATED *pucch_config_dedicated = &phy_vars_eNB->pucch_config_dedicated[UE_id];
-  int8_t sigma2_dB                                   = phy_vars_eNB->PHY_measurements_eNB[0].n0_power_tot_dB;
-  int32_t *Po_PUCCH                                  = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH);
-  int32_t *Po_PUCCH_dBm                              = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH_dBm);
-  int32_t *Po_PUCCH1_below                           = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH1_below);
-  int32_t *Po_PUCCH1_above                           = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH1_above);
-  int32_t *Po_PUCCH_update                           = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH_update);
-  uint32_t u,v,n,aa;
-  uint32_t z[12*14];
-  int16_t *zptr;
-  int16_t rxcomp[NB_ANTENNAS_RX][2*12*14];
-  uint8_t ns,N_UL_symb,nsymb,n_oc,n_oc0,n_oc1;
-  uint8_t c = (frame_parms->Ncp==0) ? 3 : 2;
-  uint16_t nprime,nprime0,nprime1;
-  uint16_t i,j,re_offset,thres,h,off;
-  uint8_t Nprime_div_deltaPUCCH_Shift,Nprime,d;
-  uint8_t m,l,refs,phase,re,l2,phase_max=0;
-  uint8_t n_cs,S,alpha_ind,rem;
-  int16_t tmp_re,tmp_im,W_re=0,W_im=0;
-  int16_t *rxptr;
-  uint32_t symbol_offset;
-  int16_t stat_ref_re,stat_ref_im,*cfo,chest_re,chest_im;
-  int32_t stat_re=0,stat_im=0;
-  int32_t stat,stat_max=0;
-
-  uint8_t deltaPUCCH_Shift          = frame_parms->pucch_config_common.deltaPUCCH_Shift;
-  uint8_t NRB2                      = frame_parms->pucch_config_common.nRB_CQI;
-  uint8_t Ncs1_div_deltaPUCCH_Shift = frame_parms->pucch_config_common.nCS_AN;
-
-  uint32_t u0 = (frame_parms->Nid_cell + frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.grouphop[subframe<<1]) % 30;
-  uint32_t u1 = (frame_parms->Nid_cell + frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.grouphop[1+(subframe<<1)]) % 30;
-  uint32_t v0=frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.seqhop[subframe<<1];
-  uint32_t v1=frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.seqhop[1+(subframe<<1)];
-
-
-  switch (frame_parms->N_RB_UL) {
+  switch (phy_vars_eNB->lte_frame_parms.N_RB_UL) {
 
   case 6:
     sigma2_dB -= 8;
@@ -497,17 +454,72 @@ int32_t rx_pucch(PHY_VARS_eNB *phy_vars_eNB,
     sigma2_dB -= 14;
   }
 
-  if ((deltaPUCCH_Shift==0) || (deltaPUCCH_Shift>3)) {
-    LOG_E(PHY,"[eNB] rx_pucch: Illegal deltaPUCCH_shift %d (should be 1,2,3)\n",deltaPUCCH_Shift);
-    return(-1);
-  }
+  return(sigma2_dB);
+}
 
-  if (Ncs1_div_deltaPUCCH_Shift > 7) {
-    LOG_E(PHY,"[eNB] rx_pucch: Illegal Ncs1_div_deltaPUCCH_Shift %d (should be 0...7)\n",Ncs1_div_deltaPUCCH_Shift);
-    return(-1);
+// r_uv^alpha(n) of the two slots of the subframe for the 12 cyclic shifts, shared by all the PUCCH resources
+static void pucch_cs_sequences(LTE_DL_FRAME_PARMS *frame_parms,
+                               uint8_t subframe,
+                               int16_t rcs[2][12][24])
+{
+
+  uint32_t u,v,n;
+  uint8_t s,n_cs,alpha_ind;
+
+  for (s=0; s<2; s++) {
+    u = (frame_parms->Nid_cell + frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.grouphop[s+(subframe<<1)]) % 30;
+    v = frame_parms->pusch_config_common.ul_ReferenceSignalsPUSCH.seqhop[s+(subframe<<1)];
+
+    for (n_cs=0; n_cs<12; n_cs++) {
+      alpha_ind=0;
+
+      for (n=0; n<12; n++) {
+        rcs[s][n_cs][n<<1]     = (int16_t)(((int32_t)alpha_re[alpha_ind] * ul_ref_sigs[u][v][0][n<<1] - (int32_t)alpha_im[alpha_ind] * ul_ref_sigs[u][v][0][1+(n<<1)])>>15);
+        rcs[s][n_cs][1+(n<<1)] = (int16_t)(((int32_t)alpha_re[alpha_ind] * ul_ref_sigs[u][v][0][1+(n<<1)] + (int32_t)alpha_im[alpha_ind] * ul_ref_sigs[u][v][0][n<<1])>>15);
+        alpha_ind = (alpha_ind + n_cs)%12;
+      }
+    }
   }
+}
+
+// PUCCH RB index m of format 1/1a/1b resource n1_pucch (36.211 p. 28)
+static uint8_t pucch1_rb(LTE_DL_FRAME_PARMS *frame_parms,
+                         uint16_t n1_pucch)
+{
+
+  uint8_t c = (frame_parms->Ncp==0) ? 3 : 2;
+  uint8_t deltaPUCCH_Shift          = frame_parms->pucch_config_common.deltaPUCCH_Shift;
+  uint8_t NRB2                      = frame_parms->pucch_config_common.nRB_CQI;
+  uint8_t Ncs1_div_deltaPUCCH_Shift = frame_parms->pucch_config_common.nCS_AN;
+  uint16_t thres = (c*Ncs1_div_deltaPUCCH_Shift);
+  uint8_t rem = ((((deltaPUCCH_Shift*Ncs1_div_deltaPUCCH_Shift)>>3)&7)>0) ? 1 : 0;
+
+  return((n1_pucch < thres) ? NRB2 : (((n1_pucch-thres)/(12*c/deltaPUCCH_Shift))+NRB2+((deltaPUCCH_Shift*Ncs1_div_deltaPUCCH_Shift)>>3)+rem));
+}
+
+// conjugate of S(ns)*w_noc(m)*r_uv^alpha(n) for resource n1_pucch over the symbols of the subframe
+static void pucch1_sequence(PHY_VARS_eNB *phy_vars_eNB,
+                            uint16_t n1_pucch,
+                            uint8_t shortened_format,
+                            uint8_t subframe,
+                            int16_t rcs[2][12][24],
+                            int16_t *zptr)
+{
+
+  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
+  uint32_t n;
+  uint8_t ns,N_UL_symb,n_oc,n_oc0,n_oc1;
+  uint8_t c = (frame_parms->Ncp==0) ? 3 : 2;
+  uint16_t nprime,nprime0,nprime1;
+  uint16_t thres,h;
+  uint8_t Nprime_div_deltaPUCCH_Shift,Nprime,d;
+  uint8_t l,refs;
+  uint8_t n_cs,S;
+  int16_t tmp_re,tmp_im,W_re=0,W_im=0,*r;
+
+  uint8_t deltaPUCCH_Shift          = frame_parms->pucch_config_common.deltaPUCCH_Shift;
+  uint8_t Ncs1_div_deltaPUCCH_Shift = frame_parms->pucch_config_common.nCS_AN;
 
-  zptr = (int16_t *)z;
   thres = (c*Ncs1_div_deltaPUCCH_Shift);
   Nprime_div_deltaPUCCH_Shift = (n1_pucch < thres) ? Ncs1_div_deltaPUCCH_Shift : (12/deltaPUCCH_Shift);
   Nprime = Nprime_div_deltaPUCCH_Shift * deltaPUCCH_Shift;
@@ -553,7 +565,7 @@ int32_t rx_pucch(PHY_VARS_eNB *phy_vars_eNB,
   n_oc  =n_oc0;
 
   // loop over 2 slots
-  for (ns=(subframe<<1),u=u0,v=v0; ns<(2+(subframe<<1)); ns++,u=u1,v=v1) {
+  for (ns=(subframe<<1); ns<(2+(subframe<<1)); ns++) {
 
     if ((nprime&1) == 0)
       S=0;  // 1
@@ -620,24 +632,20 @@ int32_t rx_pucch(PHY_VARS_eNB *phy_vars_eNB,
 #ifdef DEBUG_PUCCH_RX
       LOG_D(PHY,"[eNB] PUCCH: ncs[%d][%d]=%d, W_re %d, W_im %d, S %d, refs %d\n",ns,l,n_cs,W_re,W_im,S,refs);
 #endif
-      alpha_ind=0;
-      // compute output sequence
+      // r_uv^alpha(n) is taken from the cyclic shifts of the subframe
+      r = rcs[ns&1][n_cs];
 
       for (n=0; n<12; n++) {
-
-        // this is r_uv^alpha(n)
-        tmp_re = (int16_t)(((int32_t)alpha_re[alpha_ind] * ul_ref_sigs[u][v][0][n<<1] - (int32_t)alpha_im[alpha_ind] * ul_ref_sigs[u][v][0][1+(n<<1)])>>15);
-        tmp_im = (int16_t)(((int32_t)alpha_re[alpha_ind] * ul_ref_sigs[u][v][0][1+(n<<1)] + (int32_t)alpha_im[alpha_ind] * ul_ref_sigs[u][v][0][n<<1])>>15);
+        tmp_re = r[n<<1];
+        tmp_im = r[1+(n<<1)];
 
         // this is S(ns)*w_noc(m)*r_uv^alpha(n)
         zptr[n<<1] = (tmp_re*W_re - tmp_im*W_im)>>15;
         zptr[1+(n<<1)] = -(tmp_re*W_im + tmp_im*W_re)>>15;
 
 #ifdef DEBUG_PUCCH_RX
-        LOG_D(PHY,"[eNB] PUCCH subframe %d z(%d,%d) => %d,%d, alpha(%d) => %d,%d\n",subframe,l,n,zptr[n<<1],zptr[(n<<1)+1],
-              alpha_ind,alpha_re[alpha_ind],alpha_im[alpha_ind]);
+        LOG_D(PHY,"[eNB] PUCCH subframe %d z(%d,%d) => %d,%d\n",subframe,l,n,zptr[n<<1],zptr[(n<<1)+1]);
 #endif
-        alpha_ind = (alpha_ind + n_cs)%12;
       } // n
 
       zptr+=24;
@@ -646,55 +654,220 @@ int32_t rx_pucch(PHY_VARS_eNB *phy_vars_eNB,
     nprime=nprime1;
     n_oc  =n_oc1;
   } // ns
+}
 
-  rem = ((((deltaPUCCH_Shift*Ncs1_div_deltaPUCCH_Shift)>>3)&7)>0) ? 1 : 0;
+// copies the 12 REs of PUCCH RB m of the symbols of the subframe, so that all the resources of the RB read them from there
+static void pucch_extract_rb(LTE_DL_FRAME_PARMS *frame_parms,
+                             int32_t *rxdataF,
+                             uint8_t m,
+                             int16_t *rxm)
+{
 
-  m = (n1_pucch < thres) ? NRB2 : (((n1_pucch-thres)/(12*c/deltaPUCCH_Shift))+NRB2+((deltaPUCCH_Shift*Ncs1_div_deltaPUCCH_Shift)>>3)+rem);
+  uint8_t l,i;
+  uint8_t nsymb = (frame_parms->Ncp==0) ? 14 : 12;
+  uint16_t re_offset,j;
+  int16_t *rxptr;
 
-#ifdef DEBUG_PUCCH_RX
-  LOG_D(PHY,"[eNB] PUCCH: m %d\n",m);
+  for (j=0,l=0; l<nsymb; l++) {
+    if ((l<(nsymb>>1)) && ((m&1) == 0))
+      re_offset = (m*6) + frame_parms->first_carrier_offset;
+    else if ((l<(nsymb>>1)) && ((m&1) == 1))
+      re_offset = frame_parms->first_carrier_offset + (frame_parms->N_RB_DL - (m>>1) - 1)*12;
+    else if ((m&1) == 0)
+      re_offset = frame_parms->first_carrier_offset + (frame_parms->N_RB_DL - (m>>1) - 1)*12;
+    else
+      re_offset = ((m-1)*6) + frame_parms->first_carrier_offset;
+
+    if (re_offset > frame_parms->ofdm_symbol_size)
+      re_offset -= (frame_parms->ofdm_symbol_size);
+
+    rxptr = (int16_t *)&rxdataF[(unsigned int)frame_parms->ofdm_symbol_size*l];
+
+    for (i=0; i<12; i++,j+=2,re_offset++) {
+      rxm[j]   = rxptr[re_offset<<2];
+      rxm[1+j] = rxptr[1+(re_offset<<2)];
+
+      if (re_offset==frame_parms->ofdm_symbol_size)
+        re_offset = 0;
+    }
+  }
+}
+
+// rxcomp = rxm * z over len int16 (len multiple of 8), each product truncated to Q15 as in the scalar code
+static inline void pucch_compensate(int16_t *rxm,
+                                    int16_t *z,
+                                    int16_t *rxcomp,
+                                    int len)
+{
+
+  int i=0;
+
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i *rxm128 = (__m128i *)rxm;
+  __m128i *z128 = (__m128i *)z;
+  __m128i *rxcomp128 = (__m128i *)rxcomp;
+  __m128i rxsw,p,q;
+  const __m128i re_mask = _mm_set1_epi32(0x0000ffff);
+
+  for (; i<(len>>3); i++) {
+    // (x*y)>>15 on 16 bits is rebuilt from the high and low halves of the products
+    p = _mm_or_si128(_mm_slli_epi16(_mm_mulhi_epi16(rxm128[i],z128[i]),1),
+                     _mm_srli_epi16(_mm_mullo_epi16(rxm128[i],z128[i]),15));   // re*z_re, im*z_im
+    rxsw = _mm_shufflelo_epi16(rxm128[i],_MM_SHUFFLE(2,3,0,1));
+    rxsw = _mm_shufflehi_epi16(rxsw,_MM_SHUFFLE(2,3,0,1));
+    q = _mm_or_si128(_mm_slli_epi16(_mm_mulhi_epi16(rxsw,z128[i]),1),
+                     _mm_srli_epi16(_mm_mullo_epi16(rxsw,z128[i]),15));        // im*z_re, re*z_im
+    p = _mm_sub_epi16(p,_mm_srli_epi32(p,16));
+    q = _mm_add_epi16(q,_mm_slli_epi32(q,16));
+    rxcomp128[i] = _mm_or_si128(_mm_and_si128(re_mask,p),_mm_andnot_si128(re_mask,q));
+  }
+
+  i<<=3;
 #endif
-  nsymb = N_UL_symb<<1;
 
-  zptr = (int16_t*)z;
+  for (; i<len; i+=2) {
+    rxcomp[i]   = (int16_t)((rxm[i]*(int32_t)z[i])>>15)   - ((rxm[1+i]*(int32_t)z[1+i])>>15);
+    rxcomp[1+i] = (int16_t)((rxm[i]*(int32_t)z[1+i])>>15) + ((rxm[1+i]*(int32_t)z[i])>>15);
+  }
+}
 
-  // Do detection
-  for (aa=0; aa<frame_parms->nb_antennas_rx; aa++) {
+// correlation of the 12 REs of one antenna with the cfo phase ramp, separately over the data and the
+// reference symbols (format 1a/1b phase search)
+static inline void pucch1_phase_corr(int16_t *rxcomp,
+                                     int16_t *cfo,
+                                     uint8_t nsymb,
+                                     int32_t *stat_re,
+                                     int32_t *stat_im,
+                                     int16_t *stat_ref_re,
+                                     int16_t *stat_ref_im)
+{
 
-    //for (j=0,l=0;l<(nsymb-1);l++) {
-    for (j=0,l=0; l<nsymb; l++) {
-      if ((l<(nsymb>>1)) && ((m&1) == 0))
-        re_offset = (m*6) + frame_parms->first_carrier_offset;
-      else if ((l<(nsymb>>1)) && ((m&1) == 1))
-        re_offset = frame_parms->first_carrier_offset + (frame_parms->N_RB_DL - (m>>1) - 1)*12;
-      else if ((m&1) == 0)
-        re_offset = frame_parms->first_carrier_offset + (frame_parms->N_RB_DL - (m>>1) - 1)*12;
-      else
-        re_offset = ((m-1)*6) + frame_parms->first_carrier_offset;
+  uint8_t l,l2,re;
 
-      if (re_offset > frame_parms->ofdm_symbol_size)
-        re_offset -= (frame_parms->ofdm_symbol_size);
+#if defined(__x86_64__) || defined(__i386__)
+  __m128i acc[2][6],x,lo_r,hi_r,lo_i,hi_i,p,q,cre,cim;
+  const __m128i neg_re = _mm_set_epi32(0,-1,0,-1);
+  int32_t corr[2][24] __attribute__((aligned(16)));
+  int16_t *c;
+  uint8_t ref;
+  int i;
 
-      symbol_offset = (unsigned int)frame_parms->ofdm_symbol_size*l;
-      rxptr = (int16_t *)&eNB_common_vars->rxdataF[0][aa][symbol_offset];
+  for (i=0; i<6; i++) {
+    acc[0][i] = _mm_setzero_si128();
+    acc[1][i] = _mm_setzero_si128();
+  }
 
-      for (i=0; i<12; i++,j+=2,re_offset++) {
-        rxcomp[aa][j]   = (int16_t)((rxptr[re_offset<<2]*(int32_t)zptr[j])>>15)   - ((rxptr[1+(re_offset<<2)]*(int32_t)zptr[1+j])>>15);
-        rxcomp[aa][1+j] = (int16_t)((rxptr[re_offset<<2]*(int32_t)zptr[1+j])>>15) + ((rxptr[1+(re_offset<<2)]*(int32_t)zptr[j])>>15);
+  for (l=0; l<(nsymb-1); l++) {
+    if (l<(nsymb>>1)) {
+      ref = ((l>=2) && (l<=(nsymb>>1)-3)) ? 1 : 0;
+      c = &cfo[l<<1];
+    } else {
+      l2 = l-(nsymb>>1);
+      ref = ((l2>=2) && (l2<=(nsymb>>1)-3)) ? 1 : 0;
+      c = (ref==1) ? &cfo[l<<1] : &cfo[l2<<1];
+    }
 
-        if (re_offset==frame_parms->ofdm_symbol_size)
-          re_offset = 0;
+    cre = _mm_set1_epi16(c[0]);
+    cim = _mm_set1_epi16(c[1]);
+
+    for (i=0; i<3; i++) {
+      // RE re of symbol l is read at off = (re+l)<<1, as in the scalar loop
+      x    = _mm_loadu_si128((__m128i *)&rxcomp[(l<<1)+(i<<3)]);
+      lo_r = _mm_mullo_epi16(x,cre);
+      hi_r = _mm_mulhi_epi16(x,cre);
+      lo_i = _mm_mullo_epi16(x,cim);
+      hi_i = _mm_mulhi_epi16(x,cim);
+
+      p = _mm_srai_epi32(_mm_unpacklo_epi16(lo_r,hi_r),15);          // re*c_re, im*c_re
+      q = _mm_srai_epi32(_mm_unpacklo_epi16(lo_i,hi_i),15);          // re*c_im, im*c_im
+      q = _mm_shuffle_epi32(q,_MM_SHUFFLE(2,3,0,1));
+      q = _mm_sub_epi32(_mm_xor_si128(q,neg_re),neg_re);             // -im*c_im, re*c_im
+      acc[ref][i<<1] = _mm_add_epi32(acc[ref][i<<1],_mm_add_epi32(p,q));
+
+      p = _mm_srai_epi32(_mm_unpackhi_epi16(lo_r,hi_r),15);
+      q = _mm_srai_epi32(_mm_unpackhi_epi16(lo_i,hi_i),15);
+      q = _mm_shuffle_epi32(q,_MM_SHUFFLE(2,3,0,1));
+      q = _mm_sub_epi32(_mm_xor_si128(q,neg_re),neg_re);
+      acc[ref][1+(i<<1)] = _mm_add_epi32(acc[ref][1+(i<<1)],_mm_add_epi32(p,q));
+    }
+  }
+
+  for (i=0; i<6; i++) {
+    _mm_store_si128((__m128i *)&corr[0][i<<2],acc[0][i]);
+    _mm_store_si128((__m128i *)&corr[1][i<<2],acc[1][i]);
+  }
+
+  for (re=0; re<12; re++) {
+    stat_re[re]     = corr[0][re<<1];
+    stat_im[re]     = corr[0][1+(re<<1)];
+    stat_ref_re[re] = (int16_t)corr[1][re<<1];
+    stat_ref_im[re] = (int16_t)corr[1][1+(re<<1)];
+  }
+
+#else
+  uint16_t off;
+
+  for (re=0; re<12; re++) {
+    stat_re[re]=0;
+    stat_im[re]=0;
+    stat_ref_re[re]=0;
+    stat_ref_im[re]=0;
+    off=re<<1;
+
+    for (l=0; l<(nsymb>>1); l++) {
+      if ((l<2)||(l>(nsymb>>1) - 3)) {  //data symbols
+        stat_re[re] += ((rxcomp[off]*(int32_t)cfo[l<<1])>>15)     - ((rxcomp[1+off]*(int32_t)cfo[1+(l<<1)])>>15);
+        stat_im[re] += ((rxcomp[off]*(int32_t)cfo[1+(l<<1)])>>15) + ((rxcomp[1+off]*(int32_t)cfo[(l<<1)])>>15);
+      } else { //reference symbols
+        stat_ref_re[re] += ((rxcomp[off]*(int32_t)cfo[l<<1])>>15)     - ((rxcomp[1+off]*(int32_t)cfo[1+(l<<1)])>>15);
+        stat_ref_im[re] += ((rxcomp[off]*(int32_t)cfo[1+(l<<1)])>>15) + ((rxcomp[1+off]*(int32_t)cfo[(l<<1)])>>15);
+      }
+
+      off+=2;
+    }
+
+    for (l2=0,l=(nsymb>>1); l<(nsymb-1); l++,l2++) {
+      if ((l2<2) || ((l2>(nsymb>>1) - 3)) ) {  // data symbols
+        stat_re[re] += ((rxcomp[off]*(int32_t)cfo[l2<<1])>>15)     - ((rxcomp[1+off]*(int32_t)cfo[1+(l2<<1)])>>15);
+        stat_im[re] += ((rxcomp[off]*(int32_t)cfo[1+(l2<<1)])>>15) + ((rxcomp[1+off]*(int32_t)cfo[(l2<<1)])>>15);
+      } else { //reference_symbols
+        stat_ref_re[re] += ((rxcomp[off]*(int32_t)cfo[l<<1])>>15)     - ((rxcomp[1+off]*(int32_t)cfo[1+(l<<1)])>>15);
+        stat_ref_im[re] += ((rxcomp[off]*(int32_t)cfo[1+(l<<1)])>>15) + ((rxcomp[1+off]*(int32_t)cfo[(l<<1)])>>15);
+      }
+
+      off+=2;
+    }
+  }
 
-#ifdef DEBUG_PUCCH_RX
-        LOG_D(PHY,"[eNB] PUCCH subframe %d (%d,%d,%d,%d,%d) => (%d,%d) x (%d,%d) : (%d,%d)\n",subframe,l,i,re_offset,m,j,
-              rxptr[re_offset<<2],rxptr[1+(re_offset<<2)],
-              zptr[j],zptr[1+j],
-              rxcomp[aa][j],rxcomp[aa][1+j]);
 #endif
-      } //re
-    } // symbol
-  }  // antenna
+}
 
+static int32_t pucch1_detect(PHY_VARS_eNB *phy_vars_eNB,
+                             PUCCH_FMT_t fmt,
+                             uint8_t UE_id,
+                             int16_t rxcomp[NB_ANTENNAS_RX][2*12*14],
+                             uint8_t *payload,
+                             int8_t sigma2_dB,
+                             uint8_t pucch1_thres,
+                             uint8_t subframe)
+{
+
+  LTE_DL_FRAME_PARMS *frame_parms                    = &phy_vars_eNB->lte_frame_parms;
+  int32_t *Po_PUCCH                                  = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH);
+  int32_t *Po_PUCCH_dBm                              = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH_dBm);
+  int32_t *Po_PUCCH1_below                           = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH1_below);
+  int32_t *Po_PUCCH1_above                           = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH1_above);
+  int32_t *Po_PUCCH_update                           = &(phy_vars_eNB->eNB_UE_stats[UE_id].Po_PUCCH_update);
+  uint32_t aa;
+  uint8_t nsymb = (frame_parms->Ncp==0) ? 14 : 12;
+  uint16_t off;
+  uint8_t l,phase,re,l2,phase_max=0;
+  int16_t tmp_re,tmp_im;
+  int16_t *cfo,chest_re,chest_im;
+  int16_t corr_ref_re[12],corr_ref_im[12];
+  int32_t corr_re[12],corr_im[12];
+  int32_t stat_re=0,stat_im=0;
+  int32_t stat,stat_max=0;
 
   // PUCCH Format 1
   // Do cfo correction and MRC across symbols
@@ -780,56 +953,14 @@ int32_t rx_pucch(PHY_VARS_eNB *phy_vars_eNB,
 
     for (phase=0; phase<7; phase++) {
       stat=0;
+      cfo =  (frame_parms->Ncp==0) ? &cfo_pucch_np[14*phase] : &cfo_pucch_ep[12*phase];
 
       for (aa=0; aa<frame_parms->nb_antennas_rx; aa++) {
-        for (re=0; re<12; re++) {
-          stat_re=0;
-          stat_im=0;
-          stat_ref_re=0;
-          stat_ref_im=0;
-          off=re<<1;
-          cfo =  (frame_parms->Ncp==0) ? &cfo_pucch_np[14*phase] : &cfo_pucch_ep[12*phase];
-
-
-          for (l=0; l<(nsymb>>1); l++) {
-            if ((l<2)||(l>(nsymb>>1) - 3)) {  //data symbols
-              stat_re += ((rxcomp[aa][off]*(int32_t)cfo[l<<1])>>15)     - ((rxcomp[aa][1+off]*(int32_t)cfo[1+(l<<1)])>>15);
-              stat_im += ((rxcomp[aa][off]*(int32_t)cfo[1+(l<<1)])>>15) + ((rxcomp[aa][1+off]*(int32_t)cfo[(l<<1)])>>15);
-            } else { //reference symbols
-              stat_ref_re += ((rxcomp[aa][off]*(int32_t)cfo[l<<1])>>15)     - ((rxcomp[aa][1+off]*(int32_t)cfo[1+(l<<1)])>>15);
-              stat_ref_im += ((rxcomp[aa][off]*(int32_t)cfo[1+(l<<1)])>>15) + ((rxcomp[aa][1+off]*(int32_t)cfo[(l<<1)])>>15);
-            }
-
-            off+=2;
-#ifdef DEBUG_PUCCH_RX
-            LOG_D(PHY,"[eNB] PUCCH subframe %d (%d,%d) => (%d,%d) x (%d,%d) : (%d,%d)\n",subframe,l,re,
-                  rxcomp[aa][off],rxcomp[aa][1+off],
-                  cfo[l<<1],cfo[1+(l<<1)],
-                  stat_re,stat_im);
-#endif
-          }
-
-          for (l2=0,l=(nsymb>>1); l<(nsymb-1); l++,l2++) {
-            if ((l2<2) || ((l2>(nsymb>>1) - 3)) ) {  // data symbols
-              stat_re += ((rxcomp[aa][off]*(int32_t)cfo[l2<<1])>>15)     - ((rxcomp[aa][1+off]*(int32_t)cfo[1+(l2<<1)])>>15);
-              stat_im += ((rxcomp[aa][off]*(int32_t)cfo[1+(l2<<1)])>>15) + ((rxcomp[aa][1+off]*(int32_t)cfo[(l2<<1)])>>15);
-            } else { //reference_symbols
-              stat_ref_re += ((rxcomp[aa][off]*(int32_t)cfo[l<<1])>>15)     - ((rxcomp[aa][1+off]*(int32_t)cfo[1+(l<<1)])>>15);
-              stat_ref_im += ((rxcomp[aa][off]*(int32_t)cfo[1+(l<<1)])>>15) + ((rxcomp[aa][1+off]*(int32_t)cfo[(l<<1)])>>15);
-            }
-
-            off+=2;
-#ifdef DEBUG_PUCCH_RX
-            LOG_D(PHY,"[eNB] PUCCH subframe %d (%d,%d) => (%d,%d) x (%d,%d) : (%d,%d)\n",subframe,l2,re,
-                  rxcomp[aa][off],rxcomp[aa][1+off],
-                  cfo[l2<<1],cfo[1+(l2<<1)],
-                  stat_re,stat_im);
-#endif
+        pucch1_phase_corr(rxcomp[aa],cfo,nsymb,corr_re,corr_im,corr_ref_re,corr_ref_im);
 
-          }
-
-          stat += (((stat_re*stat_re)) + ((stat_im*stat_im)) +
-                   ((stat_ref_re*stat_ref_re)) + ((stat_ref_im*stat_ref_im)));
+        for (re=0; re<12; re++) {
+          stat += (((corr_re[re]*corr_re[re])) + ((corr_im[re]*corr_im[re])) +
+                   ((corr_ref_re[re]*corr_ref_re[re])) + ((corr_ref_im[re]*corr_ref_im[re])));
 #ifdef DEBUG_PUCCH_RX
           LOG_D(PHY,"aa%d re %d : phase %d : stat %d\n",aa,re,phase,stat);
 #endif
@@ -990,7 +1121,119 @@ int32_t rx_pucch(PHY_VARS_eNB *phy_vars_eNB,
   }
 
   return((int32_t)stat_max);
+}
+
+int32_t rx_pucch_multi(PHY_VARS_eNB *phy_vars_eNB,
+                       LTE_eNB_PUCCH_t *pucch,
+                       int nb_pucch,
+                       uint8_t subframe)
+{
+
+  LTE_eNB_COMMON *eNB_common_vars = &phy_vars_eNB->lte_eNB_common_vars;
+  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
+  int16_t rcs[2][12][24];
+  int16_t z[2*12*14] __attribute__((aligned(16)));
+  int16_t rxm[NB_ANTENNAS_RX][2*12*14] __attribute__((aligned(16)));
+  int16_t rxcomp[NB_ANTENNAS_RX][2*12*14] __attribute__((aligned(16)));
+  int8_t sigma2_dB;
+  uint8_t nsymb = (frame_parms->Ncp==0) ? 14 : 12;
+  uint8_t m[nb_pucch>0 ? nb_pucch : 1];
+  int order[nb_pucch>0 ? nb_pucch : 1];
+  int i,j,k,m_last=-1;
+  uint32_t aa;
+
+  uint8_t deltaPUCCH_Shift          = frame_parms->pucch_config_common.deltaPUCCH_Shift;
+  uint8_t Ncs1_div_deltaPUCCH_Shift = frame_parms->pucch_config_common.nCS_AN;
+
+  if (nb_pucch == 0)
+    return(0);
+
+  if ((deltaPUCCH_Shift==0) || (deltaPUCCH_Shift>3)) {
+    LOG_E(PHY,"[eNB] rx_pucch: Illegal deltaPUCCH_shift %d (should be 1,2,3)\n",deltaPUCCH_Shift);
+    return(-1);
+  }
+
+  if (Ncs1_div_deltaPUCCH_Shift > 7) {
+    LOG_E(PHY,"[eNB] rx_pucch: Illegal Ncs1_div_deltaPUCCH_Shift %d (should be 0...7)\n",Ncs1_div_deltaPUCCH_Shift);
+    return(-1);
+  }
+
+  sigma2_dB = pucch_sigma2_dB(phy_vars_eNB);
+  pucch_cs_sequences(frame_parms,subframe,rcs);
+
+  // the requests are served in RB order, so that each PUCCH RB is extracted once for all its resources
+  for (i=0; i<nb_pucch; i++) {
+    m[i] = pucch1_rb(frame_parms,pucch[i].n1_pucch);
+
+    for (j=i; (j>0) && (m[order[j-1]]>m[i]); j--)
+      order[j] = order[j-1];
+
+    order[j] = i;
+  }
+
+#ifdef DEBUG_PUCCH_RX
+  LOG_D(PHY,"[eNB] rx_pucch_multi: subframe %d, %d requests\n",subframe,nb_pucch);
+#endif
+
+  for (k=0; k<nb_pucch; k++) {
+    i = order[k];
+
+    if (m[i] != m_last) {
+      for (aa=0; aa<frame_parms->nb_antennas_rx; aa++)
+        pucch_extract_rb(frame_parms,eNB_common_vars->rxdataF[0][aa],m[i],rxm[aa]);
+
+      m_last = m[i];
+    }
+
+    pucch1_sequence(phy_vars_eNB,pucch[i].n1_pucch,pucch[i].shortened_format,subframe,rcs,z);
+
+    for (aa=0; aa<frame_parms->nb_antennas_rx; aa++)
+      pucch_compensate(rxm[aa],z,rxcomp[aa],24*nsymb);
+
+    pucch[i].stat = pucch1_detect(phy_vars_eNB,
+                                  pucch[i].fmt,
+                                  pucch[i].UE_id,
+                                  rxcomp,
+                                  pucch[i].payload,
+                                  sigma2_dB,
+                                  pucch[i].pucch1_thres,
+                                  subframe);
+  }
+
+  return(0);
+}
+
+int32_t rx_pucch(PHY_VARS_eNB *phy_vars_eNB,
+                 PUCCH_FMT_t fmt,
+                 uint8_t UE_id,
+                 uint16_t n1_pucch,
+                 uint16_t n2_pucch,
+                 uint8_t shortened_format,
+                 uint8_t *payload,
+                 uint8_t subframe,
+                 uint8_t pucch1_thres)
+{
+
+  LTE_eNB_PUCCH_t pucch;
+
+  pucch.fmt              = fmt;
+  pucch.UE_id            = UE_id;
+  pucch.n1_pucch         = n1_pucch;
+  pucch.n2_pucch         = n2_pucch;
+  pucch.shortened_format = shortened_format;
+  pucch.pucch1_thres     = pucch1_thres;
+  pucch.payload[0]       = payload[0];
+  pucch.payload[1]       = (fmt==pucch_format1b) ? payload[1] : 0;
+
+  if (rx_pucch_multi(phy_vars_eNB,&pucch,1,subframe) < 0)
+    return(-1);
+
+  payload[0] = pucch.payload[0];
+
+  if (fmt==pucch_format1b)
+    payload[1] = pucch.payload[1];
 
+  return(pucch.stat);
 }
 
 
@@ -227,12 +227,11 @@ uint8_t extract_cqi_crc(uint8_t *cqi,uint8_t CQI_LENGTH)
 
 
 
-unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
-                             uint8_t UE_id,
-                             uint8_t sched_subframe,
-                             uint8_t control_only_flag,
-                             uint8_t Nbundled,
-                             uint8_t llr8_flag)
+int ulsch_decoding_start(PHY_VARS_eNB *phy_vars_eNB,
+                         uint8_t UE_id,
+                         uint8_t sched_subframe,
+                         uint8_t control_only_flag,
+                         uint8_t Nbundled)
 {
 
 
@@ -241,16 +240,13 @@ unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
   LTE_eNB_ULSCH_t *ulsch = phy_vars_eNB->ulsch_eNB[UE_id];
   uint8_t harq_pid;
   unsigned short nb_rb;
-  unsigned int A,E;
+  unsigned int A;
   uint8_t Q_m;
   unsigned int i,i2,q,j,j2;
   int iprime;
-  unsigned int ret=0,offset;
-  unsigned short iind;
   //  uint8_t dummy_channel_output[(3*8*block_length)+12];
 
-  unsigned int r,r_offset=0,Kr,Kr_bytes;
-  uint8_t crc_type;
+  unsigned int r,r_offset=0,Kr,Kr_bytes,Gp,GpmodC;
   uint8_t *columnset;
   unsigned int sumKr=0;
   unsigned int Qprime,L,G,Q_CQI,Q_RI,H,Hprime,Hpp,Cmux,Rmux_prime,O_RCC;
@@ -258,39 +254,18 @@ unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
   //  uint8_t q_ACK[MAX_ACK_PAYLOAD],q_RI[MAX_RI_PAYLOAD];
   int metric,metric_new;
   uint8_t o_flip[8];
-  uint32_t x1, x2, s=0;
+  uint32_t x2;
   int16_t ys,c;
   uint32_t wACK_idx;
-  int16_t dummy_w[MAX_NUM_ULSCH_SEGMENTS][3*(6144+64)];
   uint8_t dummy_w_cc[3*(MAX_CQI_BITS+8+32)];
   int16_t y[6*14*1200];
   uint8_t ytag[14*1200];
   //  uint8_t ytag2[6*14*1200],*ytag2_ptr;
   int16_t cseq[6*14*1200];
   int off;
-  int status[20];
   int subframe = phy_vars_eNB->proc[sched_subframe].subframe_rx;
   LTE_UL_eNB_HARQ_t *ulsch_harq;
 
-  uint8_t (*tc)(int16_t *y,
-                uint8_t *,
-                uint16_t,
-                uint16_t,
-                uint16_t,
-                uint8_t,
-                uint8_t,
-                uint8_t,
-                time_stats_t *,
-                time_stats_t *,
-                time_stats_t *,
-                time_stats_t *,
-                time_stats_t *,
-                time_stats_t *,
-                time_stats_t *);
-
-  VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_PHY_ENB_ULSCH_DECODING,1);
-
-  // x1 is set in lte_gold_generic
   x2 = ((uint32_t)ulsch->rnti<<14) + ((uint32_t)subframe<<9) + frame_parms->Nid_cell; //this is c_init in 36.211 Sec 6.3.1
 
   //  harq_pid = (ulsch->RRCConnRequest_flag == 0) ? subframe2harq_pid_tdd(frame_parms->tdd_config,subframe) : 0;
@@ -302,15 +277,12 @@ unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
     return -1;
   }
 
+  ulsch_harq->cb_pending = 0;
+
   if (ulsch_harq->Nsymb_pusch == 0) {
       LOG_E(PHY, "FATAL ERROR: harq_pid %d, Nsymb 0!\n",harq_pid);
       return 1+ulsch->max_turbo_iterations;
   }
-  if (llr8_flag == 0)
-    tc = phy_threegpplte_turbo_decoder16;
-  else
-    tc = phy_threegpplte_turbo_decoder8;
-
   nb_rb = ulsch_harq->nb_rb;
 
   A = ulsch_harq->TBS;
@@ -597,16 +569,7 @@ unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
   // llrs stored per symbol correspond to columns of interleaving matrix
 
 
-  s = lte_gold_generic(&x1, &x2, 1);
-  i2=0;
-
-  for (i=0; i<((Hpp*Q_m)>>5); i++) {
-    for (j=0; j<32; j++) {
-      cseq[i2++] = (int16_t)((((s>>j)&1)<<1)-1);
-    }
-
-    s = lte_gold_generic(&x1, &x2, 0);
-  }
+  scrambling_sign16(cseq,lte_gold_scrambling_sequence(x2,(Hpp*Q_m+31)>>5),Hpp*Q_m);
 
   if (frame_parms->Ncp == 0)
     columnset = cs_ri_normal;
@@ -1211,15 +1174,73 @@ unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
 #endif
   }
 
-  //  return(0);
-  // Do PUSCH Decoding
+  // Check the code block sizes and locate the code blocks in the e-sequence
+  // (E as computed by lte_rate_matching_turbo_rx() with Nl=1), so that each
+  // of them can be rate-matched and decoded independently
+  ulsch_harq->G = G;
+  Gp = G/Q_m;
+  GpmodC = Gp%ulsch_harq->C;
+  r_offset = 0;
 
-  //  stop_meas(&phy_vars_eNB->ulsch_demultiplexing_stats);
+  for (r=0; r<ulsch_harq->C; r++) {
+    if (r<ulsch_harq->Cminus)
+      Kr = ulsch_harq->Kminus;
+    else
+      Kr = ulsch_harq->Kplus;
 
+    Kr_bytes = Kr>>3;
 
-  r_offset = 0;
+    if ((Kr_bytes<5) || (Kr_bytes>768)) {
+      LOG_E(PHY,"ulsch_decoding: Illegal codeword size %d!!!\n",Kr_bytes);
+      return(-1);
+    }
 
-  for (r=0; r<ulsch_harq->C; r++) {
+    ulsch_harq->e_offset[r] = r_offset;
+
+    if (r < (ulsch_harq->C-GpmodC))
+      r_offset += Q_m * (Gp/ulsch_harq->C);
+    else
+      r_offset += Q_m * ((GpmodC==0?0:1) + (Gp/ulsch_harq->C));
+  }
+
+  ulsch_harq->cb_failed = 0;
+  ulsch_harq->cb_pending = 1;
+
+  return(0);
+}
+
+void ulsch_decoding_segments(PHY_VARS_eNB *phy_vars_eNB,
+                             uint8_t UE_id,
+                             uint8_t harq_pid,
+                             uint8_t r0,
+                             uint8_t nb_segments,
+                             uint8_t llr8_flag,
+                             ulsch_decoding_stats_t *stats)
+{
+
+  LTE_eNB_ULSCH_t *ulsch = phy_vars_eNB->ulsch_eNB[UE_id];
+  LTE_UL_eNB_HARQ_t *ulsch_harq = ulsch->harq_processes[harq_pid];
+  rm_turbo_map_t rm_map_F;
+  const rm_turbo_map_t *rm_map;
+  int16_t *tc_in[MAX_NUM_ULSCH_SEGMENTS];
+  uint8_t *tc_out[MAX_NUM_ULSCH_SEGMENTS];
+  uint16_t tc_n[MAX_NUM_ULSCH_SEGMENTS];
+  uint8_t tc_ret[MAX_NUM_ULSCH_SEGMENTS];
+  unsigned int r,Kr,Kr_bytes,E;
+  unsigned short iind;
+  uint8_t crc_type = (ulsch_harq->C == 1) ? CRC24_A : CRC24_B;
+  time_stats_t *rm_stats    = stats ? &stats->rate_unmatching : &phy_vars_eNB->ulsch_rate_unmatching_stats;
+  time_stats_t *deint_stats = stats ? &stats->deinterleaving  : &phy_vars_eNB->ulsch_deinterleaving_stats;
+  time_stats_t *tc_stats    = stats ? &stats->turbo_decoding  : &phy_vars_eNB->ulsch_turbo_decoding_stats;
+  time_stats_t *init_stats  = stats ? &stats->tc_init         : &phy_vars_eNB->ulsch_tc_init_stats;
+  time_stats_t *alpha_stats = stats ? &stats->tc_alpha        : &phy_vars_eNB->ulsch_tc_alpha_stats;
+  time_stats_t *beta_stats  = stats ? &stats->tc_beta         : &phy_vars_eNB->ulsch_tc_beta_stats;
+  time_stats_t *gamma_stats = stats ? &stats->tc_gamma        : &phy_vars_eNB->ulsch_tc_gamma_stats;
+  time_stats_t *ext_stats   = stats ? &stats->tc_ext          : &phy_vars_eNB->ulsch_tc_ext_stats;
+  time_stats_t *intl1_stats = stats ? &stats->tc_intl1        : &phy_vars_eNB->ulsch_tc_intl1_stats;
+  time_stats_t *intl2_stats = stats ? &stats->tc_intl2        : &phy_vars_eNB->ulsch_tc_intl2_stats;
+
+  for (r=r0; r<r0+nb_segments; r++) {
 
     // Get Turbo interleaver parameters
     if (r<ulsch_harq->Cminus)
@@ -1235,150 +1256,160 @@ unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
       iind = 59 + ((Kr_bytes-64)>>1);
     else if (Kr_bytes <= 256)
       iind = 91 + ((Kr_bytes-128)>>2);
-    else if (Kr_bytes <= 768)
+    else
       iind = 123 + ((Kr_bytes-256)>>3);
-    else {
-      LOG_E(PHY,"ulsch_decoding: Illegal codeword size %d!!!\n",Kr_bytes);
-      return(-1);
-    }
+
+    tc_in[r-r0]  = &ulsch_harq->d[r][96];
+    tc_out[r-r0] = ulsch_harq->c[r];
+    tc_n[r-r0]   = Kr;
 
 #ifdef DEBUG_ULSCH_DECODING
     msg("f1 %d, f2 %d, F %d\n",f1f2mat_old[2*iind],f1f2mat_old[1+(2*iind)],(r==0) ? ulsch_harq->F : 0);
 #endif
 
-    memset(&dummy_w[r][0],0,3*(6144+64)*sizeof(short));
-    ulsch_harq->RTC[r] = generate_dummy_w(4+(Kr_bytes*8),
-                                          (uint8_t*)&dummy_w[r][0],
-                                          (r==0) ? ulsch_harq->F : 0);
+    rm_map = get_rm_turbo_map(4+(Kr_bytes*8),
+                              (r==0) ? ulsch_harq->F : 0,
+                              &rm_map_F);
+    ulsch_harq->RTC[r] = rm_map->RTC;
 
 #ifdef DEBUG_ULSCH_DECODING
     msg("Rate Matching Segment %d (coded bits (G) %d,unpunctured/repeated bits %d, Q_m %d, nb_rb %d, Nl %d)...\n",
-        r, G,
+        r, ulsch_harq->G,
         Kr*3,
-        Q_m,
-        nb_rb,
+        get_Qm_ul(ulsch_harq->mcs),
+        ulsch_harq->nb_rb,
         ulsch_harq->Nl);
 #endif
 
-    start_meas(&phy_vars_eNB->ulsch_rate_unmatching_stats);
-
-    if (lte_rate_matching_turbo_rx(ulsch_harq->RTC[r],
-                                   G,
-                                   ulsch_harq->w[r],
-                                   (uint8_t*) &dummy_w[r][0],
-                                   ulsch_harq->e+r_offset,
-                                   ulsch_harq->C,
-                                   NSOFT,
-                                   ulsch->Mdlharq,
-                                   1,
-                                   ulsch_harq->rvidx,
-                                   (ulsch_harq->round==0)?1:0,  // clear
-                                   get_Qm_ul(ulsch_harq->mcs),
-                                   1,
-                                   r,
-                                   &E)==-1) {
+    start_meas(rm_stats);
+
+    if (lte_rate_matching_turbo_rx_map(rm_map,
+                                       ulsch_harq->G,
+                                       ulsch_harq->w[r],
+                                       ulsch_harq->e+ulsch_harq->e_offset[r],
+                                       ulsch_harq->C,
+                                       NSOFT,
+                                       ulsch->Mdlharq,
+                                       1,
+                                       ulsch_harq->rvidx,
+                                       (ulsch_harq->round==0)?1:0,  // clear
+                                       get_Qm_ul(ulsch_harq->mcs),
+                                       1,
+                                       r,
+                                       &E)==-1) {
       LOG_E(PHY,"ulsch_decoding.c: Problem in rate matching\n");
-      return(-1);
+      ulsch_harq->cb_status[r] = -1;
+      ulsch_harq->cb_failed = 1;
+      return;
     }
 
-    stop_meas(&phy_vars_eNB->ulsch_rate_unmatching_stats);
-    r_offset += E;
-    /*
-    msg("Subblock deinterleaving, d %p w %p\n",
-     ulsch_harq->d[r],
-     ulsch_harq->w);
-    */
-    start_meas(&phy_vars_eNB->ulsch_deinterleaving_stats);
+    stop_meas(rm_stats);
+
+    start_meas(deint_stats);
     sub_block_deinterleaving_turbo(4+Kr,
                                    &ulsch_harq->d[r][96],
                                    ulsch_harq->w[r]);
-    stop_meas(&phy_vars_eNB->ulsch_deinterleaving_stats);
-    /*
-    #ifdef DEBUG_ULSCH_DECODING
-    msg("decoder input(segment %d) :",r);
-    for (i=0;i<(3*8*Kr_bytes)+12;i++)
-      msg("%d : %d\n",i,ulsch_harq->d[r][96+i]);
-    msg("\n");
-    #endif
-    */
-  }
+    stop_meas(deint_stats);
 
-#ifdef OMP
-  #pragma omp parallel private(r,ret) shared(ulsch,harq_pid,crc_type,Kr,f1f2mat_old,phy_vars_eNB,status,iind,)
-  {
-    #pragma omp for nowait
-#endif
+    if (llr8_flag == 1)
+      continue;
 
-    for (r=0; r<ulsch_harq->C; r++) {
-      //    msg("Clearing c, %p\n",ulsch_harq->c[r]);
-      //    memset(ulsch_harq->c[r],0,16);//block_length);
-      //    msg("done\n");
-      if (ulsch_harq->C == 1)
-        crc_type = CRC24_A;
-      else
-        crc_type = CRC24_B;
-
-      /*
-        msg("decoder input(segment %d)\n",r);
-        for (i=0;i<(3*8*Kr_bytes)+12;i++)
-        if ((ulsch_harq->d[r][96+i]>7) ||
-        (ulsch_harq->d[r][96+i] < -8))
-        msg("%d : %d\n",i,ulsch_harq->d[r][96+i]);
-        msg("\n");
-      */
-
-      start_meas(&phy_vars_eNB->ulsch_turbo_decoding_stats);
+    // another code block of this transport block is already in error, don't spend time on this one
+    if (ulsch_harq->cb_failed == 1) {
+      ulsch_harq->cb_status[r] = 2+ulsch->max_turbo_iterations;
+      continue;
+    }
 
-      ret = tc(&ulsch_harq->d[r][96],
-               ulsch_harq->c[r],
-               Kr,
-               f1f2mat_old[iind*2],
-               f1f2mat_old[(iind*2)+1],
-               ulsch->max_turbo_iterations,//MAX_TURBO_ITERATIONS,
-               crc_type,
-               (r==0) ? ulsch_harq->F : 0,
-               &phy_vars_eNB->ulsch_tc_init_stats,
-               &phy_vars_eNB->ulsch_tc_alpha_stats,
-               &phy_vars_eNB->ulsch_tc_beta_stats,
-               &phy_vars_eNB->ulsch_tc_gamma_stats,
-               &phy_vars_eNB->ulsch_tc_ext_stats,
-               &phy_vars_eNB->ulsch_tc_intl1_stats,
-               &phy_vars_eNB->ulsch_tc_intl2_stats);
-
-      stop_meas(&phy_vars_eNB->ulsch_turbo_decoding_stats);
-
-      status[r] = ret;
-
-      if (ret==(1+ulsch->max_turbo_iterations)) {// a Code segment is in error so break;
+    start_meas(tc_stats);
+
+    ulsch_harq->cb_status[r] = phy_simd.turbo_decoder16(&ulsch_harq->d[r][96],
+                                                        ulsch_harq->c[r],
+                                                        Kr,
+                                                        f1f2mat_old[iind*2],
+                                                        f1f2mat_old[(iind*2)+1],
+                                                        ulsch->max_turbo_iterations,//MAX_TURBO_ITERATIONS,
+                                                        crc_type,
+                                                        (r==0) ? ulsch_harq->F : 0,
+                                                        init_stats,
+                                                        alpha_stats,
+                                                        beta_stats,
+                                                        gamma_stats,
+                                                        ext_stats,
+                                                        intl1_stats,
+                                                        intl2_stats);
+
+    stop_meas(tc_stats);
+
+    if (ulsch_harq->cb_status[r] == (1+ulsch->max_turbo_iterations)) {
 #ifdef DEBUG_ULSCH_DECODING
-        msg("ULSCH harq_pid %d CRC failed\n",harq_pid);
+      msg("ULSCH harq_pid %d CRC failed\n",harq_pid);
 #endif
-        /*
-          for (i=0;i<Kr_bytes;i++)
-          printf("segment %d : byte %d => %d\n",r,i,ulsch_harq->c[r][i]);
-          return(ret);
-        */
-      }
+      ulsch_harq->cb_failed = 1;
+    }
+  }
 
-#ifdef DEBUG_ULSCH_DECODING
-      else
-        msg("ULSCH harq_pid %d CRC OK : %d iterations\n",harq_pid, ret);
+  if (llr8_flag == 1) {
+    // with AVX2 the 8-bit decoder handles two code blocks per pass
+    if (ulsch_harq->cb_failed == 1) {
+      for (r=0; r<nb_segments; r++)
+        tc_ret[r] = 2+ulsch->max_turbo_iterations;
+    } else {
+      start_meas(tc_stats);
+
+      phy_threegpplte_turbo_decoder8_batch(tc_in,
+                                           tc_out,
+                                           tc_n,
+                                           nb_segments,
+                                           ulsch->max_turbo_iterations,
+                                           crc_type,
+                                           (r0==0) ? ulsch_harq->F : 0,
+                                           tc_ret,
+                                           init_stats,
+                                           alpha_stats,
+                                           beta_stats,
+                                           gamma_stats,
+                                           ext_stats,
+                                           intl1_stats,
+                                           intl2_stats);
+
+      stop_meas(tc_stats);
+    }
 
-#endif
+    for (r=0; r<nb_segments; r++) {
+      ulsch_harq->cb_status[r0+r] = tc_ret[r];
 
+      if (tc_ret[r] >= (1+ulsch->max_turbo_iterations))
+        ulsch_harq->cb_failed = 1;
     }
-
-#ifdef OMP
   }
-#endif
+}
+
+unsigned int ulsch_decoding_reassembly(PHY_VARS_eNB *phy_vars_eNB,
+                                       uint8_t UE_id,
+                                       uint8_t harq_pid)
+{
+
+  LTE_eNB_ULSCH_t *ulsch = phy_vars_eNB->ulsch_eNB[UE_id];
+  LTE_UL_eNB_HARQ_t *ulsch_harq = ulsch->harq_processes[harq_pid];
+  unsigned int r,Kr,Kr_bytes,offset=0;
+  unsigned int ret;
+
+  ulsch_harq->cb_pending = 0;
+
   // Reassembly of Transport block here
-  offset = 0;
   //  msg("F %d, Fbytes %d\n",ulsch_harq->F,ulsch_harq->F>>3);
 
   ret = 1;
 
   for (r=0; r<ulsch_harq->C; r++) {
-    if (status[r] != (1+ulsch->max_turbo_iterations)) {
+    if (ulsch_harq->cb_status[r] == -1)
+      return(-1);
+
+    // the code blocks skipped after a failed one are not in the histogram
+    if (ulsch_harq->cb_status[r] <= (1+ulsch->max_turbo_iterations))
+      count_meas(&phy_vars_eNB->eNB_UE_stats[UE_id].ulsch_turbo_iterations,ulsch_harq->cb_status[r]);
+
+    if (ulsch_harq->cb_status[r] < (1+ulsch->max_turbo_iterations)) {
       if (r<ulsch_harq->Cminus)
         Kr = ulsch_harq->Kminus;
       else
@@ -1401,13 +1432,54 @@ unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
       }
 
       if (ret != (1+ulsch->max_turbo_iterations))
-        ret = status[r];
+        ret = ulsch_harq->cb_status[r];
     } else {
       ret = 1+ulsch->max_turbo_iterations;
     }
 
   }
 
+  return(ret);
+}
+
+unsigned int  ulsch_decoding(PHY_VARS_eNB *phy_vars_eNB,
+                             uint8_t UE_id,
+                             uint8_t sched_subframe,
+                             uint8_t control_only_flag,
+                             uint8_t Nbundled,
+                             uint8_t llr8_flag)
+{
+
+  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
+  uint8_t harq_pid = subframe2harq_pid(frame_parms,
+                                       phy_vars_eNB->proc[sched_subframe].frame_rx,
+                                       phy_vars_eNB->proc[sched_subframe].subframe_rx);
+  LTE_UL_eNB_HARQ_t *ulsch_harq;
+  int r;
+  unsigned int ret;
+
+  VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_PHY_ENB_ULSCH_DECODING,1);
+
+  ret = ulsch_decoding_start(phy_vars_eNB,UE_id,sched_subframe,control_only_flag,Nbundled);
+
+  if (ret == 0) {
+    ulsch_harq = phy_vars_eNB->ulsch_eNB[UE_id]->harq_processes[harq_pid];
+
+    if (llr8_flag == 1) {
+      // all the code blocks in one call, so that they can be decoded in pairs
+      ulsch_decoding_segments(phy_vars_eNB,UE_id,harq_pid,0,ulsch_harq->C,1,NULL);
+    } else {
+#ifdef OMP
+      #pragma omp parallel for private(r) shared(phy_vars_eNB,UE_id,harq_pid)
+#endif
+
+      for (r=0; r<ulsch_harq->C; r++)
+        ulsch_decoding_segments(phy_vars_eNB,UE_id,harq_pid,r,1,0,NULL);
+    }
+
+    ret = ulsch_decoding_reassembly(phy_vars_eNB,UE_id,harq_pid);
+  }
+
   VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_PHY_ENB_ULSCH_DECODING,0);
 
   return(ret);
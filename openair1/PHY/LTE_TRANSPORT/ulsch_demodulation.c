@@ -512,65 +512,12 @@ void ulsch_16qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
                      uint16_t nb_rb,
                      int16_t **llrp)
 {
-int i;
-
-#if defined(__x86_64__) || defined(__i386__)
-  __m128i *rxF=(__m128i*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
-  __m128i *ch_mag;
-  __m128i mmtmpU0;
-  __m128i **llrp128=(__m128i **)llrp;
-  ch_mag =(__m128i*)&ul_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
-#elif defined(__arm__)
-  int16x8_t *rxF=(int16x8_t*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
-  int16x8_t *ch_mag;
-  int16x8_t xmm0;
-  int16_t **llrp16=llrp;
-  ch_mag =(int16x8_t*)&ul_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
-#endif
-
-  for (i=0; i<(nb_rb*3); i++) {
-
-#if defined(__x86_64__) || defined(__i386__)
-    mmtmpU0 = _mm_abs_epi16(rxF[i]);
-    //    print_shorts("tmp0",&tmp0);
-
-    mmtmpU0 = _mm_subs_epi16(ch_mag[i],mmtmpU0);
-
-    (*llrp128)[0] = _mm_unpacklo_epi32(rxF[i],mmtmpU0);
-    (*llrp128)[1] = _mm_unpackhi_epi32(rxF[i],mmtmpU0);
-    (*llrp128)+=2;
-#elif defined(__arm__)
-    xmm0 = vabsq_s16(rxF[i]);
-    xmm0 = vqsubq_s16(ch_mag[i],xmm0);
-    (*llrp16)[0] = vgetq_lane_s16(rxF[i],0);
-    (*llrp16)[1] = vgetq_lane_s16(xmm0,0);
-    (*llrp16)[2] = vgetq_lane_s16(rxF[i],1);
-    (*llrp16)[3] = vgetq_lane_s16(xmm0,1);
-    (*llrp16)[4] = vgetq_lane_s16(rxF[i],2);
-    (*llrp16)[5] = vgetq_lane_s16(xmm0,2);
-    (*llrp16)[6] = vgetq_lane_s16(rxF[i],2);
-    (*llrp16)[7] = vgetq_lane_s16(xmm0,3);
-    (*llrp16)[8] = vgetq_lane_s16(rxF[i],4);
-    (*llrp16)[9] = vgetq_lane_s16(xmm0,4);
-    (*llrp16)[10] = vgetq_lane_s16(rxF[i],5);
-    (*llrp16)[11] = vgetq_lane_s16(xmm0,5);
-    (*llrp16)[12] = vgetq_lane_s16(rxF[i],6);
-    (*llrp16)[13] = vgetq_lane_s16(xmm0,6);
-    (*llrp16)[14] = vgetq_lane_s16(rxF[i],7);
-    (*llrp16)[15] = vgetq_lane_s16(xmm0,7);
-    (*llrp16)+=16;
-#endif
-
-
-    //    print_bytes("rxF[i]",&rxF[i]);
-    //    print_bytes("rxF[i+1]",&rxF[i+1]);
-  }
-
-#if defined(__x86_64__) || defined(__i386__)
-  _mm_empty();
-  _m_empty();
-#endif
 
+  qam16_llr((int16_t*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)],
+            (int16_t*)&ul_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)],
+            *llrp,
+            nb_rb*12);
+  (*llrp) += nb_rb*48;
 }
 
 void ulsch_64qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
@@ -582,76 +529,13 @@ void ulsch_64qam_llr(LTE_DL_FRAME_PARMS *frame_parms,
                      uint16_t nb_rb,
                      int16_t **llrp)
 {
-  int i;
-  int32_t **llrp32=(int32_t **)llrp;
-
-#if defined(__x86_64__) || defined(__i386)
-  __m128i *rxF=(__m128i*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
-  __m128i *ch_mag,*ch_magb;
-  __m128i mmtmpU1,mmtmpU2;
-
-  ch_mag =(__m128i*)&ul_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
-  ch_magb =(__m128i*)&ul_ch_magb[0][(symbol*frame_parms->N_RB_DL*12)];
-#elif defined(__arm__)
-  int16x8_t *rxF=(int16x8_t*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)];
-  int16x8_t *ch_mag,*ch_magb;
-  int16x8_t mmtmpU1,mmtmpU2;
-
-  ch_mag =(int16x8_t*)&ul_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)];
-  ch_magb =(int16x8_t*)&ul_ch_magb[0][(symbol*frame_parms->N_RB_DL*12)];
-#endif
-  //  printf("symbol %d: mag %d, magb %d\n",symbol,_mm_extract_epi16(ch_mag[0],0),_mm_extract_epi16(ch_magb[0],0));
-  for (i=0; i<(nb_rb*3); i++) {
-
 
-#if defined(__x86_64__) || defined(__i386__)
-    mmtmpU1 = _mm_abs_epi16(rxF[i]);
-
-    mmtmpU1  = _mm_subs_epi16(ch_mag[i],mmtmpU1);
-
-    mmtmpU2 = _mm_abs_epi16(mmtmpU1);
-    mmtmpU2 = _mm_subs_epi16(ch_magb[i],mmtmpU2);
-
-    (*llrp32)[0]  = _mm_extract_epi32(rxF[i],0);
-    (*llrp32)[1]  = _mm_extract_epi32(mmtmpU1,0);
-    (*llrp32)[2]  = _mm_extract_epi32(mmtmpU2,0);
-    (*llrp32)[3]  = _mm_extract_epi32(rxF[i],1);
-    (*llrp32)[4]  = _mm_extract_epi32(mmtmpU1,1);
-    (*llrp32)[5]  = _mm_extract_epi32(mmtmpU2,1);
-    (*llrp32)[6]  = _mm_extract_epi32(rxF[i],2);
-    (*llrp32)[7]  = _mm_extract_epi32(mmtmpU1,2);
-    (*llrp32)[8]  = _mm_extract_epi32(mmtmpU2,2);
-    (*llrp32)[9]  = _mm_extract_epi32(rxF[i],3);
-    (*llrp32)[10] = _mm_extract_epi32(mmtmpU1,3);
-    (*llrp32)[11] = _mm_extract_epi32(mmtmpU2,3);
-#elif defined(__arm__)
-    mmtmpU1 = vabsq_s16(rxF[i]);
-
-    mmtmpU1 = vqsubq_s16(ch_mag[i],mmtmpU1);
-
-    mmtmpU2 = vabsq_s16(mmtmpU1);
-    mmtmpU2 = vqsubq_s16(ch_magb[i],mmtmpU2);
-
-    (*llrp32)[0]  = vgetq_lane_s32((int32x4_t)rxF[i],0);
-    (*llrp32)[1]  = vgetq_lane_s32((int32x4_t)mmtmpU1,0);
-    (*llrp32)[2]  = vgetq_lane_s32((int32x4_t)mmtmpU2,0);
-    (*llrp32)[3]  = vgetq_lane_s32((int32x4_t)rxF[i],1);
-    (*llrp32)[4]  = vgetq_lane_s32((int32x4_t)mmtmpU1,1);
-    (*llrp32)[5]  = vgetq_lane_s32((int32x4_t)mmtmpU2,1);
-    (*llrp32)[6]  = vgetq_lane_s32((int32x4_t)rxF[i],2);
-    (*llrp32)[7]  = vgetq_lane_s32((int32x4_t)mmtmpU1,2);
-    (*llrp32)[8]  = vgetq_lane_s32((int32x4_t)mmtmpU2,2);
-    (*llrp32)[9]  = vgetq_lane_s32((int32x4_t)rxF[i],3);
-    (*llrp32)[10] = vgetq_lane_s32((int32x4_t)mmtmpU1,3);
-    (*llrp32)[11] = vgetq_lane_s32((int32x4_t)mmtmpU2,3);
-
-#endif
-    (*llrp32)+=12;
-  }
-#if defined(__x86_64__) || defined(__i386__)
-  _mm_empty();
-  _m_empty();
-#endif
+  qam64_llr((int16_t*)&rxdataF_comp[0][(symbol*frame_parms->N_RB_DL*12)],
+            (int16_t*)&ul_ch_mag[0][(symbol*frame_parms->N_RB_DL*12)],
+            (int16_t*)&ul_ch_magb[0][(symbol*frame_parms->N_RB_DL*12)],
+            *llrp,
+            nb_rb*12);
+  (*llrp) += nb_rb*72;
 }
 
 void ulsch_detection_mrc(LTE_DL_FRAME_PARMS *frame_parms,
@@ -717,59 +601,67 @@ void ulsch_detection_mrc(LTE_DL_FRAME_PARMS *frame_parms,
 #endif
 }
 
-void ulsch_extract_rbs_single(int32_t **rxdataF,
-                              int32_t **rxdataF_ext,
-                              uint32_t first_rb,
-                              uint32_t nb_rb,
-                              uint8_t l,
-                              uint8_t Ns,
-                              LTE_DL_FRAME_PARMS *frame_parms)
+static inline void ulsch_extract_rbs_ant(int32_t *rxdataF,
+                                         int32_t *rxdataF_ext,
+                                         uint32_t first_rb,
+                                         uint32_t nb_rb,
+                                         uint8_t symbol,
+                                         LTE_DL_FRAME_PARMS *frame_parms)
 {
 
-
   uint16_t nb_rb1,nb_rb2;
-  uint8_t aarx;
   int32_t *rxF,*rxF_ext;
 
-  //uint8_t symbol = l+Ns*frame_parms->symbols_per_tti/2;
-  uint8_t symbol = l+((7-frame_parms->Ncp)*(Ns&1)); ///symbol within sub-frame
-
-  for (aarx=0; aarx<frame_parms->nb_antennas_rx; aarx++) {
-
-
-    nb_rb1 = cmin(cmax((int)(frame_parms->N_RB_UL) - (int)(2*first_rb),(int)0),(int)(2*nb_rb));    // 2 times no. RBs before the DC
-    nb_rb2 = 2*nb_rb - nb_rb1;                                   // 2 times no. RBs after the DC
+  nb_rb1 = cmin(cmax((int)(frame_parms->N_RB_UL) - (int)(2*first_rb),(int)0),(int)(2*nb_rb));    // 2 times no. RBs before the DC
+  nb_rb2 = 2*nb_rb - nb_rb1;                                   // 2 times no. RBs after the DC
 
 #ifdef DEBUG_ULSCH
-    msg("ulsch_extract_rbs_single: 2*nb_rb1 = %d, 2*nb_rb2 = %d\n",nb_rb1,nb_rb2);
+  msg("ulsch_extract_rbs_single: 2*nb_rb1 = %d, 2*nb_rb2 = %d\n",nb_rb1,nb_rb2);
 #endif
 
-    rxF_ext   = &rxdataF_ext[aarx][(symbol*frame_parms->N_RB_UL*12)];
-
-    if (nb_rb1) {
-      rxF = &rxdataF[aarx][(first_rb*12 + frame_parms->first_carrier_offset + symbol*frame_parms->ofdm_symbol_size)];
-      memcpy(rxF_ext, rxF, nb_rb1*6*sizeof(int));
-      rxF_ext += nb_rb1*6;
-
-      if (nb_rb2)  {
-        //#ifdef OFDMA_ULSCH
-        //  rxF = &rxdataF[aarx][(1 + symbol*frame_parms->ofdm_symbol_size)*2];
-        //#else
-        rxF = &rxdataF[aarx][(symbol*frame_parms->ofdm_symbol_size)];
-        //#endif
-        memcpy(rxF_ext, rxF, nb_rb2*6*sizeof(int));
-        rxF_ext += nb_rb2*6;
-      }
-    } else { //there is only data in the second half
+  rxF_ext   = &rxdataF_ext[(symbol*frame_parms->N_RB_UL*12)];
+
+  if (nb_rb1) {
+    rxF = &rxdataF[(first_rb*12 + frame_parms->first_carrier_offset + symbol*frame_parms->ofdm_symbol_size)];
+    memcpy(rxF_ext, rxF, nb_rb1*6*sizeof(int));
+    rxF_ext += nb_rb1*6;
+
+    if (nb_rb2)  {
       //#ifdef OFDMA_ULSCH
-      //      rxF = &rxdataF[aarx][(1 + 6*(2*first_rb - frame_parms->N_RB_UL) + symbol*frame_parms->ofdm_symbol_size)*2];
+      //  rxF = &rxdataF[(1 + symbol*frame_parms->ofdm_symbol_size)*2];
       //#else
-      rxF = &rxdataF[aarx][(6*(2*first_rb - frame_parms->N_RB_UL) + symbol*frame_parms->ofdm_symbol_size)];
+      rxF = &rxdataF[(symbol*frame_parms->ofdm_symbol_size)];
       //#endif
       memcpy(rxF_ext, rxF, nb_rb2*6*sizeof(int));
       rxF_ext += nb_rb2*6;
     }
+  } else { //there is only data in the second half
+    //#ifdef OFDMA_ULSCH
+    //      rxF = &rxdataF[(1 + 6*(2*first_rb - frame_parms->N_RB_UL) + symbol*frame_parms->ofdm_symbol_size)*2];
+    //#else
+    rxF = &rxdataF[(6*(2*first_rb - frame_parms->N_RB_UL) + symbol*frame_parms->ofdm_symbol_size)];
+    //#endif
+    memcpy(rxF_ext, rxF, nb_rb2*6*sizeof(int));
+    rxF_ext += nb_rb2*6;
   }
+}
+
+void ulsch_extract_rbs_single(int32_t **rxdataF,
+                              int32_t **rxdataF_ext,
+                              uint32_t first_rb,
+                              uint32_t nb_rb,
+                              uint8_t l,
+                              uint8_t Ns,
+                              LTE_DL_FRAME_PARMS *frame_parms)
+{
+
+  uint8_t aarx;
+
+  //uint8_t symbol = l+Ns*frame_parms->symbols_per_tti/2;
+  uint8_t symbol = l+((7-frame_parms->Ncp)*(Ns&1)); ///symbol within sub-frame
+
+  for (aarx=0; aarx<frame_parms->nb_antennas_rx; aarx++)
+    ulsch_extract_rbs_ant(rxdataF[aarx],rxdataF_ext[aarx],first_rb,nb_rb,symbol,frame_parms);
 
 }
 
@@ -1578,6 +1470,117 @@ void ulsch_channel_level(int32_t **drs_ch_estimates_ext,
 int32_t avgU[2];
 int32_t avgU_0[2],avgU_1[2]; // For the Distributed Alamouti Scheme
 
+static void rx_ulsch_power(LTE_DL_FRAME_PARMS *frame_parms,
+                           LTE_eNB_PUSCH *eNB_pusch_vars,
+                           uint8_t eNB_id,
+                           uint16_t nb_rb,
+                           uint16_t rx_power_correction)
+{
+
+  uint32_t i;
+
+  for (i=0; i<frame_parms->nb_antennas_rx; i++) {
+    eNB_pusch_vars->ulsch_power[i] = signal_energy_nodc(eNB_pusch_vars->drs_ch_estimates[eNB_id][i],
+                                     nb_rb*12)*rx_power_correction;
+#ifdef LOCALIZATION
+    eNB_pusch_vars->subcarrier_power = (int32_t *)malloc(nb_rb*12*sizeof(int32_t));
+    eNB_pusch_vars->active_subcarrier = subcarrier_energy(eNB_pusch_vars->drs_ch_estimates[eNB_id][i],
+                                        nb_rb*12, eNB_pusch_vars->subcarrier_power, rx_power_correction);
+#endif
+  }
+}
+
+static uint8_t rx_ulsch_log2_maxh(LTE_DL_FRAME_PARMS *frame_parms,
+                                  LTE_eNB_PUSCH *eNB_pusch_vars,
+                                  uint8_t eNB_id,
+                                  uint16_t nb_rb)
+{
+
+  int32_t avgs;
+  uint8_t log2_maxh,aarx;
+
+  ulsch_channel_level(eNB_pusch_vars->drs_ch_estimates[eNB_id],
+                      frame_parms,
+                      avgU,
+                      nb_rb);
+
+  //  msg("[ULSCH] avg[0] %d\n",avgU[0]);
+
+
+  avgs = 0;
+
+  for (aarx=0; aarx<frame_parms->nb_antennas_rx; aarx++)
+    avgs = cmax(avgs,avgU[(aarx<<1)]);
+
+  //      log2_maxh = 4+(log2_approx(avgs)/2);
+
+  log2_maxh = (log2_approx(avgs)/2)+ log2_approx(frame_parms->nb_antennas_rx-1)+4;
+
+#ifdef DEBUG_ULSCH
+  msg("[ULSCH] log2_maxh = %d (%d,%d)\n",log2_maxh,avgU[0],avgs);
+#endif
+
+  return(log2_maxh);
+}
+
+static void rx_ulsch_llr(LTE_DL_FRAME_PARMS *frame_parms,
+                         LTE_eNB_PUSCH *eNB_pusch_vars,
+                         uint8_t eNB_id,
+                         uint8_t Qm,
+                         uint16_t nb_rb,
+                         uint32_t nb_symbols)
+{
+
+  uint32_t l;
+  int16_t *llrp;
+
+  llrp = (int16_t*)&eNB_pusch_vars->llr[0];
+
+  for (l=0; l<nb_symbols; l++) {
+
+    if (((frame_parms->Ncp == 0) && ((l==3) || (l==10)))||   // skip pilots
+        ((frame_parms->Ncp == 1) && ((l==2) || (l==8)))) {
+      l++;
+    }
+
+    switch (Qm) {
+    case 2 :
+      ulsch_qpsk_llr(frame_parms,
+                     eNB_pusch_vars->rxdataF_comp[eNB_id],
+                     eNB_pusch_vars->llr,
+                     l,
+                     nb_rb,
+                     &llrp);
+      break;
+
+    case 4 :
+      ulsch_16qam_llr(frame_parms,
+                      eNB_pusch_vars->rxdataF_comp[eNB_id],
+                      eNB_pusch_vars->llr,
+                      eNB_pusch_vars->ul_ch_mag[eNB_id],
+                      l,nb_rb,
+                      &llrp);
+      break;
+
+    case 6 :
+      ulsch_64qam_llr(frame_parms,
+                      eNB_pusch_vars->rxdataF_comp[eNB_id],
+                      eNB_pusch_vars->llr,
+                      eNB_pusch_vars->ul_ch_mag[eNB_id],
+                      eNB_pusch_vars->ul_ch_magb[eNB_id],
+                      l,nb_rb,
+                      &llrp);
+      break;
+
+    default:
+#ifdef DEBUG_ULSCH
+      msg("ulsch_demodulation.c (rx_ulsch): Unknown Qm!!!!\n");
+#endif //DEBUG_ULSCH
+      break;
+    }
+  }
+}
+
 void rx_ulsch(PHY_VARS_eNB *phy_vars_eNB,
               uint32_t sched_subframe,
               uint8_t eNB_id,  // this is the effective sector id
@@ -1592,7 +1595,6 @@ void rx_ulsch(PHY_VARS_eNB *phy_vars_eNB,
   LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
 
   uint32_t l,i;
-  int32_t avgs;
   uint8_t log2_maxh=0,aarx;
 
 
@@ -1604,7 +1606,6 @@ void rx_ulsch(PHY_VARS_eNB *phy_vars_eNB,
   uint8_t harq_pid;
   uint8_t Qm;
   uint16_t rx_power_correction;
-  int16_t *llrp;
   int subframe = phy_vars_eNB->proc[sched_subframe].subframe_rx;
 
   harq_pid = subframe2harq_pid(frame_parms,phy_vars_eNB->proc[sched_subframe].frame_rx,subframe);
@@ -1656,15 +1657,7 @@ void rx_ulsch(PHY_VARS_eNB *phy_vars_eNB,
                                          ulsch[UE_id]->harq_processes[harq_pid]->nb_rb*12)*rx_power_correction;
     }
   } else {
-    for (i=0; i<frame_parms->nb_antennas_rx; i++) {
-      eNB_pusch_vars->ulsch_power[i] = signal_energy_nodc(eNB_pusch_vars->drs_ch_estimates[eNB_id][i],
-                                       ulsch[UE_id]->harq_processes[harq_pid]->nb_rb*12)*rx_power_correction;
-#ifdef LOCALIZATION
-      eNB_pusch_vars->subcarrier_power = (int32_t *)malloc(ulsch[UE_id]->harq_processes[harq_pid]->nb_rb*12*sizeof(int32_t));
-      eNB_pusch_vars->active_subcarrier = subcarrier_energy(eNB_pusch_vars->drs_ch_estimates[eNB_id][i],
-                                          ulsch[UE_id]->harq_processes[harq_pid]->nb_rb*12, eNB_pusch_vars->subcarrier_power, rx_power_correction);
-#endif
-    }
+    rx_ulsch_power(frame_parms,eNB_pusch_vars,eNB_id,ulsch[UE_id]->harq_processes[harq_pid]->nb_rb,rx_power_correction);
   }
 
   //write_output("rxdataF_ext.m","rxF_ext",eNB_pusch_vars->rxdataF_ext[eNB_id][0],300*(frame_parms->symbols_per_tti-ulsch[UE_id]->srs_active),1,1);
@@ -1709,26 +1702,7 @@ void rx_ulsch(PHY_VARS_eNB *phy_vars_eNB,
 #endif
     log2_maxh = max(log2_maxh_0,log2_maxh_1);
   } else {
-    ulsch_channel_level(eNB_pusch_vars->drs_ch_estimates[eNB_id],
-                        frame_parms,
-                        avgU,
-                        ulsch[UE_id]->harq_processes[harq_pid]->nb_rb);
-
-    //  msg("[ULSCH] avg[0] %d\n",avgU[0]);
-
-
-    avgs = 0;
-
-    for (aarx=0; aarx<frame_parms->nb_antennas_rx; aarx++)
-      avgs = cmax(avgs,avgU[(aarx<<1)]);
-
-    //      log2_maxh = 4+(log2_approx(avgs)/2);
-
-    log2_maxh = (log2_approx(avgs)/2)+ log2_approx(frame_parms->nb_antennas_rx-1)+4;
-
-#ifdef DEBUG_ULSCH
-    msg("[ULSCH] log2_maxh = %d (%d,%d)\n",log2_maxh,avgU[0],avgs);
-#endif
+    log2_maxh = rx_ulsch_log2_maxh(frame_parms,eNB_pusch_vars,eNB_id,ulsch[UE_id]->harq_processes[harq_pid]->nb_rb);
   }
 
   for (l=0; l<frame_parms->symbols_per_tti-ulsch[UE_id]->harq_processes[harq_pid]->srs_active; l++) {
@@ -1833,52 +1807,186 @@ void rx_ulsch(PHY_VARS_eNB *phy_vars_eNB,
 #endif
 
 
-  llrp = (int16_t*)&eNB_pusch_vars->llr[0];
+  rx_ulsch_llr(frame_parms,
+               eNB_pusch_vars,
+               eNB_id,
+               Qm,
+               ulsch[UE_id]->harq_processes[harq_pid]->nb_rb,
+               frame_parms->symbols_per_tti-ulsch[UE_id]->harq_processes[harq_pid]->srs_active);
+}
 
-  for (l=0; l<frame_parms->symbols_per_tti-ulsch[UE_id]->harq_processes[harq_pid]->srs_active; l++) {
+void rx_ulsch_multi(PHY_VARS_eNB *phy_vars_eNB,
+                    uint32_t sched_subframe,
+                    uint8_t *UE_list,
+                    uint8_t nb_UE,
+                    LTE_eNB_ULSCH_t **ulsch)
+{
 
-    if (((frame_parms->Ncp == 0) && ((l==3) || (l==10)))||   // skip pilots
-        ((frame_parms->Ncp == 1) && ((l==2) || (l==8)))) {
-      l++;
+  LTE_eNB_COMMON *eNB_common_vars = &phy_vars_eNB->lte_eNB_common_vars;
+  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
+  LTE_eNB_PUSCH *eNB_pusch_vars;
+  LTE_UL_eNB_HARQ_t *harq;
+  int subframe = phy_vars_eNB->proc[sched_subframe].subframe_rx;
+  uint8_t harq_pid = subframe2harq_pid(frame_parms,phy_vars_eNB->proc[sched_subframe].frame_rx,subframe);
+  // UEs in allocation order (sector, first_rb) and in DFT size order
+  uint8_t alloc_order[NUMBER_OF_UE_MAX],size_order[NUMBER_OF_UE_MAX];
+  uint8_t eNB_id[NUMBER_OF_UE_MAX],Qm[NUMBER_OF_UE_MAX],log2_maxh[NUMBER_OF_UE_MAX];
+  uint32_t nb_symbols[NUMBER_OF_UE_MAX];
+  uint32_t l,nb_symbols_max=0;
+  uint8_t UE_id,aarx;
+  int n,m,nb_active=0;
+
+  for (n=0; n<nb_UE; n++) {
+    UE_id = UE_list[n];
+    harq  = ulsch[UE_id]->harq_processes[harq_pid];
+
+    if (harq->nb_rb == 0) {
+      LOG_E(PHY,"PUSCH (%d/%x) nb_rb=0!\n", harq_pid,ulsch[UE_id]->rnti,harq_pid);
+      continue;
     }
 
-    switch (Qm) {
-    case 2 :
-      ulsch_qpsk_llr(frame_parms,
-                     eNB_pusch_vars->rxdataF_comp[eNB_id],
-                     eNB_pusch_vars->llr,
-                     l,
-                     ulsch[UE_id]->harq_processes[harq_pid]->nb_rb,
-                     &llrp);
-      break;
+    eNB_id[UE_id]     = phy_vars_eNB->eNB_UE_stats[UE_id].sector;
+    Qm[UE_id]         = get_Qm_ul(harq->mcs);
+    nb_symbols[UE_id] = frame_parms->symbols_per_tti-harq->srs_active;
+    nb_symbols_max    = cmax(nb_symbols_max,nb_symbols[UE_id]);
 
-    case 4 :
-      ulsch_16qam_llr(frame_parms,
-                      eNB_pusch_vars->rxdataF_comp[eNB_id],
-                      eNB_pusch_vars->llr,
-                      eNB_pusch_vars->ul_ch_mag[eNB_id],
-                      l,ulsch[UE_id]->harq_processes[harq_pid]->nb_rb,
-                      &llrp);
-      break;
+    // insertion sort, there are at most NUMBER_OF_UE_MAX entries
+    for (m=nb_active; m>0; m--) {
+      uint8_t UE_m = alloc_order[m-1];
 
-    case 6 :
-      ulsch_64qam_llr(frame_parms,
-                      eNB_pusch_vars->rxdataF_comp[eNB_id],
-                      eNB_pusch_vars->llr,
-                      eNB_pusch_vars->ul_ch_mag[eNB_id],
-                      eNB_pusch_vars->ul_ch_magb[eNB_id],
-                      l,ulsch[UE_id]->harq_processes[harq_pid]->nb_rb,
-                      &llrp);
-      break;
+      if ((eNB_id[UE_m] < eNB_id[UE_id]) ||
+          ((eNB_id[UE_m] == eNB_id[UE_id]) &&
+           (ulsch[UE_m]->harq_processes[harq_pid]->first_rb <= harq->first_rb)))
+        break;
 
-    default:
-#ifdef DEBUG_ULSCH
-      msg("ulsch_demodulation.c (rx_ulsch): Unknown Qm!!!!\n");
-#endif //DEBUG_ULSCH
-      break;
+      alloc_order[m] = UE_m;
+    }
+
+    alloc_order[m] = UE_id;
+
+    for (m=nb_active; m>0; m--) {
+      uint8_t UE_m = size_order[m-1];
+
+      if (ulsch[UE_m]->harq_processes[harq_pid]->nb_rb <= harq->nb_rb)
+        break;
+
+      size_order[m] = UE_m;
+    }
+
+    size_order[m] = UE_id;
+    nb_active++;
+  }
+
+  // One sweep over each received symbol: the allocations are copied out in frequency order,
+  // then the DMRS symbols are estimated while the extracted data is still in cache
+  for (l=0; l<nb_symbols_max; l++) {
+    for (aarx=0; aarx<frame_parms->nb_antennas_rx; aarx++) {
+      for (n=0; n<nb_active; n++) {
+        UE_id = alloc_order[n];
+        harq  = ulsch[UE_id]->harq_processes[harq_pid];
+
+        if (l < nb_symbols[UE_id])
+          ulsch_extract_rbs_ant(eNB_common_vars->rxdataF[eNB_id[UE_id]][aarx],
+                                phy_vars_eNB->lte_eNB_pusch_vars[UE_id]->rxdataF_ext[eNB_id[UE_id]][aarx],
+                                harq->first_rb,
+                                harq->nb_rb,
+                                l,
+                                frame_parms);
+      }
+    }
+
+    // the DMRS symbols are never the SRS symbol, all the UEs have them
+    lte_ul_channel_estimation_multi(phy_vars_eNB,
+                                    eNB_id,
+                                    alloc_order,
+                                    nb_active,
+                                    sched_subframe,
+                                    l%(frame_parms->symbols_per_tti/2),
+                                    l/(frame_parms->symbols_per_tti/2));
+  }
+
+  for (n=0; n<nb_active; n++) {
+    UE_id = alloc_order[n];
+    eNB_pusch_vars = phy_vars_eNB->lte_eNB_pusch_vars[UE_id];
+    rx_ulsch_power(frame_parms,eNB_pusch_vars,eNB_id[UE_id],ulsch[UE_id]->harq_processes[harq_pid]->nb_rb,1);
+    log2_maxh[UE_id] = rx_ulsch_log2_maxh(frame_parms,eNB_pusch_vars,eNB_id[UE_id],ulsch[UE_id]->harq_processes[harq_pid]->nb_rb);
+  }
+
+  // Compensation, MRC and equalization symbol by symbol across all the allocations. Each UE
+  // keeps its own output scaling and modulation order, so the segments are processed in turn.
+  for (l=0; l<nb_symbols_max; l++) {
+
+    if (((frame_parms->Ncp == 0) && ((l==3) || (l==10)))||   // skip pilots
+        ((frame_parms->Ncp == 1) && ((l==2) || (l==8))))
+      continue;
+
+    for (n=0; n<nb_active; n++) {
+      UE_id = alloc_order[n];
+
+      if (l >= nb_symbols[UE_id])
+        continue;
+
+      eNB_pusch_vars = phy_vars_eNB->lte_eNB_pusch_vars[UE_id];
+      harq = ulsch[UE_id]->harq_processes[harq_pid];
+
+      ulsch_channel_compensation(
+        eNB_pusch_vars->rxdataF_ext[eNB_id[UE_id]],
+        eNB_pusch_vars->drs_ch_estimates[eNB_id[UE_id]],
+        eNB_pusch_vars->ul_ch_mag[eNB_id[UE_id]],
+        eNB_pusch_vars->ul_ch_magb[eNB_id[UE_id]],
+        eNB_pusch_vars->rxdataF_comp[eNB_id[UE_id]],
+        frame_parms,
+        l,
+        Qm[UE_id],
+        harq->nb_rb,
+        log2_maxh[UE_id]);
+
+      if (frame_parms->nb_antennas_rx > 1)
+        ulsch_detection_mrc(frame_parms,
+                            eNB_pusch_vars->rxdataF_comp[eNB_id[UE_id]],
+                            eNB_pusch_vars->ul_ch_mag[eNB_id[UE_id]],
+                            eNB_pusch_vars->ul_ch_magb[eNB_id[UE_id]],
+                            l,
+                            harq->nb_rb);
+
+#ifndef OFDMA_ULSCH
+
+      if ((phy_vars_eNB->PHY_measurements_eNB->n0_power_dB[0]+3)<eNB_pusch_vars->ulsch_power[0]) {
+
+        freq_equalization(frame_parms,
+                          eNB_pusch_vars->rxdataF_comp[eNB_id[UE_id]],
+                          eNB_pusch_vars->ul_ch_mag[eNB_id[UE_id]],
+                          eNB_pusch_vars->ul_ch_magb[eNB_id[UE_id]],
+                          l,
+                          harq->nb_rb*12,
+                          Qm[UE_id]);
+      }
+
+#endif
     }
   }
 
+#ifndef OFDMA_ULSCH
+
+  // DFT-despreading grouped by size, each DFT's twiddles are brought in once per subframe
+  for (n=0; n<nb_active; n++) {
+    UE_id = size_order[n];
+    lte_idft(frame_parms,
+             (uint32_t*)phy_vars_eNB->lte_eNB_pusch_vars[UE_id]->rxdataF_comp[eNB_id[UE_id]][0],
+             ulsch[UE_id]->harq_processes[harq_pid]->nb_rb*12);
+  }
+
+#endif
+
+  for (n=0; n<nb_active; n++) {
+    UE_id = alloc_order[n];
+    rx_ulsch_llr(frame_parms,
+                 phy_vars_eNB->lte_eNB_pusch_vars[UE_id],
+                 eNB_id[UE_id],
+                 Qm[UE_id],
+                 ulsch[UE_id]->harq_processes[harq_pid]->nb_rb,
+                 nb_symbols[UE_id]);
+  }
 }
 
 void rx_ulsch_emul(PHY_VARS_eNB *phy_vars_eNB,
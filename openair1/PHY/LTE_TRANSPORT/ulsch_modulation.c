@@ -399,7 +399,7 @@ void ulsch_modulation(mod_sym_t **txdataF,
   uint16_t nb_rb;
   int G;
 
-  uint32_t x1, x2, s=0;
+  uint32_t x2, s, *c_seq;
   uint8_t c;
 
   if (!ulsch) {
@@ -407,7 +407,6 @@ void ulsch_modulation(mod_sym_t **txdataF,
     return;
   }
 
-  // x1 is set in lte_gold_generic
   x2 = (ulsch->rnti<<14) + (subframe<<9) + frame_parms->Nid_cell; //this is c_init in 36.211 Sec 6.3.1
 
   if (harq_pid > 7) {
@@ -445,11 +444,13 @@ void ulsch_modulation(mod_sym_t **txdataF,
 
   // scrambling (Note the placeholding bits are handled in ulsch_coding.c directly!)
   //msg("ulsch bits: ");
-  s = lte_gold_generic(&x1, &x2, 1);
+  c_seq = lte_gold_scrambling_sequence(x2,1+(G>>5));
   k=0;
 
   //printf("G %d\n",G);
   for (i=0; i<(1+(G>>5)); i++) {
+    s = c_seq[i];
+
     for (j=0; j<32; j++,k++) {
       c = (uint8_t)((s>>j)&1);
 
@@ -465,8 +466,6 @@ void ulsch_modulation(mod_sym_t **txdataF,
       }
 
     }
-
-    s = lte_gold_generic(&x1, &x2, 0);
   }
 
   //msg("\n");
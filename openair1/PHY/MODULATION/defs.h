@@ -85,14 +85,65 @@ int slot_fep_ul(LTE_DL_FRAME_PARMS *frame_parms,
                 unsigned char eNb_id,
                 int no_prefix);
 
+/*!
+\brief OFDM front end of a whole uplink subframe: all symbols of both slots on all receive antennas in one batch
+\param frame_parms Pointer to frame parameters
+\param eNb_common_vars Pointer to eNB common variables (rxdata_7_5kHz -> rxdataF)
+\param subframe Subframe number (0..9)
+\param eNb_id eNB index
+\param no_prefix if 1 prefix is removed by HW
+*/
+int slot_fep_ul_subframe(LTE_DL_FRAME_PARMS *frame_parms,
+                         LTE_eNB_COMMON *eNb_common_vars,
+                         unsigned char subframe,
+                         unsigned char eNb_id,
+                         int no_prefix);
+
 void normal_prefix_mod(int32_t *txdataF,int32_t *txdata,uint8_t nsymb,LTE_DL_FRAME_PARMS *frame_parms);
 
 void do_OFDM_mod(mod_sym_t **txdataF, int32_t **txdata, uint32_t frame,uint16_t next_slot, LTE_DL_FRAME_PARMS *frame_parms);
 
+/*!
+\brief OFDM front end of a whole uplink subframe which removes the 7.5 kHz shift of the SC-FDMA symbols while it copies them
+to the dft input, instead of remove_7_5_kHz() followed by slot_fep_ul_subframe() (rxdata -> rxdataF)
+\param phy_vars_eNB Pointer to eNB variables
+\param subframe Subframe number (0..9)
+\param eNB_id eNB index
+*/
+int slot_fep_ul_subframe_7_5kHz(PHY_VARS_eNB *phy_vars_eNB,
+                                unsigned char subframe,
+                                unsigned char eNB_id);
+
+/*!
+\brief Uplink OFDM modulation of a full subframe of one antenna with the cyclic prefixes and the 7.5 kHz shift, instead of
+PHY_ofdm_mod()/normal_prefix_mod() followed by apply_7_5_kHz() on both slots
+\param txdataF Pointer to the frequency-domain symbols of the subframe
+\param txdata Pointer to the time-domain output of the subframe
+\param frame_parms Pointer to frame parameters
+*/
+void ul_ofdm_mod_7_5kHz(int32_t *txdataF,int32_t *txdata,LTE_DL_FRAME_PARMS *frame_parms);
+
 void remove_7_5_kHz(PHY_VARS_eNB *phy_vars_eNB,uint8_t subframe);
 
 void apply_7_5_kHz(PHY_VARS_UE *phy_vars_ue,int32_t*txdata,uint8_t subframe);
 
+/*!
+\brief 7.5 kHz sinusoid of one slot (one entry per sample, cyclic prefixes included) for the uplink bandwidth and prefix
+\param frame_parms Pointer to frame parameters
+*/
+int16_t *kHz_7_5_table(LTE_DL_FRAME_PARMS *frame_parms);
+
+/*!
+\brief Multiplies len samples of x by the conjugate of kHz7_5 (remove=0, UE transmitter) or by kHz7_5 (remove=1, eNB receiver).
+x and y can be the same buffer and need not be aligned.
+\param x Input samples
+\param kHz7_5 Sinusoid, from kHz_7_5_table() at the position of x in the slot
+\param y Output samples
+\param len Number of samples
+\param remove 1 to remove the shift, 0 to apply it
+*/
+void rotate_7_5_kHz(int16_t *x,int16_t *kHz7_5,int16_t *y,uint32_t len,int remove);
+
 void init_prach625(LTE_DL_FRAME_PARMS *frame_parms);
 
 void remove_625_Hz(PHY_VARS_eNB *phy_vars_eNB,int16_t *prach);
@@ -131,6 +131,29 @@ void PHY_ofdm_mod(int *input,                       /// pointer to complex input
       1<<log2fftsize,nb_prefix_samples,nb_symbols,input,output);
 #endif
 
+  if (etype == CYCLIC_PREFIX) {
+    // all symbols in one batch, written in place behind their prefix (idft_batch stages misaligned ones)
+    int16_t *idft_in[nb_symbols],*idft_out[nb_symbols];
+
+    for (i=0; i<nb_symbols; i++) {
+      idft_in[i]  = (int16_t *)&input[i<<log2fftsize];
+      idft_out[i] = (int16_t *)&output[(i<<log2fftsize) + ((1+i)*nb_prefix_samples)];
+    }
+
+    idft_batch(log2fftsize,idft_in,idft_out,nb_symbols,1);
+
+    for (i=0; i<nb_symbols; i++) {
+      output_ptr = &output[(i<<log2fftsize) + ((1+i)*nb_prefix_samples)];
+      j=(1<<log2fftsize);
+
+      for (k=-1; k>=-nb_prefix_samples; k--) {
+        output_ptr[k] = output_ptr[--j];
+      }
+    }
+
+    return;
+  }
+
 
 
   for (i=0; i<nb_symbols; i++) {
@@ -230,6 +253,66 @@ void PHY_ofdm_mod(int *input,                       /// pointer to complex input
 }
 
 
+// OFDM modulation with cyclic prefix of a full slot on all transmit antennas in a single idft batch
+static void ofdm_mod_slot(mod_sym_t **txdataF,int32_t **txdata,int slot_offset_F,int slot_offset,LTE_DL_FRAME_PARMS *frame_parms)
+{
+  int nsymb = frame_parms->symbols_per_tti>>1;
+  int nb_antennas_tx = frame_parms->nb_antennas_tx;
+  int N = frame_parms->ofdm_symbol_size;
+  int nb_prefix_samples = frame_parms->nb_prefix_samples;
+  int nb_prefix_samples0 = (frame_parms->Ncp == EXTENDED) ? nb_prefix_samples : frame_parms->nb_prefix_samples0;
+  int16_t *idft_in[nsymb*nb_antennas_tx],*idft_out[nsymb*nb_antennas_tx];
+  int32_t *out;
+  int aa,l,n=0;
+
+  for (aa=0; aa<nb_antennas_tx; aa++) {
+    for (l=0; l<nsymb; l++,n++) {
+      idft_in[n]  = (int16_t *)&txdataF[aa][slot_offset_F + l*N];
+      idft_out[n] = (int16_t *)&txdata[aa][slot_offset + nb_prefix_samples0 + l*(N+nb_prefix_samples)];
+    }
+  }
+
+  idft_batch(frame_parms->log2_symbol_size,idft_in,idft_out,n,1);
+
+  for (n=0; n<nsymb*nb_antennas_tx; n++) {
+    out = (int32_t *)idft_out[n];
+    l = (n%nsymb == 0) ? nb_prefix_samples0 : nb_prefix_samples;
+    memcpy((void *)(out-l),(void *)(out+N-l),l*sizeof(int32_t));
+  }
+}
+
+// Uplink SC-FDMA modulation of a subframe of one antenna with the 7.5 kHz shift (36-211 Section 5.6). The
+// sinusoid is applied while the cyclic prefix is written and to the symbol in place while it is still in
+// cache, instead of in a second pass over the subframe with apply_7_5_kHz().
+void ul_ofdm_mod_7_5kHz(int32_t *txdataF,int32_t *txdata,LTE_DL_FRAME_PARMS *frame_parms)
+{
+  int nsymb = frame_parms->symbols_per_tti;
+  int N = frame_parms->ofdm_symbol_size;
+  int nb_prefix_samples = frame_parms->nb_prefix_samples;
+  int nb_prefix_samples0 = (frame_parms->Ncp == EXTENDED) ? nb_prefix_samples : frame_parms->nb_prefix_samples0;
+  int16_t *kHz7_5 = kHz_7_5_table(frame_parms);
+  int16_t *idft_in[nsymb],*idft_out[nsymb];
+  int32_t *out;
+  int l,pos,cp;
+
+  for (l=0; l<nsymb; l++) {
+    idft_in[l]  = (int16_t *)&txdataF[l*N];
+    idft_out[l] = (int16_t *)&txdata[(l/(nsymb>>1))*(frame_parms->samples_per_tti>>1) +
+                                     nb_prefix_samples0 + (l%(nsymb>>1))*(N+nb_prefix_samples)];
+  }
+
+  idft_batch(frame_parms->log2_symbol_size,idft_in,idft_out,nsymb,1);
+
+  for (l=0; l<nsymb; l++) {
+    out = (int32_t *)idft_out[l];
+    pos = nb_prefix_samples0 + (l%(nsymb>>1))*(N+nb_prefix_samples);
+    cp  = (l%(nsymb>>1) == 0) ? nb_prefix_samples0 : nb_prefix_samples;
+    // prefix from the end of the symbol before it is rotated
+    rotate_7_5_kHz((int16_t *)(out+N-cp),&kHz7_5[(pos-cp)<<1],(int16_t *)(out-cp),cp,0);
+    rotate_7_5_kHz((int16_t *)out,&kHz7_5[pos<<1],(int16_t *)out,N,0);
+  }
+}
+
 void do_OFDM_mod(mod_sym_t **txdataF, int32_t **txdata, uint32_t frame,uint16_t next_slot, LTE_DL_FRAME_PARMS *frame_parms)
 {
 
@@ -238,44 +321,33 @@ void do_OFDM_mod(mod_sym_t **txdataF, int32_t **txdata, uint32_t frame,uint16_t
   slot_offset_F = (next_slot)*(frame_parms->ofdm_symbol_size)*((frame_parms->Ncp==1) ? 6 : 7);
   slot_offset = (next_slot)*(frame_parms->samples_per_tti>>1);
 
+  if (!is_pmch_subframe(frame,next_slot>>1,frame_parms)) {
+    ofdm_mod_slot(txdataF,txdata,slot_offset_F,slot_offset,frame_parms);
+    return;
+  }
+
   for (aa=0; aa<frame_parms->nb_antennas_tx; aa++) {
-    if (is_pmch_subframe(frame,next_slot>>1,frame_parms)) {
-      if ((next_slot%2)==0) {
-        LOG_D(PHY,"Frame %d, subframe %d: Doing MBSFN modulation (slot_offset %d)\n",frame,next_slot>>1,slot_offset);
-        PHY_ofdm_mod(&txdataF[aa][slot_offset_F],        // input
-                     &txdata[aa][slot_offset],         // output
-                     frame_parms->log2_symbol_size,                // log2_fft_size
-                     12,                 // number of symbols
-                     frame_parms->ofdm_symbol_size>>2,               // number of prefix samples
-                     CYCLIC_PREFIX);
+    if ((next_slot%2)==0) {
+      LOG_D(PHY,"Frame %d, subframe %d: Doing MBSFN modulation (slot_offset %d)\n",frame,next_slot>>1,slot_offset);
+      PHY_ofdm_mod(&txdataF[aa][slot_offset_F],        // input
+                   &txdata[aa][slot_offset],         // output
+                   frame_parms->log2_symbol_size,                // log2_fft_size
+                   12,                 // number of symbols
+                   frame_parms->ofdm_symbol_size>>2,               // number of prefix samples
+                   CYCLIC_PREFIX);
 
-        if (frame_parms->Ncp == EXTENDED)
-          PHY_ofdm_mod(&txdataF[aa][slot_offset_F],        // input
-                       &txdata[aa][slot_offset],         // output
-                       frame_parms->log2_symbol_size,                // log2_fft_size
-                       2,                 // number of symbols
-                       frame_parms->nb_prefix_samples,               // number of prefix samples
-                       CYCLIC_PREFIX);
-        else {
-          LOG_D(PHY,"Frame %d, subframe %d: Doing PDCCH modulation\n",frame,next_slot>>1);
-          normal_prefix_mod(&txdataF[aa][slot_offset_F],
-                            &txdata[aa][slot_offset],
-                            2,
-                            frame_parms);
-        }
-      }
-    } else {
       if (frame_parms->Ncp == EXTENDED)
         PHY_ofdm_mod(&txdataF[aa][slot_offset_F],        // input
                      &txdata[aa][slot_offset],         // output
                      frame_parms->log2_symbol_size,                // log2_fft_size
-                     6,                 // number of symbols
+                     2,                 // number of symbols
                      frame_parms->nb_prefix_samples,               // number of prefix samples
                      CYCLIC_PREFIX);
       else {
+        LOG_D(PHY,"Frame %d, subframe %d: Doing PDCCH modulation\n",frame,next_slot>>1);
         normal_prefix_mod(&txdataF[aa][slot_offset_F],
                           &txdata[aa][slot_offset],
-                          7,
+                          2,
                           frame_parms);
       }
     }
@@ -31,58 +31,55 @@
 #include "defs.h"
 //#define DEBUG_FEP
 
-int slot_fep_ul(LTE_DL_FRAME_PARMS *frame_parms,
-                LTE_eNB_COMMON *eNB_common_vars,
-                unsigned char l,
-                unsigned char Ns,
-                unsigned char eNB_id,
-                int no_prefix)
+// offset of symbol l of slot Ns (after the cyclic prefix) in the time-domain receive buffer
+static inline unsigned int fep_ul_offset(LTE_DL_FRAME_PARMS *frame_parms,
+    unsigned char l,
+    unsigned char Ns,
+    int no_prefix)
 {
-#ifdef DEBUG_FEP
-  char fname[40], vname[40];
-#endif
-  unsigned char aa;
-  unsigned char symbol = l+((7-frame_parms->Ncp)*(Ns&1)); ///symbol within sub-frame
   unsigned int nb_prefix_samples = (no_prefix ? 0 : frame_parms->nb_prefix_samples);
   unsigned int nb_prefix_samples0 = (no_prefix ? 0 : frame_parms->nb_prefix_samples0);
-  //  unsigned int subframe_offset;
   unsigned int slot_offset;
 
-  void (*dft)(int16_t *,int16_t *, int);
-
-  switch (frame_parms->log2_symbol_size) {
-  case 7:
-    dft = dft128;
-    break;
+#ifndef OFDMA_ULSCH
 
-  case 8:
-    dft = dft256;
-    break;
+  if (no_prefix)
+    slot_offset = frame_parms->ofdm_symbol_size * (frame_parms->symbols_per_tti>>1) * (Ns%2);
+  else
+    slot_offset = (frame_parms->samples_per_tti>>1) * (Ns%2);
 
-  case 9:
-    dft = dft512;
-    break;
+#else
+  slot_offset = (frame_parms->samples_per_tti>>1)*Ns;
+#endif
 
-  case 10:
-    dft = dft1024;
-    break;
+  if (l==0)
+    return(slot_offset + nb_prefix_samples0);
 
-  case 11:
-    dft = dft2048;
-    break;
+  return(slot_offset +
+         (frame_parms->ofdm_symbol_size+nb_prefix_samples0+nb_prefix_samples) +
+         (frame_parms->ofdm_symbol_size+nb_prefix_samples)*(l-1));
+}
 
-  default:
-    dft = dft512;
-    break;
-  }
+static inline int32_t *fep_ul_input(LTE_eNB_COMMON *eNB_common_vars,unsigned char eNB_id,unsigned char aa)
+{
+#ifndef OFDMA_ULSCH
+  return(eNB_common_vars->rxdata_7_5kHz[eNB_id][aa]);
+#else
+  return(eNB_common_vars->rxdata[eNB_id][aa]);
+#endif
+}
 
-  if (no_prefix) {
-    //    subframe_offset = frame_parms->ofdm_symbol_size * frame_parms->symbols_per_tti * (Ns>>1);
-    slot_offset = frame_parms->ofdm_symbol_size * (frame_parms->symbols_per_tti>>1) * (Ns%2);
-  } else {
-    //    subframe_offset = frame_parms->samples_per_tti * (Ns>>1);
-    slot_offset = (frame_parms->samples_per_tti>>1) * (Ns%2);
-  }
+int slot_fep_ul(LTE_DL_FRAME_PARMS *frame_parms,
+                LTE_eNB_COMMON *eNB_common_vars,
+                unsigned char l,
+                unsigned char Ns,
+                unsigned char eNB_id,
+                int no_prefix)
+{
+  unsigned char aa;
+  unsigned char symbol = l+((7-frame_parms->Ncp)*(Ns&1)); ///symbol within sub-frame
+  unsigned int rx_offset;
+  int16_t *dft_in[frame_parms->nb_antennas_rx],*dft_out[frame_parms->nb_antennas_rx];
 
   if (l<0 || l>=7-frame_parms->Ncp) {
     LOG_E(PHY,"slot_fep: l must be between 0 and %d\n",7-frame_parms->Ncp);
@@ -94,38 +91,104 @@ int slot_fep_ul(LTE_DL_FRAME_PARMS *frame_parms,
     return(-1);
   }
 
+  rx_offset = fep_ul_offset(frame_parms,l,Ns,no_prefix);
+
 #ifdef DEBUG_FEP
-  LOG_D(PHY,"slot_fep: Ns %d offset %d, symbol %d, nb_prefix_samples %d\n",Ns,slot_offset,symbol, nb_prefix_samples);
+  LOG_D(PHY,"slot_fep: Ns %d, symbol %d, rx_offset %d\n",Ns,symbol,rx_offset);
 #endif
 
   for (aa=0; aa<frame_parms->nb_antennas_rx; aa++) {
+    dft_in[aa]  = (int16_t *)&fep_ul_input(eNB_common_vars,eNB_id,aa)[rx_offset];
+    dft_out[aa] = (int16_t *)&eNB_common_vars->rxdataF[eNB_id][aa][frame_parms->ofdm_symbol_size*symbol];
+  }
 
-    if (l==0) {
+  dft_batch(frame_parms->log2_symbol_size,dft_in,dft_out,frame_parms->nb_antennas_rx,1);
 
-      dft(
-#ifndef OFDMA_ULSCH
-        (int16_t *)&eNB_common_vars->rxdata_7_5kHz[eNB_id][aa][slot_offset +
-            nb_prefix_samples0],
-#else
-        (int16_t *)&eNB_common_vars->rxdata[eNB_id][aa][((frame_parms->samples_per_tti>>1)*Ns) +
-            nb_prefix_samples0],
-#endif
-        (int16_t *)&eNB_common_vars->rxdataF[eNB_id][aa][frame_parms->ofdm_symbol_size*symbol],1);
-    } else {
-      dft(
-#ifndef OFDMA_ULSCH
-        (short *)&eNB_common_vars->rxdata_7_5kHz[eNB_id][aa][slot_offset +
-#else
-        (short *)&eNB_common_vars->rxdata[eNB_id][aa][((frame_parms->samples_per_tti>>1)*Ns) +
+#ifdef DEBUG_FEP
+  LOG_D(PHY,"slot_fep: done\n");
 #endif
-            (frame_parms->ofdm_symbol_size+nb_prefix_samples0+nb_prefix_samples) +
-            (frame_parms->ofdm_symbol_size+nb_prefix_samples)*(l-1)],
-        (short*)&eNB_common_vars->rxdataF[eNB_id][aa][frame_parms->ofdm_symbol_size*symbol],1);
+  return(0);
+}
+
+int slot_fep_ul_subframe(LTE_DL_FRAME_PARMS *frame_parms,
+                         LTE_eNB_COMMON *eNB_common_vars,
+                         unsigned char subframe,
+                         unsigned char eNB_id,
+                         int no_prefix)
+{
+  unsigned char aa,l,Ns;
+  unsigned char nsymb = frame_parms->symbols_per_tti>>1;
+  int nb = 0;
+  int16_t *dft_in[frame_parms->nb_antennas_rx*frame_parms->symbols_per_tti];
+  int16_t *dft_out[frame_parms->nb_antennas_rx*frame_parms->symbols_per_tti];
+  int32_t *rxdata;
+
+  if (subframe>=10) {
+    LOG_E(PHY,"slot_fep_ul_subframe: subframe must be between 0 and 9\n");
+    return(-1);
+  }
+
+  // antenna-major: the symbols of one antenna are contiguous in rxdata so the prefetch follows the stream
+  for (aa=0; aa<frame_parms->nb_antennas_rx; aa++) {
+    rxdata = fep_ul_input(eNB_common_vars,eNB_id,aa);
+
+    for (Ns=subframe<<1; Ns<=(subframe<<1)+1; Ns++) {
+      for (l=0; l<nsymb; l++) {
+        dft_in[nb]  = (int16_t *)&rxdata[fep_ul_offset(frame_parms,l,Ns,no_prefix)];
+        dft_out[nb] = (int16_t *)&eNB_common_vars->rxdataF[eNB_id][aa][frame_parms->ofdm_symbol_size*(l+nsymb*(Ns&1))];
+        nb++;
+      }
     }
   }
 
 #ifdef DEBUG_FEP
-  LOG_D(PHY,"slot_fep: done\n");
+  LOG_D(PHY,"slot_fep_ul_subframe: subframe %d, %d transforms\n",subframe,nb);
 #endif
+
+  dft_batch(frame_parms->log2_symbol_size,dft_in,dft_out,nb,1);
+
+  return(0);
+}
+
+int slot_fep_ul_subframe_7_5kHz(PHY_VARS_eNB *phy_vars_eNB,
+                                unsigned char subframe,
+                                unsigned char eNB_id)
+{
+  LTE_DL_FRAME_PARMS *frame_parms = &phy_vars_eNB->lte_frame_parms;
+  LTE_eNB_COMMON *eNB_common_vars = &phy_vars_eNB->lte_eNB_common_vars;
+  unsigned char aa,l,Ns;
+  unsigned char nsymb = frame_parms->symbols_per_tti>>1;
+  int16_t *kHz7_5 = kHz_7_5_table(frame_parms);
+  int16_t *dft_in[frame_parms->nb_antennas_rx],*dft_out[frame_parms->nb_antennas_rx];
+  int32_t rxrot[frame_parms->nb_antennas_rx][frame_parms->ofdm_symbol_size] __attribute__((aligned(16)));
+  uint32_t slot_offset,sym_offset;
+
+  if (subframe>=10) {
+    LOG_E(PHY,"slot_fep_ul_subframe_7_5kHz: subframe must be between 0 and 9\n");
+    return(-1);
+  }
+
+  // the 7.5 kHz sinusoid of the slot is removed from the samples of each symbol (after the prefix) while
+  // they are copied to the aligned dft input, the prefixes are skipped and rxdata_7_5kHz is not used
+  for (Ns=subframe<<1; Ns<=(subframe<<1)+1; Ns++) {
+    slot_offset = (uint32_t)Ns * (frame_parms->samples_per_tti>>1) - phy_vars_eNB->N_TA_offset;
+
+    for (l=0; l<nsymb; l++) {
+      sym_offset = fep_ul_offset(frame_parms,l,0,0);
+
+      for (aa=0; aa<frame_parms->nb_antennas_rx; aa++) {
+        rotate_7_5_kHz((int16_t *)&eNB_common_vars->rxdata[eNB_id][aa][slot_offset+sym_offset],
+                       &kHz7_5[sym_offset<<1],
+                       (int16_t *)rxrot[aa],
+                       frame_parms->ofdm_symbol_size,
+                       1);
+        dft_in[aa]  = (int16_t *)rxrot[aa];
+        dft_out[aa] = (int16_t *)&eNB_common_vars->rxdataF[eNB_id][aa][frame_parms->ofdm_symbol_size*(l+nsymb*(Ns&1))];
+      }
+
+      dft_batch(frame_parms->log2_symbol_size,dft_in,dft_out,frame_parms->nb_antennas_rx,1);
+    }
+  }
+
   return(0);
 }
@@ -78,6 +78,39 @@ void multadd_complex_vector_real_scalar(int16_t *x,
   _m_empty();
 
 }
+void interp_complex_vector_real_scalar(int16_t *x0,
+                                       int16_t *x1,
+                                       int16_t *alpha,
+                                       int16_t *y,
+                                       uint8_t nb_y,
+                                       uint32_t N)
+{
+
+  simd_q15_t a0_128[4],a1_128[4],x0_128,x1_128,*y_128;
+  uint32_t n;
+  uint8_t j;
+
+  for (j=0; j<nb_y; j++) {
+    a0_128[j] = set1_int16(alpha[j<<1]);
+    a1_128[j] = set1_int16(alpha[1+(j<<1)]);
+  }
+
+  // x0 and x1 are read once for all outputs, y may be x0 when nb_y is 1
+  for (n=0; n<N>>2; n++) {
+    x0_128 = ((simd_q15_t *)x0)[n];
+    x1_128 = ((simd_q15_t *)x1)[n];
+
+    for (j=0; j<nb_y; j++) {
+      y_128 = (simd_q15_t *)&y[(j*N)<<1];
+      y_128[n] = adds_int16(mulhi_int16(x0_128,a0_128[j]),mulhi_int16(x1_128,a1_128[j]));
+    }
+  }
+
+  _mm_empty();
+  _m_empty();
+
+}
+
 void multadd_real_vector_complex_scalar(int16_t *x,
                                         int16_t *alpha,
                                         int16_t *y,
@@ -90,7 +90,7 @@ int mult_cpx_conj_vector(int16_t *x1,
     tmp_im = _mm_shufflelo_epi16(*x1_128,_MM_SHUFFLE(2,3,0,1));
     tmp_im = _mm_shufflehi_epi16(tmp_im,_MM_SHUFFLE(2,3,0,1));
     tmp_im = _mm_sign_epi16(tmp_im,*(__m128i*)&conjug[0]);
-    tmp_im = _mm_madd_epi16(tmp_im,*x1_128);
+    tmp_im = _mm_madd_epi16(tmp_im,*x2_128);
     tmp_re = _mm_srai_epi32(tmp_re,output_shift);
     tmp_im = _mm_srai_epi32(tmp_im,output_shift);
     tmpy0  = _mm_unpacklo_epi32(tmp_re,tmp_im);
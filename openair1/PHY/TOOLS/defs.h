@@ -39,6 +39,7 @@
 #include <stdint.h>
 
 #include "PHY/sse_intrin.h"
+#include "PHY/TOOLS/time_meas.h"
 
 
 //defined in rtai_math.h
@@ -96,6 +97,25 @@ void multadd_complex_vector_real_scalar(int16_t *x,
                                         uint8_t zero_flag,
                                         uint32_t N);
 
+/*!\fn void interp_complex_vector_real_scalar(int16_t *x0,int16_t *x1,int16_t *alpha,int16_t *y,uint8_t nb_y,uint32_t N)
+This function computes up to 4 weighted combinations of two complex vectors in one pass, e.g. the time
+interpolation of channel estimates between two pilot symbols.
+@param x0 First vector input (Q1.15) in the format |Re0 Im0|Re1 Im 1| ...
+@param x1 Second vector input (Q1.15) in the format |Re0 Im0|Re1 Im 1| ...
+@param alpha Scalar weights (Q1.15) of x0 and x1 for each output in the format |a0_0 a1_0|a0_1 a1_1| ...
+@param y Outputs (Q1.15), spaced by N complex samples, y can be x0 for a single output
+@param nb_y Number of outputs (1..4)
+@param N Length of x0 and x1 WARNING: N>=4
+
+The function implemented is : \f$\mathbf{y}_j = \alpha_{0,j}\mathbf{x}_0 + \alpha_{1,j}\mathbf{x}_1\f$
+*/
+void interp_complex_vector_real_scalar(int16_t *x0,
+                                       int16_t *x1,
+                                       int16_t *alpha,
+                                       int16_t *y,
+                                       uint8_t nb_y,
+                                       uint32_t N);
+
 
 /*!\fn int32_t mult_cpx_vector(int16_t *x1,int16_t *x2,int16_t *y,uint32_t N,int32_t output_shift)
 This function performs optimized componentwise multiplication of two Q1.15 vectors in repeated format.
@@ -131,6 +151,23 @@ int32_t mult_cpx_vector_norep(int16_t *x1,
                               uint32_t N,
                               int32_t output_shift);
 
+/*!\fn int mult_cpx_conj_vector(int16_t *x1,int16_t *x2,int16_t *y,uint32_t N,int output_shift)
+This function performs optimized componentwise multiplication of the conjugate of a Q1.15 vector with another one, with normal formatted inputs and output.
+
+@param x1 Input 1 in the format  |Re0 Im0 Re1 Im1|,......,|Re(N-2)  Im(N-2) Re(N-1) Im(N-1)|
+@param x2 Input 2 in the format  |Re0 Im0 Re1 Im1|,......,|Re(N-2)  Im(N-2) Re(N-1) Im(N-1)|
+@param y  Output in the format  |Re0 Im0 Re1 Im1|,......,|Re(N-2)  Im(N-2) Re(N-1) Im(N-1)|
+@param N  Length of Vector WARNING: N must be a multiple of 4
+@param output_shift Number of bits to shift output down to Q1.15 (should be 15 for Q1.15 inputs)
+
+The function implemented is : \f$\mathbf{y} = \mathbf{x_1}^*\odot\mathbf{x_2}\f$
+*/
+int mult_cpx_conj_vector(int16_t *x1,
+                         int16_t *x2,
+                         int16_t *y,
+                         uint32_t N,
+                         int output_shift);
+
 
 /*!\fn int32_t mult_cpx_vector_norep2(int16_t *x1,int16_t *x2,int16_t *y,uint32_t N,int32_t output_shift)
 This function performs optimized componentwise multiplication of two Q1.15 vectors with normal formatted output.
@@ -554,6 +591,21 @@ void dft1080(int16_t *x,int16_t *y,uint8_t scale_flag);
 void dft1152(int16_t *x,int16_t *y,uint8_t scale_flag);
 void dft1200(int16_t *x,int16_t *y,uint8_t scale_flag);
 
+/*!\fn void init_dft_plans(void)
+\brief Generate the twiddles of the plan-based DFT-S transforms (called on first use otherwise)
+*/
+void init_dft_plans(void);
+
+/*!\fn void dft_plan(uint16_t N,int16_t *x,int16_t *y,unsigned char scale_flag)
+\brief Plan-based DFT of size N (multiple of 12 up to 1200, 2^a 3^b 5^c) on 4 interleaved inputs,
+bit-exact with the corresponding dftN function. With -DDFT_PLANS the dftN functions call it.
+@param N DFT size
+@param x Input (4 complex per 128-bit vector)
+@param y Output
+@param scale_flag 1 to normalize the output as dftN does
+*/
+void dft_plan(uint16_t N,int16_t *x,int16_t *y,unsigned char scale_flag);
+
 void dft64(int16_t *x,int16_t *y,int scale);
 void dft128(int16_t *x,int16_t *y,int scale);
 void dft256(int16_t *x,int16_t *y,int scale);
@@ -570,6 +622,101 @@ void idft1024(int16_t *x,int16_t *y,int scale);
 void idft2048(int16_t *x,int16_t *y,int scale);
 void idft4096(int16_t *x,int16_t *y,int scale);
 void idft8192(int16_t *x,int16_t *y,int scale);
+
+/*!\fn void dft_batch(uint8_t log2fftsize,int16_t **x,int16_t **y,int nb,int scale)
+\brief Run nb DFTs of size 2^log2fftsize (128..4096) back to back, e.g. all symbols x antennas of a subframe.
+Inputs/outputs need not be 128-bit aligned (they are staged through an aligned buffer).
+@param log2fftsize Base-2 logarithm of the DFT size
+@param x Array of nb input pointers
+@param y Array of nb output pointers
+@param nb Number of transforms
+@param scale Scaling flag passed to each transform
+*/
+void dft_batch(uint8_t log2fftsize,int16_t **x,int16_t **y,int nb,int scale);
+
+/*!\fn void idft_batch(uint8_t log2fftsize,int16_t **x,int16_t **y,int nb,int scale)
+\brief Inverse counterpart of dft_batch
+*/
+void idft_batch(uint8_t log2fftsize,int16_t **x,int16_t **y,int nb,int scale);
+
+/*!\fn int dft_set_avx2(int enable)
+\brief Select the 256-bit radix stages of the dft/idft functions
+@param enable 1 to use AVX2 when the host supports it, 0 to force the 128-bit path
+@returns 1 if the AVX2 stages are in use, 0 otherwise
+*/
+int dft_set_avx2(int enable);
+
+/// SIMD instruction set levels known to the PHY kernel dispatcher, in increasing order on x86
+typedef enum {
+  PHY_SIMD_SCALAR=0,
+  PHY_SIMD_SSE2,
+  PHY_SIMD_SSSE3,
+  PHY_SIMD_SSE4_1,
+  PHY_SIMD_AVX2,
+  PHY_SIMD_NEON
+} phy_simd_level_t;
+
+/// Prototype shared by the 8-bit and 16-bit turbo decoders (see PHY/CODING/defs.h)
+typedef uint8_t (*phy_turbo_decoder_t)(int16_t *y,
+                                       uint8_t *decoded_bytes,
+                                       uint16_t n,
+                                       uint16_t f1,
+                                       uint16_t f2,
+                                       uint8_t max_iterations,
+                                       uint8_t crc_type,
+                                       uint8_t F,
+                                       time_stats_t *init_stats,
+                                       time_stats_t *alpha_stats,
+                                       time_stats_t *beta_stats,
+                                       time_stats_t *gamma_stats,
+                                       time_stats_t *ext_stats,
+                                       time_stats_t *intl1_stats,
+                                       time_stats_t *intl2_stats);
+
+/// Runtime dispatch table of the PHY SIMD kernels
+typedef struct {
+  /// highest level supported by the host CPU
+  phy_simd_level_t host;
+  /// level the binary was compiled for, lower bound for every kernel
+  phy_simd_level_t build;
+  /// dft/idft radix stages (lte_dfts.c)
+  phy_simd_level_t dft;
+  /// LLR computation (dlsch_llr_computation.c)
+  phy_simd_level_t llr;
+  /// channel compensation (dlsch_demodulation.c, ulsch_demodulation.c)
+  phy_simd_level_t chcomp;
+  /// Viterbi decoder (viterbi_lte.c)
+  phy_simd_level_t viterbi;
+  /// turbo decoders
+  phy_simd_level_t turbo;
+  /// scrambling/descrambling kernels (dlsch_scrambling.c)
+  phy_simd_level_t scrambling;
+  /// soft combining of the turbo rate dematching (lte_rate_matching.c)
+  phy_simd_level_t rate_matching;
+  /// output expansion of the turbo encoder (3gpplte_sse.c)
+  phy_simd_level_t turbo_encoder;
+  /// 1 when the CRCs use the PCLMULQDQ folding, 0 for the slice-by-8 tables (crc_byte.c)
+  int crc_pclmul;
+  /// turbo decoder used when llr8_flag==0
+  phy_turbo_decoder_t turbo_decoder16;
+  /// turbo decoder used when llr8_flag==1
+  phy_turbo_decoder_t turbo_decoder8;
+} phy_simd_dispatch_t;
+
+/// Dispatch table, holds the compile-time choices until phy_simd_dispatch_init() is called
+extern phy_simd_dispatch_t phy_simd;
+
+/*!\fn void phy_simd_dispatch_init(void)
+\brief Probe the host CPU and fill phy_simd with the best variant of each kernel.
+The level can be capped with the environment variable OAI_SIMD (sse2, ssse3, sse4.1, avx2).
+The selected variants are written to the PHY log.
+*/
+void phy_simd_dispatch_init(void);
+
+/*!\fn const char *phy_simd_level_name(phy_simd_level_t level)
+\brief Printable name of a SIMD level
+*/
+const char *phy_simd_level_name(phy_simd_level_t level);
 /** @} */
 
 
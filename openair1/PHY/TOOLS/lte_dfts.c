@@ -44,19 +44,19 @@
 
 #define debug_msg
 #define ONE_OVER_SQRT2_Q15 23170
+#define AssertFatal(cond,...) do { if (!(cond)) { fprintf(stderr,__VA_ARGS__); exit(-1); } } while (0)
 
 #endif
 
 
 #include "PHY/sse_intrin.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 #define print_shorts(s,x) printf("%s %d,%d,%d,%d,%d,%d,%d,%d\n",s,(x)[0],(x)[1],(x)[2],(x)[3],(x)[4],(x)[5],(x)[6],(x)[7])
 #define print_ints(s,x) printf("%s %d %d %d %d\n",s,(x)[0],(x)[1],(x)[2],(x)[3])
 
-#ifdef AVX2
-static int16_t conjugatedft2[16] __attribute__((aligned(32))) = {1,1,1,1,1,1,1,1,-1,1,-1,1,-1,1,-1,1,-1,1};
-#endif
-
 static int16_t conjugatedft[8] __attribute__((aligned(16))) = {-1,1,-1,1,-1,1,-1,1} ;
 
 static short reflip[8]  __attribute__((aligned(16))) = {1,-1,1,-1,1,-1,1,-1};
@@ -1437,7 +1437,6 @@ static inline void dft16(int16_t *x,int16_t *y)
 
 
 
-#ifndef AVX2
   /*  This is the original version before unrolling
 
   bfly4_tw1(x128,x128+1,x128+2,x128+3,
@@ -1496,31 +1495,6 @@ static inline void dft16(int16_t *x,int16_t *y)
   y128[1] = _mm_adds_epi16(x02t,x13t);  // x0 + x1f - x2 - x3f
   y128[3] = _mm_subs_epi16(x02t,x13t);  // x0 - x1f - x2 + x3f
 
-#else
-
-  //  x02t    = _mm_adds_epi16(x128[0],x128[2]);
-  //  x13t    = _mm_adds_epi16(x128[1],x128[3]);
-
-  xt      = _mm256_adds_epi16(x256[0],x256[1]);
-
-  xtmp0   = _mm_adds_epi16(x02t,x13t);
-  xtmp2   = _mm_subs_epi16(x02t,x13t);
-
-  x13_flip
-  x1_flip = _mm_sign_epi16(x128[1],*(__m128i*)conjugatedft);
-  x1_flip = _mm_shuffle_epi8(x1_flip,_mm_set_epi8(13,12,15,14,9,8,11,10,5,4,7,6,1,0,3,2));
-  x3_flip = _mm_sign_epi16(x128[3],*(__m128i*)conjugatedft);
-  x3_flip = _mm_shuffle_epi8(x3_flip,_mm_set_epi8(13,12,15,14,9,8,11,10,5,4,7,6,1,0,3,2));
-
-  //  x02t    = _mm_subs_epi16(x128[0],x128[2]);
-  //  x13t    = _mm_subs_epi16(x1_flip,x3_flip);
-  xt      = _mm256_subs_epi16(x256flip0,x256flip1);
-
-  xtmp1   = _mm_adds_epi16(x02t,x13t);  // x0 + x1f - x2 - x3f
-  xtmp3   = _mm_subs_epi16(x02t,x13t);  // x0 - x1f - x2 + x3f
-
-
-#endif
 
 #elif defined(__arm__)
 
@@ -1763,6 +1737,850 @@ int16_t tw64c[96] __attribute__((aligned(16))) = { 0,32767,3212,32609,6393,32137
 #define _m_empty()
 #endif
 
+// 256-bit (AVX2) versions of the butterflies. Each __m256i holds two consecutive 128-bit
+// vectors of the SSE path. All the arithmetic below (madd, unpack, pack, shuffle_epi8) is
+// confined to 128-bit lanes, so one 256-bit butterfly is bit-exact with two 128-bit ones.
+// They are compiled for AVX2 independently of the global compiler flags and only called
+// through the radix stages further down when the host CPU supports AVX2.
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define AVX2_FUNC __attribute__((always_inline,target("avx2")))
+
+static int dft_avx2 = -1;
+
+static inline int dft_avx2_enabled(void) __attribute__((always_inline));
+static inline int dft_avx2_enabled(void)
+{
+
+  if (dft_avx2 < 0)
+    dft_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+
+  return(dft_avx2);
+}
+
+int dft_set_avx2(int enable)
+{
+
+  dft_avx2 = (enable && __builtin_cpu_supports("avx2")) ? 1 : 0;
+
+  return(dft_avx2);
+}
+
+static inline __m256i complex_shuffle_256(void) AVX2_FUNC;
+static inline __m256i complex_shuffle_256(void)
+{
+  return(_mm256_set_epi8(13,12,15,14,9,8,11,10,5,4,7,6,1,0,3,2,
+                         13,12,15,14,9,8,11,10,5,4,7,6,1,0,3,2));
+}
+
+static inline __m256i bcast_256(__m128i *a) AVX2_FUNC;
+static inline __m256i bcast_256(__m128i *a)
+{
+  return(_mm256_broadcastsi128_si256(_mm_loadu_si128(a)));
+}
+
+static inline void cmac_256(__m256i a,__m256i b, __m256i *re32, __m256i *im32) AVX2_FUNC;
+static inline void cmac_256(__m256i a,__m256i b, __m256i *re32, __m256i *im32)
+{
+
+  __m256i cmac_tmp,cmac_tmp_re32,cmac_tmp_im32;
+
+  cmac_tmp      = _mm256_sign_epi16(b,bcast_256((__m128i*)reflip));
+  cmac_tmp_re32 = _mm256_madd_epi16(a,cmac_tmp);
+  cmac_tmp      = _mm256_shuffle_epi8(b,complex_shuffle_256());
+  cmac_tmp_im32 = _mm256_madd_epi16(cmac_tmp,a);
+
+  *re32 = _mm256_add_epi32(*re32,cmac_tmp_re32);
+  *im32 = _mm256_add_epi32(*im32,cmac_tmp_im32);
+}
+
+static inline void cmacc_256(__m256i a,__m256i b, __m256i *re32, __m256i *im32) AVX2_FUNC;
+static inline void cmacc_256(__m256i a,__m256i b, __m256i *re32, __m256i *im32)
+{
+
+  __m256i cmac_tmp,cmac_tmp_re32,cmac_tmp_im32;
+
+  cmac_tmp_re32 = _mm256_madd_epi16(a,b);
+  cmac_tmp      = _mm256_shuffle_epi8(b,complex_shuffle_256());
+  cmac_tmp_im32 = _mm256_madd_epi16(cmac_tmp,a);
+
+  *re32 = _mm256_add_epi32(*re32,cmac_tmp_re32);
+  *im32 = _mm256_add_epi32(*im32,cmac_tmp_im32);
+}
+
+static inline void cmult_256(__m256i a,__m256i b, __m256i *re32, __m256i *im32) AVX2_FUNC;
+static inline void cmult_256(__m256i a,__m256i b, __m256i *re32, __m256i *im32)
+{
+
+  register __m256i mmtmpb;
+
+  mmtmpb = _mm256_sign_epi16(b,bcast_256((__m128i*)reflip));
+  *re32  = _mm256_madd_epi16(a,mmtmpb);
+  mmtmpb = _mm256_shuffle_epi8(b,complex_shuffle_256());
+  *im32  = _mm256_madd_epi16(a,mmtmpb);
+}
+
+static inline void cmultc_256(__m256i a,__m256i b, __m256i *re32, __m256i *im32) AVX2_FUNC;
+static inline void cmultc_256(__m256i a,__m256i b, __m256i *re32, __m256i *im32)
+{
+
+  register __m256i mmtmpb;
+
+  *re32  = _mm256_madd_epi16(a,b);
+  mmtmpb = _mm256_sign_epi16(b,bcast_256((__m128i*)reflip));
+  mmtmpb = _mm256_shuffle_epi8(mmtmpb,complex_shuffle_256());
+  *im32  = _mm256_madd_epi16(a,mmtmpb);
+}
+
+static inline __m256i cpack_256(__m256i xre,__m256i xim) AVX2_FUNC;
+static inline __m256i cpack_256(__m256i xre,__m256i xim)
+{
+
+  register __m256i cpack_tmp1,cpack_tmp2;
+
+  cpack_tmp1 = _mm256_unpacklo_epi32(xre,xim);
+  cpack_tmp2 = _mm256_unpackhi_epi32(xre,xim);
+  return(_mm256_packs_epi32(_mm256_srai_epi32(cpack_tmp1,15),_mm256_srai_epi32(cpack_tmp2,15)));
+}
+
+static inline __m256i packed_cmult_256(__m256i a,__m256i b) AVX2_FUNC;
+static inline __m256i packed_cmult_256(__m256i a,__m256i b)
+{
+
+  __m256i cre,cim;
+
+  cmult_256(a,b,&cre,&cim);
+  return(cpack_256(cre,cim));
+}
+
+static inline __m256i packed_cmultc_256(__m256i a,__m256i b) AVX2_FUNC;
+static inline __m256i packed_cmultc_256(__m256i a,__m256i b)
+{
+
+  __m256i cre,cim;
+
+  cmultc_256(a,b,&cre,&cim);
+  return(cpack_256(cre,cim));
+}
+
+static inline __m256i packed_cmult2_256(__m256i a,__m256i b,__m256i b2) AVX2_FUNC;
+static inline __m256i packed_cmult2_256(__m256i a,__m256i b,__m256i b2)
+{
+
+  register __m256i cre,cim;
+
+  cre = _mm256_madd_epi16(a,b);
+  cim = _mm256_madd_epi16(a,b2);
+
+  return(cpack_256(cre,cim));
+}
+
+// conjugate and swap real/imaginary parts, i.e. multiply by -j
+static inline __m256i cflip_256(__m256i x) AVX2_FUNC;
+static inline __m256i cflip_256(__m256i x)
+{
+  return(_mm256_shuffle_epi8(_mm256_sign_epi16(x,bcast_256((__m128i*)conjugatedft)),complex_shuffle_256()));
+}
+
+static inline void bfly2_256(__m256i *x0, __m256i *x1,__m256i *y0, __m256i *y1,__m256i *tw) AVX2_FUNC;
+static inline void bfly2_256(__m256i *x0, __m256i *x1,__m256i *y0, __m256i *y1,__m256i *tw)
+{
+
+  __m256i x0r_2,x0i_2,x1r_2,x1i_2,dy0r,dy1r,dy0i,dy1i;
+
+  cmult_256(*(x0),bcast_256(W0),&x0r_2,&x0i_2);
+  cmult_256(*(x1),*(tw),&x1r_2,&x1i_2);
+
+  dy0r = _mm256_srai_epi32(_mm256_add_epi32(x0r_2,x1r_2),15);
+  dy1r = _mm256_srai_epi32(_mm256_sub_epi32(x0r_2,x1r_2),15);
+  dy0i = _mm256_srai_epi32(_mm256_add_epi32(x0i_2,x1i_2),15);
+  dy1i = _mm256_srai_epi32(_mm256_sub_epi32(x0i_2,x1i_2),15);
+
+  *y0 = _mm256_packs_epi32(_mm256_unpacklo_epi32(dy0r,dy0i),_mm256_unpackhi_epi32(dy0r,dy0i));
+  *y1 = _mm256_packs_epi32(_mm256_unpacklo_epi32(dy1r,dy1i),_mm256_unpackhi_epi32(dy1r,dy1i));
+}
+
+static inline void ibfly2_256(__m256i *x0, __m256i *x1,__m256i *y0, __m256i *y1,__m256i *tw) AVX2_FUNC;
+static inline void ibfly2_256(__m256i *x0, __m256i *x1,__m256i *y0, __m256i *y1,__m256i *tw)
+{
+
+  __m256i x0r_2,x0i_2,x1r_2,x1i_2,dy0r,dy1r,dy0i,dy1i;
+
+  cmultc_256(*(x0),bcast_256(W0),&x0r_2,&x0i_2);
+  cmultc_256(*(x1),*(tw),&x1r_2,&x1i_2);
+
+  dy0r = _mm256_srai_epi32(_mm256_add_epi32(x0r_2,x1r_2),15);
+  dy1r = _mm256_srai_epi32(_mm256_sub_epi32(x0r_2,x1r_2),15);
+  dy0i = _mm256_srai_epi32(_mm256_add_epi32(x0i_2,x1i_2),15);
+  dy1i = _mm256_srai_epi32(_mm256_sub_epi32(x0i_2,x1i_2),15);
+
+  *y0 = _mm256_packs_epi32(_mm256_unpacklo_epi32(dy0r,dy0i),_mm256_unpackhi_epi32(dy0r,dy0i));
+  *y1 = _mm256_packs_epi32(_mm256_unpacklo_epi32(dy1r,dy1i),_mm256_unpackhi_epi32(dy1r,dy1i));
+}
+
+static inline void bfly2_16_256(__m256i *x0, __m256i *x1, __m256i *y0, __m256i *y1, __m256i *tw, __m256i *twb) AVX2_FUNC;
+static inline void bfly2_16_256(__m256i *x0, __m256i *x1, __m256i *y0, __m256i *y1, __m256i *tw, __m256i *twb)
+{
+
+  register __m256i x1t;
+
+  x1t = packed_cmult2_256(*(x1),*(tw),*(twb));
+
+  *y0 = _mm256_adds_epi16(*x0,x1t);
+  *y1 = _mm256_subs_epi16(*x0,x1t);
+}
+
+static inline void bfly3_256(__m256i *x0,__m256i *x1,__m256i *x2,
+                             __m256i *y0,__m256i *y1,__m256i *y2,
+                             __m256i *tw1,__m256i *tw2) AVX2_FUNC;
+static inline void bfly3_256(__m256i *x0,__m256i *x1,__m256i *x2,
+                             __m256i *y0,__m256i *y1,__m256i *y2,
+                             __m256i *tw1,__m256i *tw2)
+{
+
+  __m256i tmpre,tmpim,x1_2,x2_2;
+  __m256i W13_256 = bcast_256(W13),W23_256 = bcast_256(W23);
+
+  x1_2   = packed_cmult_256(*(x1),*(tw1));
+  x2_2   = packed_cmult_256(*(x2),*(tw2));
+  *(y0)  = _mm256_adds_epi16(*(x0),_mm256_adds_epi16(x1_2,x2_2));
+  cmult_256(x1_2,W13_256,&tmpre,&tmpim);
+  cmac_256(x2_2,W23_256,&tmpre,&tmpim);
+  *(y1) = _mm256_adds_epi16(*(x0),cpack_256(tmpre,tmpim));
+  cmult_256(x1_2,W23_256,&tmpre,&tmpim);
+  cmac_256(x2_2,W13_256,&tmpre,&tmpim);
+  *(y2) = _mm256_adds_epi16(*(x0),cpack_256(tmpre,tmpim));
+}
+
+static inline void ibfly3_256(__m256i *x0,__m256i *x1,__m256i *x2,
+                              __m256i *y0,__m256i *y1,__m256i *y2,
+                              __m256i *tw1,__m256i *tw2) AVX2_FUNC;
+static inline void ibfly3_256(__m256i *x0,__m256i *x1,__m256i *x2,
+                              __m256i *y0,__m256i *y1,__m256i *y2,
+                              __m256i *tw1,__m256i *tw2)
+{
+
+  __m256i tmpre,tmpim,x1_2,x2_2;
+  __m256i W13_256 = bcast_256(W13),W23_256 = bcast_256(W23);
+
+  x1_2   = packed_cmultc_256(*(x1),*(tw1));
+  x2_2   = packed_cmultc_256(*(x2),*(tw2));
+  *(y0)  = _mm256_adds_epi16(*(x0),_mm256_adds_epi16(x1_2,x2_2));
+  cmultc_256(x1_2,W13_256,&tmpre,&tmpim);
+  cmacc_256(x2_2,W23_256,&tmpre,&tmpim);
+  *(y1) = _mm256_adds_epi16(*(x0),cpack_256(tmpre,tmpim));
+  cmultc_256(x1_2,W23_256,&tmpre,&tmpim);
+  cmacc_256(x2_2,W13_256,&tmpre,&tmpim);
+  *(y2) = _mm256_adds_epi16(*(x0),cpack_256(tmpre,tmpim));
+}
+
+static inline void bfly4_256(__m256i *x0,__m256i *x1,__m256i *x2,__m256i *x3,
+                             __m256i *y0,__m256i *y1,__m256i *y2,__m256i *y3,
+                             __m256i *tw1,__m256i *tw2,__m256i *tw3) AVX2_FUNC;
+static inline void bfly4_256(__m256i *x0,__m256i *x1,__m256i *x2,__m256i *x3,
+                             __m256i *y0,__m256i *y1,__m256i *y2,__m256i *y3,
+                             __m256i *tw1,__m256i *tw2,__m256i *tw3)
+{
+
+  __m256i x1r_2,x1i_2,x2r_2,x2i_2,x3r_2,x3i_2,dy0r,dy0i,dy1r,dy1i,dy2r,dy2i,dy3r,dy3i;
+
+  cmult_256(*(x1),*(tw1),&x1r_2,&x1i_2);
+  cmult_256(*(x2),*(tw2),&x2r_2,&x2i_2);
+  cmult_256(*(x3),*(tw3),&x3r_2,&x3i_2);
+
+  dy0r  = _mm256_add_epi32(x1r_2,_mm256_add_epi32(x2r_2,x3r_2));
+  dy0i  = _mm256_add_epi32(x1i_2,_mm256_add_epi32(x2i_2,x3i_2));
+  *(y0) = _mm256_add_epi16(*(x0),cpack_256(dy0r,dy0i));
+  dy1r  = _mm256_sub_epi32(x1i_2,_mm256_add_epi32(x2r_2,x3i_2));
+  dy1i  = _mm256_sub_epi32(_mm256_sub_epi32(x3r_2,x2i_2),x1r_2);
+  *(y1) = _mm256_add_epi16(*(x0),cpack_256(dy1r,dy1i));
+  dy2r  = _mm256_sub_epi32(_mm256_sub_epi32(x2r_2,x3r_2),x1r_2);
+  dy2i  = _mm256_sub_epi32(_mm256_sub_epi32(x2i_2,x3i_2),x1i_2);
+  *(y2) = _mm256_add_epi16(*(x0),cpack_256(dy2r,dy2i));
+  dy3r  = _mm256_sub_epi32(_mm256_sub_epi32(x3i_2,x2r_2),x1i_2);
+  dy3i  = _mm256_sub_epi32(x1r_2,_mm256_add_epi32(x2i_2,x3r_2));
+  *(y3) = _mm256_add_epi16(*(x0),cpack_256(dy3r,dy3i));
+}
+
+static inline void ibfly4_256(__m256i *x0,__m256i *x1,__m256i *x2,__m256i *x3,
+                              __m256i *y0,__m256i *y1,__m256i *y2,__m256i *y3,
+                              __m256i *tw1,__m256i *tw2,__m256i *tw3) AVX2_FUNC;
+static inline void ibfly4_256(__m256i *x0,__m256i *x1,__m256i *x2,__m256i *x3,
+                              __m256i *y0,__m256i *y1,__m256i *y2,__m256i *y3,
+                              __m256i *tw1,__m256i *tw2,__m256i *tw3)
+{
+
+  __m256i x1r_2,x1i_2,x2r_2,x2i_2,x3r_2,x3i_2,dy0r,dy0i,dy1r,dy1i,dy2r,dy2i,dy3r,dy3i;
+
+  cmultc_256(*(x1),*(tw1),&x1r_2,&x1i_2);
+  cmultc_256(*(x2),*(tw2),&x2r_2,&x2i_2);
+  cmultc_256(*(x3),*(tw3),&x3r_2,&x3i_2);
+
+  dy0r  = _mm256_add_epi32(x1r_2,_mm256_add_epi32(x2r_2,x3r_2));
+  dy0i  = _mm256_add_epi32(x1i_2,_mm256_add_epi32(x2i_2,x3i_2));
+  *(y0) = _mm256_add_epi16(*(x0),cpack_256(dy0r,dy0i));
+  dy3r  = _mm256_sub_epi32(x1i_2,_mm256_add_epi32(x2r_2,x3i_2));
+  dy3i  = _mm256_sub_epi32(_mm256_sub_epi32(x3r_2,x2i_2),x1r_2);
+  *(y3) = _mm256_add_epi16(*(x0),cpack_256(dy3r,dy3i));
+  dy2r  = _mm256_sub_epi32(_mm256_sub_epi32(x2r_2,x3r_2),x1r_2);
+  dy2i  = _mm256_sub_epi32(_mm256_sub_epi32(x2i_2,x3i_2),x1i_2);
+  *(y2) = _mm256_add_epi16(*(x0),cpack_256(dy2r,dy2i));
+  dy1r  = _mm256_sub_epi32(_mm256_sub_epi32(x3i_2,x2r_2),x1i_2);
+  dy1i  = _mm256_sub_epi32(x1r_2,_mm256_add_epi32(x2i_2,x3r_2));
+  *(y1) = _mm256_add_epi16(*(x0),cpack_256(dy1r,dy1i));
+}
+
+static inline void bfly4_16_256(__m256i *x0,__m256i *x1,__m256i *x2,__m256i *x3,
+                                __m256i *y0,__m256i *y1,__m256i *y2,__m256i *y3,
+                                __m256i *tw1,__m256i *tw2,__m256i *tw3,
+                                __m256i *tw1b,__m256i *tw2b,__m256i *tw3b) AVX2_FUNC;
+static inline void bfly4_16_256(__m256i *x0,__m256i *x1,__m256i *x2,__m256i *x3,
+                                __m256i *y0,__m256i *y1,__m256i *y2,__m256i *y3,
+                                __m256i *tw1,__m256i *tw2,__m256i *tw3,
+                                __m256i *tw1b,__m256i *tw2b,__m256i *tw3b)
+{
+
+  register __m256i x1t,x2t,x3t,x02t,x13t;
+
+  x1t = packed_cmult2_256(*(x1),*(tw1),*(tw1b));
+  x2t = packed_cmult2_256(*(x2),*(tw2),*(tw2b));
+  x3t = packed_cmult2_256(*(x3),*(tw3),*(tw3b));
+
+  x02t  = _mm256_adds_epi16(*(x0),x2t);
+  x13t  = _mm256_adds_epi16(x1t,x3t);
+  *(y0) = _mm256_adds_epi16(x02t,x13t);
+  *(y2) = _mm256_subs_epi16(x02t,x13t);
+  x02t  = _mm256_subs_epi16(*(x0),x2t);
+  x13t  = _mm256_subs_epi16(cflip_256(x1t),cflip_256(x3t));
+  *(y1) = _mm256_adds_epi16(x02t,x13t);  // x0 + x1f - x2 - x3f
+  *(y3) = _mm256_subs_epi16(x02t,x13t);  // x0 - x1f - x2 + x3f
+}
+
+static inline void ibfly4_16_256(__m256i *x0,__m256i *x1,__m256i *x2,__m256i *x3,
+                                 __m256i *y0,__m256i *y1,__m256i *y2,__m256i *y3,
+                                 __m256i *tw1,__m256i *tw2,__m256i *tw3,
+                                 __m256i *tw1b,__m256i *tw2b,__m256i *tw3b) AVX2_FUNC;
+static inline void ibfly4_16_256(__m256i *x0,__m256i *x1,__m256i *x2,__m256i *x3,
+                                 __m256i *y0,__m256i *y1,__m256i *y2,__m256i *y3,
+                                 __m256i *tw1,__m256i *tw2,__m256i *tw3,
+                                 __m256i *tw1b,__m256i *tw2b,__m256i *tw3b)
+{
+
+  register __m256i x1t,x2t,x3t,x02t,x13t;
+
+  x1t = packed_cmult2_256(*(x1),*(tw1),*(tw1b));
+  x2t = packed_cmult2_256(*(x2),*(tw2),*(tw2b));
+  x3t = packed_cmult2_256(*(x3),*(tw3),*(tw3b));
+
+  x02t  = _mm256_adds_epi16(*(x0),x2t);
+  x13t  = _mm256_adds_epi16(x1t,x3t);
+  *(y0) = _mm256_adds_epi16(x02t,x13t);
+  *(y2) = _mm256_subs_epi16(x02t,x13t);
+  x02t  = _mm256_subs_epi16(*(x0),x2t);
+  x13t  = _mm256_subs_epi16(cflip_256(x1t),cflip_256(x3t));
+  *(y3) = _mm256_adds_epi16(x02t,x13t);  // x0 + x1f - x2 - x3f
+  *(y1) = _mm256_subs_epi16(x02t,x13t);  // x0 - x1f - x2 + x3f
+}
+
+static inline void bfly5_256(__m256i *x0, __m256i *x1, __m256i *x2, __m256i *x3,__m256i *x4,
+                             __m256i *y0, __m256i *y1, __m256i *y2, __m256i *y3,__m256i *y4,
+                             __m256i *tw1,__m256i *tw2,__m256i *tw3,__m256i *tw4) AVX2_FUNC;
+static inline void bfly5_256(__m256i *x0, __m256i *x1, __m256i *x2, __m256i *x3,__m256i *x4,
+                             __m256i *y0, __m256i *y1, __m256i *y2, __m256i *y3,__m256i *y4,
+                             __m256i *tw1,__m256i *tw2,__m256i *tw3,__m256i *tw4)
+{
+
+  __m256i x1_2,x2_2,x3_2,x4_2,tmpre,tmpim;
+  __m256i W15_256 = bcast_256(W15),W25_256 = bcast_256(W25),W35_256 = bcast_256(W35),W45_256 = bcast_256(W45);
+
+  x1_2 = packed_cmult_256(*(x1),*(tw1));
+  x2_2 = packed_cmult_256(*(x2),*(tw2));
+  x3_2 = packed_cmult_256(*(x3),*(tw3));
+  x4_2 = packed_cmult_256(*(x4),*(tw4));
+
+  *(y0) = _mm256_adds_epi16(*(x0),_mm256_adds_epi16(x1_2,_mm256_adds_epi16(x2_2,_mm256_adds_epi16(x3_2,x4_2))));
+  cmult_256(x1_2,W15_256,&tmpre,&tmpim);
+  cmac_256(x2_2,W25_256,&tmpre,&tmpim);
+  cmac_256(x3_2,W35_256,&tmpre,&tmpim);
+  cmac_256(x4_2,W45_256,&tmpre,&tmpim);
+  *(y1) = _mm256_adds_epi16(*(x0),cpack_256(tmpre,tmpim));
+
+  cmult_256(x1_2,W25_256,&tmpre,&tmpim);
+  cmac_256(x2_2,W45_256,&tmpre,&tmpim);
+  cmac_256(x3_2,W15_256,&tmpre,&tmpim);
+  cmac_256(x4_2,W35_256,&tmpre,&tmpim);
+  *(y2) = _mm256_adds_epi16(*(x0),cpack_256(tmpre,tmpim));
+
+  cmult_256(x1_2,W35_256,&tmpre,&tmpim);
+  cmac_256(x2_2,W15_256,&tmpre,&tmpim);
+  cmac_256(x3_2,W45_256,&tmpre,&tmpim);
+  cmac_256(x4_2,W25_256,&tmpre,&tmpim);
+  *(y3) = _mm256_adds_epi16(*(x0),cpack_256(tmpre,tmpim));
+
+  cmult_256(x1_2,W45_256,&tmpre,&tmpim);
+  cmac_256(x2_2,W35_256,&tmpre,&tmpim);
+  cmac_256(x3_2,W25_256,&tmpre,&tmpim);
+  cmac_256(x4_2,W15_256,&tmpre,&tmpim);
+  *(y4) = _mm256_adds_epi16(*(x0),cpack_256(tmpre,tmpim));
+}
+
+#else
+
+int dft_set_avx2(int enable)
+{
+
+  return(0);
+}
+
+#endif
+
+// Radix stages : n butterflies on consecutive vectors, the legs of each butterfly being stride
+// vectors apart both at the input and at the output. When AVX2 is available two butterflies
+// are computed per iteration, the odd one left (if any) goes through the 128-bit path.
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define load256(p) _mm256_loadu_si256((__m256i *)(p))
+#define store256(p,v) _mm256_storeu_si256((__m256i *)(p),v)
+
+static void bfly2_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw,int stride,int n) __attribute__((target("avx2")));
+static void bfly2_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw,int stride,int n)
+{
+  __m256i x0,x1,y0,y1,tw0;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0  = load256(x+i);
+    x1  = load256(x+stride+i);
+    tw0 = load256(tw+i);
+    bfly2_256(&x0,&x1,&y0,&y1,&tw0);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+  }
+
+  if (i<n)
+    bfly2(x+i,x+stride+i,y+i,y+stride+i,tw+i);
+}
+
+static void ibfly2_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw,int stride,int n) __attribute__((target("avx2")));
+static void ibfly2_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw,int stride,int n)
+{
+  __m256i x0,x1,y0,y1,tw0;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0  = load256(x+i);
+    x1  = load256(x+stride+i);
+    tw0 = load256(tw+i);
+    ibfly2_256(&x0,&x1,&y0,&y1,&tw0);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+  }
+
+  if (i<n)
+    ibfly2(x+i,x+stride+i,y+i,y+stride+i,tw+i);
+}
+
+static void bfly2_16_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw,simd_q15_t *twb,int stride,int n) __attribute__((target("avx2")));
+static void bfly2_16_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw,simd_q15_t *twb,int stride,int n)
+{
+  __m256i x0,x1,y0,y1,tw0,twb0;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0   = load256(x+i);
+    x1   = load256(x+stride+i);
+    tw0  = load256(tw+i);
+    twb0 = load256(twb+i);
+    bfly2_16_256(&x0,&x1,&y0,&y1,&tw0,&twb0);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+  }
+
+  if (i<n)
+    bfly2_16(x+i,x+stride+i,y+i,y+stride+i,tw+i,twb+i);
+}
+
+static void bfly3_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,int stride,int n) __attribute__((target("avx2")));
+static void bfly3_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,int stride,int n)
+{
+  __m256i x0,x1,x2,y0,y1,y2,tw10,tw20;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0   = load256(x+i);
+    x1   = load256(x+stride+i);
+    x2   = load256(x+2*stride+i);
+    tw10 = load256(tw1+i);
+    tw20 = load256(tw2+i);
+    bfly3_256(&x0,&x1,&x2,&y0,&y1,&y2,&tw10,&tw20);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+    store256(y+2*stride+i,y2);
+  }
+
+  if (i<n)
+    bfly3(x+i,x+stride+i,x+2*stride+i,y+i,y+stride+i,y+2*stride+i,tw1+i,tw2+i);
+}
+
+static void ibfly3_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,int stride,int n) __attribute__((target("avx2")));
+static void ibfly3_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,int stride,int n)
+{
+  __m256i x0,x1,x2,y0,y1,y2,tw10,tw20;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0   = load256(x+i);
+    x1   = load256(x+stride+i);
+    x2   = load256(x+2*stride+i);
+    tw10 = load256(tw1+i);
+    tw20 = load256(tw2+i);
+    ibfly3_256(&x0,&x1,&x2,&y0,&y1,&y2,&tw10,&tw20);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+    store256(y+2*stride+i,y2);
+  }
+
+  if (i<n)
+    ibfly3(x+i,x+stride+i,x+2*stride+i,y+i,y+stride+i,y+2*stride+i,tw1+i,tw2+i);
+}
+
+static void bfly4_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,int stride,int n) __attribute__((target("avx2")));
+static void bfly4_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,int stride,int n)
+{
+  __m256i x0,x1,x2,x3,y0,y1,y2,y3,tw10,tw20,tw30;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0   = load256(x+i);
+    x1   = load256(x+stride+i);
+    x2   = load256(x+2*stride+i);
+    x3   = load256(x+3*stride+i);
+    tw10 = load256(tw1+i);
+    tw20 = load256(tw2+i);
+    tw30 = load256(tw3+i);
+    bfly4_256(&x0,&x1,&x2,&x3,&y0,&y1,&y2,&y3,&tw10,&tw20,&tw30);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+    store256(y+2*stride+i,y2);
+    store256(y+3*stride+i,y3);
+  }
+
+  if (i<n)
+    bfly4(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,
+          y+i,y+stride+i,y+2*stride+i,y+3*stride+i,
+          tw1+i,tw2+i,tw3+i);
+}
+
+static void ibfly4_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,int stride,int n) __attribute__((target("avx2")));
+static void ibfly4_stage_avx2(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,int stride,int n)
+{
+  __m256i x0,x1,x2,x3,y0,y1,y2,y3,tw10,tw20,tw30;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0   = load256(x+i);
+    x1   = load256(x+stride+i);
+    x2   = load256(x+2*stride+i);
+    x3   = load256(x+3*stride+i);
+    tw10 = load256(tw1+i);
+    tw20 = load256(tw2+i);
+    tw30 = load256(tw3+i);
+    ibfly4_256(&x0,&x1,&x2,&x3,&y0,&y1,&y2,&y3,&tw10,&tw20,&tw30);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+    store256(y+2*stride+i,y2);
+    store256(y+3*stride+i,y3);
+  }
+
+  if (i<n)
+    ibfly4(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,
+           y+i,y+stride+i,y+2*stride+i,y+3*stride+i,
+           tw1+i,tw2+i,tw3+i);
+}
+
+static void bfly4_16_stage_avx2(simd_q15_t *x,simd_q15_t *y,
+                                simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,
+                                simd_q15_t *tw1b,simd_q15_t *tw2b,simd_q15_t *tw3b,
+                                int stride,int n) __attribute__((target("avx2")));
+static void bfly4_16_stage_avx2(simd_q15_t *x,simd_q15_t *y,
+                                simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,
+                                simd_q15_t *tw1b,simd_q15_t *tw2b,simd_q15_t *tw3b,
+                                int stride,int n)
+{
+  __m256i x0,x1,x2,x3,y0,y1,y2,y3,tw10,tw20,tw30,tw1b0,tw2b0,tw3b0;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0    = load256(x+i);
+    x1    = load256(x+stride+i);
+    x2    = load256(x+2*stride+i);
+    x3    = load256(x+3*stride+i);
+    tw10  = load256(tw1+i);
+    tw20  = load256(tw2+i);
+    tw30  = load256(tw3+i);
+    tw1b0 = load256(tw1b+i);
+    tw2b0 = load256(tw2b+i);
+    tw3b0 = load256(tw3b+i);
+    bfly4_16_256(&x0,&x1,&x2,&x3,&y0,&y1,&y2,&y3,&tw10,&tw20,&tw30,&tw1b0,&tw2b0,&tw3b0);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+    store256(y+2*stride+i,y2);
+    store256(y+3*stride+i,y3);
+  }
+
+  if (i<n)
+    bfly4_16(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,
+             y+i,y+stride+i,y+2*stride+i,y+3*stride+i,
+             tw1+i,tw2+i,tw3+i,
+             tw1b+i,tw2b+i,tw3b+i);
+}
+
+static void ibfly4_16_stage_avx2(simd_q15_t *x,simd_q15_t *y,
+                                 simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,
+                                 simd_q15_t *tw1b,simd_q15_t *tw2b,simd_q15_t *tw3b,
+                                 int stride,int n) __attribute__((target("avx2")));
+static void ibfly4_16_stage_avx2(simd_q15_t *x,simd_q15_t *y,
+                                 simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,
+                                 simd_q15_t *tw1b,simd_q15_t *tw2b,simd_q15_t *tw3b,
+                                 int stride,int n)
+{
+  __m256i x0,x1,x2,x3,y0,y1,y2,y3,tw10,tw20,tw30,tw1b0,tw2b0,tw3b0;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0    = load256(x+i);
+    x1    = load256(x+stride+i);
+    x2    = load256(x+2*stride+i);
+    x3    = load256(x+3*stride+i);
+    tw10  = load256(tw1+i);
+    tw20  = load256(tw2+i);
+    tw30  = load256(tw3+i);
+    tw1b0 = load256(tw1b+i);
+    tw2b0 = load256(tw2b+i);
+    tw3b0 = load256(tw3b+i);
+    ibfly4_16_256(&x0,&x1,&x2,&x3,&y0,&y1,&y2,&y3,&tw10,&tw20,&tw30,&tw1b0,&tw2b0,&tw3b0);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+    store256(y+2*stride+i,y2);
+    store256(y+3*stride+i,y3);
+  }
+
+  if (i<n)
+    ibfly4_16(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,
+              y+i,y+stride+i,y+2*stride+i,y+3*stride+i,
+              tw1+i,tw2+i,tw3+i,
+              tw1b+i,tw2b+i,tw3b+i);
+}
+
+static void bfly5_stage_avx2(simd_q15_t *x,simd_q15_t *y,
+                             simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,simd_q15_t *tw4,
+                             int stride,int n) __attribute__((target("avx2")));
+static void bfly5_stage_avx2(simd_q15_t *x,simd_q15_t *y,
+                             simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,simd_q15_t *tw4,
+                             int stride,int n)
+{
+  __m256i x0,x1,x2,x3,x4,y0,y1,y2,y3,y4,tw10,tw20,tw30,tw40;
+  int i;
+
+  for (i=0; i<(n&~1); i+=2) {
+    x0   = load256(x+i);
+    x1   = load256(x+stride+i);
+    x2   = load256(x+2*stride+i);
+    x3   = load256(x+3*stride+i);
+    x4   = load256(x+4*stride+i);
+    tw10 = load256(tw1+i);
+    tw20 = load256(tw2+i);
+    tw30 = load256(tw3+i);
+    tw40 = load256(tw4+i);
+    bfly5_256(&x0,&x1,&x2,&x3,&x4,&y0,&y1,&y2,&y3,&y4,&tw10,&tw20,&tw30,&tw40);
+    store256(y+i,y0);
+    store256(y+stride+i,y1);
+    store256(y+2*stride+i,y2);
+    store256(y+3*stride+i,y3);
+    store256(y+4*stride+i,y4);
+  }
+
+  if (i<n)
+    bfly5(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,x+4*stride+i,
+          y+i,y+stride+i,y+2*stride+i,y+3*stride+i,y+4*stride+i,
+          tw1+i,tw2+i,tw3+i,tw4+i);
+}
+
+#endif
+
+static inline void bfly2_stage(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw,int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    bfly2_stage_avx2(x,y,tw,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    bfly2(x+i,x+stride+i,y+i,y+stride+i,tw+i);
+}
+
+static inline void ibfly2_stage(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw,int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    ibfly2_stage_avx2(x,y,tw,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    ibfly2(x+i,x+stride+i,y+i,y+stride+i,tw+i);
+}
+
+static inline void bfly2_16_stage(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw,simd_q15_t *twb,int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    bfly2_16_stage_avx2(x,y,tw,twb,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    bfly2_16(x+i,x+stride+i,y+i,y+stride+i,tw+i,twb+i);
+}
+
+static inline void bfly3_stage(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    bfly3_stage_avx2(x,y,tw1,tw2,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    bfly3(x+i,x+stride+i,x+2*stride+i,y+i,y+stride+i,y+2*stride+i,tw1+i,tw2+i);
+}
+
+static inline void ibfly3_stage(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    ibfly3_stage_avx2(x,y,tw1,tw2,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    ibfly3(x+i,x+stride+i,x+2*stride+i,y+i,y+stride+i,y+2*stride+i,tw1+i,tw2+i);
+}
+
+static inline void bfly4_stage(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    bfly4_stage_avx2(x,y,tw1,tw2,tw3,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    bfly4(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,
+          y+i,y+stride+i,y+2*stride+i,y+3*stride+i,
+          tw1+i,tw2+i,tw3+i);
+}
+
+static inline void ibfly4_stage(simd_q15_t *x,simd_q15_t *y,simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    ibfly4_stage_avx2(x,y,tw1,tw2,tw3,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    ibfly4(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,
+           y+i,y+stride+i,y+2*stride+i,y+3*stride+i,
+           tw1+i,tw2+i,tw3+i);
+}
+
+static inline void bfly4_16_stage(simd_q15_t *x,simd_q15_t *y,
+                                  simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,
+                                  simd_q15_t *tw1b,simd_q15_t *tw2b,simd_q15_t *tw3b,
+                                  int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    bfly4_16_stage_avx2(x,y,tw1,tw2,tw3,tw1b,tw2b,tw3b,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    bfly4_16(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,
+             y+i,y+stride+i,y+2*stride+i,y+3*stride+i,
+             tw1+i,tw2+i,tw3+i,
+             tw1b+i,tw2b+i,tw3b+i);
+}
+
+static inline void ibfly4_16_stage(simd_q15_t *x,simd_q15_t *y,
+                                   simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,
+                                   simd_q15_t *tw1b,simd_q15_t *tw2b,simd_q15_t *tw3b,
+                                   int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    ibfly4_16_stage_avx2(x,y,tw1,tw2,tw3,tw1b,tw2b,tw3b,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    ibfly4_16(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,
+              y+i,y+stride+i,y+2*stride+i,y+3*stride+i,
+              tw1+i,tw2+i,tw3+i,
+              tw1b+i,tw2b+i,tw3b+i);
+}
+
+static inline void bfly5_stage(simd_q15_t *x,simd_q15_t *y,
+                               simd_q15_t *tw1,simd_q15_t *tw2,simd_q15_t *tw3,simd_q15_t *tw4,
+                               int stride,int n)
+{
+  int i;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled()) {
+    bfly5_stage_avx2(x,y,tw1,tw2,tw3,tw4,stride,n);
+    return;
+  }
+#endif
+
+  for (i=0; i<n; i++)
+    bfly5(x+i,x+stride+i,x+2*stride+i,x+3*stride+i,x+4*stride+i,
+          y+i,y+stride+i,y+2*stride+i,y+3*stride+i,y+4*stride+i,
+          tw1+i,tw2+i,tw3+i,tw4+i);
+}
+
+
 void dft64(int16_t *x,int16_t *y,int scale)
 {
 
@@ -1803,25 +2621,10 @@ void dft64(int16_t *x,int16_t *y,int scale)
 #endif
 
 
-  bfly4_16(ytmp,ytmp+4,ytmp+8,ytmp+12,
-           y128,y128+4,y128+8,y128+12,
-           tw64a_128,tw64a_128+4,tw64a_128+8,
-           tw64b_128,tw64b_128+4,tw64b_128+8);
-
-  bfly4_16(ytmp+1,ytmp+5,ytmp+9,ytmp+13,
-           y128+1,y128+5,y128+9,y128+13,
-           tw64a_128+1,tw64a_128+5,tw64a_128+9,
-           tw64b_128+1,tw64b_128+5,tw64b_128+9);
-
-  bfly4_16(ytmp+2,ytmp+6,ytmp+10,ytmp+14,
-           y128+2,y128+6,y128+10,y128+14,
-           tw64a_128+2,tw64a_128+6,tw64a_128+10,
-           tw64b_128+2,tw64b_128+6,tw64b_128+10);
-
-  bfly4_16(ytmp+3,ytmp+7,ytmp+11,ytmp+15,
-           y128+3,y128+7,y128+11,y128+15,
-           tw64a_128+3,tw64a_128+7,tw64a_128+11,
-           tw64b_128+3,tw64b_128+7,tw64b_128+11);
+  bfly4_16_stage(ytmp,y128,
+                 tw64a_128,tw64a_128+4,tw64a_128+8,
+                 tw64b_128,tw64b_128+4,tw64b_128+8,
+                 4,4);
 
 #ifdef D64STATS
   stop_meas(&ts_b);
@@ -1893,25 +2696,10 @@ void idft64(int16_t *x,int16_t *y,int scale)
 #endif
 
 
-  ibfly4_16(ytmp,ytmp+4,ytmp+8,ytmp+12,
-            y128,y128+4,y128+8,y128+12,
-            tw64a_128,tw64a_128+4,tw64a_128+8,
-            tw64b_128,tw64b_128+4,tw64b_128+8);
-
-  ibfly4_16(ytmp+1,ytmp+5,ytmp+9,ytmp+13,
-            y128+1,y128+5,y128+9,y128+13,
-            tw64a_128+1,tw64a_128+5,tw64a_128+9,
-            tw64b_128+1,tw64b_128+5,tw64b_128+9);
-
-  ibfly4_16(ytmp+2,ytmp+6,ytmp+10,ytmp+14,
-            y128+2,y128+6,y128+10,y128+14,
-            tw64a_128+2,tw64a_128+6,tw64a_128+10,
-            tw64b_128+2,tw64b_128+6,tw64b_128+10);
-
-  ibfly4_16(ytmp+3,ytmp+7,ytmp+11,ytmp+15,
-            y128+3,y128+7,y128+11,y128+15,
-            tw64a_128+3,tw64a_128+7,tw64a_128+11,
-            tw64b_128+3,tw64b_128+7,tw64b_128+11);
+  ibfly4_16_stage(ytmp,y128,
+                  tw64a_128,tw64a_128+4,tw64a_128+8,
+                  tw64b_128,tw64b_128+4,tw64b_128+8,
+                  4,4);
 
 #ifdef D64STATS
   stop_meas(&ts_b);
@@ -1960,7 +2748,6 @@ void dft128(int16_t *x,int16_t *y,int scale)
   simdshort_q15_t xtmp[64],*x64 = (simdshort_q15_t *)x;
   simd_q15_t ytmp[32],*tw128a_128p=(simd_q15_t *)tw128a,*tw128b_128p=(simd_q15_t *)tw128b,*y128=(simd_q15_t *)y,*y128p=(simd_q15_t *)y;
   simd_q15_t *ytmpp = &ytmp[0];
-  int i;
   simd_q15_t ONE_OVER_SQRT2_Q15_128 = set1_int16(ONE_OVER_SQRT2_Q15);
 
 
@@ -2001,16 +2788,7 @@ void dft128(int16_t *x,int16_t *y,int scale)
   dft64((int16_t*)(xtmp+32),(int16_t*)(ytmp+16),1);
 
 
-  for (i=0; i<16; i++) {
-    bfly2_16(ytmpp,ytmpp+16,
-             y128p,y128p+16,
-             tw128a_128p,
-             tw128b_128p);
-    tw128a_128p++;
-    tw128b_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  bfly2_16_stage(ytmpp,y128p,tw128a_128p,tw128b_128p,16,16);
 
   if (scale>0) {
 
@@ -2061,7 +2839,6 @@ void idft128(int16_t *x,int16_t *y,int scale)
   simdshort_q15_t xtmp[64],*x64 = (simdshort_q15_t *)x;
   simd_q15_t ytmp[32],*tw128_128p=(simd_q15_t *)tw128,*y128=(simd_q15_t *)y,*y128p=(simd_q15_t *)y;
   simd_q15_t *ytmpp = &ytmp[0];
-  int i;
   simd_q15_t ONE_OVER_SQRT2_Q15_128 = set1_int16(ONE_OVER_SQRT2_Q15);
 
 
@@ -2102,14 +2879,7 @@ void idft128(int16_t *x,int16_t *y,int scale)
   idft64((int16_t*)(xtmp+32),(int16_t*)(ytmp+16),1);
 
 
-  for (i=0; i<16; i++) {
-    ibfly2(ytmpp,ytmpp+16,
-           y128p,y128p+16,
-           tw128_128p);
-    tw128_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  ibfly2_stage(ytmpp,y128p,tw128_128p,16,16);
 
   if (scale>0) {
 
@@ -2221,28 +2991,10 @@ void dft256(int16_t *x,int16_t *y,int scale)
   start_meas(&ts_b);
 #endif
 
-  for (i=0; i<16; i+=4) {
-    bfly4_16(ytmpp,ytmpp+16,ytmpp+32,ytmpp+48,
-             y128p,y128p+16,y128p+32,y128p+48,
-             tw256a_128p,tw256a_128p+16,tw256a_128p+32,
-             tw256b_128p,tw256b_128p+16,tw256b_128p+32);
-    bfly4_16(ytmpp+1,ytmpp+17,ytmpp+33,ytmpp+49,
-             y128p+1,y128p+17,y128p+33,y128p+49,
-             tw256a_128p+1,tw256a_128p+17,tw256a_128p+33,
-             tw256b_128p+1,tw256b_128p+17,tw256b_128p+33);
-    bfly4_16(ytmpp+2,ytmpp+18,ytmpp+34,ytmpp+50,
-             y128p+2,y128p+18,y128p+34,y128p+50,
-             tw256a_128p+2,tw256a_128p+18,tw256a_128p+34,
-             tw256b_128p+2,tw256b_128p+18,tw256b_128p+34);
-    bfly4_16(ytmpp+3,ytmpp+19,ytmpp+35,ytmpp+51,
-             y128p+3,y128p+19,y128p+35,y128p+51,
-             tw256a_128p+3,tw256a_128p+19,tw256a_128p+35,
-             tw256b_128p+3,tw256b_128p+19,tw256b_128p+35);
-    tw256a_128p+=4;
-    tw256b_128p+=4;
-    y128p+=4;
-    ytmpp+=4;
-  }
+  bfly4_16_stage(ytmpp,y128p,
+                 tw256a_128p,tw256a_128p+16,tw256a_128p+32,
+                 tw256b_128p,tw256b_128p+16,tw256b_128p+32,
+                 16,16);
 
 #ifdef D256STATS
   stop_meas(&ts_b);
@@ -2298,14 +3050,7 @@ void idft256(int16_t *x,int16_t *y,int scale)
   idft64((int16_t*)(xtmp+32),(int16_t*)(ytmp+32),1);
   idft64((int16_t*)(xtmp+48),(int16_t*)(ytmp+48),1);
 
-  for (i=0; i<16; i++) {
-    ibfly4(ytmpp,ytmpp+16,ytmpp+32,ytmpp+48,
-           y128p,y128p+16,y128p+32,y128p+48,
-           tw256_128p,tw256_128p+16,tw256_128p+32);
-    tw256_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  ibfly4_stage(ytmpp,y128p,tw256_128p,tw256_128p+16,tw256_128p+32,16,16);
 
   if (scale>0) {
 
@@ -2408,44 +3153,7 @@ void dft512(int16_t *x,int16_t *y,int scale)
   dft256((int16_t*)(xtmp+128),(int16_t*)(ytmp+64),1);
 
 
-  for (i=0; i<64; i+=8) {
-    bfly2_16(ytmpp,ytmpp+64,
-             y128p,y128p+64,
-             tw512a_128p,
-             tw512b_128p);
-    bfly2_16(ytmpp+1,ytmpp+65,
-             y128p+1,y128p+65,
-             tw512a_128p+1,
-             tw512b_128p+1);
-    bfly2_16(ytmpp+2,ytmpp+66,
-             y128p+2,y128p+66,
-             tw512a_128p+2,
-             tw512b_128p+2);
-    bfly2_16(ytmpp+3,ytmpp+67,
-             y128p+3,y128p+67,
-             tw512a_128p+3,
-             tw512b_128p+3);
-    bfly2_16(ytmpp+4,ytmpp+68,
-             y128p+4,y128p+68,
-             tw512a_128p+4,
-             tw512b_128p+4);
-    bfly2_16(ytmpp+5,ytmpp+69,
-             y128p+5,y128p+69,
-             tw512a_128p+5,
-             tw512b_128p+5);
-    bfly2_16(ytmpp+6,ytmpp+70,
-             y128p+6,y128p+70,
-             tw512a_128p+6,
-             tw512b_128p+6);
-    bfly2_16(ytmpp+7,ytmpp+71,
-             y128p+7,y128p+71,
-             tw512a_128p+7,
-             tw512b_128p+7);
-    tw512a_128p+=8;
-    tw512b_128p+=8;
-    y128p+=8;
-    ytmpp+=8;
-  }
+  bfly2_16_stage(ytmpp,y128p,tw512a_128p,tw512b_128p,64,64);
 
   if (scale>0) {
     y128p = y128;
@@ -2528,14 +3236,7 @@ void idft512(int16_t *x,int16_t *y,int scale)
   idft256((int16_t*)(xtmp+128),(int16_t*)(ytmp+64),1);
 
 
-  for (i=0; i<64; i++) {
-    ibfly2(ytmpp,ytmpp+64,
-           y128p,y128p+64,
-           tw512_128p);
-    tw512_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  ibfly2_stage(ytmpp,y128p,tw512_128p,64,64);
 
   if (scale>0) {
     y128p = y128;
@@ -2588,14 +3289,7 @@ void dft1024(int16_t *x,int16_t *y,int scale)
   dft256((int16_t*)(xtmp+128),(int16_t*)(ytmp+128),1);
   dft256((int16_t*)(xtmp+192),(int16_t*)(ytmp+192),1);
 
-  for (i=0; i<64; i++) {
-    bfly4(ytmpp,ytmpp+64,ytmpp+128,ytmpp+192,
-          y128p,y128p+64,y128p+128,y128p+192,
-          tw1024_128p,tw1024_128p+64,tw1024_128p+128);
-    tw1024_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  bfly4_stage(ytmpp,y128p,tw1024_128p,tw1024_128p+64,tw1024_128p+128,64,64);
 
   if (scale>0) {
 
@@ -2644,14 +3338,7 @@ void idft1024(int16_t *x,int16_t *y,int scale)
   idft256((int16_t*)(xtmp+128),(int16_t*)(ytmp+128),1);
   idft256((int16_t*)(xtmp+192),(int16_t*)(ytmp+192),1);
 
-  for (i=0; i<64; i++) {
-    ibfly4(ytmpp,ytmpp+64,ytmpp+128,ytmpp+192,
-           y128p,y128p+64,y128p+128,y128p+192,
-           tw1024_128p,tw1024_128p+64,tw1024_128p+128);
-    tw1024_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  ibfly4_stage(ytmpp,y128p,tw1024_128p,tw1024_128p+64,tw1024_128p+128,64,64);
 
   if (scale>0) {
 
@@ -2738,14 +3425,7 @@ void dft2048(int16_t *x,int16_t *y,int scale)
   dft1024((int16_t*)(xtmp+512),(int16_t*)(ytmp+256),1);
 
 
-  for (i=0; i<256; i++) {
-    bfly2(ytmpp,ytmpp+256,
-          y128p,y128p+256,
-          tw2048_128p);
-    tw2048_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  bfly2_stage(ytmpp,y128p,tw2048_128p,256,256);
 
   if (scale>0) {
     y128p = y128;
@@ -2828,14 +3508,7 @@ void idft2048(int16_t *x,int16_t *y,int scale)
   idft1024((int16_t*)(xtmp+512),(int16_t*)(ytmp+256),1);
 
 
-  for (i=0; i<256; i++) {
-    ibfly2(ytmpp,ytmpp+256,
-           y128p,y128p+256,
-           tw2048_128p);
-    tw2048_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  ibfly2_stage(ytmpp,y128p,tw2048_128p,256,256);
 
   if (scale>0) {
     y128p = y128;
@@ -2885,14 +3558,7 @@ void dft4096(int16_t *x,int16_t *y,int scale)
   dft1024((int16_t*)(xtmp+512),(int16_t*)(ytmp+512),1);
   dft1024((int16_t*)(xtmp+768),(int16_t*)(ytmp+768),1);
 
-  for (i=0; i<256; i++) {
-    bfly4(ytmpp,ytmpp+256,ytmpp+512,ytmpp+768,
-          y128p,y128p+256,y128p+512,y128p+768,
-          tw4096_128p,tw4096_128p+256,tw4096_128p+512);
-    tw4096_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  bfly4_stage(ytmpp,y128p,tw4096_128p,tw4096_128p+256,tw4096_128p+512,256,256);
 
   if (scale>0) {
 
@@ -2941,14 +3607,7 @@ void idft4096(int16_t *x,int16_t *y,int scale)
   idft1024((int16_t*)(xtmp+512),(int16_t*)(ytmp+512),1);
   idft1024((int16_t*)(xtmp+768),(int16_t*)(ytmp+768),1);
 
-  for (i=0; i<256; i++) {
-    ibfly4(ytmpp,ytmpp+256,ytmpp+512,ytmpp+768,
-           y128p,y128p+256,y128p+512,y128p+768,
-           tw4096_128p,tw4096_128p+256,tw4096_128p+512);
-    tw4096_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  ibfly4_stage(ytmpp,y128p,tw4096_128p,tw4096_128p+256,tw4096_128p+512,256,256);
 
   if (scale>0) {
 
@@ -2980,6 +3639,123 @@ void idft4096(int16_t *x,int16_t *y,int scale)
 
 }
 
+// Batched OFDM transforms: all symbols/antennas of a slot or subframe are run back to back through
+// the same kernel so that its twiddles and stack scratch stay in cache, the next input is prefetched
+// while the current one is transformed and buffers that are not 128-bit aligned (odd cyclic prefix
+// lengths) are staged through an aligned copy instead of being handled by every caller.
+static void fft_batch(void (*fft)(int16_t *,int16_t *,int),int fftsize,int16_t **x,int16_t **y,int nb,int scale)
+{
+  int32_t xtmp[4096] __attribute__((aligned(32)));
+  int32_t ytmp[4096] __attribute__((aligned(32)));
+  int16_t *xi,*yi;
+  int i,j;
+
+  for (i=0; i<nb; i++) {
+#if defined(__x86_64__) || defined(__i386__)
+
+    if (i+1<nb)
+      for (j=0; j<fftsize*4; j+=64)
+        _mm_prefetch(((char *)x[i+1])+j,_MM_HINT_T1);
+
+#elif defined(__arm__)
+
+    if (i+1<nb)
+      for (j=0; j<fftsize*4; j+=64)
+        __builtin_prefetch(((char *)x[i+1])+j,0,2);
+
+#endif
+    xi = x[i];
+    yi = y[i];
+
+    if (((uintptr_t)xi&15) != 0) {
+      memcpy((void *)xtmp,(void *)xi,fftsize*sizeof(int32_t));
+      xi = (int16_t *)xtmp;
+    }
+
+    if (((uintptr_t)yi&15) != 0)
+      yi = (int16_t *)ytmp;
+
+    fft(xi,yi,scale);
+
+    if (yi != y[i])
+      memcpy((void *)y[i],(void *)yi,fftsize*sizeof(int32_t));
+  }
+}
+
+void dft_batch(uint8_t log2fftsize,int16_t **x,int16_t **y,int nb,int scale)
+{
+  void (*dft)(int16_t *,int16_t *,int);
+
+  switch (log2fftsize) {
+  case 7:
+    dft = dft128;
+    break;
+
+  case 8:
+    dft = dft256;
+    break;
+
+  case 9:
+    dft = dft512;
+    break;
+
+  case 10:
+    dft = dft1024;
+    break;
+
+  case 11:
+    dft = dft2048;
+    break;
+
+  case 12:
+    dft = dft4096;
+    break;
+
+  default:
+    AssertFatal(0,"dft_batch: unsupported size 2^%d\n",log2fftsize);
+    return;
+  }
+
+  fft_batch(dft,1<<log2fftsize,x,y,nb,scale);
+}
+
+void idft_batch(uint8_t log2fftsize,int16_t **x,int16_t **y,int nb,int scale)
+{
+  void (*idft)(int16_t *,int16_t *,int);
+
+  switch (log2fftsize) {
+  case 7:
+    idft = idft128;
+    break;
+
+  case 8:
+    idft = idft256;
+    break;
+
+  case 9:
+    idft = idft512;
+    break;
+
+  case 10:
+    idft = idft1024;
+    break;
+
+  case 11:
+    idft = idft2048;
+    break;
+
+  case 12:
+    idft = idft4096;
+    break;
+
+  default:
+    AssertFatal(0,"idft_batch: unsupported size 2^%d\n",log2fftsize);
+    return;
+  }
+
+  fft_batch(idft,1<<log2fftsize,x,y,nb,scale);
+}
+
 /* Twiddles generated with
 twa = floor(32767*exp(-sqrt(-1)*2*pi*(0:4095)/8192));
 twa2 = zeros(1,2*4096);
@@ -2997,7 +3773,7 @@ void dft8192(int16_t *x,int16_t *y,int scale)
 {
 
   simdshort_q15_t xtmp[4096],*xtmpp,*x64 = (simdshort_q15_t *)x;
-  simd_q15_t ytmp[1024],*tw8192_128p=(simd_q15_t *)tw8192,*y128=(simd_q15_t *)y,*y128p=(simd_q15_t *)y;
+  simd_q15_t ytmp[2048],*tw8192_128p=(simd_q15_t *)tw8192,*y128=(simd_q15_t *)y,*y128p=(simd_q15_t *)y;
   simd_q15_t *ytmpp = &ytmp[0];
   int i;
   simd_q15_t ONE_OVER_SQRT2_Q15_128 = set1_int16(ONE_OVER_SQRT2_Q15);
@@ -3045,14 +3821,7 @@ void dft8192(int16_t *x,int16_t *y,int scale)
   dft4096((int16_t*)(xtmp+2048),(int16_t*)(ytmp+1024),1);
 
 
-  for (i=0; i<1024; i++) {
-    bfly2(ytmpp,ytmpp+1024,
-          y128p,y128p+1024,
-          tw8192_128p);
-    tw8192_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  bfly2_stage(ytmpp,y128p,tw8192_128p,1024,1024);
 
   if (scale>0) {
     y128p = y128;
@@ -3135,14 +3904,7 @@ void idft8192(int16_t *x,int16_t *y,int scale)
   idft4096((int16_t*)(xtmp+2048),(int16_t*)(ytmp+1024),1);
 
 
-  for (i=0; i<1024; i++) {
-    ibfly2(ytmpp,ytmpp+1024,
-           y128p,y128p+1024,
-           tw8192_128p);
-    tw8192_128p++;
-    y128p++;
-    ytmpp++;
-  }
+  ibfly2_stage(ytmpp,y128p,tw8192_128p,1024,1024);
 
   if (scale>0) {
     y128p = y128;
@@ -3177,7 +3939,7 @@ void idft8192(int16_t *x,int16_t *y,int scale)
 // 512 x 3
 void idft1536(int16_t *input, int16_t *output)
 {
-  int i,i2,j;
+  int i,j;
   uint32_t tmp[3][512 ]__attribute__((aligned(16)));
   uint32_t tmpo[3][512] __attribute__((aligned(16)));
 
@@ -3202,11 +3964,9 @@ void idft1536(int16_t *input, int16_t *output)
   //  write_output("out1.m","o1",tmpo[1],2048,1,1);
   //  write_output("out2.m","o2",tmpo[2],2048,1,1);
 
-  for (i=0,i2=0; i<1024; i+=8,i2+=4)  {
-    ibfly3((simd_q15_t*)(&tmpo[0][i2]),(simd_q15_t*)(&tmpo[1][i2]),((simd_q15_t*)&tmpo[2][i2]),
-          (simd_q15_t*)(output+i),(simd_q15_t*)(output+1024+i),(simd_q15_t*)(output+2048+i),
-          (simd_q15_t*)(twa1536+i),(simd_q15_t*)(twb1536+i));
-  }
+  ibfly3_stage((simd_q15_t*)tmpo[0],(simd_q15_t*)output,
+               (simd_q15_t*)twa1536,(simd_q15_t*)twb1536,
+               128,128);
 
 
   _mm_empty();
@@ -3216,7 +3976,7 @@ void idft1536(int16_t *input, int16_t *output)
 
 void dft1536(int16_t *input, int16_t *output)
 {
-  int i,i2,j;
+  int i,j;
   uint32_t tmp[3][512] __attribute__((aligned(16)));
   uint32_t tmpo[3][512] __attribute__((aligned(16)));
 
@@ -3240,11 +4000,9 @@ void dft1536(int16_t *input, int16_t *output)
   //  write_output("out0.m","o0",tmpo[0],2048,1,1);
   //  write_output("out1.m","o1",tmpo[1],2048,1,1);
   //  write_output("out2.m","o2",tmpo[2],2048,1,1);
-  for (i=0,i2=0; i<1024; i+=8,i2+=4)  {
-    bfly3((simd_q15_t*)(&tmpo[0][i2]),(simd_q15_t*)(&tmpo[1][i2]),(simd_q15_t*)(&tmpo[2][i2]),
-          (simd_q15_t*)(output+i),(simd_q15_t*)(output+1024+i),(simd_q15_t*)(output+2048+i),
-          (simd_q15_t*)(twa1536+i),(simd_q15_t*)(twb1536+i));
-  }
+  bfly3_stage((simd_q15_t*)tmpo[0],(simd_q15_t*)output,
+              (simd_q15_t*)twa1536,(simd_q15_t*)twb1536,
+              128,128);
 
   _mm_empty();
   _m_empty();
@@ -3266,7 +4024,7 @@ void idft3072(int16_t *input, int16_t *output)
 
 void idft6144(int16_t *input, int16_t *output)
 {
-  int i,i2,j;
+  int i,j;
   uint32_t tmp[3][2048] __attribute__((aligned(16)));
   uint32_t tmpo[3][2048] __attribute__((aligned(16)));
 
@@ -3292,11 +4050,9 @@ void idft6144(int16_t *input, int16_t *output)
   //  write_output("out1.m","o1",tmpo[1],2048,1,1);
   //  write_output("out2.m","o2",tmpo[2],2048,1,1);
 
-  for (i=0,i2=0; i<4096; i+=8,i2+=4)  {
-    ibfly3((simd_q15_t*)(&tmpo[0][i2]),(simd_q15_t*)(&tmpo[1][i2]),((simd_q15_t*)&tmpo[2][i2]),
-	   (simd_q15_t*)(output+i),(simd_q15_t*)(output+4096+i),(simd_q15_t*)(output+8192+i),
-	   (simd_q15_t*)(twa6144+i),(simd_q15_t*)(twb6144+i));
-  }
+  ibfly3_stage((simd_q15_t*)tmpo[0],(simd_q15_t*)output,
+               (simd_q15_t*)twa6144,(simd_q15_t*)twb6144,
+               512,512);
 
   //  write_output("out.m","out",output,6144,1,1);
   _mm_empty();
@@ -3307,7 +4063,7 @@ void idft6144(int16_t *input, int16_t *output)
 
 void dft6144(int16_t *input, int16_t *output)
 {
-  int i,i2,j;
+  int i,j;
   uint32_t tmp[3][2048] __attribute__((aligned(16)));
   uint32_t tmpo[3][2048] __attribute__((aligned(16)));
 
@@ -3331,11 +4087,9 @@ void dft6144(int16_t *input, int16_t *output)
   //  write_output("out0.m","o0",tmpo[0],2048,1,1);
   //  write_output("out1.m","o1",tmpo[1],2048,1,1);
   //  write_output("out2.m","o2",tmpo[2],2048,1,1);
-  for (i=0,i2=0; i<4096; i+=8,i2+=4)  {
-    bfly3((simd_q15_t*)(&tmpo[0][i2]),(simd_q15_t*)(&tmpo[1][i2]),(simd_q15_t*)(&tmpo[2][i2]),
-          (simd_q15_t*)(output+i),(simd_q15_t*)(output+4096+i),(simd_q15_t*)(output+8192+i),
-          (simd_q15_t*)(twa6144+i),(simd_q15_t*)(twb6144+i));
-  }
+  bfly3_stage((simd_q15_t*)tmpo[0],(simd_q15_t*)output,
+              (simd_q15_t*)twa6144,(simd_q15_t*)twb6144,
+              512,512);
 
   _mm_empty();
   _m_empty();
@@ -3347,7 +4101,7 @@ void dft6144(int16_t *input, int16_t *output)
 // 4096 x 3
 void dft12288(int16_t *input, int16_t *output)
 {
-  int i,i2,j;
+  int i,j;
   uint32_t tmp[3][4096] __attribute__((aligned(16)));
   uint32_t tmpo[3][4096] __attribute__((aligned(16)));
 
@@ -3370,11 +4124,9 @@ void dft12288(int16_t *input, int16_t *output)
   //  write_output("out0.m","o0",tmpo[0],4096,1,1);
   //  write_output("out1.m","o1",tmpo[1],4096,1,1);
   //  write_output("out2.m","o2",tmpo[2],4096,1,1);
-  for (i=0,i2=0; i<8192; i+=8,i2+=4)  {
-    bfly3((simd_q15_t*)(&tmpo[0][i2]),(simd_q15_t*)(&tmpo[1][i2]),(simd_q15_t*)(&tmpo[2][i2]),
-          (simd_q15_t*)(output+i),(simd_q15_t*)(output+8192+i),(simd_q15_t*)(output+16384+i),
-          (simd_q15_t*)(twa12288+i),(simd_q15_t*)(twb12288+i));
-  }
+  bfly3_stage((simd_q15_t*)tmpo[0],(simd_q15_t*)output,
+              (simd_q15_t*)twa12288,(simd_q15_t*)twb12288,
+              1024,1024);
 
   _mm_empty();
   _m_empty();
@@ -3383,7 +4135,7 @@ void dft12288(int16_t *input, int16_t *output)
 
 void idft12288(int16_t *input, int16_t *output)
 {
-  int i,i2,j;
+  int i,j;
   uint32_t tmp[3][4096] __attribute__((aligned(16)));
   uint32_t tmpo[3][4096] __attribute__((aligned(16)));
 
@@ -3403,11 +4155,9 @@ void idft12288(int16_t *input, int16_t *output)
     write_output("out1.m","o1",tmpo[1],4096,1,1);
     write_output("out2.m","o2",tmpo[2],4096,1,1);
   */
-  for (i=0,i2=0; i<8192; i+=8,i2+=4)  {
-    ibfly3((simd_q15_t*)(&tmpo[0][i2]),(simd_q15_t*)(&tmpo[1][i2]),((simd_q15_t*)&tmpo[2][i2]),
-          (simd_q15_t*)(output+i),(simd_q15_t*)(output+8192+i),(simd_q15_t*)(output+16384+i),
-          (simd_q15_t*)(twa12288+i),(simd_q15_t*)(twb12288+i));
-  }
+  ibfly3_stage((simd_q15_t*)tmpo[0],(simd_q15_t*)output,
+               (simd_q15_t*)twa12288,(simd_q15_t*)twb12288,
+               1024,1024);
 
   _mm_empty();
   _m_empty();
@@ -3430,7 +4180,7 @@ void idft18432(int16_t *input, int16_t *output)
 // 8192 x 3
 void dft24576(int16_t *input, int16_t *output)
 {
-  int i,i2,j;
+  int i,j;
   uint32_t tmp[3][8192] __attribute__((aligned(16)));
   uint32_t tmpo[3][8192] __attribute__((aligned(16)));
 
@@ -3453,11 +4203,9 @@ void dft24576(int16_t *input, int16_t *output)
   //   write_output("out0.m","o0",tmpo[0],8192,1,1);
   //    write_output("out1.m","o1",tmpo[1],8192,1,1);
   //    write_output("out2.m","o2",tmpo[2],8192,1,1);
-  for (i=0,i2=0; i<16384; i+=8,i2+=4)  {
-    bfly3((simd_q15_t*)(&tmpo[0][i2]),(simd_q15_t*)(&tmpo[1][i2]),(simd_q15_t*)(&tmpo[2][i2]),
-          (simd_q15_t*)(output+i),(simd_q15_t*)(output+16384+i),(simd_q15_t*)(output+32768+i),
-          (simd_q15_t*)(twa24576+i),(simd_q15_t*)(twb24576+i));
-  }
+  bfly3_stage((simd_q15_t*)tmpo[0],(simd_q15_t*)output,
+              (simd_q15_t*)twa24576,(simd_q15_t*)twb24576,
+              2048,2048);
 
   _mm_empty();
   _m_empty();
@@ -3467,9 +4215,9 @@ void dft24576(int16_t *input, int16_t *output)
 
 void idft24576(int16_t *input, int16_t *output)
 {
-  int i,i2,j;
-  uint32_t tmp[3][16384] __attribute__((aligned(16)));
-  uint32_t tmpo[3][16384] __attribute__((aligned(16)));
+  int i,j;
+  uint32_t tmp[3][8192] __attribute__((aligned(16)));
+  uint32_t tmpo[3][8192] __attribute__((aligned(16)));
 
   for (i=0,j=0; i<8192; i++) {
     tmp[0][i] = ((uint32_t *)input)[j++];
@@ -3495,11 +4243,9 @@ void idft24576(int16_t *input, int16_t *output)
     write_output("out2.m","o2",tmpo[2],8192,1,1);
   */
 
-  for (i=0,i2=0; i<16384; i+=8,i2+=4)  {
-    ibfly3((simd_q15_t*)(&tmpo[0][i2]),(simd_q15_t*)(&tmpo[1][i2]),((simd_q15_t*)&tmpo[2][i2]),
-          (simd_q15_t*)(output+i),(simd_q15_t*)(output+16384+i),(simd_q15_t*)(output+32768+i),
-          (simd_q15_t*)(twa24576+i),(simd_q15_t*)(twb24576+i));
-  }
+  ibfly3_stage((simd_q15_t*)tmpo[0],(simd_q15_t*)output,
+               (simd_q15_t*)twa24576,(simd_q15_t*)twb24576,
+               2048,2048);
 
   _mm_empty();
   _m_empty();
@@ -4374,6 +5120,362 @@ void dft60(int16_t *x,int16_t *y,unsigned char scale)
 
 }
 
+// Plan-based transforms for the DFT-S sizes (72..1200). Each size is described by the radix of
+// its last stage, the sub-transforms being either other plans or the dft12..dft60 kernels above.
+// The twiddles are generated at init time, non-replicated (one int32 re/im pair per factor) and
+// shared between sizes which divide each other, instead of the 4x replicated static tables of the
+// unrolled dftN functions. The decomposition, the twiddle rounding and the normalization of each
+// size are those of the unrolled functions, so dft_plan() is bit-exact with them.
+
+typedef struct {
+  /// transform size
+  uint16_t N;
+  /// radix of the last stage
+  uint8_t radix;
+  /// scale_flag passed to the sub-transforms
+  uint8_t sub_scale;
+  /// rounding of the twiddles (0 truncation, 1 floor) used by the unrolled function
+  uint8_t tw_floor;
+  /// index in dft_norm_table of the normalization applied when scale_flag==1
+  int8_t norm;
+  /// twiddle table W_{N*tw_step}^j, shared with the largest size which is a multiple of N
+  int32_t *tw;
+  /// index step in tw for W_N^1
+  uint16_t tw_step;
+} dft_plan_t;
+
+static dft_plan_t dft_plans[] = {
+  {72,2,1,0,5},   {96,2,0,0,6},   {108,3,0,0,7},  {120,2,0,0,8},  {144,3,1,0,9},  {180,3,1,0,10},
+  {192,4,1,0,11}, {216,3,1,0,12}, {240,4,1,0,13}, {288,3,1,0,14}, {300,5,1,0,15},
+  {324,3,1,1,14}, {360,3,1,1,14}, {384,4,1,1,11}, {432,4,1,1,11}, {480,4,1,1,11}, {540,3,1,1,14},
+  {576,3,1,1,14}, {600,2,1,1,5},  {648,3,1,1,14}, {720,4,1,1,11}, {864,3,1,1,14}, {900,3,1,1,14},
+  {960,4,1,1,11}, {972,3,1,1,14}, {1080,3,1,1,14},{1152,4,1,1,11},{1200,4,1,1,11}
+};
+
+#define DFT_PLANS_NB (sizeof(dft_plans)/sizeof(dft_plans[0]))
+// sum of the root sizes of the twiddle tables (288,216,240,192,180,300,1200,1080,1152,972,960,900,864,720,648)
+#define DFT_PLAN_TW_SIZE 9912
+
+static int32_t dft_plan_tw[DFT_PLAN_TW_SIZE] __attribute__((aligned(16)));
+// plan index for each multiple of 12 up to 1200, -1 for the kernel sizes
+static int8_t dft_plan_index[101];
+static int dft_plans_ready = 0;
+
+void init_dft_plans(void)
+{
+
+  int i,j,n,tw_offset=0;
+  dft_plan_t *p,*root;
+  double c,s;
+  int16_t re,im;
+
+  memset(dft_plan_index,-1,sizeof(dft_plan_index));
+
+  // largest sizes first so that smaller ones can share their tables
+  for (i=DFT_PLANS_NB-1; i>=0; i--) {
+    p = &dft_plans[i];
+    dft_plan_index[p->N/12] = i;
+    root = NULL;
+
+    for (j=DFT_PLANS_NB-1; j>i; j--)
+      if ((dft_plans[j].tw_floor == p->tw_floor) &&
+          (dft_plans[j].tw_step == 1) &&
+          ((dft_plans[j].N % p->N) == 0)) {
+        root = &dft_plans[j];
+        break;
+      }
+
+    if (root) {
+      p->tw      = root->tw;
+      p->tw_step = root->N/p->N;
+      continue;
+    }
+
+    AssertFatal(tw_offset+p->N <= DFT_PLAN_TW_SIZE,"dft plan twiddle pool too small\n");
+    p->tw      = &dft_plan_tw[tw_offset];
+    p->tw_step = 1;
+    tw_offset += p->N;
+
+    for (n=0; n<p->N; n++) {
+      c = 32767.0*cos(2*M_PI*n/p->N);
+      s = -32767.0*sin(2*M_PI*n/p->N);
+
+      if (p->tw_floor == 1) {
+        c = floor(c);
+        s = floor(s);
+      }
+
+      re = (int16_t)c;
+      im = (int16_t)s;
+      p->tw[n] = (int32_t)((uint16_t)re | ((uint32_t)(uint16_t)im<<16));
+    }
+  }
+
+  dft_plans_ready = 1;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define set1_cpx(a) _mm_set1_epi32(a)
+#elif defined(__arm__)
+#define set1_cpx(a) vreinterpretq_s16_s32(vdupq_n_s32(a))
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+
+static inline __m256i bcast2_cpx_256(int32_t *tw,int step) AVX2_FUNC;
+static inline __m256i bcast2_cpx_256(int32_t *tw,int step)
+{
+  return(_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_set1_epi32(tw[0])),_mm_set1_epi32(tw[step]),1));
+}
+
+// butterflies k=1..M-1 of the last stage of a plan, two per iteration, the odd one left (if any)
+// is returned to the 128-bit loop
+static int dft_plan_stage_avx2(dft_plan_t *p,simd_q15_t *x,simd_q15_t *y) __attribute__((target("avx2")));
+static int dft_plan_stage_avx2(dft_plan_t *p,simd_q15_t *x,simd_q15_t *y)
+{
+
+  int M=p->N/p->radix,s=p->tw_step,k;
+  int32_t *tw=p->tw;
+  __m256i x0,x1,x2,x3,x4,y0,y1,y2,y3,y4,tw1,tw2,tw3,tw4;
+
+  switch (p->radix) {
+  case 2:
+    for (k=1; k<M-1; k+=2) {
+      x0  = load256(x+k);
+      x1  = load256(x+M+k);
+      tw1 = bcast2_cpx_256(tw+k*s,s);
+      bfly2_256(&x0,&x1,&y0,&y1,&tw1);
+      store256(y+k,y0);
+      store256(y+M+k,y1);
+    }
+
+    break;
+
+  case 3:
+    for (k=1; k<M-1; k+=2) {
+      x0  = load256(x+k);
+      x1  = load256(x+M+k);
+      x2  = load256(x+2*M+k);
+      tw1 = bcast2_cpx_256(tw+k*s,s);
+      tw2 = bcast2_cpx_256(tw+2*k*s,2*s);
+      bfly3_256(&x0,&x1,&x2,&y0,&y1,&y2,&tw1,&tw2);
+      store256(y+k,y0);
+      store256(y+M+k,y1);
+      store256(y+2*M+k,y2);
+    }
+
+    break;
+
+  case 4:
+    for (k=1; k<M-1; k+=2) {
+      x0  = load256(x+k);
+      x1  = load256(x+M+k);
+      x2  = load256(x+2*M+k);
+      x3  = load256(x+3*M+k);
+      tw1 = bcast2_cpx_256(tw+k*s,s);
+      tw2 = bcast2_cpx_256(tw+2*k*s,2*s);
+      tw3 = bcast2_cpx_256(tw+3*k*s,3*s);
+      bfly4_256(&x0,&x1,&x2,&x3,&y0,&y1,&y2,&y3,&tw1,&tw2,&tw3);
+      store256(y+k,y0);
+      store256(y+M+k,y1);
+      store256(y+2*M+k,y2);
+      store256(y+3*M+k,y3);
+    }
+
+    break;
+
+  default:
+    for (k=1; k<M-1; k+=2) {
+      x0  = load256(x+k);
+      x1  = load256(x+M+k);
+      x2  = load256(x+2*M+k);
+      x3  = load256(x+3*M+k);
+      x4  = load256(x+4*M+k);
+      tw1 = bcast2_cpx_256(tw+k*s,s);
+      tw2 = bcast2_cpx_256(tw+2*k*s,2*s);
+      tw3 = bcast2_cpx_256(tw+3*k*s,3*s);
+      tw4 = bcast2_cpx_256(tw+4*k*s,4*s);
+      bfly5_256(&x0,&x1,&x2,&x3,&x4,&y0,&y1,&y2,&y3,&y4,&tw1,&tw2,&tw3,&tw4);
+      store256(y+k,y0);
+      store256(y+M+k,y1);
+      store256(y+2*M+k,y2);
+      store256(y+3*M+k,y3);
+      store256(y+4*M+k,y4);
+    }
+
+    break;
+  }
+
+  return(k);
+}
+
+#endif
+
+static void dft_plan_stage(dft_plan_t *p,simd_q15_t *x,simd_q15_t *y)
+{
+
+  int M=p->N/p->radix,s=p->tw_step,k=1;
+  int32_t *tw=p->tw;
+  simd_q15_t tw1,tw2,tw3,tw4;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (dft_avx2_enabled())
+    k = dft_plan_stage_avx2(p,x,y);
+#endif
+
+  switch (p->radix) {
+  case 2:
+    bfly2_tw1(x,x+M,y,y+M);
+
+    for (; k<M; k++) {
+      tw1 = set1_cpx(tw[k*s]);
+      bfly2(x+k,x+M+k,y+k,y+M+k,&tw1);
+    }
+
+    break;
+
+  case 3:
+    bfly3_tw1(x,x+M,x+2*M,y,y+M,y+2*M);
+
+    for (; k<M; k++) {
+      tw1 = set1_cpx(tw[k*s]);
+      tw2 = set1_cpx(tw[2*k*s]);
+      bfly3(x+k,x+M+k,x+2*M+k,y+k,y+M+k,y+2*M+k,&tw1,&tw2);
+    }
+
+    break;
+
+  case 4:
+    bfly4_tw1(x,x+M,x+2*M,x+3*M,y,y+M,y+2*M,y+3*M);
+
+    for (; k<M; k++) {
+      tw1 = set1_cpx(tw[k*s]);
+      tw2 = set1_cpx(tw[2*k*s]);
+      tw3 = set1_cpx(tw[3*k*s]);
+      bfly4(x+k,x+M+k,x+2*M+k,x+3*M+k,y+k,y+M+k,y+2*M+k,y+3*M+k,&tw1,&tw2,&tw3);
+    }
+
+    break;
+
+  default:
+    bfly5_tw1(x,x+M,x+2*M,x+3*M,x+4*M,y,y+M,y+2*M,y+3*M,y+4*M);
+
+    for (; k<M; k++) {
+      tw1 = set1_cpx(tw[k*s]);
+      tw2 = set1_cpx(tw[2*k*s]);
+      tw3 = set1_cpx(tw[3*k*s]);
+      tw4 = set1_cpx(tw[4*k*s]);
+      bfly5(x+k,x+M+k,x+2*M+k,x+3*M+k,x+4*M+k,y+k,y+M+k,y+2*M+k,y+3*M+k,y+4*M+k,&tw1,&tw2,&tw3,&tw4);
+    }
+
+    break;
+  }
+}
+
+void dft_plan(uint16_t N,int16_t *x,int16_t *y,unsigned char scale_flag)
+{
+
+  simd_q15_t *x128=(simd_q15_t *)x;
+  simd_q15_t *y128=(simd_q15_t *)y;
+  dft_plan_t *p;
+  int r,M,i,j,k;
+
+  switch (N) {
+  case 12:
+    dft12(x,y);
+    return;
+
+  case 24:
+    dft24(x,y,scale_flag);
+    return;
+
+  case 36:
+    dft36(x,y,scale_flag);
+    return;
+
+  case 48:
+    dft48(x,y,scale_flag);
+    return;
+
+  case 60:
+    dft60(x,y,scale_flag);
+    return;
+  }
+
+  if (dft_plans_ready == 0)
+    init_dft_plans();
+
+  AssertFatal((N == 12*(N/12)) && (N <= 1200) && (dft_plan_index[N/12] >= 0),
+              "dft_plan: no plan for size %d\n",N);
+
+  p = &dft_plans[dft_plan_index[N/12]];
+  r = p->radix;
+  M = N/r;
+
+  {
+    simd_q15_t x2128[N],ytmp128[N];
+
+    switch (r) {
+    case 2:
+      for (i=0,j=0; i<M; i++,j+=2) {
+        x2128[i]   = x128[j];
+        x2128[i+M] = x128[j+1];
+      }
+
+      break;
+
+    case 3:
+      for (i=0,j=0; i<M; i++,j+=3) {
+        x2128[i]     = x128[j];
+        x2128[i+M]   = x128[j+1];
+        x2128[i+2*M] = x128[j+2];
+      }
+
+      break;
+
+    case 4:
+      for (i=0,j=0; i<M; i++,j+=4) {
+        x2128[i]     = x128[j];
+        x2128[i+M]   = x128[j+1];
+        x2128[i+2*M] = x128[j+2];
+        x2128[i+3*M] = x128[j+3];
+      }
+
+      break;
+
+    default:
+      for (i=0,j=0; i<M; i++,j+=5) {
+        x2128[i]     = x128[j];
+        x2128[i+M]   = x128[j+1];
+        x2128[i+2*M] = x128[j+2];
+        x2128[i+3*M] = x128[j+3];
+        x2128[i+4*M] = x128[j+4];
+      }
+
+      break;
+    }
+
+    for (k=0; k<r; k++)
+      dft_plan(M,(int16_t *)(x2128+k*M),(int16_t *)(ytmp128+k*M),p->sub_scale);
+
+    dft_plan_stage(p,ytmp128,y128);
+  }
+
+  if (scale_flag==1) {
+    norm128 = set1_int16(dft_norm_table[p->norm]);
+
+    for (i=0; i<N; i++) {
+      y128[i] = mulhi_int16(y128[i],norm128);
+    }
+  }
+
+  _mm_empty();
+  _m_empty();
+
+}
+
+#ifndef DFT_PLANS
+
 static int16_t tw72[280]__attribute__((aligned(16))) = {32642,-2855,32642,-2855,32642,-2855,32642,-2855,
                                                         32269,-5689,32269,-5689,32269,-5689,32269,-5689,
                                                         31650,-8480,31650,-8480,31650,-8480,31650,-8480,
@@ -4432,13 +5534,7 @@ void dft72(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly2_tw1(ytmp128,ytmp128+36,y128,y128+36);
 
-  for (i=1,j=0; i<36; i++,j++) {
-    bfly2(ytmp128+i,
-          ytmp128+36+i,
-          y128+i,
-          y128+36+i,
-          tw128+j);
-  }
+  bfly2_stage(ytmp128+1,y128+1,tw128,36,35);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[5]);
@@ -4525,13 +5621,7 @@ void dft96(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly2_tw1(ytmp128,ytmp128+48,y128,y128+48);
 
-  for (i=1,j=0; i<48; i++,j++) {
-    bfly2(ytmp128+i,
-          ytmp128+48+i,
-          y128+i,
-          y128+48+i,
-          tw128+j);
-  }
+  bfly2_stage(ytmp128+1,y128+1,tw128,48,47);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[6]);
@@ -4645,17 +5735,7 @@ void dft108(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly3_tw1(ytmp128,ytmp128+36,ytmp128+72,y128,y128+36,y128+72);
 
-  for (i=1,j=0; i<36; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+36+i,
-          ytmp128+72+i,
-          y128+i,
-          y128+36+i,
-          y128+72+i,
-          twa128+j,
-          twb128+j);
-
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,36,35);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[7]);
@@ -4754,13 +5834,7 @@ void dft120(int16_t *x,int16_t *y, unsigned char scale_flag)
 
   bfly2_tw1(ytmp128,ytmp128+60,y128,y128+60);
 
-  for (i=1,j=0; i<60; i++,j++) {
-    bfly2(ytmp128+i,
-          ytmp128+60+i,
-          y128+i,
-          y128+60+i,
-          tw128+j);
-  }
+  bfly2_stage(ytmp128+1,y128+1,tw128,60,59);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[8]);
@@ -4898,16 +5972,7 @@ void dft144(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly3_tw1(ytmp128,ytmp128+48,ytmp128+96,y128,y128+48,y128+96);
 
-  for (i=1,j=0; i<48; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+48+i,
-          ytmp128+96+i,
-          y128+i,
-          y128+48+i,
-          y128+96+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,48,47);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[9]);
@@ -5069,16 +6134,7 @@ void dft180(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly3_tw1(ytmp128,ytmp128+60,ytmp128+120,y128,y128+60,y128+120);
 
-  for (i=1,j=0; i<60; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+60+i,
-          ytmp128+120+i,
-          y128+i,
-          y128+60+i,
-          y128+120+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,60,59);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[10]);
@@ -5268,19 +6324,7 @@ void dft192(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly4_tw1(ytmp128,ytmp128+48,ytmp128+96,ytmp128+144,y128,y128+48,y128+96,y128+144);
 
-  for (i=1,j=0; i<48; i++,j++) {
-    bfly4(ytmp128+i,
-          ytmp128+48+i,
-          ytmp128+96+i,
-          ytmp128+144+i,
-          y128+i,
-          y128+48+i,
-          y128+96+i,
-          y128+144+i,
-          twa128+j,
-          twb128+j,
-          twc128+j);
-  }
+  bfly4_stage(ytmp128+1,y128+1,twa128,twb128,twc128,48,47);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[11]);
@@ -5466,16 +6510,7 @@ void dft216(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly3_tw1(ytmp128,ytmp128+72,ytmp128+144,y128,y128+72,y128+144);
 
-  for (i=1,j=0; i<72; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+72+i,
-          ytmp128+144+i,
-          y128+i,
-          y128+72+i,
-          y128+144+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,72,71);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[12]);
@@ -5701,19 +6736,7 @@ void dft240(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly4_tw1(ytmp128,ytmp128+60,ytmp128+120,ytmp128+180,y128,y128+60,y128+120,y128+180);
 
-  for (i=1,j=0; i<60; i++,j++) {
-    bfly4(ytmp128+i,
-          ytmp128+60+i,
-          ytmp128+120+i,
-          ytmp128+180+i,
-          y128+i,
-          y128+60+i,
-          y128+120+i,
-          y128+180+i,
-          twa128+j,
-          twb128+j,
-          twc128+j);
-  }
+  bfly4_stage(ytmp128+1,y128+1,twa128,twb128,twc128,60,59);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[13]);
@@ -5959,16 +6982,7 @@ void dft288(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly3_tw1(ytmp128,ytmp128+96,ytmp128+192,y128,y128+96,y128+192);
 
-  for (i=1,j=0; i<96; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+96+i,
-          ytmp128+192+i,
-          y128+i,
-          y128+96+i,
-          y128+192+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,96,95);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -6258,22 +7272,7 @@ void dft300(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly5_tw1(ytmp128,ytmp128+60,ytmp128+120,ytmp128+180,ytmp128+240,y128,y128+60,y128+120,y128+180,y128+240);
 
-  for (i=1,j=0; i<60; i++,j++) {
-    bfly5(ytmp128+i,
-          ytmp128+60+i,
-          ytmp128+120+i,
-          ytmp128+180+i,
-          ytmp128+240+i,
-          y128+i,
-          y128+60+i,
-          y128+120+i,
-          y128+180+i,
-          y128+240+i,
-          twa128+j,
-          twb128+j,
-          twc128+j,
-          twd128+j);
-  }
+  bfly5_stage(ytmp128+1,y128+1,twa128,twb128,twc128,twd128,60,59);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[15]);
@@ -6553,16 +7552,7 @@ void dft324(int16_t *x,int16_t *y,unsigned char scale_flag)  // 108 x 3
 
   bfly3_tw1(ytmp128,ytmp128+108,ytmp128+216,y128,y128+108,y128+216);
 
-  for (i=1,j=0; i<108; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+108+i,
-          ytmp128+216+i,
-          y128+i,
-          y128+108+i,
-          y128+216+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,108,107);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -6867,16 +7857,7 @@ void dft360(int16_t *x,int16_t *y,unsigned char scale_flag)  // 120 x 3
 
   bfly3_tw1(ytmp128,ytmp128+120,ytmp128+240,y128,y128+120,y128+240);
 
-  for (i=1,j=0; i<120; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+120+i,
-          ytmp128+240+i,
-          y128+i,
-          y128+120+i,
-          y128+240+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,120,119);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -7242,19 +8223,7 @@ void dft384(int16_t *x,int16_t *y,unsigned char scale_flag)  // 96 x 4
 
   bfly4_tw1(ytmp128,ytmp128+96,ytmp128+192,ytmp128+288,y128,y128+96,y128+192,y128+288);
 
-  for (i=1,j=0; i<96; i++,j++) {
-    bfly4(ytmp128+i,
-          ytmp128+96+i,
-          ytmp128+192+i,
-          ytmp128+288+i,
-          y128+i,
-          y128+96+i,
-          y128+192+i,
-          y128+288+i,
-          twa128+j,
-          twb128+j,
-          twc128+j);
-  }
+  bfly4_stage(ytmp128+1,y128+1,twa128,twb128,twc128,96,95);
 
   if (scale_flag==1) {
     norm128 = set1_int16(16384);//dft_norm_table[13]);
@@ -7656,19 +8625,7 @@ void dft432(int16_t *x,int16_t *y,unsigned char scale_flag)  // 108 x 4
 
   bfly4_tw1(ytmp128,ytmp128+108,ytmp128+216,ytmp128+324,y128,y128+108,y128+216,y128+324);
 
-  for (i=1,j=0; i<108; i++,j++) {
-    bfly4(ytmp128+i,
-          ytmp128+108+i,
-          ytmp128+216+i,
-          ytmp128+324+i,
-          y128+i,
-          y128+108+i,
-          y128+216+i,
-          y128+324+i,
-          twa128+j,
-          twb128+j,
-          twc128+j);
-  }
+  bfly4_stage(ytmp128+1,y128+1,twa128,twb128,twc128,108,107);
 
   if (scale_flag==1) {
     norm128 = set1_int16(16384);//dft_norm_table[13]);
@@ -8106,19 +9063,7 @@ void dft480(int16_t *x,int16_t *y,unsigned char scale_flag)  // 120 x 4
 
   bfly4_tw1(ytmp128,ytmp128+120,ytmp128+240,ytmp128+360,y128,y128+120,y128+240,y128+360);
 
-  for (i=1,j=0; i<120; i++,j++) {
-    bfly4(ytmp128+i,
-          ytmp128+120+i,
-          ytmp128+240+i,
-          ytmp128+360+i,
-          y128+i,
-          y128+120+i,
-          y128+240+i,
-          y128+360+i,
-          twa128+j,
-          twb128+j,
-          twc128+j);
-  }
+  bfly4_stage(ytmp128+1,y128+1,twa128,twb128,twc128,120,119);
 
   if (scale_flag==1) {
     norm128 = set1_int16(16384);//dft_norm_table[13]);
@@ -8544,16 +9489,7 @@ void dft540(int16_t *x,int16_t *y,unsigned char scale_flag)  // 180 x 3
 
   bfly3_tw1(ytmp128,ytmp128+180,ytmp128+360,y128,y128+180,y128+360);
 
-  for (i=1,j=0; i<180; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+180+i,
-          ytmp128+360+i,
-          y128+i,
-          y128+180+i,
-          y128+360+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,180,179);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -9004,16 +9940,7 @@ void dft576(int16_t *x,int16_t *y,unsigned char scale_flag)  // 192 x 3
 
   bfly3_tw1(ytmp128,ytmp128+192,ytmp128+384,y128,y128+192,y128+384);
 
-  for (i=1,j=0; i<192; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+192+i,
-          ytmp128+384+i,
-          y128+i,
-          y128+192+i,
-          y128+384+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,192,191);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -9363,13 +10290,7 @@ void dft600(int16_t *x,int16_t *y,unsigned char scale_flag)  // 300 x 2
 
   bfly2_tw1(ytmp128,ytmp128+300,y128,y128+300);
 
-  for (i=1,j=0; i<300; i++,j++) {
-    bfly2(ytmp128+i,
-          ytmp128+300+i,
-          y128+i,
-          y128+300+i,
-          tw128+j);
-  }
+  bfly2_stage(ytmp128+1,y128+1,tw128,300,299);
 
   if (scale_flag==1) {
     norm128 = set1_int16(ONE_OVER_SQRT2_Q15);
@@ -9867,16 +10788,7 @@ void dft648(int16_t *x,int16_t *y,unsigned char scale_flag)  // 216 x 3
 
   bfly3_tw1(ytmp128,ytmp128+216,ytmp128+432,y128,y128+216,y128+432);
 
-  for (i=1,j=0; i<216; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+216+i,
-          ytmp128+432+i,
-          y128+i,
-          y128+216+i,
-          y128+432+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,216,215);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -10497,19 +11409,7 @@ void dft720(int16_t *x,int16_t *y,unsigned char scale_flag)  // 180 x 4
 
   bfly4_tw1(ytmp128,ytmp128+180,ytmp128+360,ytmp128+540,y128,y128+180,y128+360,y128+540);
 
-  for (i=1,j=0; i<180; i++,j++) {
-    bfly4(ytmp128+i,
-          ytmp128+180+i,
-          ytmp128+360+i,
-          ytmp128+540+i,
-          y128+i,
-          y128+180+i,
-          y128+360+i,
-          y128+540+i,
-          twa128+j,
-          twb128+j,
-          twc128+j);
-  }
+  bfly4_stage(ytmp128+1,y128+1,twa128,twb128,twc128,180,179);
 
   if (scale_flag==1) {
     norm128 = set1_int16(16384);//dft_norm_table[13]);
@@ -11149,16 +12049,7 @@ void dft864(int16_t *x,int16_t *y,unsigned char scale_flag)  // 288 x 3
 
   bfly3_tw1(ytmp128,ytmp128+288,ytmp128+576,y128,y128+288,y128+576);
 
-  for (i=1,j=0; i<288; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+288+i,
-          ytmp128+576+i,
-          y128+i,
-          y128+288+i,
-          y128+576+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,288,287);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -11822,16 +12713,7 @@ void dft900(int16_t *x,int16_t *y,unsigned char scale_flag)  // 300 x 3
 
   bfly3_tw1(ytmp128,ytmp128+300,ytmp128+600,y128,y128+300,y128+600);
 
-  for (i=1,j=0; i<300; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+300+i,
-          ytmp128+600+i,
-          y128+i,
-          y128+300+i,
-          y128+600+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,300,299);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -12631,19 +13513,7 @@ void dft960(int16_t *x,int16_t *y,unsigned char scale_flag)  // 240 x 4
 
   bfly4_tw1(ytmp128,ytmp128+240,ytmp128+480,ytmp128+720,y128,y128+240,y128+480,y128+720);
 
-  for (i=1,j=0; i<240; i++,j++) {
-    bfly4(ytmp128+i,
-          ytmp128+240+i,
-          ytmp128+480+i,
-          ytmp128+720+i,
-          y128+i,
-          y128+240+i,
-          y128+480+i,
-          y128+720+i,
-          twa128+j,
-          twb128+j,
-          twc128+j);
-  }
+  bfly4_stage(ytmp128+1,y128+1,twa128,twb128,twc128,240,239);
 
   if (scale_flag==1) {
     norm128 = set1_int16(16384);//dft_norm_table[13]);
@@ -13355,16 +14225,7 @@ void dft972(int16_t *x,int16_t *y,unsigned char scale_flag)  // 324 x 3
 
   bfly3_tw1(ytmp128,ytmp128+324,ytmp128+648,y128,y128+324,y128+648);
 
-  for (i=1,j=0; i<324; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+324+i,
-          ytmp128+648+i,
-          y128+i,
-          y128+324+i,
-          y128+648+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,324,323);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -14148,16 +15009,7 @@ void dft1080(int16_t *x,int16_t *y,unsigned char scale_flag)  // 360 x 3
 
   bfly3_tw1(ytmp128,ytmp128+360,ytmp128+720,y128,y128+360,y128+720);
 
-  for (i=1,j=0; i<360; i++,j++) {
-    bfly3(ytmp128+i,
-          ytmp128+360+i,
-          ytmp128+720+i,
-          y128+i,
-          y128+360+i,
-          y128+720+i,
-          twa128+j,
-          twb128+j);
-  }
+  bfly3_stage(ytmp128+1,y128+1,twa128,twb128,360,359);
 
   if (scale_flag==1) {
     norm128 = set1_int16(dft_norm_table[14]);
@@ -15101,19 +15953,7 @@ void dft1152(int16_t *x,int16_t *y,unsigned char scale_flag)  // 288 x 4
 
   bfly4_tw1(ytmp128,ytmp128+288,ytmp128+576,ytmp128+864,y128,y128+288,y128+576,y128+864);
 
-  for (i=1,j=0; i<288; i++,j++) {
-    bfly4(ytmp128+i,
-          ytmp128+288+i,
-          ytmp128+576+i,
-          ytmp128+864+i,
-          y128+i,
-          y128+288+i,
-          y128+576+i,
-          y128+864+i,
-          twa128+j,
-          twb128+j,
-          twc128+j);
-  }
+  bfly4_stage(ytmp128+1,y128+1,twa128,twb128,twc128,288,287);
 
   if (scale_flag==1) {
     norm128 = set1_int16(16384);//dft_norm_table[13]);
@@ -16059,19 +16899,7 @@ void dft1200(int16_t *x,int16_t *y,unsigned char scale_flag)
 
   bfly4_tw1(ytmp128,ytmp128+300,ytmp128+600,ytmp128+900,y128,y128+300,y128+600,y128+900);
 
-  for (i=1,j=0; i<300; i++,j++) {
-    bfly4(ytmp128+i,
-          ytmp128+300+i,
-          ytmp128+600+i,
-          ytmp128+900+i,
-          y128+i,
-          y128+300+i,
-          y128+600+i,
-          y128+900+i,
-          twa128+j,
-          twb128+j,
-          twc128+j);
-  }
+  bfly4_stage(ytmp128+1,y128+1,twa128,twb128,twc128,300,299);
 
   if (scale_flag==1) {
     norm128 = set1_int16(16384);//dft_norm_table[13]);
@@ -16087,6 +16915,47 @@ void dft1200(int16_t *x,int16_t *y,unsigned char scale_flag)
 }
 
 
+
+#else // DFT_PLANS
+
+// the unrolled functions and their twiddle tables are replaced by the plan-based transforms
+#define DFT_PLAN_FUNC(N) \
+void dft##N(int16_t *x,int16_t *y,unsigned char scale_flag) \
+{ \
+  dft_plan(N,x,y,scale_flag); \
+}
+
+DFT_PLAN_FUNC(72)
+DFT_PLAN_FUNC(96)
+DFT_PLAN_FUNC(108)
+DFT_PLAN_FUNC(120)
+DFT_PLAN_FUNC(144)
+DFT_PLAN_FUNC(180)
+DFT_PLAN_FUNC(192)
+DFT_PLAN_FUNC(216)
+DFT_PLAN_FUNC(240)
+DFT_PLAN_FUNC(288)
+DFT_PLAN_FUNC(300)
+DFT_PLAN_FUNC(324)
+DFT_PLAN_FUNC(360)
+DFT_PLAN_FUNC(384)
+DFT_PLAN_FUNC(432)
+DFT_PLAN_FUNC(480)
+DFT_PLAN_FUNC(540)
+DFT_PLAN_FUNC(576)
+DFT_PLAN_FUNC(600)
+DFT_PLAN_FUNC(648)
+DFT_PLAN_FUNC(720)
+DFT_PLAN_FUNC(864)
+DFT_PLAN_FUNC(900)
+DFT_PLAN_FUNC(960)
+DFT_PLAN_FUNC(972)
+DFT_PLAN_FUNC(1080)
+DFT_PLAN_FUNC(1152)
+DFT_PLAN_FUNC(1200)
+
+#endif // DFT_PLANS
+
 #ifdef MR_MAIN
 #include <string.h>
 #include <stdio.h>
@@ -16571,6 +17440,62 @@ int main(int argc, char**argv)
   }
 
   printf("\n\n2048-point(%f cycles)\n",(double)ts.diff/(double)ts.trials);
+
+  // DFT-S sizes, unrolled functions against the plan-based transforms (identical with -DDFT_PLANS)
+  {
+    void (*dfts_func[])(int16_t *,int16_t *,unsigned char) = {dft72,dft96,dft108,dft120,dft144,dft180,dft192,dft216,dft240,dft288,dft300,dft324,dft360,dft384,
+                                                               dft432,dft480,dft540,dft576,dft600,dft648,dft720,dft864,dft900,dft960,dft972,dft1080,dft1152,dft1200
+                                                              };
+    uint16_t dfts_size[] = {72,96,108,120,144,180,192,216,240,288,300,324,360,384,432,480,540,576,600,648,720,864,900,960,972,1080,1152,1200};
+    simd_q15_t y2[1200];
+    time_stats_t ts2;
+    int n,nb_sizes = sizeof(dfts_size)/sizeof(dfts_size[0]);
+
+    for (i=0; i<8*1200; i++) {
+      ((int16_t*)x)[i] = (int16_t)((taus()&0xffff))>>5;
+    }
+
+    for (n=0; n<nb_sizes; n++) {
+      reset_meas(&ts);
+      reset_meas(&ts2);
+
+      for (i=0; i<10000; i++) {
+        start_meas(&ts);
+        dfts_func[n]((int16_t *)x,(int16_t *)y,1);
+        stop_meas(&ts);
+        start_meas(&ts2);
+        dft_plan(dfts_size[n],(int16_t *)x,(int16_t *)y2,1);
+        stop_meas(&ts2);
+      }
+
+      printf("%d-point: dft%d %f cycles, dft_plan %f cycles, %s\n",dfts_size[n],dfts_size[n],
+             (double)ts.diff/(double)ts.trials,(double)ts2.diff/(double)ts2.trials,
+             memcmp(y,y2,dfts_size[n]*sizeof(simd_q15_t))==0 ? "bit-exact" : "MISMATCH");
+    }
+
+    // all sizes in turn, as when many Msc_PUSCH are demodulated in one subframe
+    reset_meas(&ts);
+    reset_meas(&ts2);
+
+    for (i=0; i<1000; i++) {
+      start_meas(&ts);
+
+      for (n=0; n<nb_sizes; n++)
+        dfts_func[n]((int16_t *)x,(int16_t *)y,1);
+
+      stop_meas(&ts);
+      start_meas(&ts2);
+
+      for (n=0; n<nb_sizes; n++)
+        dft_plan(dfts_size[n],(int16_t *)x,(int16_t *)y2,1);
+
+      stop_meas(&ts2);
+    }
+
+    printf("\nall DFT-S sizes: dftN %f cycles, dft_plan %f cycles\n",
+           (double)ts.diff/(double)ts.trials,(double)ts2.diff/(double)ts2.trials);
+  }
+
   return(0);
 }
 
@@ -0,0 +1,200 @@
+/*******************************************************************************
+    OpenAirInterface
+    Copyright(c) 1999 - 2014 Eurecom
+
+    OpenAirInterface is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+
+    OpenAirInterface is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with OpenAirInterface.The full GNU General Public License is
+   included in this distribution in the file called "COPYING". If not,
+   see <http://www.gnu.org/licenses/>.
+
+  Contact Information
+  OpenAirInterface Admin: openair_admin@eurecom.fr
+  OpenAirInterface Tech : openair_tech@eurecom.fr
+  OpenAirInterface Dev  : openair4g-devel@eurecom.fr
+
+  Address      : Eurecom, Campus SophiaTech, 450 Route des Chappes, CS 50193 - 06904 Biot Sophia Antipolis cedex, FRANCE
+
+ *******************************************************************************/
+
+/*! \file PHY/TOOLS/simd_dispatch.c
+ * \brief Runtime selection of the SIMD variants of the PHY kernels
+ *
+ * The binary is compiled for a baseline instruction set (C_FLAGS_PROCESSOR). Kernels which also
+ * have variants for a higher level (compiled with target attributes) are selected here
+ * according to the host CPU, once, from phy_init_lte_top().
+ */
+
+#include <string.h>
+#include "PHY/defs.h"
+#include "PHY/extern.h"
+
+#if defined(__AVX2__)
+#define PHY_SIMD_BUILD PHY_SIMD_AVX2
+#elif defined(__SSE4_1__)
+#define PHY_SIMD_BUILD PHY_SIMD_SSE4_1
+#elif defined(__SSSE3__)
+#define PHY_SIMD_BUILD PHY_SIMD_SSSE3
+#elif defined(__SSE2__)
+#define PHY_SIMD_BUILD PHY_SIMD_SSE2
+#elif defined(__arm__) || defined(__aarch64__)
+#define PHY_SIMD_BUILD PHY_SIMD_NEON
+#else
+#define PHY_SIMD_BUILD PHY_SIMD_SCALAR
+#endif
+
+phy_simd_dispatch_t phy_simd = {
+  PHY_SIMD_BUILD,
+  PHY_SIMD_BUILD,
+  PHY_SIMD_BUILD,
+  PHY_SIMD_BUILD,
+  PHY_SIMD_BUILD,
+  PHY_SIMD_BUILD,
+  PHY_SIMD_BUILD,
+  PHY_SIMD_BUILD,
+  PHY_SIMD_BUILD,
+  PHY_SIMD_BUILD,
+  0,
+  phy_threegpplte_turbo_decoder16,
+  phy_threegpplte_turbo_decoder8
+};
+
+static const char *phy_simd_names[] = {"scalar","sse2","ssse3","sse4.1","avx2","neon"};
+
+const char *phy_simd_level_name(phy_simd_level_t level)
+{
+
+  if ((unsigned int)level >= sizeof(phy_simd_names)/sizeof(phy_simd_names[0]))
+    return("unknown");
+
+  return(phy_simd_names[level]);
+}
+
+static phy_simd_level_t phy_simd_host_level(void)
+{
+
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    return(PHY_SIMD_AVX2);
+
+  if (__builtin_cpu_supports("sse4.1"))
+    return(PHY_SIMD_SSE4_1);
+
+  if (__builtin_cpu_supports("ssse3"))
+    return(PHY_SIMD_SSSE3);
+
+  if (__builtin_cpu_supports("sse2"))
+    return(PHY_SIMD_SSE2);
+
+  return(PHY_SIMD_SCALAR);
+#else
+  return(PHY_SIMD_BUILD);
+#endif
+}
+
+// OAI_SIMD lets a deployment cap the level, e.g. to compare the outputs of two variants on the same host
+static phy_simd_level_t phy_simd_max_level(phy_simd_level_t host)
+{
+
+  char *env = getenv("OAI_SIMD");
+  int i;
+
+  if (env == NULL)
+    return(host);
+
+  for (i=PHY_SIMD_SCALAR; i<=PHY_SIMD_AVX2; i++)
+    if (strcmp(env,phy_simd_names[i]) == 0)
+      return((i < host) ? (phy_simd_level_t)i : host);
+
+  LOG_W(PHY,"[INIT] Unknown OAI_SIMD value %s, ignored\n",env);
+  return(host);
+}
+
+void phy_simd_dispatch_init(void)
+{
+
+  phy_simd_level_t max_level;
+
+  phy_simd.build = PHY_SIMD_BUILD;
+  phy_simd.host  = phy_simd_host_level();
+
+  if (phy_simd.host < phy_simd.build)
+    LOG_E(PHY,"[INIT] Binary compiled for %s but the host only supports %s\n",
+          phy_simd_level_name(phy_simd.build),phy_simd_level_name(phy_simd.host));
+
+  max_level = phy_simd_max_level(phy_simd.host);
+
+  // kernels which only exist at the compile-time level
+  phy_simd.chcomp  = phy_simd.build;
+  phy_simd.turbo   = phy_simd.build;
+  phy_simd.turbo_decoder16 = phy_threegpplte_turbo_decoder16;
+  phy_simd.turbo_decoder8  = phy_threegpplte_turbo_decoder8;
+
+  // the 8-bit turbo decoder decodes pairs of code blocks with 256-bit recursions
+  if (td8_set_avx2(max_level >= PHY_SIMD_AVX2 && phy_simd.build != PHY_SIMD_NEON) == 1)
+    phy_simd.turbo = PHY_SIMD_AVX2;
+
+  // dft/idft radix stages have 256-bit versions
+  if (dft_set_avx2(max_level >= PHY_SIMD_AVX2 && phy_simd.build != PHY_SIMD_NEON) == 1)
+    phy_simd.dft = PHY_SIMD_AVX2;
+  else
+    phy_simd.dft = phy_simd.build;
+
+  // 32 bits of the scrambling sequence per 256-bit vector
+  if (scrambling_set_avx2(max_level >= PHY_SIMD_AVX2 && phy_simd.build != PHY_SIMD_NEON) == 1)
+    phy_simd.scrambling = PHY_SIMD_AVX2;
+  else
+    phy_simd.scrambling = phy_simd.build;
+
+  // single-stream 16/64QAM LLRs of 8 REs per 256-bit vector
+  if (llr_set_avx2(max_level >= PHY_SIMD_AVX2 && phy_simd.build != PHY_SIMD_NEON) == 1)
+    phy_simd.llr = PHY_SIMD_AVX2;
+  else
+    phy_simd.llr = phy_simd.build;
+
+  // PDCCH candidates of the same DCI size decoded in pairs, one per 128-bit lane
+  if (viterbi_set_avx2(max_level >= PHY_SIMD_AVX2 && phy_simd.build != PHY_SIMD_NEON) == 1)
+    phy_simd.viterbi = PHY_SIMD_AVX2;
+  else
+    phy_simd.viterbi = phy_simd.build;
+
+  // saturating soft combining of 16 LLRs per instruction
+  if (rm_set_avx2(max_level >= PHY_SIMD_AVX2 && phy_simd.build != PHY_SIMD_NEON) == 1)
+    phy_simd.rate_matching = PHY_SIMD_AVX2;
+  else
+    phy_simd.rate_matching = phy_simd.build;
+
+  // 16 coded bits expanded to 48 output bytes per 256-bit shuffle
+  if (te_set_avx2(max_level >= PHY_SIMD_AVX2 && phy_simd.build != PHY_SIMD_NEON) == 1)
+    phy_simd.turbo_encoder = PHY_SIMD_AVX2;
+  else
+    phy_simd.turbo_encoder = phy_simd.build;
+
+  // carry-less multiply CRC folding, kept off when the level is capped below sse4.1
+  phy_simd.crc_pclmul = crc_set_pclmul(max_level >= PHY_SIMD_SSE4_1 && phy_simd.build != PHY_SIMD_NEON);
+
+  LOG_I(PHY,"[INIT] SIMD dispatch: host %s, build %s, dft %s, llr %s, chcomp %s, turbo %s, viterbi %s, scrambling %s, rate matching %s, turbo encoder %s, crc %s\n",
+        phy_simd_level_name(phy_simd.host),
+        phy_simd_level_name(phy_simd.build),
+        phy_simd_level_name(phy_simd.dft),
+        phy_simd_level_name(phy_simd.llr),
+        phy_simd_level_name(phy_simd.chcomp),
+        phy_simd_level_name(phy_simd.turbo),
+        phy_simd_level_name(phy_simd.viterbi),
+        phy_simd_level_name(phy_simd.scrambling),
+        phy_simd_level_name(phy_simd.rate_matching),
+        phy_simd_level_name(phy_simd.turbo_encoder),
+        (phy_simd.crc_pclmul == 1) ? "pclmul" : "slice8");
+}
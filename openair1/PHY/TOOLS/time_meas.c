@@ -107,6 +107,26 @@ void print_meas(time_stats_t *ts, const char* name, time_stats_t * total_exec_ti
 
 }
 
+void print_count_meas(count_stats_t *cs, const char* name)
+{
+
+  int i,last;
+
+  if (opp_enabled && (cs->trials>0)) {
+    for (last=COUNT_STATS_BINS-1; last>0 && cs->bin[last]==0; last--);
+
+    fprintf(stderr, "%25s:  average %6.2f (%10d trials), histogram",
+            name,
+            (double)cs->sum/cs->trials,
+            cs->trials);
+
+    for (i=0; i<=last; i++)
+      fprintf(stderr, " %d:%u",i,cs->bin[i]);
+
+    fprintf(stderr, "\n");
+  }
+}
+
 double get_time_meas_us(time_stats_t *ts)
 {
 
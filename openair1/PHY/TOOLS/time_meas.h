@@ -26,6 +26,9 @@
   Address      : Eurecom, Campus SophiaTech, 450 Route des Chappes, CS 50193 - 06904 Biot Sophia Antipolis cedex, FRANCE
 
  *******************************************************************************/
+#ifndef __TIME_MEAS_DEFS__H__
+#define __TIME_MEAS_DEFS__H__
+
 #include <unistd.h>
 #include <math.h>
 #include <stdint.h>
@@ -62,12 +65,24 @@ typedef struct {
 } time_stats_t;
 
 #endif
+
+/// number of bins of count_stats_t, larger values go to the last bin
+#define COUNT_STATS_BINS 16
+
+/*! \brief histogram of small integer counts (e.g. decoder iterations) */
+typedef struct {
+  unsigned int bin[COUNT_STATS_BINS];
+  unsigned int trials;
+  unsigned long long sum; /*!< \brief sum of the recorded values, for the average */
+} count_stats_t;
+
 static inline void start_meas(time_stats_t *ts) __attribute__((always_inline));
 static inline void stop_meas(time_stats_t *ts) __attribute__((always_inline));
 
 
 void print_meas_now(time_stats_t *ts, const char* name, int subframe, FILE* file_name);
 void print_meas(time_stats_t *ts, const char* name, time_stats_t * total_exec_time, time_stats_t * sf_exec_time);
+void print_count_meas(count_stats_t *cs, const char* name);
 double get_time_meas_us(time_stats_t *ts);
 double get_cpu_freq_GHz(void);
 
@@ -157,3 +172,56 @@ static inline void copy_meas(time_stats_t *dst_ts,time_stats_t *src_ts)
     dst_ts->max=src_ts->max;
   }
 }
+
+static inline void merge_meas(time_stats_t *dst_ts,time_stats_t *src_ts)
+{
+
+  if (opp_enabled) {
+    dst_ts->trials+=src_ts->trials;
+    dst_ts->diff+=src_ts->diff;
+    dst_ts->diff_square+=src_ts->diff_square;
+
+    if (src_ts->max > dst_ts->max)
+      dst_ts->max=src_ts->max;
+  }
+}
+
+static inline void count_meas(count_stats_t *cs,unsigned int value)
+{
+
+  if (opp_enabled) {
+    cs->trials++;
+    cs->sum+=value;
+    cs->bin[(value < COUNT_STATS_BINS) ? value : COUNT_STATS_BINS-1]++;
+  }
+}
+
+static inline void reset_count_meas(count_stats_t *cs)
+{
+
+  int i;
+
+  if (opp_enabled) {
+    cs->trials=0;
+    cs->sum=0;
+
+    for (i=0; i<COUNT_STATS_BINS; i++)
+      cs->bin[i]=0;
+  }
+}
+
+static inline void merge_count_meas(count_stats_t *dst_cs,count_stats_t *src_cs)
+{
+
+  int i;
+
+  if (opp_enabled) {
+    dst_cs->trials+=src_cs->trials;
+    dst_cs->sum+=src_cs->sum;
+
+    for (i=0; i<COUNT_STATS_BINS; i++)
+      dst_cs->bin[i]+=src_cs->bin[i];
+  }
+}
+
+#endif
@@ -498,6 +498,8 @@ typedef struct {
   uint32_t high_speed_flag;
   uint32_t perfect_ce;
   int16_t ch_est_alpha;
+  /// Wiener smoothing of the pilot LS estimates before interpolation (0 off, 1 on)
+  uint8_t ch_est_wiener;
   UE_SCAN_INFO_t scan_info[NB_BANDS_MAX];
 
   char ulsch_no_allocation_counter[NUMBER_OF_CONNECTED_eNB_MAX];
@@ -642,6 +644,8 @@ typedef struct {
   time_stats_t dlsch_tc_ext_stats;
   time_stats_t dlsch_tc_intl1_stats;
   time_stats_t dlsch_tc_intl2_stats;
+  /// turbo decoder iterations per code block of the PDSCH
+  count_stats_t dlsch_turbo_iterations;
   time_stats_t tx_prach;
 
 #if defined(ENABLE_RAL)
@@ -904,6 +904,21 @@ typedef struct {
   //MIMO_mode_t mimo_mode;
 } LTE_UE_PDSCH_FLP;
 
+/// Max number of PDCCH candidates decoded in a subframe (6 common and 16 UE specific per DCI size, 3 DCI sizes)
+#define MAX_DCI_CANDIDATES 48
+
+/// PDCCH candidate decoded by the UE, reused when the common and UE specific search spaces or two DCI formats overlap
+typedef struct {
+  /// first CCE
+  uint16_t CCEind;
+  /// log2 of the aggregation level
+  uint8_t L;
+  /// DCI size in bits
+  uint8_t sizeof_bits;
+  /// Viterbi output, (MAX_DCI_SIZE_BITS+64)/8 bytes
+  uint8_t decoded_output[16];
+} LTE_UE_DCI_CANDIDATE;
+
 typedef struct {
   /// \brief Pointers to extracted PDCCH symbols in frequency-domain.
   /// - first index: ? [0..7] (hard coded) FIXME! accessed via \c nb_antennas_rx
@@ -951,6 +966,10 @@ typedef struct {
   uint32_t dci_missed;
   /// nCCE for PUCCH per subframe
   uint8_t nCCE[10];
+  /// PDCCH candidates already Viterbi decoded in the current subframe
+  LTE_UE_DCI_CANDIDATE dci_candidates[MAX_DCI_CANDIDATES];
+  /// number of entries of \c dci_candidates
+  int nb_dci_candidates;
 } LTE_UE_PDCCH;
 
 #define PBCH_A 24
@@ -0,0 +1,344 @@
+/*******************************************************************************
+    OpenAirInterface
+    Copyright(c) 1999 - 2014 Eurecom
+
+    OpenAirInterface is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+
+    OpenAirInterface is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with OpenAirInterface.The full GNU General Public License is
+   included in this distribution in the file called "COPYING". If not,
+   see <http://www.gnu.org/licenses/>.
+
+  Contact Information
+  OpenAirInterface Admin: openair_admin@eurecom.fr
+  OpenAirInterface Tech : openair_tech@eurecom.fr
+  OpenAirInterface Dev  : openair4g-devel@eurecom.fr
+
+  Address      : Eurecom, Campus SophiaTech, 450 Route des Chappes, CS 50193 - 06904 Biot Sophia Antipolis cedex, FRANCE
+
+ *******************************************************************************/
+
+/*! \file cb_pool.c
+ * \brief Pool of worker threads decoding the ULSCH and encoding the DLSCH code blocks of a subframe in parallel
+ * \note Each TX/RX thread hands the code blocks of its subframe over as one batch. The
+ *       jobs of a batch are claimed with an atomic increment, by the workers and by
+ *       the TX/RX thread itself, in the order of their priority. The mutex/conditions
+ *       wake up idle workers, publish/retire batches and let the TX/RX thread sleep
+ *       until the last worker holding its batch is done. The TX/RX threads are
+ *       SCHED_FIFO, a yield loop would never let a worker sharing their CPU run.
+ */
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "PHY/defs.h"
+#include "PHY/extern.h"
+#include "SCHED/defs.h"
+#include "UTIL/LOG/log.h"
+#include "assertions.h"
+
+#define CB_POOL_MAX_WORKERS 16
+// one batch per eNB TX and RX thread (one of each per subframe)
+#define CB_POOL_MAX_BATCHES 20
+
+typedef struct {
+  ulsch_decoding_stats_t ulsch;
+  time_stats_t dlsch_rate_matching;
+  time_stats_t dlsch_turbo_encoding;
+  time_stats_t dlsch_interleaving;
+} cb_stats_t;
+
+typedef struct {
+  cb_job_t *job;
+  int nb_jobs;
+  /// next job to be claimed
+  volatile int next;
+  /// number of finished jobs
+  volatile int done;
+  /// number of workers holding a pointer to the batch, protected by the pool mutex
+  int users;
+  /// signaled by the last worker leaving the batch
+  pthread_cond_t cond_done;
+  /// timing of each worker, the last one is the submitting thread
+  cb_stats_t stats[CB_POOL_MAX_WORKERS+1];
+} cb_batch_t;
+
+typedef struct {
+  int id;
+  int cpu;
+  pthread_t thread;
+} cb_worker_t;
+
+static struct {
+  int nb_workers;
+  volatile int exit;
+  cb_worker_t worker[CB_POOL_MAX_WORKERS];
+  cb_batch_t *batch[CB_POOL_MAX_BATCHES];
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+} cb_pool;
+
+static void cb_job_run(cb_job_t *job, cb_stats_t *stats)
+{
+  switch (job->type) {
+  case CB_JOB_ULSCH_DECODING:
+    ulsch_decoding_segments(job->phy_vars_eNB,
+                            job->UE_id,
+                            job->harq_pid,
+                            job->r,
+                            job->nb_segments,
+                            job->llr8_flag,
+                            stats ? &stats->ulsch : NULL);
+    break;
+
+  case CB_JOB_DLSCH_ENCODING:
+    dlsch_encoding_segments(job->dlsch,
+                            job->r,
+                            job->nb_segments,
+                            stats ? &stats->dlsch_rate_matching  : &job->phy_vars_eNB->dlsch_rate_matching_stats,
+                            stats ? &stats->dlsch_turbo_encoding : &job->phy_vars_eNB->dlsch_turbo_encoding_stats,
+                            stats ? &stats->dlsch_interleaving   : &job->phy_vars_eNB->dlsch_interleaving_stats);
+    break;
+  }
+}
+
+static void cb_batch_work(cb_batch_t *batch, cb_stats_t *stats)
+{
+  int j;
+
+  while ((j = __sync_fetch_and_add(&batch->next,1)) < batch->nb_jobs) {
+    cb_job_run(&batch->job[j],stats);
+    __sync_fetch_and_add(&batch->done,1);
+  }
+}
+
+// first published batch with unclaimed jobs, called with the mutex held
+static cb_batch_t *cb_pool_pending(void)
+{
+  int b;
+
+  for (b=0; b<CB_POOL_MAX_BATCHES; b++)
+    if ((cb_pool.batch[b] != NULL) && (__atomic_load_n(&cb_pool.batch[b]->next,__ATOMIC_RELAXED) < cb_pool.batch[b]->nb_jobs))
+      return(cb_pool.batch[b]);
+
+  return(NULL);
+}
+
+static void *cb_worker_thread(void *arg)
+{
+  cb_worker_t *worker = (cb_worker_t *)arg;
+  cb_batch_t *batch = NULL;
+  char name[16];
+  cpu_set_t cpuset;
+
+  snprintf(name,sizeof(name),"cb_worker%d",worker->id);
+  pthread_setname_np(pthread_self(),name);
+
+  if (worker->cpu >= 0) {
+    CPU_ZERO(&cpuset);
+    CPU_SET(worker->cpu,&cpuset);
+
+    if (pthread_setaffinity_np(pthread_self(),sizeof(cpuset),&cpuset) != 0)
+      LOG_E(PHY,"[SCHED][CB] worker %d: cannot pin to CPU %d\n",worker->id,worker->cpu);
+  }
+
+  while (1) {
+    pthread_mutex_lock(&cb_pool.mutex);
+
+    batch = NULL;
+
+    while (cb_pool.exit == 0) {
+      if ((batch = cb_pool_pending()) != NULL)
+        break;
+
+      pthread_cond_wait(&cb_pool.cond,&cb_pool.mutex);
+    }
+
+    if (batch == NULL) {
+      pthread_mutex_unlock(&cb_pool.mutex);
+      break;
+    }
+
+    batch->users++;
+    pthread_mutex_unlock(&cb_pool.mutex);
+
+    cb_batch_work(batch,&batch->stats[worker->id]);
+
+    pthread_mutex_lock(&cb_pool.mutex);
+
+    if (--batch->users == 0)
+      pthread_cond_signal(&batch->cond_done);
+
+    pthread_mutex_unlock(&cb_pool.mutex);
+  }
+
+  return(NULL);
+}
+
+int cb_pool_init(int nb_workers, int first_cpu)
+{
+  int w;
+  int nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  pthread_attr_t attr;
+  struct sched_param sched_param;
+
+  if (nb_workers > CB_POOL_MAX_WORKERS) {
+    LOG_E(PHY,"[SCHED][CB] %d code block workers requested, limiting to %d\n",nb_workers,CB_POOL_MAX_WORKERS);
+    nb_workers = CB_POOL_MAX_WORKERS;
+  }
+
+  // the CPUs below first_cpu are left to the eNB TX/RX threads
+  if (first_cpu == 0) {
+    LOG_E(PHY,"[SCHED][CB] code block workers cannot start at CPU 0, not pinning them\n");
+    first_cpu = -1;
+  }
+
+  pthread_mutex_init(&cb_pool.mutex,NULL);
+  pthread_cond_init(&cb_pool.cond,NULL);
+  cb_pool.exit = 0;
+
+  // just below the eNB TX/RX threads (sched_get_priority_max(SCHED_FIFO)-1), which wait for the workers
+  pthread_attr_init(&attr);
+  pthread_attr_setinheritsched(&attr,PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attr,SCHED_FIFO);
+  sched_param.sched_priority = sched_get_priority_max(SCHED_FIFO)-2;
+  pthread_attr_setschedparam(&attr,&sched_param);
+
+  for (w=0; w<nb_workers; w++) {
+    cb_pool.worker[w].id  = w;
+    // no wrap around, a worker never shares the CPU of a TX/RX thread
+    cb_pool.worker[w].cpu = ((first_cpu < 0) || (first_cpu+w >= nb_cpus)) ? -1 : first_cpu+w;
+
+    if ((first_cpu >= 0) && (cb_pool.worker[w].cpu < 0))
+      LOG_W(PHY,"[SCHED][CB] no CPU left for code block worker %d, not pinning it\n",w);
+
+    if (pthread_create(&cb_pool.worker[w].thread,&attr,cb_worker_thread,&cb_pool.worker[w]) != 0) {
+      LOG_W(PHY,"[SCHED][CB] cannot create code block worker %d with SCHED_FIFO, using the default policy\n",w);
+
+      if (pthread_create(&cb_pool.worker[w].thread,NULL,cb_worker_thread,&cb_pool.worker[w]) != 0) {
+        LOG_E(PHY,"[SCHED][CB] cannot create code block worker %d\n",w);
+        break;
+      }
+    }
+  }
+
+  pthread_attr_destroy(&attr);
+
+  cb_pool.nb_workers = w;
+  LOG_I(PHY,"[SCHED][CB] %d code block workers started (first CPU %d)\n",w,first_cpu);
+
+  return(w);
+}
+
+void cb_pool_free(void)
+{
+  int w;
+
+  if (cb_pool.nb_workers == 0)
+    return;
+
+  pthread_mutex_lock(&cb_pool.mutex);
+  cb_pool.exit = 1;
+  pthread_cond_broadcast(&cb_pool.cond);
+  pthread_mutex_unlock(&cb_pool.mutex);
+
+  for (w=0; w<cb_pool.nb_workers; w++)
+    pthread_join(cb_pool.worker[w].thread,NULL);
+
+  cb_pool.nb_workers = 0;
+  pthread_cond_destroy(&cb_pool.cond);
+  pthread_mutex_destroy(&cb_pool.mutex);
+}
+
+static int cb_job_cmp(const void *a, const void *b)
+{
+  const cb_job_t *ja = (const cb_job_t *)a;
+  const cb_job_t *jb = (const cb_job_t *)b;
+
+  if (ja->priority != jb->priority)
+    return((ja->priority > jb->priority) ? -1 : 1);
+
+  // keep the order of the code blocks of a transport block
+  return((ja->UE_id != jb->UE_id) ? (ja->UE_id - jb->UE_id) : (ja->r - jb->r));
+}
+
+static void cb_merge_stats(PHY_VARS_eNB *phy_vars_eNB, cb_stats_t *stats)
+{
+  merge_meas(&phy_vars_eNB->ulsch_rate_unmatching_stats,&stats->ulsch.rate_unmatching);
+  merge_meas(&phy_vars_eNB->ulsch_deinterleaving_stats,&stats->ulsch.deinterleaving);
+  merge_meas(&phy_vars_eNB->ulsch_turbo_decoding_stats,&stats->ulsch.turbo_decoding);
+  merge_meas(&phy_vars_eNB->ulsch_tc_init_stats,&stats->ulsch.tc_init);
+  merge_meas(&phy_vars_eNB->ulsch_tc_alpha_stats,&stats->ulsch.tc_alpha);
+  merge_meas(&phy_vars_eNB->ulsch_tc_beta_stats,&stats->ulsch.tc_beta);
+  merge_meas(&phy_vars_eNB->ulsch_tc_gamma_stats,&stats->ulsch.tc_gamma);
+  merge_meas(&phy_vars_eNB->ulsch_tc_ext_stats,&stats->ulsch.tc_ext);
+  merge_meas(&phy_vars_eNB->ulsch_tc_intl1_stats,&stats->ulsch.tc_intl1);
+  merge_meas(&phy_vars_eNB->ulsch_tc_intl2_stats,&stats->ulsch.tc_intl2);
+  merge_meas(&phy_vars_eNB->dlsch_rate_matching_stats,&stats->dlsch_rate_matching);
+  merge_meas(&phy_vars_eNB->dlsch_turbo_encoding_stats,&stats->dlsch_turbo_encoding);
+  merge_meas(&phy_vars_eNB->dlsch_interleaving_stats,&stats->dlsch_interleaving);
+}
+
+void cb_pool_run(PHY_VARS_eNB *phy_vars_eNB, cb_job_t *job, int nb_jobs)
+{
+  cb_batch_t batch;
+  int j,b,w;
+
+  if (nb_jobs == 0)
+    return;
+
+  qsort(job,nb_jobs,sizeof(cb_job_t),cb_job_cmp);
+
+  if ((cb_pool.nb_workers == 0) || (nb_jobs == 1)) {
+    for (j=0; j<nb_jobs; j++)
+      cb_job_run(&job[j],NULL);
+
+    return;
+  }
+
+  memset(&batch,0,sizeof(batch));
+  batch.job     = job;
+  batch.nb_jobs = nb_jobs;
+  pthread_cond_init(&batch.cond_done,NULL);
+
+  pthread_mutex_lock(&cb_pool.mutex);
+
+  for (b=0; b<CB_POOL_MAX_BATCHES; b++)
+    if (cb_pool.batch[b] == NULL)
+      break;
+
+  AssertFatal(b<CB_POOL_MAX_BATCHES,"[SCHED][CB] more than %d subframes processed at once\n",CB_POOL_MAX_BATCHES);
+  cb_pool.batch[b] = &batch;
+  pthread_cond_broadcast(&cb_pool.cond);
+  pthread_mutex_unlock(&cb_pool.mutex);
+
+  // the TX/RX thread works as well, then sleeps until the jobs still in the workers are done
+  cb_batch_work(&batch,&batch.stats[CB_POOL_MAX_WORKERS]);
+
+  pthread_mutex_lock(&cb_pool.mutex);
+  cb_pool.batch[b] = NULL;
+
+  // all the jobs are claimed, the ones not done yet are held by a worker. A worker may
+  // also still be about to see that there is nothing left to claim.
+  while (batch.users > 0)
+    pthread_cond_wait(&batch.cond_done,&cb_pool.mutex);
+
+  AssertFatal(batch.done == nb_jobs,"[SCHED][CB] %d/%d code block jobs done\n",batch.done,nb_jobs);
+
+  // the eNB statistics are shared by the TX/RX threads
+  for (w=0; w<=CB_POOL_MAX_WORKERS; w++)
+    cb_merge_stats(phy_vars_eNB,&batch.stats[w]);
+
+  pthread_mutex_unlock(&cb_pool.mutex);
+  pthread_cond_destroy(&batch.cond_done);
+}
@@ -547,7 +547,65 @@ int16_t get_target_pucch_rx_power(module_id_t module_idP, uint8_t CC_id);
 
 int get_ue_active_harq_pid(uint8_t Mod_id,uint8_t CC_id,uint16_t rnti,int frame, uint8_t subframe,uint8_t *harq_pid,uint8_t *round,uint8_t ul_flag);
 
-void ulsch_decoding_procedures(unsigned char last_slot, unsigned int i, PHY_VARS_eNB *phy_vars_eNB, unsigned char abstraction_flag);
+/*! \brief Decodes the code blocks of the ULSCHs prepared by ulsch_decoding_start() for a subframe.
+  The code blocks are decoded by the code block pool (if started), Msg3 and retransmissions first.
+  @param sched_subframe Index of the RX subframe processing
+  @param UE_list Indices of the UEs whose ULSCH was prepared by the calling RX thread
+  @param nb_UE Number of entries of UE_list
+  @param phy_vars_eNB Pointer to eNB variables
+  @param abstraction_flag Indicator of PHY abstraction (nothing to decode)
+*/
+void ulsch_decoding_procedures(unsigned char sched_subframe, uint8_t *UE_list, uint8_t nb_UE, PHY_VARS_eNB *phy_vars_eNB, unsigned char abstraction_flag);
+
+/*! \brief Encodes the code blocks of the DLSCHs prepared by dlsch_encoding_start() for a subframe.
+  The code blocks are encoded by the code block pool (if started), the larger ones first.
+  @param UE_list Indices of the UEs whose DLSCH was prepared by the calling TX thread
+  @param nb_UE Number of entries of UE_list
+  @param phy_vars_eNB Pointer to eNB variables
+  @param abstraction_flag Indicator of PHY abstraction (nothing to encode)
+*/
+void dlsch_encoding_procedures(uint8_t *UE_list, uint8_t nb_UE, PHY_VARS_eNB *phy_vars_eNB, unsigned char abstraction_flag);
+
+typedef enum {
+  CB_JOB_ULSCH_DECODING=0,
+  CB_JOB_DLSCH_ENCODING
+} cb_job_type_t;
+
+/// One code block job: code blocks r..r+nb_segments-1 of the ULSCH transport block of UE_id or of dlsch
+typedef struct {
+  cb_job_type_t type;
+  PHY_VARS_eNB *phy_vars_eNB;
+  /// DLSCH to encode (CB_JOB_DLSCH_ENCODING)
+  LTE_eNB_DLSCH_t *dlsch;
+  uint8_t UE_id;
+  uint8_t harq_pid;
+  uint8_t r;
+  uint8_t nb_segments;
+  uint8_t llr8_flag;
+  /// jobs with a higher priority are run first
+  uint32_t priority;
+} cb_job_t;
+
+/*! \brief Starts the code block workers.
+  @param nb_workers Number of worker threads
+  The workers are SCHED_FIFO, one priority level below the eNB TX/RX threads.
+  @param first_cpu CPU of the first worker, the next ones are pinned to the following CPUs up to the last one (-1: no pinning).
+  The CPUs below first_cpu are left to the eNB TX/RX threads, so first_cpu 0 disables the pinning.
+  @returns the number of workers started
+*/
+int cb_pool_init(int nb_workers, int first_cpu);
+
+/*! \brief Stops the code block workers.
+*/
+void cb_pool_free(void);
+
+/*! \brief Runs a set of code block jobs with the code block workers and the calling thread, returns when all are done.
+  Without workers, the jobs are run by the calling thread.
+  @param phy_vars_eNB Pointer to eNB variables (the timing of the workers is added to its statistics)
+  @param job Jobs to run, sorted by priority
+  @param nb_jobs Number of jobs
+*/
+void cb_pool_run(PHY_VARS_eNB *phy_vars_eNB, cb_job_t *job, int nb_jobs);
 
 void dump_dlsch(PHY_VARS_UE *phy_vars_ue,uint8_t eNB_id,uint8_t subframe,uint8_t harq_pid);
 void dump_dlsch_SI(PHY_VARS_UE *phy_vars_ue,uint8_t eNB_id,uint8_t subframe);
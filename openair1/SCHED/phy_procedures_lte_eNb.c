@@ -1369,6 +1369,47 @@ void phy_eNB_lte_check_measurement_thresholds(instance_t instanceP, ral_threshol
 
 
 
+void dlsch_encoding_procedures(uint8_t *UE_list, uint8_t nb_UE, PHY_VARS_eNB *phy_vars_eNB, unsigned char abstraction_flag)
+{
+  cb_job_t job[NUMBER_OF_UE_MAX*MAX_NUM_DLSCH_SEGMENTS];
+  int nb_jobs = 0;
+  unsigned int n,UE_id,r;
+  LTE_eNB_DLSCH_t *dlsch;
+  LTE_DL_eNB_HARQ_t *dlsch_harq;
+
+  if (abstraction_flag == 1)
+    return;
+
+  // only the DLSCHs of the calling TX thread, another one may be preparing the next subframe
+  for (n=0; n<nb_UE; n++) {
+    UE_id = UE_list[n];
+    dlsch = phy_vars_eNB->dlsch_eNB[UE_id][0];
+
+    if ((dlsch == NULL) || (dlsch->rnti == 0) || (dlsch->harq_processes[dlsch->current_harq_pid]->cb_pending == 0))
+      continue;
+
+    dlsch_harq = dlsch->harq_processes[dlsch->current_harq_pid];
+
+    for (r=0; r<dlsch_harq->C; r++) {
+      job[nb_jobs].type         = CB_JOB_DLSCH_ENCODING;
+      job[nb_jobs].phy_vars_eNB = phy_vars_eNB;
+      job[nb_jobs].dlsch        = dlsch;
+      job[nb_jobs].UE_id        = UE_id;
+      job[nb_jobs].harq_pid     = dlsch->current_harq_pid;
+      job[nb_jobs].r            = r;
+      job[nb_jobs].nb_segments  = 1;
+      job[nb_jobs].llr8_flag    = 0;
+      // larger code blocks first, so that the small ones fill the gaps at the end
+      job[nb_jobs].priority     = (r<dlsch_harq->Cminus) ? dlsch_harq->Kminus : dlsch_harq->Kplus;
+      nb_jobs++;
+    }
+
+    dlsch_harq->cb_pending = 0;
+  }
+
+  cb_pool_run(phy_vars_eNB,job,nb_jobs);
+}
+
 void phy_procedures_eNB_TX(unsigned char sched_subframe,PHY_VARS_eNB *phy_vars_eNB,uint8_t abstraction_flag,
                            relaying_type_t r_type,PHY_VARS_RN *phy_vars_rn)
 {
@@ -1384,6 +1425,8 @@ void phy_procedures_eNB_TX(unsigned char sched_subframe,PHY_VARS_eNB *phy_vars_e
   uint8_t DLSCH_pdu_tmp[768*8];
 #endif
   int8_t UE_id;
+  // UEs whose DLSCH is scrambled and modulated once all the code blocks are encoded
+  uint8_t dlsch_UE_list[NUMBER_OF_UE_MAX],nb_dlsch_UE=0,j;
   uint8_t num_pdcch_symbols=0;
   uint8_t ul_subframe;
   uint32_t ul_frame;
@@ -2393,6 +2436,7 @@ void phy_procedures_eNB_TX(unsigned char sched_subframe,PHY_VARS_eNB *phy_vars_e
   }
 
   // Now scan UE specific DLSCH
+
   for (UE_id=0; UE_id<NUMBER_OF_UE_MAX; UE_id++)
   {
     if ((phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0])&&
@@ -2492,51 +2536,15 @@ void phy_procedures_eNB_TX(unsigned char sched_subframe,PHY_VARS_eNB *phy_vars_e
 
       if (abstraction_flag==0) {
 
-        // 36-212
+        // 36-212, the code blocks of all the UEs are encoded together by dlsch_encoding_procedures()
         start_meas(&phy_vars_eNB->dlsch_encoding_stats);
-        dlsch_encoding(DLSCH_pdu,
-                       &phy_vars_eNB->lte_frame_parms,
-                       num_pdcch_symbols,
-                       phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0],
-                       phy_vars_eNB->proc[sched_subframe].frame_tx,subframe,
-                       &phy_vars_eNB->dlsch_rate_matching_stats,
-                       &phy_vars_eNB->dlsch_turbo_encoding_stats,
-                       &phy_vars_eNB->dlsch_interleaving_stats);
+        dlsch_encoding_start(DLSCH_pdu,
+                             &phy_vars_eNB->lte_frame_parms,
+                             num_pdcch_symbols,
+                             phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0],
+                             phy_vars_eNB->proc[sched_subframe].frame_tx,subframe);
         stop_meas(&phy_vars_eNB->dlsch_encoding_stats);
-        // 36-211
-        start_meas(&phy_vars_eNB->dlsch_scrambling_stats);
-        dlsch_scrambling(&phy_vars_eNB->lte_frame_parms,
-                         0,
-                         phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0],
-                         get_G(&phy_vars_eNB->lte_frame_parms,
-                               phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->nb_rb,
-                               phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->rb_alloc,
-                               get_Qm(phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->mcs),
-                               phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->Nl,
-                               num_pdcch_symbols,phy_vars_eNB->proc[sched_subframe].frame_tx,subframe),
-                         0,
-                         subframe<<1);
-        stop_meas(&phy_vars_eNB->dlsch_scrambling_stats);
-        start_meas(&phy_vars_eNB->dlsch_modulation_stats);
-        //for (sect_id=0;sect_id<number_of_cards;sect_id++) {
-
-        /*          if ((phy_vars_eNB->transmission_mode[(uint8_t)UE_id] == 5) &&
-              (phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->dl_power_off == 0))
-              amp = (int16_t)(((int32_t)AMP*(int32_t)ONE_OVER_SQRT2_Q15)>>15);
-              else*/
-        //              amp = AMP;
-        //      if (UE_id == 1)
-        //      LOG_I(PHY,"[MYEMOS] MCS_i %d\n", phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->mcs);
-
-        re_allocated = dlsch_modulation(phy_vars_eNB->lte_eNB_common_vars.txdataF[0],
-                                        AMP,
-                                        subframe,
-                                        &phy_vars_eNB->lte_frame_parms,
-                                        num_pdcch_symbols,
-                                        phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0],
-                                        phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][1]);
-
-        stop_meas(&phy_vars_eNB->dlsch_modulation_stats);
+        dlsch_UE_list[nb_dlsch_UE++] = (uint8_t)UE_id;
       }
 
 #ifdef PHY_ABSTRACTION
@@ -2549,7 +2557,8 @@ void phy_procedures_eNB_TX(unsigned char sched_subframe,PHY_VARS_eNB *phy_vars_e
       }
 
 #endif
-      phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->active = 0;
+      if (abstraction_flag==1)
+        phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->active = 0;
 
       //mac_xface->macphy_exit("first dlsch transmitted\n");
     }
@@ -2568,6 +2577,54 @@ void phy_procedures_eNB_TX(unsigned char sched_subframe,PHY_VARS_eNB *phy_vars_e
 
 
 
+  if (abstraction_flag==0) {
+    start_meas(&phy_vars_eNB->dlsch_encoding_stats);
+    dlsch_encoding_procedures(dlsch_UE_list,nb_dlsch_UE,phy_vars_eNB,abstraction_flag);
+    stop_meas(&phy_vars_eNB->dlsch_encoding_stats);
+
+    for (j=0; j<nb_dlsch_UE; j++) {
+      UE_id = dlsch_UE_list[j];
+      harq_pid = phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->current_harq_pid;
+
+      // 36-211
+      start_meas(&phy_vars_eNB->dlsch_scrambling_stats);
+      dlsch_scrambling(&phy_vars_eNB->lte_frame_parms,
+                       0,
+                       phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0],
+                       get_G(&phy_vars_eNB->lte_frame_parms,
+                             phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->nb_rb,
+                             phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->rb_alloc,
+                             get_Qm(phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->mcs),
+                             phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->Nl,
+                             num_pdcch_symbols,phy_vars_eNB->proc[sched_subframe].frame_tx,subframe),
+                       0,
+                       subframe<<1);
+      stop_meas(&phy_vars_eNB->dlsch_scrambling_stats);
+      start_meas(&phy_vars_eNB->dlsch_modulation_stats);
+      //for (sect_id=0;sect_id<number_of_cards;sect_id++) {
+
+      /*          if ((phy_vars_eNB->transmission_mode[(uint8_t)UE_id] == 5) &&
+            (phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->dl_power_off == 0))
+            amp = (int16_t)(((int32_t)AMP*(int32_t)ONE_OVER_SQRT2_Q15)>>15);
+            else*/
+      //              amp = AMP;
+      //      if (UE_id == 1)
+      //      LOG_I(PHY,"[MYEMOS] MCS_i %d\n", phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->harq_processes[harq_pid]->mcs);
+
+      re_allocated = dlsch_modulation(phy_vars_eNB->lte_eNB_common_vars.txdataF[0],
+                                      AMP,
+                                      subframe,
+                                      &phy_vars_eNB->lte_frame_parms,
+                                      num_pdcch_symbols,
+                                      phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0],
+                                      phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][1]);
+
+      stop_meas(&phy_vars_eNB->dlsch_modulation_stats);
+
+      phy_vars_eNB->dlsch_eNB[(uint8_t)UE_id][0]->active = 0;
+    }
+  }
+
   // if we have PHICH to generate
   //    printf("[PHY][eNB] Frame %d subframe %d Checking for phich\n",phy_vars_eNB->proc[sched_subframe].frame_tx,subframe);
   if (is_phich_subframe(&phy_vars_eNB->lte_frame_parms,subframe))
@@ -3052,6 +3109,53 @@ void get_n1_pucch_eNB(PHY_VARS_eNB *phy_vars_eNB,
   }
 }
 
+#ifdef PUCCH
+
+static PUCCH_FMT_t get_pucch_AN_format(PHY_VARS_eNB *phy_vars_eNB,uint8_t UE_id,int subframe)
+{
+
+  LTE_DL_FRAME_PARMS *frame_parms=&phy_vars_eNB->lte_frame_parms;
+  ANFBmode_t bundling_flag = phy_vars_eNB->pucch_config_dedicated[UE_id].tdd_AckNackFeedbackMode;
+
+  // fix later for 2 TB case and format1b
+
+  if ((frame_parms->frame_type==FDD) ||
+      (bundling_flag==bundling)    ||
+      ((frame_parms->frame_type==TDD)&&(frame_parms->tdd_config==1)&&((subframe!=2)||(subframe!=7)))) {
+    return(pucch_format1a);
+  } else {
+    return(pucch_format1b);
+  }
+}
+
+static void pucch_rx_request(LTE_eNB_PUCCH_t *pucch,PUCCH_FMT_t fmt,uint8_t UE_id,uint16_t n1_pucch,uint8_t pucch1_thres)
+{
+
+  pucch->fmt              = fmt;
+  pucch->UE_id            = UE_id;
+  pucch->n1_pucch         = n1_pucch;
+  pucch->n2_pucch         = 0;
+  pucch->shortened_format = 1;
+  pucch->pucch1_thres     = pucch1_thres;
+  pucch->payload[0]       = 0;
+  pucch->payload[1]       = 0;
+  pucch->stat             = 0;
+}
+
+// payload and metric of a request served by rx_pucch_multi, as rx_pucch would have returned them
+static int16_t pucch_rx_result(LTE_eNB_PUCCH_t *pucch,uint8_t *payload)
+{
+
+  payload[0] = pucch->payload[0];
+
+  if (pucch->fmt == pucch_format1b)
+    payload[1] = pucch->payload[1];
+
+  return((int16_t)pucch->stat);
+}
+
+#endif
+
 void prach_procedures(PHY_VARS_eNB *phy_vars_eNB,uint8_t sched_subframe,uint8_t abstraction_flag)
 {
 
@@ -3178,13 +3282,49 @@ void prach_procedures(PHY_VARS_eNB *phy_vars_eNB,uint8_t sched_subframe,uint8_t
   }
 }
 
-void ulsch_decoding_procedures(unsigned char subframe, unsigned int i, PHY_VARS_eNB *phy_vars_eNB, unsigned char abstraction_flag)
+void ulsch_decoding_procedures(unsigned char sched_subframe, uint8_t *UE_list, uint8_t nb_UE, PHY_VARS_eNB *phy_vars_eNB, unsigned char abstraction_flag)
 {
-  UNUSED(subframe);
-  UNUSED(i);
-  UNUSED(phy_vars_eNB);
-  UNUSED(abstraction_flag);
-  LOG_D(PHY,"ulsch_decoding_procedures not yet implemented. should not be called");
+  cb_job_t job[NUMBER_OF_UE_MAX*MAX_NUM_ULSCH_SEGMENTS];
+  int nb_jobs = 0;
+  unsigned int n,UE_id,r;
+  LTE_eNB_ULSCH_t *ulsch;
+  LTE_UL_eNB_HARQ_t *ulsch_harq;
+  uint8_t harq_pid = subframe2harq_pid(&phy_vars_eNB->lte_frame_parms,
+                                       phy_vars_eNB->proc[sched_subframe].frame_rx,
+                                       phy_vars_eNB->proc[sched_subframe].subframe_rx);
+
+  if ((abstraction_flag == 1) || (harq_pid == 255))
+    return;
+
+  // only the ULSCHs of the calling RX thread, another one may be decoding the previous subframe
+  for (n=0; n<nb_UE; n++) {
+    UE_id = UE_list[n];
+    ulsch = phy_vars_eNB->ulsch_eNB[UE_id];
+
+    if ((ulsch == NULL) || (ulsch->rnti == 0) || (ulsch->harq_processes[harq_pid]->cb_pending == 0))
+      continue;
+
+    ulsch_harq = ulsch->harq_processes[harq_pid];
+
+    for (r=0; r<ulsch_harq->C; r++) {
+      job[nb_jobs].type         = CB_JOB_ULSCH_DECODING;
+      job[nb_jobs].phy_vars_eNB = phy_vars_eNB;
+      job[nb_jobs].dlsch        = NULL;
+      job[nb_jobs].UE_id        = UE_id;
+      job[nb_jobs].harq_pid     = harq_pid;
+      job[nb_jobs].r            = r;
+      job[nb_jobs].nb_segments  = 1;
+      job[nb_jobs].llr8_flag    = 0;
+      // Msg3 first (the RA procedure gives up after a few attempts), then the
+      // retransmissions closest to the last HARQ round, then the larger code blocks
+      job[nb_jobs].priority     = ((uint32_t)ulsch->Msg3_flag<<24) +
+                                  ((uint32_t)ulsch_harq->round<<16) +
+                                  ((r<ulsch_harq->Cminus) ? ulsch_harq->Kminus : ulsch_harq->Kplus);
+      nb_jobs++;
+    }
+  }
+
+  cb_pool_run(phy_vars_eNB,job,nb_jobs);
 }
 
 
@@ -3193,7 +3333,7 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
 {
   //RX processing
   UNUSED(r_type);
-  uint32_t l, ret=0,i,j,k,aa;
+  uint32_t ret=0,i,j,k,aa;
   uint32_t sect_id=0;
   uint32_t harq_pid, harq_idx, round;
   uint8_t SR_payload = 0,*pucch_payload=NULL,pucch_payload0[2]= {0,0},pucch_payload1[2]= {0,0};
@@ -3204,6 +3344,12 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
   ANFBmode_t bundling_flag;
   PUCCH_FMT_t format;
   uint8_t nPRS;
+  uint32_t ulsch_ret[NUMBER_OF_UE_MAX];
+  uint8_t ulsch_UE_list[NUMBER_OF_UE_MAX],nb_ulsch_UE=0;
+  LTE_eNB_PUCCH_t pucch_rx[3*NUMBER_OF_UE_MAX];
+  int16_t pucch_rx_SR[NUMBER_OF_UE_MAX],pucch_rx_AN0[NUMBER_OF_UE_MAX],pucch_rx_AN1[NUMBER_OF_UE_MAX];
+  int16_t pucch_n1[NUMBER_OF_UE_MAX][2];
+  int nb_pucch_rx=0,nb_pucch_SR=0;
   //  uint8_t two_ues_connected = 0;
   uint8_t pusch_active = 0;
   LTE_DL_FRAME_PARMS *frame_parms=&phy_vars_eNB->lte_frame_parms;
@@ -3228,11 +3374,6 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
 	    phy_vars_eNB->lte_frame_parms.samples_per_tti);
 #endif
 
-  if (abstraction_flag == 0) {
-    remove_7_5_kHz(phy_vars_eNB,subframe<<1);
-    remove_7_5_kHz(phy_vars_eNB,(subframe<<1)+1);
-  }
-
   // check if we have to detect PRACH first
   if (is_prach_subframe(&phy_vars_eNB->lte_frame_parms,frame,subframe)>0) {
     VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_PHY_ENB_PRACH_RX,1);
@@ -3243,24 +3384,19 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
   if (abstraction_flag == 0) {
     start_meas(&phy_vars_eNB->ofdm_demod_stats);
 
-    for (l=0; l<phy_vars_eNB->lte_frame_parms.symbols_per_tti/2; l++) {
-
-      //      for (sect_id=0;sect_id<number_of_cards;sect_id++) {
-      slot_fep_ul(&phy_vars_eNB->lte_frame_parms,
-                  &phy_vars_eNB->lte_eNB_common_vars,
-                  l,
-                  subframe<<1,
-                  0,
-                  0
-                 );
-      slot_fep_ul(&phy_vars_eNB->lte_frame_parms,
-                  &phy_vars_eNB->lte_eNB_common_vars,
-                  l,
-                  (subframe<<1)+1,
-                  0,
-                  0
-                 );
-    }
+#ifndef OFDMA_ULSCH
+    // 7.5 kHz shift removed while the symbols are copied to the dft input
+    slot_fep_ul_subframe_7_5kHz(phy_vars_eNB,
+                                subframe,
+                                0);
+#else
+    slot_fep_ul_subframe(&phy_vars_eNB->lte_frame_parms,
+                         &phy_vars_eNB->lte_eNB_common_vars,
+                         subframe,
+                         0,
+                         0
+                        );
+#endif
 
     stop_meas(&phy_vars_eNB->ofdm_demod_stats);
   }
@@ -3343,6 +3479,8 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
 
   //  LOG_I(PHY,"subframe %d: nPRS %d\n",last_slot>>1,phy_vars_eNB->lte_frame_parms.pusch_config_common.ul_ReferenceSignalsPUSCH.nPRS[last_slot-1]);
 
+  // First pass: list the scheduled ULSCHs, which are then demodulated together and have
+  // their code blocks prepared, so that the code blocks of all the UEs are decoded together below
   for (i=0; i<NUMBER_OF_UE_MAX; i++) {
 
     /*
@@ -3355,53 +3493,12 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
 
 #endif
 
-    /*
-    #ifdef DEBUG_PHY_PROC
-    if (phy_vars_eNB->ulsch_eNB[i]) {
-
-      LOG_D(PHY,"[eNB %d][PUSCH %d] frame %d, subframe %d rnti %x, alloc %d, Msg3 %d\n",phy_vars_eNB->Mod_id,
-      harq_pid,frame,subframe,
-      (phy_vars_eNB->ulsch_eNB[i]->rnti),
-      (phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->subframe_scheduling_flag),
-      (phy_vars_eNB->ulsch_eNB[i]->Msg3_flag)
-      );
-    }
-    #endif
-    */
+    ulsch_ret[i] = 0;
 
     if ((phy_vars_eNB->ulsch_eNB[i]) &&
         (phy_vars_eNB->ulsch_eNB[i]->rnti>0) &&
         (phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->subframe_scheduling_flag==1)) {
 
-      pusch_active = 1;
-      round = phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->round;
-
-#ifdef DEBUG_PHY_PROC
-      LOG_D(PHY,"[eNB %d][PUSCH %d] frame %d subframe %d Scheduling PUSCH/ULSCH Reception for rnti %x (UE_id %d)\n",
-            phy_vars_eNB->Mod_id,harq_pid,
-            frame,subframe,phy_vars_eNB->ulsch_eNB[i]->rnti,i);
-#endif
-
-#ifdef DEBUG_PHY_PROC
-
-      if (phy_vars_eNB->ulsch_eNB[i]->Msg3_flag == 1) {
-        LOG_D(PHY,"[eNB %d] frame %d, subframe %d: Scheduling ULSCH Reception for Msg3 in Sector %d\n",
-              phy_vars_eNB->Mod_id,
-              frame,
-              subframe,
-              phy_vars_eNB->eNB_UE_stats[i].sector);
-      } else {
-        LOG_D(PHY,"[eNB %d] frame %d, subframe %d: Scheduling ULSCH Reception for UE %d Mode %s sect_id %d\n",
-              phy_vars_eNB->Mod_id,
-              frame,
-              subframe,
-              i,
-              mode_string[phy_vars_eNB->eNB_UE_stats[i].mode],
-              phy_vars_eNB->eNB_UE_stats[i].sector);
-      }
-
-#endif
-
       nPRS = phy_vars_eNB->lte_frame_parms.pusch_config_common.ul_ReferenceSignalsPUSCH.nPRS[subframe<<1];
 
       phy_vars_eNB->ulsch_eNB[i]->cyclicShift = (phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->n_DMRS2 + phy_vars_eNB->lte_frame_parms.pusch_config_common.ul_ReferenceSignalsPUSCH.cyclicShift +
@@ -3435,50 +3532,200 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
             nPRS,
             phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->O_ACK);
 #endif
-      start_meas(&phy_vars_eNB->ulsch_demodulation_stats);
+      ulsch_UE_list[nb_ulsch_UE++] = i;
+    }
+  }
 
-      if (abstraction_flag==0) {
-        rx_ulsch(phy_vars_eNB,
-                 sched_subframe,
-                 phy_vars_eNB->eNB_UE_stats[i].sector,  // this is the effective sector id
-                 i,
-                 phy_vars_eNB->ulsch_eNB,
-                 0);
-      }
+  start_meas(&phy_vars_eNB->ulsch_demodulation_stats);
+
+  if (abstraction_flag==0) {
+    // all the scheduled UEs go through the receiver front-end together
+    rx_ulsch_multi(phy_vars_eNB,
+                   sched_subframe,
+                   ulsch_UE_list,
+                   nb_ulsch_UE,
+                   phy_vars_eNB->ulsch_eNB);
+  }
 
 #ifdef PHY_ABSTRACTION
-      else {
-        rx_ulsch_emul(phy_vars_eNB,
-                      subframe,
-                      phy_vars_eNB->eNB_UE_stats[i].sector,  // this is the effective sector id
-                      i);
-      }
+  else {
+    for (j=0; j<nb_ulsch_UE; j++)
+      rx_ulsch_emul(phy_vars_eNB,
+                    subframe,
+                    phy_vars_eNB->eNB_UE_stats[ulsch_UE_list[j]].sector,  // this is the effective sector id
+                    ulsch_UE_list[j]);
+  }
 
 #endif
-      stop_meas(&phy_vars_eNB->ulsch_demodulation_stats);
+  stop_meas(&phy_vars_eNB->ulsch_demodulation_stats);
 
+  for (j=0; j<nb_ulsch_UE; j++) {
+    i = ulsch_UE_list[j];
 
-      start_meas(&phy_vars_eNB->ulsch_decoding_stats);
+    start_meas(&phy_vars_eNB->ulsch_decoding_stats);
 
-      if (abstraction_flag == 0) {
-        ret = ulsch_decoding(phy_vars_eNB,
-                             i,
-                             sched_subframe,
-                             0, // control_only_flag
-                             phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->V_UL_DAI,
-                             0);
-      }
+    if (abstraction_flag == 0) {
+      ulsch_ret[i] = ulsch_decoding_start(phy_vars_eNB,
+                                          i,
+                                          sched_subframe,
+                                          0, // control_only_flag
+                                          phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->V_UL_DAI);
+    }
 
 #ifdef PHY_ABSTRACTION
-      else {
-        ret = ulsch_decoding_emul(phy_vars_eNB,
-                                  sched_subframe,
-                                  i,
-                                  &rnti);
+    else {
+      ulsch_ret[i] = ulsch_decoding_emul(phy_vars_eNB,
+                                         sched_subframe,
+                                         i,
+                                         &rnti);
+    }
+
+#endif
+    stop_meas(&phy_vars_eNB->ulsch_decoding_stats);
+  }
+
+  VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_PHY_ENB_ULSCH_DECODING,1);
+  start_meas(&phy_vars_eNB->ulsch_decoding_stats);
+  ulsch_decoding_procedures(sched_subframe,ulsch_UE_list,nb_ulsch_UE,phy_vars_eNB,abstraction_flag);
+  stop_meas(&phy_vars_eNB->ulsch_decoding_stats);
+  VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(VCD_SIGNAL_DUMPER_FUNCTIONS_PHY_ENB_ULSCH_DECODING,0);
+
+#ifdef PUCCH
+
+  // The PUCCH of the UEs without PUSCH in this subframe is detected here for all of them together,
+  // first the SRs and then the ACK/NAKs, whose resource depends on the SR. The loop below picks up the results.
+  if (abstraction_flag == 0) {
+    for (i=0; i<NUMBER_OF_UE_MAX; i++) {
+      pucch_rx_SR[i]  = -1;
+      pucch_rx_AN0[i] = -1;
+      pucch_rx_AN1[i] = -1;
+      pucch_n1[i][0]  = -1;
+      pucch_n1[i][1]  = -1;
+
+      if (((phy_vars_eNB->ulsch_eNB[i]) &&
+           (phy_vars_eNB->ulsch_eNB[i]->rnti>0) &&
+           (phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->subframe_scheduling_flag==1)) ||
+          (phy_vars_eNB->dlsch_eNB[i][0]==NULL) ||
+          (phy_vars_eNB->dlsch_eNB[i][0]->rnti==0))
+        continue;
+
+      if (is_SR_subframe(phy_vars_eNB,i,sched_subframe) == 1) {
+        pucch_rx_SR[i] = nb_pucch_rx;
+        pucch_rx_request(&pucch_rx[nb_pucch_rx++],
+                         pucch_format1,
+                         i,
+                         phy_vars_eNB->scheduling_request_config[i].sr_PUCCH_ResourceIndex,
+                         PUCCH1_THRES);
+      }
+
+      get_n1_pucch_eNB(phy_vars_eNB,
+                       i,
+                       sched_subframe,
+                       &pucch_n1[i][0],
+                       &pucch_n1[i][1],
+                       &n1_pucch2,
+                       &n1_pucch3);
+    }
+
+    nb_pucch_SR = nb_pucch_rx;
+    rx_pucch_multi(phy_vars_eNB,pucch_rx,nb_pucch_SR,subframe);
+
+    for (i=0; i<NUMBER_OF_UE_MAX; i++) {
+      if ((pucch_n1[i][0]==-1) && (pucch_n1[i][1]==-1))
+        continue;
+
+      SR_payload = (pucch_rx_SR[i] == -1) ? 0 : pucch_rx[pucch_rx_SR[i]].payload[0];
+
+      if (frame_parms->frame_type == FDD) {
+        // if SR was detected, use the n1_pucch from SR, else use n1_pucch0
+        pucch_rx_AN0[i] = nb_pucch_rx;
+        pucch_rx_request(&pucch_rx[nb_pucch_rx++],
+                         pucch_format1a,
+                         i,
+                         (SR_payload==1) ? phy_vars_eNB->scheduling_request_config[i].sr_PUCCH_ResourceIndex : (uint16_t)pucch_n1[i][0],
+                         PUCCH1a_THRES);
+      } else {
+        format = get_pucch_AN_format(phy_vars_eNB,i,subframe);
+
+        if (SR_payload == 1) {
+          pucch_rx_AN0[i] = nb_pucch_rx;
+          pucch_rx_request(&pucch_rx[nb_pucch_rx++],
+                           format,
+                           i,
+                           phy_vars_eNB->scheduling_request_config[i].sr_PUCCH_ResourceIndex,
+                           PUCCH1a_THRES);
+        } else {
+          if (pucch_n1[i][0] != -1) {
+            pucch_rx_AN0[i] = nb_pucch_rx;
+            pucch_rx_request(&pucch_rx[nb_pucch_rx++],format,i,(uint16_t)pucch_n1[i][0],PUCCH1a_THRES);
+          }
+
+          if (pucch_n1[i][1] != -1) {
+            pucch_rx_AN1[i] = nb_pucch_rx;
+            pucch_rx_request(&pucch_rx[nb_pucch_rx++],format,i,(uint16_t)pucch_n1[i][1],PUCCH1a_THRES);
+          }
+        }
+      }
+    }
+
+    rx_pucch_multi(phy_vars_eNB,&pucch_rx[nb_pucch_SR],nb_pucch_rx-nb_pucch_SR,subframe);
+  }
+
+#endif
+
+  for (i=0; i<NUMBER_OF_UE_MAX; i++) {
+
+    /*
+    #ifdef DEBUG_PHY_PROC
+    if (phy_vars_eNB->ulsch_eNB[i]) {
+
+      LOG_D(PHY,"[eNB %d][PUSCH %d] frame %d, subframe %d rnti %x, alloc %d, Msg3 %d\n",phy_vars_eNB->Mod_id,
+      harq_pid,frame,subframe,
+      (phy_vars_eNB->ulsch_eNB[i]->rnti),
+      (phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->subframe_scheduling_flag),
+      (phy_vars_eNB->ulsch_eNB[i]->Msg3_flag)
+      );
+    }
+    #endif
+    */
+
+    if ((phy_vars_eNB->ulsch_eNB[i]) &&
+        (phy_vars_eNB->ulsch_eNB[i]->rnti>0) &&
+        (phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->subframe_scheduling_flag==1)) {
+
+      pusch_active = 1;
+      round = phy_vars_eNB->ulsch_eNB[i]->harq_processes[harq_pid]->round;
+
+#ifdef DEBUG_PHY_PROC
+      LOG_D(PHY,"[eNB %d][PUSCH %d] frame %d subframe %d Scheduling PUSCH/ULSCH Reception for rnti %x (UE_id %d)\n",
+            phy_vars_eNB->Mod_id,harq_pid,
+            frame,subframe,phy_vars_eNB->ulsch_eNB[i]->rnti,i);
+#endif
+
+#ifdef DEBUG_PHY_PROC
+
+      if (phy_vars_eNB->ulsch_eNB[i]->Msg3_flag == 1) {
+        LOG_D(PHY,"[eNB %d] frame %d, subframe %d: Scheduling ULSCH Reception for Msg3 in Sector %d\n",
+              phy_vars_eNB->Mod_id,
+              frame,
+              subframe,
+              phy_vars_eNB->eNB_UE_stats[i].sector);
+      } else {
+        LOG_D(PHY,"[eNB %d] frame %d, subframe %d: Scheduling ULSCH Reception for UE %d Mode %s sect_id %d\n",
+              phy_vars_eNB->Mod_id,
+              frame,
+              subframe,
+              i,
+              mode_string[phy_vars_eNB->eNB_UE_stats[i].mode],
+              phy_vars_eNB->eNB_UE_stats[i].sector);
       }
 
 #endif
-      stop_meas(&phy_vars_eNB->ulsch_decoding_stats);
+
+      if ((abstraction_flag == 0) && (ulsch_ret[i] == 0))
+        ret = ulsch_decoding_reassembly(phy_vars_eNB,i,harq_pid);
+      else
+        ret = ulsch_ret[i];
 
 #ifdef DEBUG_PHY_PROC
       LOG_D(PHY,"[eNB %d][PUSCH %d] frame %d subframe %d RNTI %x RX power (%d,%d) RSSI (%d,%d) N0 (%d,%d) dB ACK (%d,%d), decoding iter %d\n",
@@ -3874,6 +4121,7 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
              (phy_vars_eNB->dlsch_eNB[i][0]->rnti>0)) { // check for PUCCH
 
       // check SR availability
+      SR_payload = 0;
       do_SR = is_SR_subframe(phy_vars_eNB,i,sched_subframe);
       //      do_SR = 0;
 
@@ -3900,15 +4148,7 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
           phy_vars_eNB->eNB_UE_stats[i].sr_total++;
 
           if (abstraction_flag == 0)
-            metric0 = rx_pucch(phy_vars_eNB,
-                               pucch_format1,
-                               i,
-                               phy_vars_eNB->scheduling_request_config[i].sr_PUCCH_ResourceIndex,
-                               0, // n2_pucch
-                               1, // shortened format
-                               &SR_payload,
-                               subframe,
-                               PUCCH1_THRES);
+            metric0 = pucch_rx_result(&pucch_rx[pucch_rx_SR[i]],&SR_payload);
 
 #ifdef PHY_ABSTRACTION
           else {
@@ -3953,15 +4193,7 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
           n1_pucch0 = (SR_payload==1) ? phy_vars_eNB->scheduling_request_config[i].sr_PUCCH_ResourceIndex:n1_pucch0;
 
           if (abstraction_flag == 0)
-            metric0 = rx_pucch(phy_vars_eNB,
-                               pucch_format1a,
-                               i,
-                               (uint16_t)n1_pucch0,
-                               0, //n2_pucch
-                               1, // shortened format
-                               pucch_payload0,
-                               subframe,
-                               PUCCH1a_THRES);
+            metric0 = pucch_rx_result(&pucch_rx[pucch_rx_AN0[i]],pucch_payload0);
           else {
 #ifdef PHY_ABSTRACTION
             metric0 = rx_pucch_emul(phy_vars_eNB,i,
@@ -3990,18 +4222,7 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
         else {  //TDD
 
           bundling_flag = phy_vars_eNB->pucch_config_dedicated[i].tdd_AckNackFeedbackMode;
-
-          // fix later for 2 TB case and format1b
-
-          if ((frame_parms->frame_type==FDD) ||
-              (bundling_flag==bundling)    ||
-              ((frame_parms->frame_type==TDD)&&(frame_parms->tdd_config==1)&&((subframe!=2)||(subframe!=7)))) {
-            format = pucch_format1a;
-            //      msg("PUCCH 1a\n");
-          } else {
-            format = pucch_format1b;
-            //      msg("PUCCH 1b\n");
-          }
+          format = get_pucch_AN_format(phy_vars_eNB,i,subframe);
 
           // if SR was detected, use the n1_pucch from SR
           if (SR_payload==1) {
@@ -4013,15 +4234,7 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
 #endif
 
             if (abstraction_flag == 0)
-              metric0 = rx_pucch(phy_vars_eNB,
-                                 format,
-                                 i,
-                                 phy_vars_eNB->scheduling_request_config[i].sr_PUCCH_ResourceIndex,
-                                 0, //n2_pucch
-                                 1, // shortened format
-                                 pucch_payload0,
-                                 subframe,
-                                 PUCCH1a_THRES);
+              metric0 = pucch_rx_result(&pucch_rx[pucch_rx_AN0[i]],pucch_payload0);
             else {
 #ifdef PHY_ABSTRACTION
               metric0 = rx_pucch_emul(phy_vars_eNB,i,
@@ -4044,15 +4257,7 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
             // Check n1_pucch0 metric
             if (n1_pucch0 != -1) {
               if (abstraction_flag == 0)
-                metric0 = rx_pucch(phy_vars_eNB,
-                                   format,
-                                   i,
-                                   (uint16_t)n1_pucch0,
-                                   0, // n2_pucch
-                                   1, // shortened format
-                                   pucch_payload0,
-                                   subframe,
-                                   PUCCH1a_THRES);
+                metric0 = pucch_rx_result(&pucch_rx[pucch_rx_AN0[i]],pucch_payload0);
               else {
 #ifdef PHY_ABSTRACTION
                 metric0 = rx_pucch_emul(phy_vars_eNB,i,
@@ -4067,15 +4272,7 @@ void phy_procedures_eNB_RX(const unsigned char sched_subframe,PHY_VARS_eNB *phy_
             // Check n1_pucch1 metric
             if (n1_pucch1 != -1) {
               if (abstraction_flag == 0)
-                metric1 = rx_pucch(phy_vars_eNB,
-                                   format,
-                                   i,
-                                   (uint16_t)n1_pucch1,
-                                   0, //n2_pucch
-                                   1, // shortened format
-                                   pucch_payload1,
-                                   subframe,
-                                   PUCCH1a_THRES);
+                metric1 = pucch_rx_result(&pucch_rx[pucch_rx_AN1[i]],pucch_payload1);
               else {
 #ifdef PHY_ABSTRACTION
                 metric1 = rx_pucch_emul(phy_vars_eNB,i,
@@ -1254,6 +1254,17 @@ void phy_procedures_UE_TX(PHY_VARS_UE *phy_vars_ue,uint8_t eNB_id,uint8_t abstra
           start_meas(&phy_vars_ue->ofdm_mod_stats);
 
           for (aa=0; aa<frame_parms->nb_antennas_tx; aa++) {
+#ifndef OFDMA_ULSCH
+            // 7.5 kHz shift applied while the cyclic prefixes are written
+            ul_ofdm_mod_7_5kHz(&phy_vars_ue->lte_ue_common_vars.txdataF[aa][subframe_tx*nsymb*frame_parms->ofdm_symbol_size],
+#if defined(EXMIMO) || defined(OAI_USRP)
+                               dummy_tx_buffer,
+#else
+                               &phy_vars_ue->lte_ue_common_vars.txdata[aa][ulsch_start],
+#endif
+                               frame_parms);
+#else
+
             if (frame_parms->Ncp == 1)
               PHY_ofdm_mod(&phy_vars_ue->lte_ue_common_vars.txdataF[aa][subframe_tx*nsymb*frame_parms->ofdm_symbol_size],
 #if defined(EXMIMO) || defined(OAI_USRP)
@@ -1275,6 +1286,7 @@ void phy_procedures_UE_TX(PHY_VARS_UE *phy_vars_ue,uint8_t eNB_id,uint8_t abstra
                                 nsymb,
                                 &phy_vars_ue->lte_frame_parms);
 
+#endif
             /*
               if (subframe_tx == 8) {
               printf("Symbol 0 %p (offset %d) base %p\n",
@@ -1287,21 +1299,6 @@ void phy_procedures_UE_TX(PHY_VARS_UE *phy_vars_ue,uint8_t eNB_id,uint8_t abstra
               phy_vars_ue->lte_frame_parms.samples_per_tti,1,1);
               }
             */
-#ifndef OFDMA_ULSCH
-#if defined(EXMIMO) || defined(OAI_USRP)
-            apply_7_5_kHz(phy_vars_ue,dummy_tx_buffer,0);
-            apply_7_5_kHz(phy_vars_ue,dummy_tx_buffer,1);
-#else
-            apply_7_5_kHz(phy_vars_ue,&phy_vars_ue->lte_ue_common_vars.txdata[aa][ulsch_start],0);
-            apply_7_5_kHz(phy_vars_ue,&phy_vars_ue->lte_ue_common_vars.txdata[aa][ulsch_start],1);
-#endif
-            /*
-              if (subframe_tx == 8) {
-              write_output("txsig8_mod.m","txs8_mod", &phy_vars_ue->lte_ue_common_vars.txdata[0][phy_vars_ue->lte_frame_parms.samples_per_tti*subframe],
-              phy_vars_ue->lte_frame_parms.samples_per_tti,1,1);
-              }
-            */
-#endif
 
 #if defined(EXMIMO) || defined(OAI_USRP)
             overflow = ulsch_start - 9*frame_parms->samples_per_tti;
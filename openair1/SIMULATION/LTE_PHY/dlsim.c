@@ -343,6 +343,7 @@ int main(int argc, char **argv)
 
   int TB0_active = 1;
   uint32_t perfect_ce = 0;
+  uint8_t ch_est_wiener = 0;
 
   LTE_DL_UE_HARQ_t *dlsch0_ue_harq;
   LTE_DL_eNB_HARQ_t *dlsch0_eNB_harq;
@@ -378,7 +379,7 @@ int main(int argc, char **argv)
   num_layers = 1;
   perfect_ce = 0;
 
-  while ((c = getopt (argc, argv, "ahdpZDe:m:n:o:s:f:t:c:g:r:F:x:y:z:AM:N:I:i:O:R:S:C:T:b:u:v:w:B:PLl:Y")) != -1) {
+  while ((c = getopt (argc, argv, "ahdpZDe:m:n:o:s:f:t:c:g:r:F:x:y:z:AM:N:I:i:O:R:S:C:T:b:u:v:w:B:PLl:YWk:q:")) != -1) {
     switch (c) {
     case 'a':
       awgn_flag = 1;
@@ -644,6 +645,20 @@ int main(int argc, char **argv)
       perfect_ce=1;
       break;
 
+    case 'W':
+      ch_est_wiener=1;
+      break;
+
+    case 'k':
+      turbo_set_stop_policy(atoi(optarg));
+      break;
+
+    case 'q':
+      if (dlsch_set_ia_llr_mode(atoi(optarg)) != atoi(optarg))
+        msg("Reduced-complexity IA LLRs not available, using the exact kernels\n");
+
+      break;
+
     case 'h':
     default:
       printf("%s -h(elp) -a(wgn on) -d(ci decoding on) -p(extended prefix on) -m mcs1 -M mcs2 -n n_frames -s snr0 -x transmission mode (1,2,5,6) -y TXant -z RXant -I trch_file\n",argv[0]);
@@ -671,6 +686,9 @@ int main(int argc, char **argv)
       printf("-O Set the percenatge of effective rate to testbench the modem performance (typically 30 and 70, range 1-100) \n");
       printf("-I Input filename for TrCH data (binary)\n");
       printf("-u Enables the Interference Aware Receiver for TM5 (default is normal receiver)\n");
+      printf("-k Turbo decoder early termination (0 CRC after each iteration (default), 1 also after each half iteration, 2 also on stable hard decisions)\n");
+      printf("-W Wiener smoothing of the DL pilot estimates (SNR taken from the wideband CQI measurement)\n");
+      printf("-q IA receiver 16/64QAM LLRs (0 exact (default), 1 reduced hypothesis set, 2 reduced further), compare the LLR time with -P\n");
       exit(1);
       break;
     }
@@ -713,6 +731,10 @@ int main(int argc, char **argv)
   if ((transmission_mode > 1) && (n_tx != 2))
     printf("n_tx must be >1 for transmission_mode %d\n",transmission_mode);
 
+  // the MATLAB/OCTAVE output of a single frame includes the extracted RBs of the PDSCH
+  if (n_frames==1)
+    dlsch_set_fused_rx(0);
+
 #ifdef XFORMS
   fl_initialize (&argc, argv, NULL, 0, 0);
   form_ue = create_lte_phy_scope_ue();
@@ -2049,6 +2071,7 @@ int main(int argc, char **argv)
   snr_step = input_snr_step;
   PHY_vars_UE->high_speed_flag = 1;
   PHY_vars_UE->ch_est_alpha=0;
+  PHY_vars_UE->ch_est_wiener = ch_est_wiener;
 
   for (ch_realization=0; ch_realization<n_ch_rlz; ch_realization++) {
     if(abstx) {
@@ -2102,6 +2125,7 @@ int main(int argc, char **argv)
       reset_meas(&PHY_vars_UE->dlsch_tc_ext_stats);
       reset_meas(&PHY_vars_UE->dlsch_tc_intl1_stats);
       reset_meas(&PHY_vars_UE->dlsch_tc_intl2_stats);
+      reset_count_meas(&PHY_vars_UE->dlsch_turbo_iterations);
       // initialization
       struct list time_vector_tx;
       initialize(&time_vector_tx);
@@ -3803,6 +3827,7 @@ PMI_FEEDBACK:
                (double)PHY_vars_UE->dlsch_tc_intl2_stats.diff/PHY_vars_UE->dlsch_tc_intl2_stats.trials/cpu_freq_GHz/1000.0,
                (double)PHY_vars_UE->dlsch_tc_intl2_stats.diff/PHY_vars_UE->dlsch_tc_intl2_stats.trials,
                PHY_vars_UE->dlsch_tc_intl2_stats.trials);
+        print_count_meas(&PHY_vars_UE->dlsch_turbo_iterations,"DLSCH turbo iterations");
       }
 
       if ((transmission_mode != 3) && (transmission_mode != 4)) {
@@ -187,7 +187,6 @@ int main(int argc, char **argv)
   int chMod = 0 ;
   int UE_id = 0;
   unsigned char nb_rb=25,first_rb=0,mcs=0,round=0,bundling_flag=1;
-  unsigned char l;
 
   unsigned char awgn_flag = 0 ;
   SCM_t channel_model=Rice1;
@@ -274,7 +273,7 @@ int main(int argc, char **argv)
 
   logInit();
 
-  while ((c = getopt (argc, argv, "hapZbm:n:Y:X:x:s:w:e:q:d:D:O:c:r:i:f:y:c:oA:C:R:g:N:l:S:T:QB:PI:L")) != -1) {
+  while ((c = getopt (argc, argv, "hapZbm:n:Y:X:x:s:w:e:q:d:D:O:c:r:i:f:y:c:oA:C:R:g:N:l:S:T:QB:PI:Lk:")) != -1) {
     switch (c) {
     case 'a':
       channel_model = AWGN;
@@ -528,6 +527,10 @@ int main(int argc, char **argv)
       dump_table = 1;
       break;
 
+    case 'k':
+      turbo_set_stop_policy(atoi(optarg));
+      break;
+
     case 'h':
     default:
       printf("%s -h(elp) -a(wgn on) -m mcs -n n_frames -s snr0 -t delay_spread -p (extended prefix on) -r nb_rb -f first_rb -c cyclic_shift -o (srs on) -g channel_model [A:M] Use 3GPP 25.814 SCM-A/B/C/D('A','B','C','D') or 36-101 EPA('E'), EVA ('F'),ETU('G') models (ignores delay spread and Ricean factor), Rayghleigh8 ('H'), Rayleigh1('I'), Rayleigh1_corr('J'), Rayleigh1_anticorr ('K'), Rice8('L'), Rice1('M'), -d Channel delay, -D maximum Doppler shift \n",
@@ -977,6 +980,7 @@ int main(int argc, char **argv)
       reset_meas(&PHY_vars_eNB->ulsch_tc_ext_stats);
       reset_meas(&PHY_vars_eNB->ulsch_tc_intl1_stats);
       reset_meas(&PHY_vars_eNB->ulsch_tc_intl2_stats);
+      reset_count_meas(&PHY_vars_eNB->eNB_UE_stats[0].ulsch_turbo_iterations);
 
       // initialization
       struct list time_vector_tx;
@@ -1109,6 +1113,12 @@ int main(int argc, char **argv)
             start_meas(&PHY_vars_UE->ofdm_mod_stats);
 
             for (aa=0; aa<1; aa++) {
+#ifndef OFDMA_ULSCH
+              ul_ofdm_mod_7_5kHz(&PHY_vars_UE->lte_ue_common_vars.txdataF[aa][subframe*nsymb*OFDM_SYMBOL_SIZE_COMPLEX_SAMPLES_NO_PREFIX],
+                                 &txdata[aa][PHY_vars_eNB->lte_frame_parms.samples_per_tti*subframe],
+                                 frame_parms);
+#else
+
               if (frame_parms->Ncp == 1)
                 PHY_ofdm_mod(&PHY_vars_UE->lte_ue_common_vars.txdataF[aa][subframe*nsymb*OFDM_SYMBOL_SIZE_COMPLEX_SAMPLES_NO_PREFIX],        // input
                              &txdata[aa][PHY_vars_eNB->lte_frame_parms.samples_per_tti*subframe],         // output
@@ -1122,9 +1132,6 @@ int main(int argc, char **argv)
                                   nsymb,
                                   frame_parms);
 
-#ifndef OFDMA_ULSCH
-              apply_7_5_kHz(PHY_vars_UE,PHY_vars_UE->lte_ue_common_vars.txdata[aa],subframe<<1);
-              apply_7_5_kHz(PHY_vars_UE,PHY_vars_UE->lte_ue_common_vars.txdata[aa],1+(subframe<<1));
 #endif
 
               stop_meas(&PHY_vars_UE->ofdm_mod_stats);
@@ -1242,29 +1249,23 @@ int main(int argc, char **argv)
             //write_output("rxsig1UL.m","rxs1", &PHY_vars_eNB->lte_eNB_common_vars.rxdata[0][0][PHY_vars_eNB->lte_frame_parms.samples_per_tti*subframe],PHY_vars_eNB->lte_frame_parms.samples_per_tti,1,1);
           }
 
-#ifndef OFDMA_ULSCH
-          remove_7_5_kHz(PHY_vars_eNB,subframe<<1);
-          remove_7_5_kHz(PHY_vars_eNB,1+(subframe<<1));
-          //  write_output("rxsig0_75.m","rxs0_75", &PHY_vars_eNB->lte_eNB_common_vars.rxdata[0][0][PHY_vars_eNB->lte_frame_parms.samples_per_tti*subframe],PHY_vars_eNB->lte_frame_parms.samples_per_tti,1,1);
-          //  write_output("rxsig1_75.m","rxs1_75", &PHY_vars_eNB->lte_eNB_common_vars.rxdata[0][0][PHY_vars_eNB->lte_frame_parms.samples_per_tti*subframe],PHY_vars_eNB->lte_frame_parms.samples_per_tti,1,1);
-
-#endif
-
           start_meas(&PHY_vars_eNB->phy_proc_rx);
           start_meas(&PHY_vars_eNB->ofdm_demod_stats);
           lte_eNB_I0_measurements(PHY_vars_eNB,
                                   0,
                                   1);
 
-          for (l=subframe*PHY_vars_UE->lte_frame_parms.symbols_per_tti; l<((1+subframe)*PHY_vars_UE->lte_frame_parms.symbols_per_tti); l++) {
-
-            slot_fep_ul(&PHY_vars_eNB->lte_frame_parms,
-                        &PHY_vars_eNB->lte_eNB_common_vars,
-                        l%(PHY_vars_eNB->lte_frame_parms.symbols_per_tti/2),
-                        l/(PHY_vars_eNB->lte_frame_parms.symbols_per_tti/2),
-                        0,
-                        0);
-          }
+#ifndef OFDMA_ULSCH
+          slot_fep_ul_subframe_7_5kHz(PHY_vars_eNB,
+                                      subframe,
+                                      0);
+#else
+          slot_fep_ul_subframe(&PHY_vars_eNB->lte_frame_parms,
+                               &PHY_vars_eNB->lte_eNB_common_vars,
+                               subframe,
+                               0,
+                               0);
+#endif
 
           stop_meas(&PHY_vars_eNB->ofdm_demod_stats);
 
@@ -1688,6 +1689,7 @@ int main(int argc, char **argv)
                (double)PHY_vars_eNB->ulsch_tc_intl2_stats.diff/PHY_vars_eNB->ulsch_tc_intl2_stats.trials/cpu_freq_GHz/1000.0,
                (double)PHY_vars_eNB->ulsch_tc_intl2_stats.diff/PHY_vars_eNB->ulsch_tc_intl2_stats.trials,
                PHY_vars_eNB->ulsch_tc_intl2_stats.trials);
+        print_count_meas(&PHY_vars_eNB->eNB_UE_stats[0].ulsch_turbo_iterations,"ULSCH turbo iterations");
       }
 
       if(abstx) { //ABSTRACTION
@@ -316,6 +316,8 @@ static int                      mbox_bounds[20] =   {8,16,24,30,38,46,54,60,68,7
 static LTE_DL_FRAME_PARMS      *frame_parms[MAX_NUM_CCs];
 
 int multi_thread=1;
+static int cb_workers=0;
+static int cb_first_cpu=-1;
 uint32_t target_dl_mcs = 28; //maximum allowed mcs
 uint32_t target_ul_mcs = 10;
 uint8_t exit_missed_slots=1;
@@ -435,7 +437,11 @@ void help (void) {
   printf("  --ue-rxgain set UE RX gain\n");
   printf("  --ue-txgain set UE TX gain\n");
   printf("  --ue-scan_carrier set UE to scan around carrier\n");
+  printf("  --ue-sync-coarse search the PSS on the signal decimated to 1.92 Msps first during the initial synchronization\n");
   printf("  --loop-memory get softmodem (UE) to loop through memory instead of acquiring from HW\n");
+  printf("  --cb-workers number of threads decoding the ULSCH and encoding the DLSCH code blocks along with the eNB TX/RX threads (default 0)\n");
+  printf("  --cb-workers-cpu pin the code block threads to this CPU and the following ones, the eNB TX/RX threads to the CPUs below it\n");
+  printf("  --turbo-early-stop turbo decoder early termination: 0 CRC after each iteration (default), 1 also after each half iteration, 2 also stop when the hard decisions no longer change\n");
   printf("  -C Set the downlink frequecny for all Component carrier\n");
   printf("  -d Enable soft scope and L1 and L2 stats (Xforms)\n");
   printf("  -F Calibrate the EXMIMO borad, available files: exmimo2_2arxg.lime exmimo2_2brxg.lime \n");
@@ -1420,6 +1426,24 @@ void init_eNB_proc(void)
       pthread_cond_init( &PHY_vars_eNB_g[0][CC_id]->proc[i].cond_rx, NULL);
       pthread_create( &PHY_vars_eNB_g[0][CC_id]->proc[i].pthread_tx, NULL, eNB_thread_tx, &PHY_vars_eNB_g[0][CC_id]->proc[i] );
       pthread_create( &PHY_vars_eNB_g[0][CC_id]->proc[i].pthread_rx, NULL, eNB_thread_rx, &PHY_vars_eNB_g[0][CC_id]->proc[i] );
+
+      // keep the TX/RX threads off the CPUs of the code block workers
+      if ((cb_workers > 0) && (cb_first_cpu > 0)) {
+        cpu_set_t cpuset;
+        int cpu;
+
+        CPU_ZERO(&cpuset);
+
+        for (cpu=0; cpu<cb_first_cpu; cpu++)
+          CPU_SET(cpu,&cpuset);
+
+        if (pthread_setaffinity_np( PHY_vars_eNB_g[0][CC_id]->proc[i].pthread_tx, sizeof(cpuset), &cpuset ) != 0)
+          perror("[ENB_PROC_TX] setting thread affinity failed\n");
+
+        if (pthread_setaffinity_np( PHY_vars_eNB_g[0][CC_id]->proc[i].pthread_rx, sizeof(cpuset), &cpuset ) != 0)
+          perror("[ENB_PROC_RX] setting thread affinity failed\n");
+      }
+
       char name[16];
       snprintf( name, sizeof(name), "TX %d", i );
       pthread_setname_np( PHY_vars_eNB_g[0][CC_id]->proc[i].pthread_tx, name );
@@ -2023,9 +2047,13 @@ static void get_options (int argc, char **argv)
     LONG_OPTION_RXGAIN,
     LONG_OPTION_TXGAIN,
     LONG_OPTION_SCANCARRIER,
+    LONG_OPTION_SYNC_COARSE,
     LONG_OPTION_MAXPOWER,
     LONG_OPTION_DUMP_FRAME,
-    LONG_OPTION_LOOPMEMORY
+    LONG_OPTION_LOOPMEMORY,
+    LONG_OPTION_CB_WORKERS,
+    LONG_OPTION_CB_WORKERS_CPU,
+    LONG_OPTION_TURBO_EARLY_STOP
   };
 
   static const struct option long_options[] = {
@@ -2039,9 +2067,13 @@ static void get_options (int argc, char **argv)
     {"ue-rxgain",   required_argument,  NULL, LONG_OPTION_RXGAIN},
     {"ue-txgain",   required_argument,  NULL, LONG_OPTION_TXGAIN},
     {"ue-scan-carrier",   no_argument,  NULL, LONG_OPTION_SCANCARRIER},
+    {"ue-sync-coarse",   no_argument,  NULL, LONG_OPTION_SYNC_COARSE},
     {"ue-max-power",   required_argument,  NULL, LONG_OPTION_MAXPOWER},
     {"ue-dump-frame", no_argument, NULL, LONG_OPTION_DUMP_FRAME},
     {"loop-memory", required_argument, NULL, LONG_OPTION_LOOPMEMORY},
+    {"cb-workers", required_argument, NULL, LONG_OPTION_CB_WORKERS},
+    {"cb-workers-cpu", required_argument, NULL, LONG_OPTION_CB_WORKERS_CPU},
+    {"turbo-early-stop", required_argument, NULL, LONG_OPTION_TURBO_EARLY_STOP},
     {NULL, 0, NULL, 0}
   };
 
@@ -2104,12 +2136,29 @@ static void get_options (int argc, char **argv)
 
       break;
 
+    case LONG_OPTION_SYNC_COARSE:
+      lte_sync_time_set_method(SYNC_TIME_FD_COARSE);
+      break;
+
     case LONG_OPTION_LOOPMEMORY:
       mode=loop_through_memory;
       input_fd = fopen(optarg,"r");
       AssertFatal(input_fd != NULL,"Please provide an input file\n");
       break;
 
+    case LONG_OPTION_CB_WORKERS:
+      cb_workers = atoi(optarg);
+      break;
+
+    case LONG_OPTION_CB_WORKERS_CPU:
+      cb_first_cpu = atoi(optarg);
+      break;
+
+    case LONG_OPTION_TURBO_EARLY_STOP:
+      AssertFatal((atoi(optarg) >= TURBO_STOP_CRC) && (atoi(optarg) <= TURBO_STOP_CRC_HALF_HD),"--turbo-early-stop takes 0, 1 or 2\n");
+      turbo_set_stop_policy(atoi(optarg));
+      break;
+
    case LONG_OPTION_DUMP_FRAME:
      mode = rx_dump_frame;
      break;
@@ -3260,6 +3309,9 @@ int main( int argc, char **argv )
 #endif
     printf("UE threads created\n");
   } else {
+    if (cb_workers>0)
+      cb_pool_init(cb_workers,cb_first_cpu);
+
     if (multi_thread>0) {
       init_eNB_proc();
       sleep(1);
@@ -3396,6 +3448,8 @@ int main( int argc, char **argv )
       kill_eNB_proc();
 
     }
+
+    cb_pool_free();
   }
 
 #ifdef OPENAIR2
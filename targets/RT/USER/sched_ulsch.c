@@ -95,6 +95,8 @@ static void * ulsch_thread(void *param)
 
   //unsigned long cpuid;
   unsigned int ulsch_thread_index = (unsigned int)param;
+  // one thread per UE
+  uint8_t ulsch_UE_id = (uint8_t)ulsch_thread_index;
 
   RTIME time_in,time_out;
 #ifdef RTAI
@@ -162,7 +164,7 @@ static void * ulsch_thread(void *param)
 
     time_in = rt_get_time_ns();
 
-    ulsch_decoding_procedures(ulsch_subframe[ulsch_thread_index]<<1,ulsch_thread_index,phy_vars_eNB,0);
+    ulsch_decoding_procedures(ulsch_subframe[ulsch_thread_index]<<1,&ulsch_UE_id,1,phy_vars_eNB,0);
 
     time_out = rt_get_time_ns();
 